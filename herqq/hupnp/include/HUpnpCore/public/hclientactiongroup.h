@@ -0,0 +1 @@
+#include "../../../src/devicemodel/client/hclientactiongroup.h"
@@ -20,6 +20,7 @@
  */
 
 #include "hclientmodel_creator_p.h"
+#include "hclientservice_loader_p.h"
 
 #include "../../dataelements/hudn.h"
 #include "../../dataelements/hserviceid.h"
@@ -39,8 +40,6 @@
 
 #include "../../general/hlogger_p.h"
 
-#include <QtXml/QDomElement>
-
 namespace Herqq
 {
 
@@ -51,7 +50,7 @@ namespace Upnp
  * HClientModelCreationArgs
  ******************************************************************************/
 HClientModelCreationArgs::HClientModelCreationArgs(QNetworkAccessManager* nam) :
-    m_nam(nam)
+    m_nam(nam), m_lazyServiceLoading(false)
 {
 }
 
@@ -62,7 +61,8 @@ HClientModelCreationArgs::~HClientModelCreationArgs()
 HClientModelCreationArgs::HClientModelCreationArgs(
     const HClientModelCreationArgs& other) :
         HModelCreationArgs(other),
-            m_nam(other.m_nam)
+            m_nam(other.m_nam),
+            m_lazyServiceLoading(other.m_lazyServiceLoading)
 {
 }
 
@@ -72,6 +72,7 @@ HClientModelCreationArgs& HClientModelCreationArgs::operator=(
     Q_ASSERT(this != &other);
     HModelCreationArgs::operator=(other);
     m_nam = other.m_nam;
+    m_lazyServiceLoading = other.m_lazyServiceLoading;
     return *this;
 }
 
@@ -89,19 +90,11 @@ HClientModelCreator::HClientModelCreator(
     Q_ASSERT(!creationParameters.m_loggingIdentifier.isEmpty());
 }
 
-bool HClientModelCreator::parseStateVariables(
-    HDefaultClientService* service, QDomElement stateVariableElement)
+void HClientModelCreator::createStateVariables(
+    HDefaultClientService* service, const QList<HStateVariableInfo>& svInfos)
 {
-    while(!stateVariableElement.isNull())
+    foreach(const HStateVariableInfo& svInfo, svInfos)
     {
-        HStateVariableInfo svInfo;
-        if (!m_docParser.parseStateVariable(stateVariableElement, &svInfo))
-        {
-            m_lastError = convert(m_docParser.lastError());
-            m_lastErrorDescription = m_docParser.lastErrorDescription();
-            return false;
-        }
-
         HDefaultClientStateVariable* sv =
             new HDefaultClientStateVariable(svInfo, service);
 
@@ -116,45 +109,20 @@ bool HClientModelCreator::parseStateVariables(
             SLOT(notifyListeners()));
 
         Q_ASSERT(ok); Q_UNUSED(ok)
-
-        Q_ASSERT(ok); Q_UNUSED(ok)
-
-        stateVariableElement =
-            stateVariableElement.nextSiblingElement("stateVariable");
     }
-
-    return true;
 }
 
-bool HClientModelCreator::parseActions(
-    HDefaultClientService* service, QDomElement actionElement,
-    const HStateVariableInfos& svInfos)
+void HClientModelCreator::createActions(
+    HDefaultClientService* service, const QList<HActionInfo>& actionInfos,
+    QNetworkAccessManager& nam)
 {
-    while(!actionElement.isNull())
+    foreach(const HActionInfo& actionInfo, actionInfos)
     {
-        HActionInfo actionInfo;
-        if (!m_docParser.parseActionInfo(
-                actionElement, svInfos, &actionInfo))
-        {
-            m_lastError = convert(m_docParser.lastError());
-            m_lastErrorDescription = m_docParser.lastErrorDescription();
-            return false;
-        }
-
         HDefaultClientAction* action =
-            new HDefaultClientAction(
-                actionInfo,
-                service,
-                *m_creationParameters->m_nam);
-
-        QString name = action->info().name();
+            new HDefaultClientAction(actionInfo, service, nam);
 
         service->addAction(action);
-
-        actionElement = actionElement.nextSiblingElement("action");
     }
-
-    return true;
 }
 
 bool HClientModelCreator::parseServiceDescription(HDefaultClientService* service)
@@ -162,54 +130,48 @@ bool HClientModelCreator::parseServiceDescription(HDefaultClientService* service
     HLOG2(H_AT, H_FUN, m_creationParameters->m_loggingIdentifier);
     Q_ASSERT(service);
 
-    QDomDocument doc;
-    QDomElement firstSv, firstAction;
+    HServiceDescriptionData descriptionData;
     if (!m_docParser.parseServiceDescription(
-        service->description(), &doc, &firstSv, &firstAction))
+        service->description(), &descriptionData))
     {
         m_lastError = convert(m_docParser.lastError());
         m_lastErrorDescription = m_docParser.lastErrorDescription();
         return false;
     }
 
-    if (!parseStateVariables(service, firstSv))
-    {
-        return false;
-    }
-
-    HStateVariableInfos svInfos;
-    HClientStateVariables svs = service->stateVariables();
-    foreach(const QString& key, svs.keys())
-    {
-        svInfos.insert(key, svs.value(key)->info());
-    }
+    createStateVariables(service, descriptionData.m_stateVariables);
+    createActions(
+        service, descriptionData.m_actions, *m_creationParameters->m_nam);
 
-    return parseActions(service, firstAction, svInfos);
+    return true;
 }
 
-bool HClientModelCreator::parseServiceList(
-    const QDomElement& serviceListElement, HDefaultClientDevice* device,
+bool HClientModelCreator::createServices(
+    const QList<HServiceInfo>& serviceInfos, HDefaultClientDevice* device,
     QList<HDefaultClientService*>* retVal)
 {
     HLOG2(H_AT, H_FUN, m_creationParameters->m_loggingIdentifier);
 
     Q_ASSERT(device);
-    Q_ASSERT(!serviceListElement.isNull());
 
-    QDomElement serviceElement = serviceListElement.firstChildElement("service");
-    while(!serviceElement.isNull())
+    foreach(const HServiceInfo& info, serviceInfos)
     {
-        HServiceInfo info;
-        if (!m_docParser.parseServiceInfo(serviceElement, &info))
-        {
-            m_lastError = convert(m_docParser.lastError());
-            m_lastErrorDescription = m_docParser.lastErrorDescription();
-            return false;
-        }
-
         QScopedPointer<HDefaultClientService> service(
             new HDefaultClientService(info, device));
 
+        if (m_creationParameters->m_lazyServiceLoading)
+        {
+            service->setLoader(new HLazyServiceLoader(
+                m_creationParameters->m_loggingIdentifier,
+                extractBaseUrl(m_creationParameters->m_deviceLocations[0]),
+                info.scpdUrl(),
+                service.data(),
+                m_creationParameters->m_nam));
+
+            retVal->push_back(service.take());
+            continue;
+        }
+
         QString description;
         if (!m_creationParameters->m_serviceDescriptionFetcher(
                 extractBaseUrl(m_creationParameters->m_deviceLocations[0]),
@@ -230,59 +192,43 @@ bool HClientModelCreator::parseServiceList(
         }
 
         retVal->push_back(service.take());
-
-        serviceElement = serviceElement.nextSiblingElement("service");
     }
 
     return true;
 }
 
-HDefaultClientDevice* HClientModelCreator::parseDevice(
-    const QDomElement& deviceElement, HDefaultClientDevice* parentDevice)
+HDefaultClientDevice* HClientModelCreator::createDevice(
+    const HDeviceDescriptionData& deviceData, HDefaultClientDevice* parentDevice)
 {
     HLOG2(H_AT, H_FUN, m_creationParameters->m_loggingIdentifier);
 
-    HDeviceInfo deviceInfo;
-    if (!m_docParser.parseDeviceInfo(deviceElement, &deviceInfo))
-    {
-        m_lastError = convert(m_docParser.lastError());
-        m_lastErrorDescription = m_docParser.lastErrorDescription();
-        return 0;
-    }
-
     QScopedPointer<HDefaultClientDevice> device(
         new HDefaultClientDevice(
             m_creationParameters->m_deviceDescription,
             m_creationParameters->m_deviceLocations,
-            deviceInfo,
+            deviceData.m_info,
             m_creationParameters->m_deviceTimeoutInSecs,
             parentDevice));
 
-    QDomElement serviceListElement =
-        deviceElement.firstChildElement("serviceList");
-
-    if (!serviceListElement.isNull())
+    if (!deviceData.m_services.isEmpty())
     {
         QList<HDefaultClientService*> services;
-        if (!parseServiceList(serviceListElement, device.data(), &services))
+        if (!createServices(deviceData.m_services, device.data(), &services))
         {
             return 0;
         }
         device->setServices(services);
     }
 
-    QDomElement deviceListElement = deviceElement.firstChildElement("deviceList");
-    if (!deviceListElement.isNull())
+    if (!deviceData.m_embeddedDevices.isEmpty())
     {
         QList<HDefaultClientDevice*> embeddedDevices;
 
-        QDomElement embeddedDeviceElement =
-            deviceListElement.firstChildElement("device");
-
-        while(!embeddedDeviceElement.isNull())
+        foreach(const HDeviceDescriptionData& embeddedDeviceData,
+                deviceData.m_embeddedDevices)
         {
             HDefaultClientDevice* embeddedDevice =
-                parseDevice(embeddedDeviceElement, device.data());
+                createDevice(embeddedDeviceData, device.data());
 
             if (!embeddedDevice)
             {
@@ -292,9 +238,6 @@ HDefaultClientDevice* HClientModelCreator::parseDevice(
             embeddedDevice->setParent(device.data());
 
             embeddedDevices.push_back(embeddedDevice);
-
-            embeddedDeviceElement =
-                embeddedDeviceElement.nextSiblingElement("device");
         }
 
         device->setEmbeddedDevices(embeddedDevices);
@@ -307,10 +250,11 @@ HDefaultClientDevice* HClientModelCreator::createRootDevice()
 {
     HLOG2(H_AT, H_FUN, m_creationParameters->m_loggingIdentifier);
 
-    QDomDocument doc;
-    QDomElement rootElement;
-    if (!m_docParser.parseRoot(
-            m_creationParameters->m_deviceDescription, &doc, &rootElement))
+    HDeviceDescriptionData rootDeviceData;
+    qint32 configId = 0;
+    if (!m_docParser.parseDeviceDescription(
+            m_creationParameters->m_deviceDescription, &rootDeviceData,
+            &configId))
     {
         m_lastError = convert(m_docParser.lastError());
         m_lastErrorDescription = m_docParser.lastErrorDescription();
@@ -318,14 +262,14 @@ HDefaultClientDevice* HClientModelCreator::createRootDevice()
     }
 
     QScopedPointer<HDefaultClientDevice> createdDevice(
-        parseDevice(rootElement, 0));
+        createDevice(rootDeviceData, 0));
 
     if (!createdDevice)
     {
         return 0;
     }
 
-    createdDevice->setConfigId(m_docParser.readConfigId(rootElement));
+    createdDevice->setConfigId(configId);
 
     HDeviceValidator validator;
     if (!validator.validateRootDevice<HClientDevice, HClientService>(createdDevice.data()))
@@ -33,8 +33,6 @@
 #include "../hddoc_parser_p.h"
 #include "../hmodelcreation_p.h"
 
-#include <QtXml/QDomElement>
-
 class QNetworkAccessManager;
 
 namespace Herqq
@@ -55,6 +53,11 @@ public:
 
     QNetworkAccessManager* m_nam;
 
+    bool m_lazyServiceLoading;
+    // when true, the service descriptions are not retrieved while the device
+    // model is created. instead, each service is given a loader that
+    // retrieves the description once it is needed.
+
     HClientModelCreationArgs(QNetworkAccessManager* nam);
     virtual ~HClientModelCreationArgs();
 
@@ -95,24 +98,14 @@ private:
 
 private:
 
-    QList<QPair<QUrl, QByteArray> > parseIconList(
-        const QDomElement& iconListElement);
-
-    bool parseStateVariables(
-        HDefaultClientService* service, QDomElement stateVariableElement);
-
-    bool parseActions(
-        HDefaultClientService*, QDomElement actionElement,
-        const HStateVariableInfos& svInfos);
-
     bool parseServiceDescription(HDefaultClientService*);
 
-    bool parseServiceList(
-        const QDomElement& serviceListElement, HDefaultClientDevice*,
+    bool createServices(
+        const QList<HServiceInfo>&, HDefaultClientDevice*,
         QList<HDefaultClientService*>* retVal);
 
-    HDefaultClientDevice* parseDevice(
-        const QDomElement& deviceElement, HDefaultClientDevice* parentDevice);
+    HDefaultClientDevice* createDevice(
+        const HDeviceDescriptionData&, HDefaultClientDevice* parentDevice);
 
     inline ErrorType convert(DocumentErrorTypes type)
     {
@@ -131,6 +124,13 @@ private:
 
 public:
 
+    static void createStateVariables(
+        HDefaultClientService* service, const QList<HStateVariableInfo>&);
+
+    static void createActions(
+        HDefaultClientService* service, const QList<HActionInfo>&,
+        QNetworkAccessManager&);
+
     HClientModelCreator(const HClientModelCreationArgs&);
     HDefaultClientDevice* createRootDevice();
 
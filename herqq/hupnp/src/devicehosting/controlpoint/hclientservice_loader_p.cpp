@@ -0,0 +1,227 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hclientservice_loader_p.h"
+#include "hclientmodel_creator_p.h"
+#include "hcontrolpoint_dataretriever_p.h"
+
+#include "../../devicemodel/client/hdefault_clientservice_p.h"
+
+#include "../../general/hlogger_p.h"
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+/*******************************************************************************
+ * HServiceDescriptionFetchTask
+ ******************************************************************************/
+class HServiceDescriptionFetchTask :
+    public HExecutorTask
+{
+H_DISABLE_COPY(HServiceDescriptionFetchTask)
+
+private:
+
+    HLazyServiceLoader* m_owner;
+
+public:
+
+    HServiceDescriptionFetchTask(Priority priority, HLazyServiceLoader* owner) :
+        HExecutorTask(priority, owner), m_owner(owner)
+    {
+    }
+
+    virtual void run()
+    {
+        m_owner->fetch(priority() == ActionPriority);
+    }
+};
+
+/*******************************************************************************
+ * HLazyServiceLoader
+ ******************************************************************************/
+HLazyServiceLoader::HLazyServiceLoader(
+    const QByteArray& loggingIdentifier, const QUrl& baseUrl,
+    const QUrl& scpdUrl, HDefaultClientService* service,
+    QNetworkAccessManager* nam) :
+        m_loggingIdentifier(loggingIdentifier),
+        m_baseUrl(baseUrl),
+        m_scpdUrl(scpdUrl),
+        m_service(service),
+        m_nam(nam),
+        m_executor(0),
+        m_mutex(),
+        m_fetched(false),
+        m_description(),
+        m_descriptionData(),
+        m_fetchesInProgress(0),
+        m_urgentFetchInProgress(false)
+{
+    Q_ASSERT(m_service);
+    Q_ASSERT(m_nam);
+}
+
+HLazyServiceLoader::~HLazyServiceLoader()
+{
+    if (m_executor)
+    {
+        m_executor->cancel(this);
+        HExecutor::releaseShared();
+    }
+}
+
+bool HLazyServiceLoader::retrieve()
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    // the data retriever runs an event loop of its own and it has to be
+    // created in the thread that uses it
+    HDataRetriever dataRetriever(m_loggingIdentifier);
+
+    QString description;
+    if (!dataRetriever.retrieveServiceDescription(
+            m_baseUrl, m_scpdUrl, &description))
+    {
+        HLOG_WARN(QString(
+            "Could not retrieve service description from [%1]: %2").arg(
+                m_scpdUrl.toString(), dataRetriever.lastError()));
+
+        return false;
+    }
+
+    HServiceDescriptionData descriptionData;
+    HDocParser docParser(m_loggingIdentifier, LooseChecks);
+    if (!docParser.parseServiceDescription(description, &descriptionData))
+    {
+        HLOG_WARN(QString(
+            "Failed to parse the service description from [%1]: %2").arg(
+                m_scpdUrl.toString(), docParser.lastErrorDescription()));
+
+        return false;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_description = description;
+    m_descriptionData = descriptionData;
+    m_fetched = true;
+
+    return true;
+}
+
+void HLazyServiceLoader::fetch(bool urgent)
+{
+    bool fetched;
+    {
+        QMutexLocker locker(&m_mutex);
+        fetched = m_fetched;
+    }
+
+    if (!fetched)
+    {
+        fetched = retrieve();
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    --m_fetchesInProgress;
+    if (urgent)
+    {
+        m_urgentFetchInProgress = false;
+    }
+
+    if (fetched)
+    {
+        // the service is deleted only after the running fetch has completed,
+        // since the destructor of the service deletes this instance
+        bool ok = QMetaObject::invokeMethod(
+            m_service, "descriptionRetrieved", Qt::QueuedConnection);
+
+        Q_ASSERT(ok); Q_UNUSED(ok)
+    }
+}
+
+void HLazyServiceLoader::prefetch(bool urgent)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    QMutexLocker locker(&m_mutex);
+    if (m_fetched ||
+        (m_fetchesInProgress > 0 && (!urgent || m_urgentFetchInProgress)))
+    {
+        // the description has been retrieved already or it is being retrieved
+        // at the requested priority. a failed retrieval is tried again on
+        // the next request.
+        return;
+    }
+
+    if (!m_executor)
+    {
+        m_executor = HExecutor::acquireShared();
+    }
+
+    // a queued prefetch is not cancelled when an urgent fetch is submitted,
+    // since cancelling would wait for the prefetch in case it is running.
+    // the fetch that runs second finds the description already retrieved.
+    if (!m_executor->submit(new HServiceDescriptionFetchTask(
+            urgent ? HExecutorTask::ActionPriority :
+                     HExecutorTask::DescriptionPriority, this)))
+    {
+        HLOG_WARN(QString(
+            "Could not load the service description from [%1]: the "
+            "executor is shutting down").arg(m_scpdUrl.toString()));
+
+        return;
+    }
+
+    ++m_fetchesInProgress;
+    if (urgent)
+    {
+        m_urgentFetchInProgress = true;
+    }
+}
+
+bool HLazyServiceLoader::load(HDefaultClientService* service)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+    Q_ASSERT(service);
+
+    QMutexLocker locker(&m_mutex);
+    if (!m_fetched)
+    {
+        return false;
+    }
+
+    service->setDescription(m_description);
+
+    HClientModelCreator::createStateVariables(
+        service, m_descriptionData.m_stateVariables);
+
+    HClientModelCreator::createActions(
+        service, m_descriptionData.m_actions, *m_nam);
+
+    return true;
+}
+
+}
+}
@@ -0,0 +1,106 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HCLIENTSERVICE_LOADER_P_H_
+#define HCLIENTSERVICE_LOADER_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "../hddoc_parser_p.h"
+#include "../../devicemodel/client/hclientservice_p.h"
+#include "../../utils/hexecutor_p.h"
+
+#include <QtCore/QUrl>
+#include <QtCore/QMutex>
+
+class QNetworkAccessManager;
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+//
+// Retrieves and parses the description of a single service in an executor task
+// and creates the actions and the state variables of the service once the
+// service asks for them. Nothing is done in the thread of the service except
+// creating the actions and the state variables.
+//
+class HLazyServiceLoader :
+    public HClientServiceLoader
+{
+H_DISABLE_COPY(HLazyServiceLoader)
+friend class HServiceDescriptionFetchTask;
+
+private:
+
+    const QByteArray m_loggingIdentifier;
+    const QUrl m_baseUrl;
+    const QUrl m_scpdUrl;
+
+    HDefaultClientService* m_service;
+    // the service that is notified when the description has been retrieved
+
+    QNetworkAccessManager* m_nam;
+    // used by the created actions
+
+    HExecutor* m_executor;
+    // the shared executor, acquired when the first fetch is submitted
+
+    QMutex m_mutex;
+    // guards the members below, which are written by the fetch task
+
+    bool m_fetched;
+    QString m_description;
+    HServiceDescriptionData m_descriptionData;
+
+    qint32 m_fetchesInProgress;
+    bool m_urgentFetchInProgress;
+
+    bool retrieve();
+    void fetch(bool urgent);
+
+public:
+
+    HLazyServiceLoader(
+        const QByteArray& loggingIdentifier, const QUrl& baseUrl,
+        const QUrl& scpdUrl, HDefaultClientService* service,
+        QNetworkAccessManager* nam);
+
+    virtual ~HLazyServiceLoader();
+    // cancels the fetch tasks that are queued and waits for a running
+    // one to complete
+
+    virtual void prefetch(bool urgent);
+    virtual bool load(HDefaultClientService*);
+};
+
+}
+}
+
+#endif /* HCLIENTSERVICE_LOADER_P_H_ */
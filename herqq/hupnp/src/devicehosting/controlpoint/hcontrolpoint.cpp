@@ -31,7 +31,9 @@
 #include "../../general/hupnp_datatypes_p.h"
 
 #include "../../dataelements/hdeviceinfo.h"
+#include "../../dataelements/hserviceinfo.h"
 #include "../../dataelements/hdiscoverytype.h"
+#include "../../dataelements/hresourcetype.h"
 #include "../../dataelements/hproduct_tokens.h"
 
 #include "../../devicemodel/client/hdefault_clientdevice_p.h"
@@ -105,6 +107,12 @@ HControlPointSsdpHandler::HControlPointSsdpHandler(
         HSsdp(owner->m_loggingIdentifier, owner), m_owner(owner)
 {
     setFilter(DiscoveryResponse | DeviceUnavailable | DeviceAvailable);
+
+    HSsdpPrefilter* prefilter = m_owner->m_ssdpPrefilter.data();
+    if (prefilter && !prefilter->isEmpty())
+    {
+        h_ptr->m_prefilter = prefilter;
+    }
 }
 
 HControlPointSsdpHandler::~HControlPointSsdpHandler()
@@ -143,18 +151,30 @@ HControlPointPrivate::HControlPointPrivate() :
         m_ssdps(),
         m_server(0),
         m_eventSubscriber(0),
+        m_connectionPool(0),
+        m_multicastEventListener(0),
         m_lastError(HControlPoint::UndefinedError),
         q_ptr(0),
         m_nam(new QNetworkAccessManager(this)),
         m_state(HControlPointPrivate::Uninitialized),
-        m_threadPool(new HThreadPool(this)),
-        m_deviceStorage(m_loggingIdentifier)
+        m_executor(HExecutor::acquireShared()),
+        m_deviceStorage(m_loggingIdentifier),
+        m_ssdpPrefilter(),
+        m_deviceExpiryWheel(m_loggingIdentifier, this)
 {
+    bool ok = connect(
+        &m_deviceExpiryWheel, SIGNAL(expired(Herqq::Upnp::HUdn)),
+        this, SLOT(deviceExpired(Herqq::Upnp::HUdn)));
+
+    Q_ASSERT(ok); Q_UNUSED(ok)
 }
 
 HControlPointPrivate::~HControlPointPrivate()
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    m_executor->cancel(this);
+    HExecutor::releaseShared();
 }
 
 HDefaultClientDevice* HControlPointPrivate::buildDevice(
@@ -188,6 +208,7 @@ HDefaultClientDevice* HControlPointPrivate::buildDevice(
         IconFetcher(&dataRetriever, &HDataRetriever::retrieveIcon);
 
     creatorParams.m_loggingIdentifier = m_loggingIdentifier;
+    creatorParams.m_lazyServiceLoading = m_configuration->lazyServiceLoading();
 
     HClientModelCreator creator(creatorParams);
     HDefaultClientDevice* device = creator.createRootDevice();
@@ -231,13 +252,6 @@ bool HControlPointPrivate::addRootDevice(HDefaultClientDevice* newRootDevice)
     }
 
     newRootDevice->setParent(this);
-    newRootDevice->startStatusNotifier(HDefaultClientDevice::All);
-
-    bool ok = connect(
-        newRootDevice, SIGNAL(statusTimeout(HDefaultClientDevice*)),
-        this, SLOT(deviceExpired(HDefaultClientDevice*)));
-
-    Q_ASSERT(ok); Q_UNUSED(ok)
 
     if (!m_deviceStorage.addRootDevice(newRootDevice))
     {
@@ -249,28 +263,74 @@ bool HControlPointPrivate::addRootDevice(HDefaultClientDevice* newRootDevice)
         return false;
     }
 
+    m_deviceExpiryWheel.reset(
+        newRootDevice->info().udn(), newRootDevice->deviceTimeoutInSecs());
+
+    if (m_configuration->lazyServiceLoading() &&
+        m_configuration->prefetchServiceDescriptions())
+    {
+        prefetchServiceDescriptions(newRootDevice);
+    }
+
     emit q_ptr->rootDeviceOnline(newRootDevice);
     return true;
 }
 
-void HControlPointPrivate::deviceExpired(HDefaultClientDevice* source)
+void HControlPointPrivate::prefetchServiceDescriptions(HClientDevice* device)
+{
+    HClientServices services(device->services());
+    for(qint32 i = 0; i < services.size(); ++i)
+    {
+        static_cast<HDefaultClientService*>(services.at(i))->prefetch();
+    }
+
+    HClientDevices devices(device->embeddedDevices());
+    for(qint32 i = 0; i < devices.size(); ++i)
+    {
+        prefetchServiceDescriptions(devices.at(i));
+    }
+}
+
+void HControlPointPrivate::removeMulticastEvents(HClientDevice* device)
+{
+    if (!m_multicastEventListener)
+    {
+        return;
+    }
+
+    m_multicastEventListener->removeDevice(device->info().udn());
+
+    HClientDevices devices(device->embeddedDevices());
+    for(qint32 i = 0; i < devices.size(); ++i)
+    {
+        removeMulticastEvents(devices.at(i));
+    }
+}
+
+void HControlPointPrivate::deviceExpired(const HUdn& rootUdn)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     Q_ASSERT(thread() == QThread::currentThread());
 
     // according to the UDA v1.1 a "device tree" (root, embedded and services)
-    // are "timed out" only when every advertisement has timed out.
+    // are "timed out" only when every advertisement has timed out. since
+    // any advertisement resets the timeout of the entire tree, the tree has
+    // timed out when the root device has.
 
-    source = static_cast<HDefaultClientDevice*>(source->rootDevice());
+    HDefaultClientDevice* source =
+        static_cast<HDefaultClientDevice*>(
+            m_deviceStorage.searchDeviceByUdn(rootUdn, RootDevices));
 
-    if (source->isTimedout(HDefaultClientDevice::All))
+    if (!source)
     {
-        source->deviceStatus()->setOnline(false);
-        m_eventSubscriber->cancel(
-            source, VisitThisRecursively, false);
-
-        emit q_ptr->rootDeviceOffline(source);
+        return;
     }
+
+    source->deviceStatus()->setOnline(false);
+    m_eventSubscriber->cancel(source, VisitThisRecursively, false);
+    removeMulticastEvents(source);
+
+    emit q_ptr->rootDeviceOffline(source);
 }
 
 void HControlPointPrivate::unsubscribed(HClientService* service)
@@ -280,6 +340,50 @@ void HControlPointPrivate::unsubscribed(HClientService* service)
     emit q_ptr->subscriptionCanceled(service);
 }
 
+void HControlPointPrivate::multicastEventReceived(
+    const HMulticastNotifyRequest& req)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    HClientDevice* device =
+        m_deviceStorage.searchDeviceByUdn(req.usn().udn(), AllDevices);
+
+    if (!device)
+    {
+        // the event concerns a device that is not known by us
+        return;
+    }
+
+    HClientService* service = device->serviceById(req.serviceId());
+    if (!service ||
+        service->info().serviceType() != req.usn().resourceType())
+    {
+        HLOG_WARN(QString(
+            "Ignoring a multicast event to an unknown service [%1] of "
+            "device [%2]").arg(
+                req.serviceId().toString(), req.usn().udn().toString()));
+
+        return;
+    }
+
+    if (!m_multicastEventListener->isNewEvent(req))
+    {
+        // the same event has been received from another address of the device
+        return;
+    }
+
+    HLOG_DBG(QString(
+        "Multicast event [seq: %1] from service [%2] of device [%3]").arg(
+            QString::number(req.seq()), req.serviceId().toString(),
+            req.usn().udn().toString()));
+
+    if (!static_cast<HDefaultClientService*>(service)->updateVariables(
+            req.variables(), true))
+    {
+        HLOG_WARN("Multicast event failed. State variable(s) were not updated.");
+    }
+}
+
 bool HControlPointPrivate::processDeviceOffline(
     const HResourceUnavailable& msg, const HEndpoint& /*source*/,
     HControlPointSsdpHandler* /*origin*/)
@@ -319,7 +423,8 @@ bool HControlPointPrivate::processDeviceOffline(
         m_eventSubscriber->remove(root, true);
 
         root->clearLocations();
-        root->stopStatusNotifier(HDefaultClientDevice::All);
+        m_deviceExpiryWheel.remove(root->info().udn());
+        removeMulticastEvents(root);
 
         emit q_ptr->rootDeviceOffline(root);
     }
@@ -347,7 +452,8 @@ bool HControlPointPrivate::processDeviceDiscovery(
         // ==> reset timeouts for entire device tree and all services.
 
         device = static_cast<HDefaultClientDevice*>(device->rootDevice());
-        device->startStatusNotifier(HDefaultClientDevice::All);
+        m_deviceExpiryWheel.reset(
+            device->info().udn(), device->deviceTimeoutInSecs());
 
         // it cannot be that only some embedded device is available at certain
         // interface, since the device description is always fetched from the
@@ -410,7 +516,7 @@ bool HControlPointPrivate::processDeviceDiscovery(
         "Attempting to build the device model.").arg(
             msg.usn().toString(), msg.location().toString()));
 
-    m_threadPool->start(newBuildTask);
+    m_executor->submit(newBuildTask);
 
     return true;
 }
@@ -626,6 +732,13 @@ bool HControlPoint::init()
 
     HLOG_INFO("ControlPoint initializing.");
 
+    h_ptr->m_connectionPool =
+        new HHttpConnectionPool(
+            h_ptr->m_loggingIdentifier,
+            h_ptr->m_configuration->maxConnectionsPerHost(),
+            h_ptr->m_configuration->connectionIdleTimeout(),
+            h_ptr);
+
     h_ptr->m_eventSubscriber = new HEventSubscriptionManager(h_ptr);
 
     ok = connect(
@@ -650,6 +763,16 @@ bool HControlPoint::init()
 
     Q_ASSERT(ok);
 
+    h_ptr->m_ssdpPrefilter.reset(new HSsdpPrefilter());
+    h_ptr->m_ssdpPrefilter->setResourceTypes(
+        h_ptr->m_configuration->acceptedResourceTypes());
+    h_ptr->m_ssdpPrefilter->setAcceptedUdns(
+        h_ptr->m_configuration->acceptedUdns());
+    h_ptr->m_ssdpPrefilter->setRejectedUdns(
+        h_ptr->m_configuration->rejectedUdns());
+    h_ptr->m_ssdpPrefilter->setSubnets(
+        h_ptr->m_configuration->acceptedSubnets());
+
     h_ptr->m_server = new ControlPointHttpServer(h_ptr);
 
     if (!doInit())
@@ -674,6 +797,9 @@ bool HControlPoint::init()
         Q_ASSERT(ok);
 
         HControlPointSsdpHandler* ssdp = new HControlPointSsdpHandler(h_ptr);
+        ssdp->setIoThreadEnabled(
+            h_ptr->m_configuration->ssdpIoThreadEnabled());
+
         if (!ssdp->init(ha))
         {
             delete ssdp;
@@ -684,10 +810,50 @@ bool HControlPoint::init()
         h_ptr->m_ssdps.append(qMakePair(netwAddr, ssdp));
     }
 
+    if (h_ptr->m_configuration->listenToMulticastEvents())
+    {
+        h_ptr->m_multicastEventListener =
+            new HMulticastEventListener(h_ptr->m_loggingIdentifier, h_ptr);
+
+        if (h_ptr->m_multicastEventListener->init(addrs))
+        {
+            ok = connect(
+                h_ptr->m_multicastEventListener,
+                SIGNAL(eventReceived(Herqq::Upnp::HMulticastNotifyRequest)),
+                h_ptr,
+                SLOT(multicastEventReceived(Herqq::Upnp::HMulticastNotifyRequest)));
+
+            Q_ASSERT(ok);
+        }
+        else
+        {
+            // multicast events are an optimization over the subscriptions,
+            // which is why this is not considered fatal
+            HLOG_WARN("Multicast events will not be received");
+
+            delete h_ptr->m_multicastEventListener;
+            h_ptr->m_multicastEventListener = 0;
+        }
+    }
+
     if (h_ptr->m_configuration->autoDiscovery())
     {
         HLOG_DBG("Searching for UPnP devices");
 
+        // responses to a search for root devices would not pass the
+        // resource type filter, hence the accepted types are searched instead
+        QList<HDiscoveryType> discoveryTypes;
+        foreach(const HResourceType& type,
+                h_ptr->m_configuration->acceptedResourceTypes())
+        {
+            discoveryTypes.append(HDiscoveryType(type));
+        }
+        if (discoveryTypes.isEmpty())
+        {
+            discoveryTypes.append(
+                HDiscoveryType::createDiscoveryTypeForRootDevices());
+        }
+
         for(qint32 i = 0; i < h_ptr->m_ssdps.size(); ++i)
         {
             QString ep =
@@ -696,18 +862,20 @@ bool HControlPoint::init()
             HLOG_DBG(QString(
                 "Sending discovery request using endpoint [%1]").arg(ep));
 
-            qint32 messagesSent =
-                h_ptr->m_ssdps[i].second->sendDiscoveryRequest(
-                    HDiscoveryRequest(
-                        1,
-                        HDiscoveryType::createDiscoveryTypeForRootDevices(),
-                        HSysInfo::instance().herqqProductTokens()));
-
-            if (!messagesSent)
+            foreach(const HDiscoveryType& discoveryType, discoveryTypes)
             {
-                HLOG_WARN(QString(
-                    "Failed to send discovery request using endpoint "
-                    "[%1]").arg(ep));
+                qint32 messagesSent =
+                    h_ptr->m_ssdps[i].second->sendDiscoveryRequest(
+                        HDiscoveryRequest(
+                            1, discoveryType,
+                            HSysInfo::instance().herqqProductTokens()));
+
+                if (!messagesSent)
+                {
+                    HLOG_WARN(QString(
+                        "Failed to send discovery request using endpoint "
+                        "[%1]").arg(ep));
+                }
             }
         }
     }
@@ -767,7 +935,7 @@ void HControlPoint::quit()
 
     h_ptr->m_server->close();
 
-    h_ptr->m_threadPool->shutdown();
+    h_ptr->m_executor->cancel(h_ptr);
 
     doQuit();
 
@@ -778,9 +946,22 @@ void HControlPoint::quit()
     }
     h_ptr->m_ssdps.clear();
 
+    delete h_ptr->m_multicastEventListener; h_ptr->m_multicastEventListener = 0;
+
+    if (h_ptr->m_ssdpPrefilter && !h_ptr->m_ssdpPrefilter->isEmpty())
+    {
+        HLOG_DBG(QString(
+            "SSDP prefilter accepted [%1] and rejected [%2] datagrams").arg(
+                QString::number(h_ptr->m_ssdpPrefilter->acceptedCount()),
+                QString::number(h_ptr->m_ssdpPrefilter->rejectedCount())));
+    }
+    h_ptr->m_ssdpPrefilter.reset(0);
+
+    h_ptr->m_deviceExpiryWheel.clear();
     h_ptr->m_deviceStorage.clear();
 
     delete h_ptr->m_eventSubscriber; h_ptr->m_eventSubscriber = 0;
+    delete h_ptr->m_connectionPool; h_ptr->m_connectionPool = 0;
 
     h_ptr->m_state = HControlPointPrivate::Uninitialized;
     HLOG_INFO("Shut down.");
@@ -1035,11 +1216,13 @@ bool HControlPoint::removeRootDevice(HClientDevice* rootDevice)
     Q_ASSERT(thread() == QThread::currentThread());
 
     h_ptr->m_eventSubscriber->remove(rootDevice, true);
+    h_ptr->removeMulticastEvents(rootDevice);
     // TODO should send unsubscription to the UPnP device?
 
     HDeviceInfo info(rootDevice->info());
     if (h_ptr->m_deviceStorage.removeRootDevice(rootDevice))
     {
+        h_ptr->m_deviceExpiryWheel.remove(info.udn());
         emit rootDeviceRemoved(info);
         return true;
     }
@@ -40,7 +40,17 @@ HControlPointConfigurationPrivate::HControlPointConfigurationPrivate() :
     m_subscribeToEvents(true),
     m_desiredSubscriptionTimeout(1800),
     m_autoDiscovery(true),
-    m_networkAddresses()
+    m_networkAddresses(),
+    m_maxConnectionsPerHost(4),
+    m_connectionIdleTimeout(10000),
+    m_acceptedResourceTypes(),
+    m_acceptedUdns(),
+    m_rejectedUdns(),
+    m_acceptedSubnets(),
+    m_ssdpIoThreadEnabled(false),
+    m_listenToMulticastEvents(true),
+    m_lazyServiceLoading(false),
+    m_prefetchServiceDescriptions(true)
 {
     QHostAddress ha = findBindableHostAddress();
     m_networkAddresses.append(ha);
@@ -59,6 +69,16 @@ HControlPointConfigurationPrivate* HControlPointConfigurationPrivate::clone() co
     newObj->m_desiredSubscriptionTimeout = m_desiredSubscriptionTimeout;
     newObj->m_autoDiscovery = m_autoDiscovery;
     newObj->m_networkAddresses = m_networkAddresses;
+    newObj->m_maxConnectionsPerHost = m_maxConnectionsPerHost;
+    newObj->m_connectionIdleTimeout = m_connectionIdleTimeout;
+    newObj->m_acceptedResourceTypes = m_acceptedResourceTypes;
+    newObj->m_acceptedUdns = m_acceptedUdns;
+    newObj->m_rejectedUdns = m_rejectedUdns;
+    newObj->m_acceptedSubnets = m_acceptedSubnets;
+    newObj->m_ssdpIoThreadEnabled = m_ssdpIoThreadEnabled;
+    newObj->m_listenToMulticastEvents = m_listenToMulticastEvents;
+    newObj->m_lazyServiceLoading = m_lazyServiceLoading;
+    newObj->m_prefetchServiceDescriptions = m_prefetchServiceDescriptions;
 
     return newObj;
 }
@@ -126,6 +146,56 @@ QList<QHostAddress> HControlPointConfiguration::networkAddressesToUse() const
     return h_ptr->m_networkAddresses;
 }
 
+qint32 HControlPointConfiguration::maxConnectionsPerHost() const
+{
+    return h_ptr->m_maxConnectionsPerHost;
+}
+
+qint32 HControlPointConfiguration::connectionIdleTimeout() const
+{
+    return h_ptr->m_connectionIdleTimeout;
+}
+
+QList<HResourceType> HControlPointConfiguration::acceptedResourceTypes() const
+{
+    return h_ptr->m_acceptedResourceTypes;
+}
+
+QList<HUdn> HControlPointConfiguration::acceptedUdns() const
+{
+    return h_ptr->m_acceptedUdns;
+}
+
+QList<HUdn> HControlPointConfiguration::rejectedUdns() const
+{
+    return h_ptr->m_rejectedUdns;
+}
+
+QList<QPair<QHostAddress, int> > HControlPointConfiguration::acceptedSubnets() const
+{
+    return h_ptr->m_acceptedSubnets;
+}
+
+bool HControlPointConfiguration::ssdpIoThreadEnabled() const
+{
+    return h_ptr->m_ssdpIoThreadEnabled;
+}
+
+bool HControlPointConfiguration::listenToMulticastEvents() const
+{
+    return h_ptr->m_listenToMulticastEvents;
+}
+
+bool HControlPointConfiguration::lazyServiceLoading() const
+{
+    return h_ptr->m_lazyServiceLoading;
+}
+
+bool HControlPointConfiguration::prefetchServiceDescriptions() const
+{
+    return h_ptr->m_prefetchServiceDescriptions;
+}
+
 void HControlPointConfiguration::setSubscribeToEvents(bool arg)
 {
     h_ptr->m_subscribeToEvents = arg;
@@ -160,5 +230,64 @@ bool HControlPointConfiguration::setNetworkAddressesToUse(
     return true;
 }
 
+void HControlPointConfiguration::setMaxConnectionsPerHost(qint32 count)
+{
+    h_ptr->m_maxConnectionsPerHost = count;
+}
+
+void HControlPointConfiguration::setConnectionIdleTimeout(qint32 timeout)
+{
+    h_ptr->m_connectionIdleTimeout = timeout;
+}
+
+void HControlPointConfiguration::setAcceptedResourceTypes(
+    const QList<HResourceType>& types)
+{
+    h_ptr->m_acceptedResourceTypes.clear();
+    foreach(const HResourceType& type, types)
+    {
+        if (type.isValid())
+        {
+            h_ptr->m_acceptedResourceTypes.append(type);
+        }
+    }
+}
+
+void HControlPointConfiguration::setAcceptedUdns(const QList<HUdn>& udns)
+{
+    h_ptr->m_acceptedUdns = udns;
+}
+
+void HControlPointConfiguration::setRejectedUdns(const QList<HUdn>& udns)
+{
+    h_ptr->m_rejectedUdns = udns;
+}
+
+void HControlPointConfiguration::setAcceptedSubnets(
+    const QList<QPair<QHostAddress, int> >& subnets)
+{
+    h_ptr->m_acceptedSubnets = subnets;
+}
+
+void HControlPointConfiguration::setSsdpIoThreadEnabled(bool enable)
+{
+    h_ptr->m_ssdpIoThreadEnabled = enable;
+}
+
+void HControlPointConfiguration::setListenToMulticastEvents(bool enable)
+{
+    h_ptr->m_listenToMulticastEvents = enable;
+}
+
+void HControlPointConfiguration::setLazyServiceLoading(bool enable)
+{
+    h_ptr->m_lazyServiceLoading = enable;
+}
+
+void HControlPointConfiguration::setPrefetchServiceDescriptions(bool enable)
+{
+    h_ptr->m_prefetchServiceDescriptions = enable;
+}
+
 }
 }
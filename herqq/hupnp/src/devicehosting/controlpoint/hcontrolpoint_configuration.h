@@ -24,6 +24,9 @@
 
 #include <HUpnpCore/HClonable>
 
+#include <QtCore/QList>
+#include <QtCore/QPair>
+
 class QHostAddress;
 
 namespace Herqq
@@ -54,6 +57,21 @@ class HControlPointConfigurationPrivate;
  * The default is the first found interface that is up. Non-loopback interfaces
  * have preference, but if none are found the loopback is used. However, in this
  * case UDP multicast is not available.
+ * - Specify how many simultaneous HTTP connections an HControlPoint may open
+ * to a single host with setMaxConnectionsPerHost() and how long an idle
+ * keep-alive connection is retained for reuse with setConnectionIdleTimeout().
+ * - Run the SSDP socket I/O in a dedicated thread with
+ * setSsdpIoThreadEnabled(). The default is no.
+ * - Specify whether an HControlPoint receives the multicast events
+ * defined in UDA v1.1 using setListenToMulticastEvents(). The default is yes.
+ * - Specify whether the service descriptions of a discovered device are
+ * retrieved before the device is made available, or only when they are needed,
+ * using setLazyServiceLoading(). The default is before.
+ * - Restrict the SSDP messages an HControlPoint processes with
+ * setAcceptedResourceTypes(), setAcceptedUdns(), setRejectedUdns() and
+ * setAcceptedSubnets(). These filters are applied to the received datagrams
+ * before they are parsed, which is considerably cheaper than
+ * filtering the resources with HControlPoint::acceptResource().
  *
  * \headerfile hcontrolpoint_configuration.h HControlPointConfiguration
  *
@@ -152,6 +170,124 @@ public:
      */
     QList<QHostAddress> networkAddressesToUse() const;
 
+    /*!
+     * \brief Returns the maximum number of simultaneous HTTP connections
+     * the control point opens to a single host for eventing.
+     *
+     * The default value is 4.
+     *
+     * \return The maximum number of simultaneous HTTP connections
+     * the control point opens to a single host. A value less than or equal
+     * to zero means there is no limit.
+     *
+     * \sa setMaxConnectionsPerHost()
+     */
+    qint32 maxConnectionsPerHost() const;
+
+    /*!
+     * \brief Returns the time in milliseconds an idle HTTP connection is kept
+     * open for reuse.
+     *
+     * The default value is 10 seconds.
+     *
+     * \return The time in milliseconds an idle HTTP connection is kept
+     * open for reuse. A value less than or equal to zero means that HTTP
+     * keep-alive is not used.
+     *
+     * \sa setConnectionIdleTimeout()
+     */
+    qint32 connectionIdleTimeout() const;
+
+    /*!
+     * \brief Returns the resource types the control point is interested in.
+     *
+     * \return The resource types the control point is interested in. An empty
+     * list means that every resource type is accepted, which is the default.
+     *
+     * \sa setAcceptedResourceTypes()
+     */
+    QList<HResourceType> acceptedResourceTypes() const;
+
+    /*!
+     * \brief Returns the UDNs of the devices the control point is interested in.
+     *
+     * \return The UDNs of the devices the control point is interested in.
+     * An empty list means that every device is accepted, which is the default.
+     *
+     * \sa setAcceptedUdns()
+     */
+    QList<HUdn> acceptedUdns() const;
+
+    /*!
+     * \brief Returns the UDNs of the devices the control point ignores.
+     *
+     * \return The UDNs of the devices the control point ignores.
+     *
+     * \sa setRejectedUdns()
+     */
+    QList<HUdn> rejectedUdns() const;
+
+    /*!
+     * \brief Returns the subnets from which the control point accepts
+     * SSDP messages.
+     *
+     * \return The subnets from which the control point accepts SSDP messages.
+     * An empty list means that messages are accepted from any source,
+     * which is the default.
+     *
+     * \sa setAcceptedSubnets()
+     */
+    QList<QPair<QHostAddress, int> > acceptedSubnets() const;
+
+    /*!
+     * \brief Indicates whether the SSDP socket I/O is run in a dedicated thread.
+     *
+     * The default is \e false.
+     *
+     * \return \e true in case the SSDP socket I/O is run in a dedicated thread.
+     *
+     * \sa setSsdpIoThreadEnabled()
+     */
+    bool ssdpIoThreadEnabled() const;
+
+    /*!
+     * \brief Indicates whether the control point receives multicast events.
+     *
+     * The default is \e true.
+     *
+     * \return \e true in case the control point receives multicast events.
+     *
+     * \sa setListenToMulticastEvents()
+     */
+    bool listenToMulticastEvents() const;
+
+    /*!
+     * \brief Indicates whether the service descriptions are retrieved only when
+     * they are needed.
+     *
+     * The default is \e false.
+     *
+     * \return \e true in case the service descriptions are retrieved only when
+     * they are needed.
+     *
+     * \sa setLazyServiceLoading(), prefetchServiceDescriptions()
+     */
+    bool lazyServiceLoading() const;
+
+    /*!
+     * \brief Indicates whether lazily loaded service descriptions are retrieved
+     * in the background once a device has been added.
+     *
+     * The default is \e true. This has no effect unless lazyServiceLoading()
+     * is \e true.
+     *
+     * \return \e true in case lazily loaded service descriptions are retrieved
+     * in the background.
+     *
+     * \sa setPrefetchServiceDescriptions()
+     */
+    bool prefetchServiceDescriptions() const;
+
     /*!
      * Defines whether a control point should automatically subscribe to all
      * events on all services of a device when a new device is added
@@ -206,6 +342,163 @@ public:
      * \sa networkAddressesToUse()
      */
     bool setNetworkAddressesToUse(const QList<QHostAddress>& addresses);
+
+    /*!
+     * \brief Sets the maximum number of simultaneous HTTP connections
+     * the control point opens to a single host for eventing.
+     *
+     * Requests exceeding the limit are delayed until a connection to the host
+     * becomes available.
+     *
+     * \param count specifies the maximum number of simultaneous connections
+     * to a single host. A value less than or equal to zero removes the limit.
+     *
+     * \sa maxConnectionsPerHost()
+     */
+    void setMaxConnectionsPerHost(qint32 count);
+
+    /*!
+     * \brief Sets the time in milliseconds an idle HTTP connection is kept
+     * open for reuse.
+     *
+     * \param timeout specifies the time in milliseconds an idle HTTP
+     * connection is kept open for reuse. A value less than or equal to zero
+     * disables HTTP keep-alive and a new connection is opened for each request.
+     *
+     * \sa connectionIdleTimeout()
+     */
+    void setConnectionIdleTimeout(qint32 timeout);
+
+    /*!
+     * \brief Specifies the device and service types the control point
+     * is interested in.
+     *
+     * When set, only the SSDP advertisements and discovery responses
+     * the \c NT or \c ST header field of which matches one of the specified
+     * types are processed. A type matches when the version of the advertised
+     * type is greater than or equal to the version of the specified type.
+     *
+     * \param types specifies the device and service types the control point
+     * is interested in. An empty list accepts every resource type.
+     *
+     * \remarks
+     * - Messages that do not carry a resource type, such as
+     * \c upnp:rootdevice and \c uuid: advertisements, are ignored when
+     * this filter is set. For this reason the initial discovery searches
+     * the specified types instead of root devices.
+     * - The filter is read when the control point is initialized.
+     *
+     * \sa acceptedResourceTypes()
+     */
+    void setAcceptedResourceTypes(const QList<HResourceType>& types);
+
+    /*!
+     * \brief Specifies the UDNs of the devices the control point is
+     * interested in.
+     *
+     * \param udns specifies the UDNs of the devices the control point is
+     * interested in. An empty list accepts every device.
+     *
+     * \remarks The UDN is matched against the \c USN header field, which
+     * identifies the root device or the embedded device the advertisement
+     * concerns.
+     *
+     * \sa acceptedUdns()
+     */
+    void setAcceptedUdns(const QList<HUdn>& udns);
+
+    /*!
+     * \brief Specifies the UDNs of the devices the control point ignores.
+     *
+     * \param udns specifies the UDNs of the devices the control point
+     * ignores. The rejection takes precedence over setAcceptedUdns().
+     *
+     * \sa rejectedUdns()
+     */
+    void setRejectedUdns(const QList<HUdn>& udns);
+
+    /*!
+     * \brief Specifies the subnets from which the control point accepts
+     * SSDP messages.
+     *
+     * \param subnets specifies the subnets from which the control point accepts
+     * SSDP messages. Each subnet is a pair of a network address and
+     * a netmask length, as returned by QHostAddress::parseSubnet().
+     * An empty list accepts messages from any source.
+     *
+     * \sa acceptedSubnets()
+     */
+    void setAcceptedSubnets(const QList<QPair<QHostAddress, int> >& subnets);
+
+    /*!
+     * \brief Specifies whether the SSDP socket I/O is run in a dedicated thread.
+     *
+     * When enabled, SSDP datagrams are received, parsed and sent in a thread
+     * separate from the one in which the control point lives. This prevents
+     * a busy event loop, such as that of a GUI thread, from causing
+     * SSDP datagrams to be dropped.
+     *
+     * \param enable specifies whether the SSDP socket I/O is run in
+     * a dedicated thread.
+     *
+     * \sa ssdpIoThreadEnabled(), HSsdp::setIoThreadEnabled()
+     */
+    void setSsdpIoThreadEnabled(bool enable);
+
+    /*!
+     * \brief Specifies whether the control point receives multicast events.
+     *
+     * UDA v1.1 devices may publish the changes of selected state variables
+     * to a multicast group in addition to the subscribers. When enabled,
+     * the control point joins the group and updates the state variables
+     * of the devices it knows from the received events, whether or not
+     * it is subscribed to the services.
+     *
+     * \param enable specifies whether the control point receives
+     * multicast events.
+     *
+     * \sa listenToMulticastEvents()
+     */
+    void setListenToMulticastEvents(bool enable);
+
+    /*!
+     * \brief Specifies whether the service descriptions are retrieved only when
+     * they are needed.
+     *
+     * By default an HControlPoint retrieves the description of every service
+     * of a discovered device before the device is made available. When lazy
+     * loading is enabled, a device is made available as soon as its device
+     * description has been processed. The description of an HClientService is
+     * retrieved in the background the first time the actions, the state
+     * variables or the description of the service are accessed, or when the
+     * first event to the service arrives. The access does not block: until the
+     * service is loaded, it reports no actions and no state variables.
+     * HClientService::loaded() is emitted once the service has been loaded.
+     *
+     * Services that have an event subscription URL are considered evented
+     * until their descriptions are loaded.
+     *
+     * \param enable specifies whether the service descriptions are
+     * retrieved only when they are needed.
+     *
+     * \sa lazyServiceLoading(), setPrefetchServiceDescriptions()
+     */
+    void setLazyServiceLoading(bool enable);
+
+    /*!
+     * \brief Specifies whether lazily loaded service descriptions are retrieved
+     * in the background once a device has been added.
+     *
+     * The background retrieval runs at a lower priority than the other
+     * work of the control point, so that the services that are accessed
+     * are not delayed by the ones that are not.
+     *
+     * \param enable specifies whether lazily loaded service descriptions are
+     * retrieved in the background.
+     *
+     * \sa prefetchServiceDescriptions(), setLazyServiceLoading()
+     */
+    void setPrefetchServiceDescriptions(bool enable);
 };
 
 }
@@ -31,8 +31,11 @@
 //
 
 #include "../../utils/hglobal.h"
+#include "../../dataelements/hudn.h"
+#include "../../dataelements/hresourcetype.h"
 
 #include <QtCore/QList>
+#include <QtCore/QPair>
 #include <QtNetwork/QHostAddress>
 
 namespace Herqq
@@ -54,6 +57,16 @@ public: // attributes
     qint32 m_desiredSubscriptionTimeout;
     bool m_autoDiscovery;
     QList<QHostAddress> m_networkAddresses;
+    qint32 m_maxConnectionsPerHost;
+    qint32 m_connectionIdleTimeout;
+    QList<HResourceType> m_acceptedResourceTypes;
+    QList<HUdn> m_acceptedUdns;
+    QList<HUdn> m_rejectedUdns;
+    QList<QPair<QHostAddress, int> > m_acceptedSubnets;
+    bool m_ssdpIoThreadEnabled;
+    bool m_listenToMulticastEvents;
+    bool m_lazyServiceLoading;
+    bool m_prefetchServiceDescriptions;
 
 public: // methods
 
@@ -32,6 +32,8 @@
 
 #include "hcontrolpoint.h"
 #include "hdevicebuild_p.h"
+#include "hdevice_expirywheel_p.h"
+#include "hmulticast_eventlistener_p.h"
 #include "hevent_subscriptionmanager_p.h"
 
 #include "../hdevicestorage_p.h"
@@ -41,10 +43,12 @@
 
 #include "../../ssdp/hssdp.h"
 #include "../../ssdp/hssdp_p.h"
+#include "../../ssdp/hssdp_prefilter_p.h"
 #include "../../http/hhttp_server_p.h"
+#include "../../http/hhttp_connectionpool_p.h"
 #include "../../ssdp/hdiscovery_messages.h"
 
-#include "../../utils/hthreadpool_p.h"
+#include "../../utils/hexecutor_p.h"
 
 #include <QtCore/QUuid>
 #include <QtCore/QScopedPointer>
@@ -134,6 +138,8 @@ private Q_SLOTS:
 private:
 
     bool addRootDevice(HDefaultClientDevice*);
+    void prefetchServiceDescriptions(HClientDevice*);
+    void removeMulticastEvents(HClientDevice*);
     void subscribeToEvents(HDefaultClientDevice*);
 
     void processDeviceOnline(HDefaultClientDevice*, bool newDevice);
@@ -151,9 +157,11 @@ private:
 
 private Q_SLOTS:
 
-    void deviceExpired(HDefaultClientDevice* source);
+    void deviceExpired(const Herqq::Upnp::HUdn& rootUdn);
     void unsubscribed(Herqq::Upnp::HClientService*);
 
+    void multicastEventReceived(const Herqq::Upnp::HMulticastNotifyRequest&);
+
 public:
 
     const QByteArray m_loggingIdentifier;
@@ -166,6 +174,12 @@ public:
     ControlPointHttpServer* m_server;
     HEventSubscriptionManager* m_eventSubscriber;
 
+    HHttpConnectionPool* m_connectionPool;
+    // keep-alive connections shared by all the event subscriptions
+
+    HMulticastEventListener* m_multicastEventListener;
+    // receives the multicast events of the devices, if enabled
+
     HControlPoint::ControlPointError m_lastError;
 
     QString m_lastErrorDescription;
@@ -185,10 +199,21 @@ public:
 
     volatile InitState m_state;
 
-    HThreadPool* m_threadPool;
+    HExecutor* m_executor;
+    // the executor shared by the control points and device hosts of
+    // the process
 
     HDeviceStorage<HClientDevice, HClientService> m_deviceStorage;
 
+    QScopedPointer<HSsdpPrefilter> m_ssdpPrefilter;
+    // the filter compiled from the configuration, which is applied to
+    // the received SSDP datagrams before they are parsed
+
+    HDeviceExpiryWheel m_deviceExpiryWheel;
+    // tracks the cache-control max-age of every root device. an entire
+    // device tree is refreshed by any alive announcement concerning it, which
+    // is why the entries are keyed by the UDN of the root device.
+
     HControlPointPrivate();
     virtual ~HControlPointPrivate();
 
@@ -0,0 +1,163 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hdevice_expirywheel_p.h"
+
+#include "../../general/hlogger_p.h"
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace
+{
+// the number of slots in the wheel. each slot covers a single second,
+// which means that the typical cache-control max-age of 1800 seconds is
+// reached in a few revolutions.
+const qint32 wheelSize = 256;
+}
+
+HDeviceExpiryWheel::HDeviceExpiryWheel(
+    const QByteArray& loggingIdentifier, QObject* parent) :
+        QObject(parent),
+            m_loggingIdentifier(loggingIdentifier),
+            m_slots(wheelSize), m_entries(), m_currentSlot(0),
+            m_tickTimer(this), m_expiriesInLastSecond(0), m_expiriesTotal(0)
+{
+    m_tickTimer.setInterval(1000);
+
+    bool ok = connect(&m_tickTimer, SIGNAL(timeout()), this, SLOT(tick()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+}
+
+HDeviceExpiryWheel::~HDeviceExpiryWheel()
+{
+}
+
+void HDeviceExpiryWheel::reset(const HUdn& udn, qint32 timeoutInSecs)
+{
+    Q_ASSERT(udn.isValid(LooseChecks));
+
+    QHash<HUdn, Entry>::iterator it = m_entries.find(udn);
+    if (it != m_entries.end())
+    {
+        m_slots[it->m_slot].remove(udn);
+    }
+
+    // one tick is added, since the first tick occurs sooner than a second
+    // after this call. this way a device never expires too early.
+    qint32 ticks = qMax(timeoutInSecs, 1) + 1;
+
+    qint32 slot = (m_currentSlot + ticks) % wheelSize;
+    quint32 rounds = (ticks - 1) / wheelSize;
+
+    m_slots[slot].insert(udn);
+    m_entries.insert(udn, Entry(slot, rounds));
+
+    if (!m_tickTimer.isActive())
+    {
+        m_expiriesInLastSecond = 0;
+        m_tickTimer.start();
+    }
+}
+
+bool HDeviceExpiryWheel::remove(const HUdn& udn)
+{
+    QHash<HUdn, Entry>::iterator it = m_entries.find(udn);
+    if (it == m_entries.end())
+    {
+        return false;
+    }
+
+    m_slots[it->m_slot].remove(udn);
+    m_entries.erase(it);
+
+    if (m_entries.isEmpty())
+    {
+        m_tickTimer.stop();
+    }
+
+    return true;
+}
+
+void HDeviceExpiryWheel::clear()
+{
+    m_tickTimer.stop();
+    m_entries.clear();
+    for(qint32 i = 0; i < m_slots.size(); ++i)
+    {
+        m_slots[i].clear();
+    }
+}
+
+void HDeviceExpiryWheel::tick()
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    m_currentSlot = (m_currentSlot + 1) % wheelSize;
+
+    QList<HUdn> expiredDevices;
+
+    QSet<HUdn>& slot = m_slots[m_currentSlot];
+    QSet<HUdn>::iterator it = slot.begin();
+    while(it != slot.end())
+    {
+        Entry& entry = m_entries[*it];
+        if (entry.m_rounds > 0)
+        {
+            --entry.m_rounds;
+            ++it;
+        }
+        else
+        {
+            expiredDevices.append(*it);
+            m_entries.remove(*it);
+            it = slot.erase(it);
+        }
+    }
+
+    m_expiriesInLastSecond = expiredDevices.size();
+    m_expiriesTotal += expiredDevices.size();
+
+    if (m_entries.isEmpty())
+    {
+        m_tickTimer.stop();
+    }
+
+    if (!expiredDevices.isEmpty())
+    {
+        HLOG_DBG(QString("[%1] device(s) expired, [%2] in total").arg(
+            QString::number(expiredDevices.size()),
+            QString::number(m_expiriesTotal)));
+    }
+
+    // the devices are removed from the wheel before any signal is emitted,
+    // which allows the receivers to reset or remove devices freely
+    foreach(const HUdn& udn, expiredDevices)
+    {
+        emit expired(udn);
+    }
+}
+
+}
+}
@@ -0,0 +1,132 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HDEVICE_EXPIRYWHEEL_P_H_
+#define HDEVICE_EXPIRYWHEEL_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "../../dataelements/hudn.h"
+
+#include <QtCore/QSet>
+#include <QtCore/QHash>
+#include <QtCore/QTimer>
+#include <QtCore/QVector>
+#include <QtCore/QObject>
+#include <QtCore/QByteArray>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+//
+// Tracks the cache-control max-age expiration of every root device known
+// to a control point using a single hashed timer wheel.
+//
+// The wheel advances one slot per second. A device is placed into the slot
+// at which it expires, along with the number of full revolutions the wheel has
+// to make before that. Resetting the timeout of a device upon an alive
+// announcement moves it from a slot to another, which is an O(1) operation
+// regardless of the number of devices tracked.
+//
+class HDeviceExpiryWheel :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HDeviceExpiryWheel)
+
+private:
+
+    class Entry
+    {
+    public:
+
+        qint32 m_slot;
+        quint32 m_rounds;
+
+        inline Entry() : m_slot(-1), m_rounds(0) {}
+        inline Entry(qint32 slot, quint32 rounds) :
+            m_slot(slot), m_rounds(rounds)
+        {
+        }
+    };
+
+    const QByteArray m_loggingIdentifier;
+
+    QVector<QSet<HUdn> > m_slots;
+    QHash<HUdn, Entry> m_entries;
+    qint32 m_currentSlot;
+
+    QTimer m_tickTimer;
+
+    quint32 m_expiriesInLastSecond;
+    quint64 m_expiriesTotal;
+
+private Q_SLOTS:
+
+    void tick();
+
+public:
+
+    HDeviceExpiryWheel(
+        const QByteArray& loggingIdentifier, QObject* parent = 0);
+
+    virtual ~HDeviceExpiryWheel();
+
+    // (re)starts the expiration timeout of the specified device.
+    // the device expires no earlier than timeoutInSecs from now.
+    void reset(const HUdn&, qint32 timeoutInSecs);
+
+    // stops tracking the specified device.
+    // returns false in case the device was not tracked.
+    bool remove(const HUdn&);
+
+    void clear();
+
+    inline bool contains(const HUdn& udn) const
+    {
+        return m_entries.contains(udn);
+    }
+
+    inline qint32 count() const { return m_entries.size(); }
+
+    // the number of devices that expired during the last tick of the wheel
+    inline quint32 expiriesPerSecond() const { return m_expiriesInLastSecond; }
+
+    inline quint64 totalExpiries() const { return m_expiriesTotal; }
+
+Q_SIGNALS:
+
+    void expired(const Herqq::Upnp::HUdn&);
+};
+
+}
+}
+
+#endif /* HDEVICE_EXPIRYWHEEL_P_H_ */
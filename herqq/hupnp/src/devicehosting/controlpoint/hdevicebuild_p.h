@@ -32,9 +32,11 @@
 
 #include "../../general/hupnp_defs.h"
 #include "../../dataelements/hudn.h"
-#include "../../utils/hthreadpool_p.h"
+#include "../../utils/hexecutor_p.h"
 
 #include <QtCore/QList>
+#include <QtCore/QObject>
+#include <QtCore/QAtomicInt>
 
 namespace Herqq
 {
@@ -47,11 +49,12 @@ class HControlPointPrivate;
 class HDefaultClientDevice;
 
 //
-// This class is used as a thread pool task to fetch a device description, its
+// This class is used as an executor task to fetch a device description, its
 // accompanying service descriptions (if any) and to build the device model.
 //
 class DeviceBuildTask :
-    public HRunnable
+    public QObject,
+    public HExecutorTask
 {
 Q_OBJECT
 H_DISABLE_COPY(DeviceBuildTask)
@@ -77,6 +80,7 @@ public:
 
     template<typename Msg>
     DeviceBuildTask(HControlPointPrivate* owner, const Msg& msg) :
+            HExecutorTask(DeviceBuildPriority, owner),
             m_owner(owner),
             m_completionValue(-1),
             m_errorString(),
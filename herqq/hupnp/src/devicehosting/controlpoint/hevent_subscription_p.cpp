@@ -27,6 +27,7 @@
 #include "../../dataelements/hserviceinfo.h"
 
 #include "../../http/hhttp_messagecreator_p.h"
+#include "../../http/hhttp_connectionpool_p.h"
 
 #include "../../general/hlogger_p.h"
 #include "../../general/hupnp_global_p.h"
@@ -42,7 +43,8 @@ namespace Upnp
  ******************************************************************************/
 HEventSubscription::HEventSubscription(
     const QByteArray& loggingIdentifier, HClientService* service,
-    const QUrl& serverRootUrl, const HTimeout& desiredTimeout, QObject* parent) :
+    const QUrl& serverRootUrl, const HTimeout& desiredTimeout,
+    HHttpConnectionPool& connectionPool, QObject* parent) :
         QObject(parent),
             m_loggingIdentifier(loggingIdentifier),
             m_randomIdentifier (QUuid::createUuid()),
@@ -54,13 +56,12 @@ HEventSubscription::HEventSubscription(
             m_seq(0),
             m_desiredTimeout(desiredTimeout),
             m_timeout(),
-            m_subscriptionTimer(this),
-            m_announcementTimer(this),
-            m_announcementTimedOut(false),
             m_service(service),
             m_serverRootUrl(serverRootUrl),
             m_http(loggingIdentifier, this),
-            m_socket(this),
+            m_connectionPool(connectionPool),
+            m_socket(0),
+            m_waitingForConnection(false),
             m_currentOpType(Op_None),
             m_nextOpType(Op_None),
             m_subscribed(false)
@@ -83,21 +84,11 @@ HEventSubscription::HEventSubscription(
     }
 
     bool ok = connect(
-        &m_subscriptionTimer, SIGNAL(timeout()),
-        this, SLOT(subscriptionTimeout()));
+        &m_connectionPool, SIGNAL(connectionAvailable(QString, quint16)),
+        this, SLOT(connectionAvailable(QString, quint16)));
 
     Q_ASSERT(ok); Q_UNUSED(ok)
 
-    ok = connect(
-        &m_announcementTimer, SIGNAL(timeout()),
-        this, SLOT(announcementTimeout()));
-
-    Q_ASSERT(ok);
-
-    ok = connect(&m_socket, SIGNAL(connected()), this, SLOT(connected()));
-
-    Q_ASSERT(ok);
-
     ok = connect(
         &m_http, SIGNAL(msgIoComplete(HHttpAsyncOperation*)),
         this, SLOT(msgIoComplete(HHttpAsyncOperation*)),
@@ -109,28 +100,25 @@ HEventSubscription::HEventSubscription(
 HEventSubscription::~HEventSubscription()
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+    releaseConnection(false);
 }
 
-void HEventSubscription::subscriptionTimeout()
+bool HEventSubscription::renew()
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
-    m_subscriptionTimer.stop();
-
     if (m_sid.isEmpty())
     {
+        if (m_currentOpType != Op_None)
+        {
+            return false;
+        }
+
         subscribe();
+        return true;
     }
-    else
-    {
-        renewSubscription();
-    }
-}
 
-void HEventSubscription::announcementTimeout()
-{
-    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
-    m_announcementTimedOut = true;
+    return renewSubscription();
 }
 
 void HEventSubscription::resetSubscription()
@@ -145,12 +133,23 @@ void HEventSubscription::resetSubscription()
     m_currentOpType = Op_None;
     m_subscribed = false;
     m_connectErrorCount = 0;
-    m_subscriptionTimer.stop();
+    m_waitingForConnection = false;
+
+    releaseConnection(false);
+}
 
-    if (m_socket.state() == QAbstractSocket::ConnectedState)
+void HEventSubscription::releaseConnection(bool keepAlive)
+{
+    if (!m_socket)
     {
-        m_socket.disconnectFromHost();
+        return;
     }
+
+    QTcpSocket* sock = m_socket;
+    m_socket = 0;
+
+    sock->disconnect(this);
+    m_connectionPool.release(sock, keepAlive);
 }
 
 void HEventSubscription::runNextOp()
@@ -183,22 +182,54 @@ void HEventSubscription::connected()
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
-    bool ok = disconnect(
-        &m_socket, SIGNAL(error(QAbstractSocket::SocketError)),
-        this, SLOT(error(QAbstractSocket::SocketError)));
-
-    Q_ASSERT(ok); Q_UNUSED(ok)
+    Q_ASSERT(m_socket);
+    m_socket->disconnect(this);
 
     m_connectErrorCount = 0;
     runNextOp();
 }
 
+void HEventSubscription::connectionAvailable(const QString& host, quint16 port)
+{
+    if (!m_waitingForConnection)
+    {
+        return;
+    }
+
+    const QUrl& loc = m_deviceLocations[m_nextLocationToTry];
+    if (loc.host().compare(host, Qt::CaseInsensitive) != 0 ||
+        loc.port(80) != port)
+    {
+        return;
+    }
+
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    m_waitingForConnection = false;
+    runNextOp();
+}
+
 void HEventSubscription::msgIoComplete(HHttpAsyncOperation* op)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
     Q_ASSERT(op);
 
+    // The socket is detached from this instance, but it is returned to the
+    // pool only once the operation is deleted. Releasing it signals
+    // connectionAvailable() synchronously and another subscription could
+    // start a request on the socket while the operation still uses it.
+    QTcpSocket* sock = m_socket;
+    m_socket = 0;
+    if (sock)
+    {
+        sock->disconnect(this);
+    }
+
+    bool keepAlive =
+        op->state() == HHttpAsyncOperation::Succeeded &&
+        op->messagingInfo()->keepAlive();
+
     switch(m_currentOpType)
     {
     case Op_Subscribe:
@@ -218,13 +249,13 @@ void HEventSubscription::msgIoComplete(HHttpAsyncOperation* op)
         break;
     };
 
-    if (m_socket.state() == QTcpSocket::ConnectedState)
+    delete op;
+
+    if (sock)
     {
-        m_socket.disconnectFromHost();
+        m_connectionPool.release(sock, keepAlive);
     }
 
-    delete op;
-
     if (m_currentOpType == Op_Subscribe || m_currentOpType == Op_Renew)
     {
         foreach(const HNotifyRequest& req, m_queuedNotifications)
@@ -262,7 +293,7 @@ void HEventSubscription::renewSubscription_done(HHttpAsyncOperation* op)
         HLOG_WARN(QString("Event subscription renewal [sid: %1] failed.").arg(
             m_sid.toString()));
 
-        emit subscriptionFailed(this);
+        emit renewalFailed(this);
         return;
     }
 
@@ -277,7 +308,7 @@ void HEventSubscription::renewSubscription_done(HHttpAsyncOperation* op)
         HLOG_WARN(QString("Received an invalid response to event "
                   "subscription renewal: %1.").arg(hdr->toString()));
 
-        emit subscriptionFailed(this);
+        emit renewalFailed(this);
         return;
     }
 
@@ -297,28 +328,24 @@ void HEventSubscription::renewSubscription_done(HHttpAsyncOperation* op)
         m_eventUrl.toString(), m_sid.toString()));
 
     m_timeout = response.timeout();
-    if (!m_timeout.isInfinite())
-    {
-        m_subscriptionTimer.start(m_timeout.value() * 1000 / 2);
-    }
+
+    emit renewed(this);
 }
 
-void HEventSubscription::renewSubscription()
+bool HEventSubscription::renewSubscription()
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
     if (m_currentOpType != Op_None || m_sid.isEmpty())
     {
-        return;
+        return false;
     }
 
-    m_announcementTimer.stop();
-
     m_currentOpType = Op_Renew;
 
     if (!connectToDevice())
     {
-        return;
+        return true;
     }
 
     HLOG_DBG(QString("Renewing subscription [sid: %1].").arg(
@@ -328,7 +355,7 @@ void HEventSubscription::renewSubscription()
         extractBaseUrl(m_deviceLocations[m_nextLocationToTry]),
         m_service->info().eventSubUrl());
 
-    HMessagingInfo* mi = new HMessagingInfo(m_socket, false);
+    HMessagingInfo* mi = new HMessagingInfo(*m_socket, true);
     mi->setHostInfo(eventUrl);
 
     HSubscribeRequest req(eventUrl, m_sid, m_desiredTimeout);
@@ -338,8 +365,13 @@ void HEventSubscription::renewSubscription()
     {
         HLOG_WARN(QString("Failed to renew subscription [sid %1].").arg(
             m_sid.toString()));
-        emit subscriptionFailed(this);
+
+        m_currentOpType = Op_None;
+        releaseConnection(false);
+        emit renewalFailed(this);
     }
+
+    return true;
 }
 
 void HEventSubscription::resubscribe()
@@ -362,8 +394,37 @@ void HEventSubscription::error(QAbstractSocket::SocketError /*err*/)
 
     // this can be called only when connecting to host
 
+    releaseConnection(false);
+
     if (++m_connectErrorCount >= m_deviceLocations.size() * 2)
     {
+        // none of the device locations could be reached; the operation
+        // is abandoned so that it can be retried later
+
+        OperationType curOp = m_currentOpType;
+        m_currentOpType = Op_None;
+        m_nextOpType = Op_None;
+        m_connectErrorCount = 0;
+
+        switch(curOp)
+        {
+        case Op_Subscribe:
+            emit subscriptionFailed(this);
+            break;
+
+        case Op_Renew:
+            emit renewalFailed(this);
+            break;
+
+        case Op_Unsubscribe:
+            resetSubscription();
+            emit unsubscribed(this);
+            break;
+
+        default:
+            break;
+        }
+
         return;
     }
 
@@ -385,31 +446,65 @@ bool HEventSubscription::connectToDevice(qint32 msecsToWait)
 
     Q_ASSERT(m_currentOpType != Op_None);
 
-    if (m_socket.state() == QTcpSocket::ConnectedState)
+    if (m_socket)
     {
-        return true;
+        if (m_socket->state() == QTcpSocket::ConnectedState)
+        {
+            return true;
+        }
+        else if (m_socket->state() == QTcpSocket::ConnectingState ||
+                 m_socket->state() == QTcpSocket::HostLookupState)
+        {
+            return false;
+        }
+
+        releaseConnection(false);
     }
-    else if (m_socket.state() == QTcpSocket::ConnectingState ||
-             m_socket.state() == QTcpSocket::HostLookupState)
+
+    QUrl lastLoc = m_deviceLocations[m_nextLocationToTry];
+
+    m_socket = m_connectionPool.acquire(lastLoc);
+    if (!m_socket)
     {
+        // the connection limit to the device has been reached. the operation
+        // is resumed once a connection to the device becomes available.
+        m_waitingForConnection = true;
         return false;
     }
 
-    QUrl lastLoc = m_deviceLocations[m_nextLocationToTry];
-
-    bool ok = connect(
-        &m_socket, SIGNAL(error(QAbstractSocket::SocketError)),
-        this, SLOT(error(QAbstractSocket::SocketError)));
+    m_waitingForConnection = false;
 
-    Q_ASSERT(ok); Q_UNUSED(ok)
+    if (m_socket->state() == QTcpSocket::ConnectedState)
+    {
+        // a kept-alive connection was reused
+        m_connectErrorCount = 0;
+        return true;
+    }
 
-    m_socket.connectToHost(lastLoc.host(), lastLoc.port());
     if (msecsToWait > 0)
     {
-        m_socket.waitForConnected(msecsToWait);
+        if (m_socket->waitForConnected(msecsToWait))
+        {
+            m_connectErrorCount = 0;
+            return true;
+        }
+        else if (m_socket->state() == QTcpSocket::UnconnectedState)
+        {
+            releaseConnection(false);
+            return false;
+        }
     }
 
-    return m_socket.state() == QAbstractSocket::ConnectedState;
+    bool ok = connect(m_socket, SIGNAL(connected()), this, SLOT(connected()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    ok = connect(
+        m_socket, SIGNAL(error(QAbstractSocket::SocketError)),
+        this, SLOT(error(QAbstractSocket::SocketError)));
+
+    Q_ASSERT(ok);
+
+    return false;
 }
 
 void HEventSubscription::subscribe_done(HHttpAsyncOperation* op)
@@ -449,11 +544,6 @@ void HEventSubscription::subscribe_done(HHttpAsyncOperation* op)
     HLOG_DBG(QString("Subscription to [%1] succeeded. Received SID: [%2]").arg(
         m_eventUrl.toString(), m_sid.toString()));
 
-    if (!m_timeout.isInfinite())
-    {
-        m_subscriptionTimer.start(m_timeout.value() * 1000 / 2);
-    }
-
     emit subscribed(this);
 }
 
@@ -499,7 +589,7 @@ void HEventSubscription::subscribe()
         extractBaseUrl(m_deviceLocations[m_nextLocationToTry]),
         m_service->info().eventSubUrl());
 
-    HMessagingInfo* mi = new HMessagingInfo(m_socket, false);
+    HMessagingInfo* mi = new HMessagingInfo(*m_socket, true);
     mi->setHostInfo(m_eventUrl);
 
     HSubscribeRequest req(
@@ -518,8 +608,10 @@ void HEventSubscription::subscribe()
     {
         HLOG_WARN(QString(
             "Failed to subscribe to events @ [%1]: %2").arg(
-                urlsAsStr(m_deviceLocations), m_socket.errorString()));
+                urlsAsStr(m_deviceLocations), m_socket->errorString()));
 
+        m_currentOpType = Op_None;
+        releaseConnection(false);
         emit subscriptionFailed(this);
     }
 }
@@ -634,8 +726,6 @@ void HEventSubscription::unsubscribe(qint32 msecsToWait)
     Q_ASSERT(m_sid.isValid());
     Q_ASSERT(!m_eventUrl.isEmpty());
 
-    m_subscriptionTimer.stop();
-
     if (!connectToDevice(msecsToWait))
     {
         return;
@@ -649,7 +739,7 @@ void HEventSubscription::unsubscribe(qint32 msecsToWait)
         "Attempting to cancel event subscription from [%1]").arg(
             m_eventUrl.toString()));
 
-    HMessagingInfo* mi = new HMessagingInfo(m_socket, false);
+    HMessagingInfo* mi = new HMessagingInfo(*m_socket, true);
     mi->setHostInfo(m_eventUrl);
 
     HUnsubscribeRequest req(m_eventUrl, m_sid);
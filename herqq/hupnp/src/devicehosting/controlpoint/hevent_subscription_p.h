@@ -39,7 +39,6 @@
 
 #include <QtCore/QUrl>
 #include <QtCore/QList>
-#include <QtCore/QTimer>
 #include <QtCore/QByteArray>
 
 #include <QtNetwork/QTcpSocket>
@@ -51,6 +50,7 @@ namespace Upnp
 {
 
 class HHttpAsyncOperation;
+class HHttpConnectionPool;
 
 //
 // This class represents and maintains a subscription to a service instantiated on the
@@ -94,14 +94,8 @@ private:
 
     HTimeout m_timeout;
     // the actual timeout of the subscription. this is received from the device
-    // upon successful subscription. if no error occurs, the subscription will
-    // be renewed before the specified timeout elapses.
-
-    QTimer m_subscriptionTimer;
-    // used to signal the time when the subscription should be renewed
-
-    QTimer m_announcementTimer;
-    bool m_announcementTimedOut;
+    // upon successful subscription. the renewals are scheduled by the
+    // HEventSubscriptionManager based on this value.
 
     HClientService* m_service;
     // the target service of the subscription
@@ -122,8 +116,16 @@ private:
         Op_Unsubscribe
     };
 
-    QTcpSocket m_socket;
-    // socket for the messaging
+    HHttpConnectionPool& m_connectionPool;
+    // the pool from which the connections to the device are acquired
+
+    QTcpSocket* m_socket;
+    // socket for the messaging. this is acquired from the connection pool
+    // when an operation is started and released once the operation is done.
+
+    bool m_waitingForConnection;
+    // indicates that the current operation is waiting for the connection pool
+    // to have a connection available to the device
 
     OperationType m_currentOpType;
     OperationType m_nextOpType;
@@ -134,10 +136,8 @@ private:
 
 private Q_SLOTS:
 
-    void subscriptionTimeout();
-    void announcementTimeout();
-
     void connected();
+    void connectionAvailable(const QString& host, quint16 port);
     void msgIoComplete(HHttpAsyncOperation*);
 
     void error(QAbstractSocket::SocketError);
@@ -145,13 +145,14 @@ private Q_SLOTS:
 private:
 
     bool connectToDevice(qint32 msecsToWait=0);
+    void releaseConnection(bool keepAlive);
     void subscribe_done(HHttpAsyncOperation*);
     void renewSubscription_done(HHttpAsyncOperation*);
     void unsubscribe_done(HHttpAsyncOperation*);
 
     void runNextOp();
     void resubscribe();
-    void renewSubscription();
+    bool renewSubscription();
     StatusCode processNotify(const HNotifyRequest&);
 
 Q_SIGNALS:
@@ -160,6 +161,12 @@ Q_SIGNALS:
     void subscriptionFailed(HEventSubscription*);
     void unsubscribed(HEventSubscription*);
 
+    void renewed(HEventSubscription*);
+    void renewalFailed(HEventSubscription*);
+    // renewal failure is signaled separately, since the subscription remains
+    // valid at the device until its timeout elapses and the renewal can be
+    // retried
+
 public:
 
     enum SubscriptionStatus
@@ -174,14 +181,22 @@ public:
         HClientService* service,
         const QUrl& serverRootUrl,
         const HTimeout& desiredTimeout,
+        HHttpConnectionPool& connectionPool,
         QObject* parent = 0);
 
     virtual ~HEventSubscription();
 
     inline QUuid id() const { return m_randomIdentifier ; }
     inline HClientService* service() const { return m_service; }
+    inline HTimeout timeout() const { return m_timeout; }
 
     void subscribe();
+
+    // renews the subscription, or re-subscribes if the subscription is not
+    // active. returns false in case nothing was done, which is the case
+    // when another operation is already in progress.
+    bool renew();
+
     void unsubscribe(qint32 msecsToWait=0);
     void resetSubscription();
     StatusCode onNotify(const HNotifyRequest&);
@@ -34,17 +34,53 @@
 
 #include "../../general/hlogger_p.h"
 
+#include <QtCore/QDateTime>
+#include <QtCore/QCoreApplication>
+
 namespace Herqq
 {
 
 namespace Upnp
 {
 
+namespace
+{
+// the time window in milliseconds within which the renewals to the same device
+// are run together with a renewal that is due
+const qint32 renewalBatchWindow = 30 * 1000;
+
+const qint32 minRetryDelay = 5 * 1000;
+const qint32 maxRetryDelay = 5 * 60 * 1000;
+
+HUdn rootUdn(const HEventSubscription* sub)
+{
+    return sub->service()->parentDevice()->rootDevice()->info().udn();
+}
+}
+
 HEventSubscriptionManager::HEventSubscriptionManager(HControlPointPrivate* owner) :
     QObject(owner),
-        m_owner(owner), m_subscribtionsByUuid(), m_subscriptionsByUdn()
+        m_owner(owner), m_subscribtionsByUuid(), m_subscriptionsByUdn(),
+        m_randomState(0), m_clock(), m_renewalTimer(this), m_renewalSchedule(), m_renewals(),
+        m_renewalBatches(), m_renewalsInProgress()
 {
     Q_ASSERT(m_owner);
+
+    m_clock.start();
+
+    // the jitter of the renewals is useful only if it differs between
+    // processes and control points, hence the seed
+    m_randomState =
+        static_cast<quint32>(QDateTime::currentDateTime().toTime_t()) ^
+        static_cast<quint32>(QCoreApplication::applicationPid()) ^
+        static_cast<quint32>(reinterpret_cast<quintptr>(this));
+
+    m_renewalTimer.setSingleShot(true);
+
+    bool ok = connect(
+        &m_renewalTimer, SIGNAL(timeout()), this, SLOT(renewalTimeout()));
+
+    Q_ASSERT(ok); Q_UNUSED(ok)
 }
 
 HEventSubscriptionManager::~HEventSubscriptionManager()
@@ -53,11 +89,259 @@ HEventSubscriptionManager::~HEventSubscriptionManager()
     removeAll();
 }
 
+quint32 HEventSubscriptionManager::random(quint32 range)
+{
+    Q_ASSERT(range > 0);
+
+    // a linear congruential generator (Numerical Recipes). the high bits are
+    // used, since the low bits of such a generator have short periods.
+    m_randomState = m_randomState * 1664525U + 1013904223U;
+    return (m_randomState >> 8) % range;
+}
+
+qint32 HEventSubscriptionManager::renewalDelay(const HTimeout& timeout)
+{
+    Q_ASSERT(!timeout.isInfinite());
+
+    // the renewal is scheduled to occur somewhere between 35% and 50% of the
+    // subscription timeout. the jitter spreads the renewals that would
+    // otherwise be aligned, such as after the control point has been started
+    // and it subscribes to every device at once.
+
+    qint64 timeoutMsecs = static_cast<qint64>(timeout.value()) * 1000;
+    qint64 jitterRange = timeoutMsecs * 15 / 100;
+    qint64 jitter = jitterRange > 0 ?
+        random(static_cast<quint32>(qMin(jitterRange, qint64(0xffffff)))) : 0;
+
+    return static_cast<qint32>(qMax(qint64(1000), timeoutMsecs / 2 - jitter));
+}
+
+qint32 HEventSubscriptionManager::retryDelay(qint32 failures)
+{
+    Q_ASSERT(failures > 0);
+
+    // exponential back-off with +-25% jitter
+    qint32 delay = minRetryDelay << qMin(failures - 1, 10);
+    delay = qMin(delay, maxRetryDelay);
+
+    qint32 jitterRange = delay / 2;
+    return delay - jitterRange / 2 + static_cast<qint32>(random(jitterRange + 1));
+}
+
+void HEventSubscriptionManager::scheduleRenewal(
+    HEventSubscription* sub, qint32 msecs)
+{
+    RenewalInfo& info = m_renewals[sub];
+    if (info.m_due >= 0)
+    {
+        m_renewalSchedule.remove(info.m_due, sub);
+    }
+
+    info.m_rootUdn = rootUdn(sub);
+    info.m_due = m_clock.elapsed() + msecs;
+
+    m_renewalSchedule.insert(info.m_due, sub);
+
+    updateRenewalTimer();
+}
+
+void HEventSubscriptionManager::scheduleNextRenewal(HEventSubscription* sub)
+{
+    HTimeout timeout = sub->timeout();
+    if (timeout.isInfinite())
+    {
+        unscheduleRenewal(sub);
+        return;
+    }
+
+    RenewalInfo& info = m_renewals[sub];
+    info.m_failures = 0;
+    info.m_expires =
+        m_clock.elapsed() + static_cast<qint64>(timeout.value()) * 1000;
+
+    scheduleRenewal(sub, renewalDelay(timeout));
+}
+
+void HEventSubscriptionManager::unscheduleRenewal(HEventSubscription* sub)
+{
+    QHash<HEventSubscription*, RenewalInfo>::iterator it = m_renewals.find(sub);
+    if (it == m_renewals.end())
+    {
+        return;
+    }
+
+    if (it->m_due >= 0)
+    {
+        m_renewalSchedule.remove(it->m_due, sub);
+    }
+
+    HUdn udn = it->m_rootUdn;
+    m_renewals.erase(it);
+
+    QHash<HUdn, QList<HEventSubscription*> >::iterator bit =
+        m_renewalBatches.find(udn);
+
+    if (bit != m_renewalBatches.end())
+    {
+        bit->removeAll(sub);
+        if (bit->isEmpty())
+        {
+            m_renewalBatches.erase(bit);
+        }
+    }
+
+    if (m_renewalsInProgress.value(udn) == sub)
+    {
+        // the subscription may be in the middle of being deleted, hence the
+        // rest of the batch is run once the control returns to the event loop
+        m_renewalsInProgress.remove(udn);
+        QMetaObject::invokeMethod(
+            this, "runPendingRenewalBatches", Qt::QueuedConnection);
+    }
+
+    updateRenewalTimer();
+}
+
+void HEventSubscriptionManager::updateRenewalTimer()
+{
+    if (m_renewalSchedule.isEmpty())
+    {
+        m_renewalTimer.stop();
+        return;
+    }
+
+    static const qint64 maxInterval = 24 * 60 * 60 * 1000;
+
+    qint64 msecs = m_renewalSchedule.constBegin().key() - m_clock.elapsed();
+    m_renewalTimer.start(static_cast<qint32>(qBound(qint64(0), msecs, maxInterval)));
+}
+
+void HEventSubscriptionManager::renewalTimeout()
+{
+    HLOG2(H_AT, H_FUN, m_owner->m_loggingIdentifier);
+
+    qint64 currentTime = m_clock.elapsed();
+    qint64 batchLimit = currentTime + renewalBatchWindow;
+
+    QList<HUdn> devices;
+
+    QMultiMap<qint64, HEventSubscription*>::iterator it =
+        m_renewalSchedule.begin();
+
+    while(it != m_renewalSchedule.end() && it.key() <= currentTime)
+    {
+        HEventSubscription* sub = it.value();
+
+        RenewalInfo& info = m_renewals[sub];
+        info.m_due = -1;
+
+        m_renewalBatches[info.m_rootUdn].append(sub);
+        if (!devices.contains(info.m_rootUdn))
+        {
+            devices.append(info.m_rootUdn);
+        }
+
+        it = m_renewalSchedule.erase(it);
+    }
+
+    // renewals to the same devices that would be due shortly are run
+    // right away as well, since a connection to the device is going to be
+    // open in any case
+    while(it != m_renewalSchedule.end() && it.key() <= batchLimit)
+    {
+        HEventSubscription* sub = it.value();
+
+        RenewalInfo& info = m_renewals[sub];
+        if (devices.contains(info.m_rootUdn))
+        {
+            info.m_due = -1;
+            m_renewalBatches[info.m_rootUdn].append(sub);
+            it = m_renewalSchedule.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    foreach(const HUdn& udn, devices)
+    {
+        if (!m_renewalsInProgress.contains(udn))
+        {
+            runRenewalBatch(udn);
+        }
+    }
+
+    updateRenewalTimer();
+}
+
+void HEventSubscriptionManager::runRenewalBatch(const HUdn& udn)
+{
+    HLOG2(H_AT, H_FUN, m_owner->m_loggingIdentifier);
+
+    QHash<HUdn, QList<HEventSubscription*> >::iterator it =
+        m_renewalBatches.find(udn);
+
+    while(it != m_renewalBatches.end() && !it->isEmpty())
+    {
+        HEventSubscription* sub = it->takeFirst();
+
+        m_renewalsInProgress.insert(udn, sub);
+        if (sub->renew())
+        {
+            // the rest of the batch is run once this renewal completes
+            return;
+        }
+
+        // the subscription is busy with another operation, which will
+        // reschedule the renewal once it completes
+        m_renewalsInProgress.remove(udn);
+        it = m_renewalBatches.find(udn);
+    }
+
+    if (it != m_renewalBatches.end())
+    {
+        m_renewalBatches.erase(it);
+    }
+}
+
+void HEventSubscriptionManager::runPendingRenewalBatches()
+{
+    foreach(const HUdn& udn, m_renewalBatches.keys())
+    {
+        if (!m_renewalsInProgress.contains(udn))
+        {
+            runRenewalBatch(udn);
+        }
+    }
+}
+
+void HEventSubscriptionManager::renewalFinished(HEventSubscription* sub)
+{
+    QHash<HEventSubscription*, RenewalInfo>::const_iterator it =
+        m_renewals.constFind(sub);
+
+    if (it == m_renewals.constEnd())
+    {
+        return;
+    }
+
+    HUdn udn = it->m_rootUdn;
+    if (m_renewalsInProgress.value(udn) == sub)
+    {
+        m_renewalsInProgress.remove(udn);
+        runRenewalBatch(udn);
+    }
+}
+
 void HEventSubscriptionManager::subscribed_slot(HEventSubscription* sub)
 {
     HLOG2(H_AT, H_FUN, m_owner->m_loggingIdentifier);
     Q_ASSERT(sub);
 
+    renewalFinished(sub);
+    scheduleNextRenewal(sub);
+
     emit subscribed(sub->service());
 }
 
@@ -66,6 +350,9 @@ void HEventSubscriptionManager::subscriptionFailed_slot(HEventSubscription* sub)
     HLOG2(H_AT, H_FUN, m_owner->m_loggingIdentifier);
     Q_ASSERT(sub);
 
+    renewalFinished(sub);
+    unscheduleRenewal(sub);
+
     HClientService* service = sub->service();
     sub->resetSubscription();
     emit subscriptionFailed(service);
@@ -76,9 +363,50 @@ void HEventSubscriptionManager::unsubscribed(HEventSubscription* sub)
     HLOG2(H_AT, H_FUN, m_owner->m_loggingIdentifier);
     Q_ASSERT(sub);
 
+    renewalFinished(sub);
+    unscheduleRenewal(sub);
+
     emit unsubscribed(sub->service());
 }
 
+void HEventSubscriptionManager::renewed_slot(HEventSubscription* sub)
+{
+    HLOG2(H_AT, H_FUN, m_owner->m_loggingIdentifier);
+    Q_ASSERT(sub);
+
+    renewalFinished(sub);
+    scheduleNextRenewal(sub);
+}
+
+void HEventSubscriptionManager::renewalFailed_slot(HEventSubscription* sub)
+{
+    HLOG2(H_AT, H_FUN, m_owner->m_loggingIdentifier);
+    Q_ASSERT(sub);
+
+    renewalFinished(sub);
+
+    RenewalInfo& info = m_renewals[sub];
+    qint32 delay = retryDelay(++info.m_failures);
+
+    if (info.m_expires >= 0 && m_clock.elapsed() + delay < info.m_expires)
+    {
+        // the subscription is still valid at the device ==> retry later
+        HLOG_DBG(QString(
+            "Retrying the renewal of subscription to [%1] in %2 ms").arg(
+                sub->service()->info().serviceId().toString(),
+                QString::number(delay)));
+
+        scheduleRenewal(sub, delay);
+        return;
+    }
+
+    unscheduleRenewal(sub);
+
+    HClientService* service = sub->service();
+    sub->resetSubscription();
+    emit subscriptionFailed(service);
+}
+
 HEventSubscription* HEventSubscriptionManager::createSubscription(
     HClientService* service, qint32 timeout)
 {
@@ -98,6 +426,7 @@ HEventSubscription* HEventSubscriptionManager::createSubscription(
             service,
             httpSrvRootUrl,
             HTimeout(timeout),
+            *m_owner->m_connectionPool,
             this);
 
     bool ok = connect(
@@ -122,6 +451,18 @@ HEventSubscription* HEventSubscriptionManager::createSubscription(
 
     Q_ASSERT(ok);
 
+    ok = connect(
+        subscription, SIGNAL(renewed(HEventSubscription*)),
+        this, SLOT(renewed_slot(HEventSubscription*)));
+
+    Q_ASSERT(ok);
+
+    ok = connect(
+        subscription, SIGNAL(renewalFailed(HEventSubscription*)),
+        this, SLOT(renewalFailed_slot(HEventSubscription*)));
+
+    Q_ASSERT(ok);
+
     return subscription;
 }
 
@@ -303,6 +644,8 @@ bool HEventSubscriptionManager::cancel(
     QList<HEventSubscription*>::iterator it = subs->begin();
     for(; it != subs->end(); ++it)
     {
+        unscheduleRenewal(*it);
+
         if (unsubscribe)
         {
             (*it)->unsubscribe();
@@ -349,6 +692,7 @@ bool HEventSubscriptionManager::remove(HClientDevice* device, bool recursive)
     for(; it != subs->end(); ++it)
     {
         HEventSubscription* sub = (*it);
+        unscheduleRenewal(sub);
         m_subscribtionsByUuid.remove(sub->id());
         delete sub;
     }
@@ -395,6 +739,8 @@ bool HEventSubscriptionManager::cancel(HClientService* service, bool unsubscribe
             continue;
         }
 
+        unscheduleRenewal(sub);
+
         if (unsubscribe)
         {
             (*it)->unsubscribe();
@@ -444,6 +790,7 @@ bool HEventSubscriptionManager::remove(HClientService* service)
             m_subscriptionsByUdn.remove(udn);
         }
 
+        unscheduleRenewal(sub);
         m_subscribtionsByUuid.remove(sub->id());
         delete sub;
 
@@ -458,7 +805,7 @@ void HEventSubscriptionManager::cancelAll(qint32 msecsToWait)
     HLOG2(H_AT, H_FUN, m_owner->m_loggingIdentifier);
     Q_ASSERT(thread() == QThread::currentThread());
 
-    QHash<QUuid, HEventSubscription*>::iterator it =
+    QHash<HUuidKey, HEventSubscription*>::iterator it =
         m_subscribtionsByUuid.begin();
 
     for(; it != m_subscribtionsByUuid.end(); ++it)
@@ -472,6 +819,12 @@ void HEventSubscriptionManager::removeAll()
     HLOG2(H_AT, H_FUN, m_owner->m_loggingIdentifier);
     Q_ASSERT(thread() == QThread::currentThread());
 
+    m_renewalTimer.stop();
+    m_renewalSchedule.clear();
+    m_renewals.clear();
+    m_renewalBatches.clear();
+    m_renewalsInProgress.clear();
+
     qDeleteAll(m_subscribtionsByUuid);
     m_subscribtionsByUuid.clear();
 
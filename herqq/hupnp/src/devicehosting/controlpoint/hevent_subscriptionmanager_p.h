@@ -24,12 +24,16 @@
 
 #include "hevent_subscription_p.h"
 #include "../../general/hupnp_global.h"
+#include "../../utils/hmisc_utils_p.h"
 #include "../../devicemodel/client/hclientdevice.h"
 
+#include <QtCore/QMap>
 #include <QtCore/QList>
 #include <QtCore/QHash>
 #include <QtCore/QUuid>
+#include <QtCore/QTimer>
 #include <QtCore/QObject>
+#include <QtCore/QElapsedTimer>
 
 namespace Herqq
 {
@@ -52,9 +56,77 @@ private:
 
     HControlPointPrivate* m_owner;
 
-    QHash<QUuid, HEventSubscription*> m_subscribtionsByUuid;
+    QHash<HUuidKey, HEventSubscription*> m_subscribtionsByUuid;
+    // keyed by the random identifier in the callback URL of a subscription
     QHash<HUdn, QList<HEventSubscription*>* > m_subscriptionsByUdn;
 
+    //
+    // Renewal bookkeeping of a single subscription
+    //
+    class RenewalInfo
+    {
+    public:
+
+        qint64 m_due;
+        // the time when the subscription is scheduled to be renewed, in
+        // milliseconds on m_clock or -1 if the renewal is not scheduled
+
+        qint64 m_expires;
+        // the time when the subscription expires at the device unless renewed,
+        // in milliseconds on m_clock or -1 if unknown
+
+        HUdn m_rootUdn;
+        // the UDN of the root device of the service, used in batching
+
+        qint32 m_failures;
+        // the number of consecutive failed renewal attempts
+
+        inline RenewalInfo() :
+            m_due(-1), m_expires(-1), m_rootUdn(), m_failures(0)
+        {
+        }
+    };
+
+    quint32 m_randomState;
+    // the state of the generator used for the jitter of the renewals. kept
+    // here so that the application's qrand() sequence is not affected
+
+    QElapsedTimer m_clock;
+    // monotonic time base of the renewal schedule, so that adjustments to
+    // the system clock do not move the renewals
+
+    QTimer m_renewalTimer;
+    // the single timer driving the renewals of every subscription
+
+    QMultiMap<qint64, HEventSubscription*> m_renewalSchedule;
+    QHash<HEventSubscription*, RenewalInfo> m_renewals;
+
+    QHash<HUdn, QList<HEventSubscription*> > m_renewalBatches;
+    // renewals that are due, grouped by the root device. the renewals to
+    // a device are run one after the other, which lets them use the same
+    // keep-alive connection
+
+    QHash<HUdn, HEventSubscription*> m_renewalsInProgress;
+
+private:
+
+    quint32 random(quint32 range);
+    qint32 renewalDelay(const HTimeout&);
+    qint32 retryDelay(qint32 failures);
+
+    void scheduleRenewal(HEventSubscription*, qint32 msecs);
+    void scheduleNextRenewal(HEventSubscription*);
+    void unscheduleRenewal(HEventSubscription*);
+    void updateRenewalTimer();
+
+    void runRenewalBatch(const HUdn& rootUdn);
+    void renewalFinished(HEventSubscription*);
+
+private Q_SLOTS:
+
+    void renewalTimeout();
+    void runPendingRenewalBatches();
+
 private:
 
     HEventSubscription* createSubscription(HClientService*, qint32 timeout);
@@ -68,6 +140,9 @@ public Q_SLOTS:
     void subscriptionFailed_slot(HEventSubscription*);
     void unsubscribed(HEventSubscription*);
 
+    void renewed_slot(HEventSubscription*);
+    void renewalFailed_slot(HEventSubscription*);
+
 Q_SIGNALS:
 
     void subscribed(Herqq::Upnp::HClientService*);
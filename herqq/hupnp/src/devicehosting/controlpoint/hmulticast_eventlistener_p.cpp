@@ -0,0 +1,187 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hmulticast_eventlistener_p.h"
+
+#include "../../http/hhttp_header_p.h"
+#include "../../http/hhttp_messagecreator_p.h"
+
+#include "../../socket/hmulticast_socket.h"
+#include "../../general/hlogger_p.h"
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+HMulticastEventListener::HMulticastEventListener(
+    const QByteArray& loggingIdentifier, QObject* parent) :
+        QObject(parent),
+            m_loggingIdentifier(loggingIdentifier),
+            m_socket(new HMulticastSocket(this)),
+            m_joinedAddresses(),
+            m_lastEvents()
+{
+    bool ok = connect(
+        m_socket, SIGNAL(readyRead()), this, SLOT(datagramsAvailable()));
+
+    Q_ASSERT(ok); Q_UNUSED(ok)
+}
+
+HMulticastEventListener::~HMulticastEventListener()
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    foreach(const QHostAddress& ha, m_joinedAddresses)
+    {
+        m_socket->leaveMulticastGroup(
+            HMulticastNotifyRequest::multicastAddress(), ha);
+    }
+}
+
+bool HMulticastEventListener::init(const QList<QHostAddress>& addresses)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    Q_ASSERT(m_joinedAddresses.isEmpty());
+
+    if (!m_socket->bind(HMulticastNotifyRequest::multicastPort()))
+    {
+        HLOG_WARN(QString(
+            "Failed to bind a socket for receiving multicast events: %1").arg(
+                m_socket->errorString()));
+
+        return false;
+    }
+
+    foreach(const QHostAddress& ha, addresses)
+    {
+        if (m_socket->joinMulticastGroup(
+                HMulticastNotifyRequest::multicastAddress(), ha))
+        {
+            m_joinedAddresses.append(ha);
+        }
+        else
+        {
+            HLOG_WARN(QString(
+                "Could not join [%1] on [%2] for receiving multicast events").arg(
+                    HMulticastNotifyRequest::multicastAddress().toString(),
+                    ha.toString()));
+        }
+    }
+
+    return !m_joinedAddresses.isEmpty();
+}
+
+bool HMulticastEventListener::isNewEvent(const HMulticastNotifyRequest& req)
+{
+    QHash<HServiceId, QPair<qint32, quint32> >& lastEvents =
+        m_lastEvents[HUuidKey(req.usn().udn().toSimpleUuid())];
+
+    QHash<HServiceId, QPair<qint32, quint32> >::iterator it =
+        lastEvents.find(req.serviceId());
+    if (it == lastEvents.end())
+    {
+        lastEvents.insert(req.serviceId(), qMakePair(req.bootId(), req.seq()));
+        return true;
+    }
+
+    qint32 lastBootId = it->first;
+    quint32 lastSeq = it->second;
+
+    bool isNew =
+        req.bootId() != lastBootId || // the device has restarted
+        req.seq() > lastSeq ||
+        req.seq() == 0 ||
+        (req.seq() == 1 && lastSeq == 0xffffffff); // the sequence wrapped
+
+    if (isNew)
+    {
+        *it = qMakePair(req.bootId(), req.seq());
+    }
+
+    return isNew;
+}
+
+void HMulticastEventListener::removeDevice(const HUdn& udn)
+{
+    m_lastEvents.remove(HUuidKey(udn.toSimpleUuid()));
+}
+
+void HMulticastEventListener::processDatagram(const QByteArray& datagram)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    qint32 headerEnd = datagram.indexOf("\r\n\r\n");
+    if (headerEnd < 0)
+    {
+        HLOG_WARN("Ignoring a multicast event without a complete header");
+        return;
+    }
+
+    HHttpRequestHeader hdr(QString::fromUtf8(datagram.constData(), headerEnd + 4));
+    if (!hdr.isValid() ||
+        hdr.method().compare("NOTIFY", Qt::CaseInsensitive) != 0)
+    {
+        HLOG_WARN("Ignoring an invalid multicast event");
+        return;
+    }
+
+    QByteArray body = datagram.mid(headerEnd + 4);
+    if (hdr.hasContentLength() && hdr.contentLength() < uint(body.size()))
+    {
+        body.truncate(hdr.contentLength());
+    }
+
+    HMulticastNotifyRequest req;
+    if (HHttpMessageCreator::create(hdr, body, req) !=
+        HMulticastNotifyRequest::Success)
+    {
+        HLOG_WARN("Ignoring an invalid multicast event");
+        return;
+    }
+
+    emit eventReceived(req);
+}
+
+void HMulticastEventListener::datagramsAvailable()
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    while(m_socket->hasPendingDatagrams())
+    {
+        QByteArray datagram;
+        datagram.resize(m_socket->pendingDatagramSize());
+
+        qint64 read = m_socket->readDatagram(datagram.data(), datagram.size());
+        if (read < 0)
+        {
+            break;
+        }
+
+        datagram.resize(read);
+        processDatagram(datagram);
+    }
+}
+
+}
+}
@@ -0,0 +1,109 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HMULTICAST_EVENTLISTENER_P_H_
+#define HMULTICAST_EVENTLISTENER_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "../messages/hevent_messages_p.h"
+#include "../../utils/hmisc_utils_p.h"
+
+#include <HUpnpCore/HUdn>
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QPair>
+#include <QtCore/QObject>
+#include <QtNetwork/QHostAddress>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+class HMulticastSocket;
+
+//
+// Receives the multicast events specified in UDA v1.1. The events are not
+// bound to subscriptions, which is why every valid event received from the
+// multicast group is reported. The owner filters out the events of unknown
+// devices before it uses isNewEvent() to drop the duplicates.
+//
+class HMulticastEventListener :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HMulticastEventListener)
+
+private:
+
+    const QByteArray m_loggingIdentifier;
+
+    HMulticastSocket* m_socket;
+    QList<QHostAddress> m_joinedAddresses;
+
+    QHash<HUuidKey, QHash<HServiceId, QPair<qint32, quint32> > > m_lastEvents;
+    // the boot ID and the sequence number of the last event of each service,
+    // keyed by the UDN of the device and the service ID. a device host sends an event
+    // from every network address it uses, which means the same event is often
+    // received more than once.
+
+private:
+
+    void processDatagram(const QByteArray&);
+
+private Q_SLOTS:
+
+    void datagramsAvailable();
+
+public:
+
+    HMulticastEventListener(const QByteArray& loggingIdentifier, QObject* parent);
+    virtual ~HMulticastEventListener();
+
+    // joins the multicast group on the specified addresses. returns false
+    // if the group could not be joined on any of the addresses.
+    bool init(const QList<QHostAddress>& addresses);
+
+    // records the event and returns false in case it has been received
+    // already. only the events of known devices should be recorded.
+    bool isNewEvent(const HMulticastNotifyRequest&);
+
+    // discards what has been recorded of the events of the specified device
+    void removeDevice(const HUdn&);
+
+Q_SIGNALS:
+
+    void eventReceived(const Herqq::Upnp::HMulticastNotifyRequest&);
+};
+
+}
+}
+
+#endif /* HMULTICAST_EVENTLISTENER_P_H_ */
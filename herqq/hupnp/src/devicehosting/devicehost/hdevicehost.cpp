@@ -34,6 +34,7 @@
 
 #include "../../general/hlogger_p.h"
 #include "../../utils/hsysutils_p.h"
+#include "../../utils/hexecutor_p.h"
 
 #include <ctime>
 
@@ -102,6 +103,62 @@ bool HServerDeviceController::isTimedout() const
     return m_timedout;
 }
 
+namespace
+{
+void collectIconUrls(const HServerDevice* device, QList<QUrl>* retVal)
+{
+    retVal->append(device->info().icons());
+    foreach(const HServerDevice* embeddedDevice, device->embeddedDevices())
+    {
+        collectIconUrls(embeddedDevice, retVal);
+    }
+}
+
+//
+// Reads a device description in an executor thread
+//
+class DeviceDescriptionReadTask :
+    public HExecutorTask
+{
+H_DISABLE_COPY(DeviceDescriptionReadTask)
+
+private:
+
+    DeviceHostDataRetriever m_dataRetriever;
+    const QString m_path;
+
+public:
+
+    bool m_succeeded;
+    QString m_deviceDescription;
+    QString m_lastError;
+
+    DeviceDescriptionReadTask(
+        const QByteArray& loggingIdentifier, const QString& path,
+        const void* group) :
+            HExecutorTask(DescriptionPriority, group),
+            m_dataRetriever(loggingIdentifier, extractBaseUrl(path)),
+            m_path(path),
+            m_succeeded(false),
+            m_deviceDescription(),
+            m_lastError()
+    {
+        setAutoDelete(false);
+    }
+
+    virtual void run()
+    {
+        m_succeeded =
+            m_dataRetriever.retrieveDeviceDescription(m_path, &m_deviceDescription);
+
+        if (!m_succeeded)
+        {
+            m_lastError = m_dataRetriever.lastError();
+        }
+    }
+};
+}
+
 /*******************************************************************************
  * HDeviceHostPrivate
  ******************************************************************************/
@@ -162,6 +219,18 @@ bool HDeviceHostPrivate::createRootDevice(const HDeviceConfiguration* deviceconf
         return false;
     }
 
+    return createRootDevice(deviceconfig, deviceDescr);
+}
+
+bool HDeviceHostPrivate::createRootDevice(
+    const HDeviceConfiguration* deviceconfig, const QString& deviceDescr)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    QString baseDir = extractBaseUrl(deviceconfig->pathToDeviceDescription());
+
+    DeviceHostDataRetriever dataRetriever(m_loggingIdentifier, baseDir);
+
     HServerModelCreationArgs creatorParams(m_config->deviceModelCreator());
     creatorParams.m_deviceDescription = deviceDescr;
     creatorParams.m_deviceLocations = m_httpServer->rootUrls();
@@ -220,6 +289,27 @@ bool HDeviceHostPrivate::createRootDevice(const HDeviceConfiguration* deviceconf
         return false;
     }
 
+    // The descriptions and icons are served from memory, which is why the
+    // icons are read here once instead of on every request.
+    QList<QUrl> iconUrls;
+    collectIconUrls(rootDevice.data(), &iconUrls);
+
+    QHash<QString, QByteArray> icons;
+    foreach(const QUrl& iconUrl, iconUrls)
+    {
+        QByteArray icon;
+        if (dataRetriever.retrieveIcon(QUrl(), iconUrl, &icon))
+        {
+            icons.insert(iconUrl.toString(), icon);
+        }
+        else
+        {
+            HLOG_WARN(dataRetriever.lastError());
+        }
+    }
+
+    m_httpServer->addRootDevice(rootDevice.data(), icons);
+
     rootDevice->setParent(this);
     connectSelfToServiceSignals(rootDevice.take());
 
@@ -233,15 +323,45 @@ bool HDeviceHostPrivate::createRootDevices()
     QList<const HDeviceConfiguration*> diParams =
         m_config->deviceConfigurations();
 
+    // The device descriptions are read in parallel using the executor shared
+    // with the other control points and device hosts of the process. The
+    // device models are created in this thread, since they are QObjects
+    // living in it.
+    HExecutor* executor = HExecutor::acquireShared();
+
+    QList<DeviceDescriptionReadTask*> readTasks;
     foreach(const HDeviceConfiguration* deviceconfig, diParams)
     {
-        if (!createRootDevice(deviceconfig))
+        DeviceDescriptionReadTask* readTask =
+            new DeviceDescriptionReadTask(
+                m_loggingIdentifier, deviceconfig->pathToDeviceDescription(),
+                this);
+
+        readTasks.append(readTask);
+        executor->submit(readTask);
+    }
+
+    executor->wait(this);
+    HExecutor::releaseShared();
+
+    bool ok = true;
+    for(qint32 i = 0; ok && i < diParams.size(); ++i)
+    {
+        const DeviceDescriptionReadTask* readTask = readTasks.at(i);
+        if (!readTask->m_succeeded)
+        {
+            m_lastError = HDeviceHost::InvalidConfigurationError;
+            m_lastErrorDescription = readTask->m_lastError;
+            ok = false;
+        }
+        else
         {
-            return false;
+            ok = createRootDevice(diParams.at(i), readTask->m_deviceDescription);
         }
     }
 
-    return true;
+    qDeleteAll(readTasks);
+    return ok;
 }
 
 void HDeviceHostPrivate::connectSelfToServiceSignals(HServerDevice* device)
@@ -397,6 +517,13 @@ bool HDeviceHost::init(const HDeviceHostConfiguration& config)
             h_ptr->m_deviceStorage,
             *h_ptr->m_eventNotifier, this));
 
+    HHttpServerLimits limits;
+    limits.m_maxConnections = config.maxIncomingConnections();
+    limits.m_maxConnectionsPerPeer = config.maxIncomingConnectionsPerHost();
+    limits.m_headerReadTimeout = config.incomingRequestTimeout();
+    limits.m_bodyReadTimeout = config.incomingRequestTimeout();
+    h_ptr->m_httpServer->setLimits(limits);
+
     QList<QHostAddress> addrs = config.networkAddressesToUse();
     if (!h_ptr->m_httpServer->init(convertHostAddressesToEndpoints(addrs)))
     {
@@ -418,6 +545,9 @@ bool HDeviceHost::init(const HDeviceHostConfiguration& config)
 
             h_ptr->m_ssdps.append(ssdp);
 
+            ssdp->setIoThreadEnabled(
+                h_ptr->m_config->ssdpIoThreadEnabled());
+
             if (!ssdp->init(ha))
             {
                 setError(CommunicationsError, "Failed to initialize SSDP");
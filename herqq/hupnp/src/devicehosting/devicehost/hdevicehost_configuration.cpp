@@ -127,6 +127,12 @@ HDeviceHostConfigurationPrivate::HDeviceHostConfigurationPrivate() :
     m_individualAdvertisementCount(2),
     m_subscriptionExpirationTimeout(0),
     m_networkAddresses(),
+    m_maxConnectionsPerHost(4),
+    m_connectionIdleTimeout(10000),
+    m_ssdpIoThreadEnabled(false),
+    m_maxIncomingConnections(128),
+    m_maxIncomingConnectionsPerHost(16),
+    m_incomingRequestTimeout(15000),
     m_deviceCreator(0),
     m_infoProvider(0)
 {
@@ -175,6 +181,15 @@ void HDeviceHostConfiguration::doClone(HClonable* target) const
 
     conf->h_ptr->m_networkAddresses = h_ptr->m_networkAddresses;
 
+    conf->h_ptr->m_maxConnectionsPerHost = h_ptr->m_maxConnectionsPerHost;
+    conf->h_ptr->m_connectionIdleTimeout = h_ptr->m_connectionIdleTimeout;
+    conf->h_ptr->m_ssdpIoThreadEnabled = h_ptr->m_ssdpIoThreadEnabled;
+
+    conf->h_ptr->m_maxIncomingConnections = h_ptr->m_maxIncomingConnections;
+    conf->h_ptr->m_maxIncomingConnectionsPerHost =
+        h_ptr->m_maxIncomingConnectionsPerHost;
+    conf->h_ptr->m_incomingRequestTimeout = h_ptr->m_incomingRequestTimeout;
+
     conf->h_ptr->m_subscriptionExpirationTimeout =
         h_ptr->m_subscriptionExpirationTimeout;
 
@@ -280,6 +295,66 @@ void HDeviceHostConfiguration::setSubscriptionExpirationTimeout(qint32 arg)
     h_ptr->m_subscriptionExpirationTimeout = arg;
 }
 
+qint32 HDeviceHostConfiguration::maxConnectionsPerHost() const
+{
+    return h_ptr->m_maxConnectionsPerHost;
+}
+
+void HDeviceHostConfiguration::setMaxConnectionsPerHost(qint32 count)
+{
+    h_ptr->m_maxConnectionsPerHost = count;
+}
+
+qint32 HDeviceHostConfiguration::connectionIdleTimeout() const
+{
+    return h_ptr->m_connectionIdleTimeout;
+}
+
+void HDeviceHostConfiguration::setConnectionIdleTimeout(qint32 timeout)
+{
+    h_ptr->m_connectionIdleTimeout = timeout;
+}
+
+bool HDeviceHostConfiguration::ssdpIoThreadEnabled() const
+{
+    return h_ptr->m_ssdpIoThreadEnabled;
+}
+
+void HDeviceHostConfiguration::setSsdpIoThreadEnabled(bool enable)
+{
+    h_ptr->m_ssdpIoThreadEnabled = enable;
+}
+
+qint32 HDeviceHostConfiguration::maxIncomingConnections() const
+{
+    return h_ptr->m_maxIncomingConnections;
+}
+
+void HDeviceHostConfiguration::setMaxIncomingConnections(qint32 count)
+{
+    h_ptr->m_maxIncomingConnections = count;
+}
+
+qint32 HDeviceHostConfiguration::maxIncomingConnectionsPerHost() const
+{
+    return h_ptr->m_maxIncomingConnectionsPerHost;
+}
+
+void HDeviceHostConfiguration::setMaxIncomingConnectionsPerHost(qint32 count)
+{
+    h_ptr->m_maxIncomingConnectionsPerHost = count;
+}
+
+qint32 HDeviceHostConfiguration::incomingRequestTimeout() const
+{
+    return h_ptr->m_incomingRequestTimeout;
+}
+
+void HDeviceHostConfiguration::setIncomingRequestTimeout(qint32 timeout)
+{
+    h_ptr->m_incomingRequestTimeout = timeout;
+}
+
 bool HDeviceHostConfiguration::setNetworkAddressesToUse(
     const QList<QHostAddress>& addresses)
 {
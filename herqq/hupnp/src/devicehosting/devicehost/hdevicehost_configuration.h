@@ -185,6 +185,11 @@ class HDeviceHostConfigurationPrivate;
  * The default is the first found interface that is up. Non-loopback interfaces
  * have preference, but if none are found the loopback is used. However, in this
  * case UDP multicast is not available.
+ * - Specify how many simultaneous HTTP connections are used to deliver events
+ * to a single control point with setMaxConnectionsPerHost() and how long
+ * an idle keep-alive connection is retained with setConnectionIdleTimeout().
+ * - Run the SSDP socket I/O in a dedicated thread with
+ * setSsdpIoThreadEnabled(). The default is no.
  *
  * \headerfile hdevicehost_configuration.h HDeviceHostConfiguration
  *
@@ -306,6 +311,86 @@ public:
      */
     qint32 subscriptionExpirationTimeout() const;
 
+    /*!
+     * \brief Returns the maximum number of simultaneous HTTP connections
+     * the device host opens to a single control point for event delivery.
+     *
+     * The default value is 4.
+     *
+     * \return The maximum number of simultaneous HTTP connections
+     * to a single control point. A value less than or equal to zero means
+     * there is no limit.
+     *
+     * \sa setMaxConnectionsPerHost()
+     */
+    qint32 maxConnectionsPerHost() const;
+
+    /*!
+     * \brief Returns the time in milliseconds an idle event delivery
+     * connection is kept open for reuse.
+     *
+     * The default value is 10 seconds.
+     *
+     * \return The time in milliseconds an idle connection is kept open
+     * for reuse. A value less than or equal to zero means that HTTP
+     * keep-alive is not used.
+     *
+     * \sa setConnectionIdleTimeout()
+     */
+    qint32 connectionIdleTimeout() const;
+
+    /*!
+     * \brief Indicates whether the SSDP socket I/O is run in a dedicated thread.
+     *
+     * The default is \e false.
+     *
+     * \return \e true in case the SSDP socket I/O is run in a dedicated thread.
+     *
+     * \sa setSsdpIoThreadEnabled()
+     */
+    bool ssdpIoThreadEnabled() const;
+
+    /*!
+     * \brief Returns the maximum number of simultaneous HTTP connections
+     * the device host accepts.
+     *
+     * The default value is 128.
+     *
+     * \return The maximum number of simultaneous HTTP connections the device
+     * host accepts. A value less than or equal to zero means there is no limit.
+     *
+     * \sa setMaxIncomingConnections()
+     */
+    qint32 maxIncomingConnections() const;
+
+    /*!
+     * \brief Returns the maximum number of simultaneous HTTP connections
+     * the device host accepts from a single network address.
+     *
+     * The default value is 16.
+     *
+     * \return The maximum number of simultaneous HTTP connections the device
+     * host accepts from a single network address. A value less than or equal
+     * to zero means there is no limit.
+     *
+     * \sa setMaxIncomingConnectionsPerHost()
+     */
+    qint32 maxIncomingConnectionsPerHost() const;
+
+    /*!
+     * \brief Returns the time in milliseconds a control point has to send
+     * the header of an HTTP request and the time it has to send the body.
+     *
+     * The default value is 15 seconds.
+     *
+     * \return The time in milliseconds a control point has to send
+     * the header of an HTTP request and the time it has to send the body.
+     * A value less than or equal to zero means there is no limit.
+     *
+     * \sa setIncomingRequestTimeout()
+     */
+    qint32 incomingRequestTimeout() const;
+
     /*!
      * \brief Returns the device model creator the HDeviceHost should use
      * to create HServerDevice instances.
@@ -392,6 +477,85 @@ public:
      */
     bool setNetworkAddressesToUse(const QList<QHostAddress>& addresses);
 
+    /*!
+     * \brief Sets the maximum number of simultaneous HTTP connections
+     * the device host opens to a single control point for event delivery.
+     *
+     * \param count specifies the maximum number of simultaneous connections
+     * to a single control point. A value less than or equal to zero removes
+     * the limit.
+     *
+     * \sa maxConnectionsPerHost()
+     */
+    void setMaxConnectionsPerHost(qint32 count);
+
+    /*!
+     * \brief Sets the time in milliseconds an idle event delivery connection
+     * is kept open for reuse.
+     *
+     * \param timeout specifies the time in milliseconds an idle connection
+     * is kept open for reuse. A value less than or equal to zero disables
+     * HTTP keep-alive and a new connection is opened for each notification.
+     *
+     * \sa connectionIdleTimeout()
+     */
+    void setConnectionIdleTimeout(qint32 timeout);
+
+    /*!
+     * \brief Specifies whether the SSDP socket I/O is run in a dedicated thread.
+     *
+     * When enabled, SSDP datagrams are received, parsed and sent in a thread
+     * separate from the one in which the device host lives. This prevents
+     * a busy event loop, such as that of a GUI thread, from causing
+     * SSDP datagrams to be dropped.
+     *
+     * \param enable specifies whether the SSDP socket I/O is run in
+     * a dedicated thread.
+     *
+     * \sa ssdpIoThreadEnabled(), HSsdp::setIoThreadEnabled()
+     */
+    void setSsdpIoThreadEnabled(bool enable);
+
+    /*!
+     * \brief Sets the maximum number of simultaneous HTTP connections
+     * the device host accepts.
+     *
+     * Connections exceeding the limit are responded with
+     * <em>503 Service Unavailable</em> and closed.
+     *
+     * \param count specifies the maximum number of simultaneous HTTP
+     * connections. A value less than or equal to zero removes the limit.
+     *
+     * \sa maxIncomingConnections()
+     */
+    void setMaxIncomingConnections(qint32 count);
+
+    /*!
+     * \brief Sets the maximum number of simultaneous HTTP connections
+     * the device host accepts from a single network address.
+     *
+     * \param count specifies the maximum number of simultaneous HTTP
+     * connections from a single network address. A value less than or equal
+     * to zero removes the limit.
+     *
+     * \sa maxIncomingConnectionsPerHost()
+     */
+    void setMaxIncomingConnectionsPerHost(qint32 count);
+
+    /*!
+     * \brief Sets the time in milliseconds a control point has to send
+     * the header of an HTTP request and the time it has to send the body.
+     *
+     * The header timeout also limits how long an idle keep-alive connection
+     * is kept open. A connection is closed once either timeout expires.
+     *
+     * \param timeout specifies the time in milliseconds. A value less
+     * than or equal to zero removes the limit.
+     *
+     * \sa incomingRequestTimeout()
+     */
+    void setIncomingRequestTimeout(qint32 timeout);
+
     /*!
      * \brief Indicates if the instance contains any device configurations.
      *
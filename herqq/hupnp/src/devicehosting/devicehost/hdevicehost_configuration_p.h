@@ -80,6 +80,14 @@ public:
 
     QList<QHostAddress> m_networkAddresses;
 
+    qint32 m_maxConnectionsPerHost;
+    qint32 m_connectionIdleTimeout;
+    bool m_ssdpIoThreadEnabled;
+
+    qint32 m_maxIncomingConnections;
+    qint32 m_maxIncomingConnectionsPerHost;
+    qint32 m_incomingRequestTimeout;
+
     QScopedPointer<HDeviceModelCreator> m_deviceCreator;
     QScopedPointer<HDeviceModelInfoProvider> m_infoProvider;
 
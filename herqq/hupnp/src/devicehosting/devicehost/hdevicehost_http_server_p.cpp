@@ -42,6 +42,7 @@
 
 #include <QtCore/QUrl>
 #include <QtCore/QPair>
+#include <QtCore/QCryptographicHash>
 
 namespace Herqq
 {
@@ -71,6 +72,73 @@ inline QString extractRequestExludingUdn(const QUrl& arg)
 
     return pathToSearch;
 }
+
+ContentType iconContentType(const QByteArray& data)
+{
+    if (data.startsWith("\x89PNG"))
+    {
+        return ContentType_ImagePng;
+    }
+    else if (data.startsWith("\xFF\xD8"))
+    {
+        return ContentType_ImageJpeg;
+    }
+    else if (data.startsWith("GIF8"))
+    {
+        return ContentType_ImageGif;
+    }
+    else if (data.startsWith("BM"))
+    {
+        return ContentType_ImageBmp;
+    }
+
+    return ContentType_OctetStream;
+}
+
+// If-None-Match uses the weak comparison function, which ignores the
+// weakness indicator of the entity tags sent by the client.
+bool matchesEntityTag(const QString& ifNoneMatch, const QString& etag)
+{
+    QStringList candidates = ifNoneMatch.split(',', QString::SkipEmptyParts);
+    foreach(QString candidate, candidates)
+    {
+        candidate = candidate.trimmed();
+        if (candidate == "*")
+        {
+            return true;
+        }
+        else if (candidate.startsWith("W/"))
+        {
+            candidate = candidate.mid(2);
+        }
+
+        if (candidate == etag)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+}
+
+/*******************************************************************************
+ * HStaticResource
+ ******************************************************************************/
+HStaticResource::HStaticResource() :
+    m_data(), m_contentType(ContentType_Undefined), m_etag()
+{
+}
+
+HStaticResource::HStaticResource(
+    const QByteArray& data, ContentType contentType, qint32 configId) :
+        m_data(data), m_contentType(contentType), m_etag()
+{
+    QByteArray digest =
+        QCryptographicHash::hash(data, QCryptographicHash::Md5).toHex();
+
+    m_etag = QString("\"%1-%2\"").arg(
+        QString::number(configId), QString::fromLatin1(digest.left(16)));
 }
 
 /*******************************************************************************
@@ -83,7 +151,7 @@ HDeviceHostHttpServer::HDeviceHostHttpServer(
     QObject* parent) :
         HHttpServer(loggingId, parent),
             m_deviceStorage(ds), m_eventNotifier(en), m_ddPostFix(ddPostFix),
-            m_ops()
+            m_ops(), m_deviceDescriptions(), m_serviceDescriptions(), m_icons()
 {
 }
 
@@ -101,6 +169,84 @@ HDeviceHostHttpServer::~HDeviceHostHttpServer()
     }
 }
 
+void HDeviceHostHttpServer::addDevice(
+    const HServerDevice* device, const HStaticResource& deviceDescription,
+    qint32 configId)
+{
+    m_deviceDescriptions.insert(device, deviceDescription);
+
+    foreach(const HServerService* service, device->services())
+    {
+        m_serviceDescriptions.insert(
+            service,
+            HStaticResource(
+                service->description().toUtf8(), ContentType_TextXml, configId));
+    }
+
+    foreach(const HServerDevice* embeddedDevice, device->embeddedDevices())
+    {
+        addDevice(embeddedDevice, deviceDescription, configId);
+    }
+}
+
+void HDeviceHostHttpServer::addRootDevice(
+    const HServerDevice* rootDevice, const QHash<QString, QByteArray>& icons)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+    Q_ASSERT(rootDevice);
+    Q_ASSERT(!rootDevice->parentDevice());
+
+    qint32 configId = rootDevice->deviceStatus().configId();
+
+    addDevice(
+        rootDevice,
+        HStaticResource(
+            rootDevice->description().toUtf8(), ContentType_TextXml, configId),
+        configId);
+
+    QHash<QString, HStaticResource> iconResources;
+
+    QHash<QString, QByteArray>::const_iterator ci = icons.constBegin();
+    for(; ci != icons.constEnd(); ++ci)
+    {
+        iconResources.insert(
+            ci.key(),
+            HStaticResource(ci.value(), iconContentType(ci.value()), configId));
+    }
+
+    m_icons.insert(rootDevice, iconResources);
+}
+
+void HDeviceHostHttpServer::sendResource(
+    HMessagingInfo* mi, const HHttpRequestHeader& requestHdr,
+    const HStaticResource& resource)
+{
+    if (!resource.isValid())
+    {
+        m_httpHandler->send(
+            mi, HHttpMessageCreator::createResponse(InternalServerError, *mi));
+
+        return;
+    }
+
+    QString ifNoneMatch = requestHdr.value("If-None-Match");
+    if (!ifNoneMatch.isEmpty() && matchesEntityTag(ifNoneMatch, resource.m_etag))
+    {
+        m_httpHandler->send(
+            mi, HHttpMessageCreator::createNotModifiedResponse(
+                *mi, resource.m_etag));
+
+        return;
+    }
+
+    m_httpHandler->send(
+        mi,
+        HHttpMessageCreator::createHeaderData(
+            Ok, *mi, resource.m_data.size(), resource.m_contentType,
+            resource.m_etag),
+        resource.m_data);
+}
+
 void HDeviceHostHttpServer::incomingSubscriptionRequest(
     HMessagingInfo* mi, const HSubscribeRequest& sreq)
 {
@@ -348,10 +494,14 @@ void HDeviceHostHttpServer::incomingControlRequest(
         soapResponse.addMethodArgument(soapArg);
     }
 
-    QString xml = "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\r\n" + soapResponse.toXmlString();
+    QByteArray body = "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\r\n";
+    body.append(soapResponse.toXmlString().toUtf8());
 
-    m_httpHandler->send(mi, HHttpMessageCreator::createResponse(
-        Ok, *mi, xml.toUtf8(), ContentType_TextXml));
+    m_httpHandler->send(
+        mi,
+        HHttpMessageCreator::createHeaderData(
+            Ok, *mi, body.size(), ContentType_TextXml),
+        body);
 
     HLOG_DBG("Control message successfully handled.");
 }
@@ -383,9 +533,7 @@ void HDeviceHostHttpServer::incomingUnknownGetRequest(
             HLOG_DBG(QString(
                 "Sending service description to [%1] as requested.").arg(peer));
 
-            m_httpHandler->send(mi, HHttpMessageCreator::createResponse(
-                Ok, *mi, service->description().toUtf8(), ContentType_TextXml));
-
+            sendResource(mi, requestHdr, m_serviceDescriptions.value(service));
             return;
         }
 
@@ -413,9 +561,7 @@ void HDeviceHostHttpServer::incomingUnknownGetRequest(
         HLOG_DBG(QString(
             "Sending device description to [%1] as requested.").arg(peer));
 
-        m_httpHandler->send(mi, HHttpMessageCreator::createResponse(
-            Ok, *mi, device->description().toUtf8(), ContentType_TextXml));
-
+        sendResource(mi, requestHdr, m_deviceDescriptions.value(device));
         return;
     }
 
@@ -429,9 +575,7 @@ void HDeviceHostHttpServer::incomingUnknownGetRequest(
         HLOG_DBG(QString(
             "Sending service description to [%1] as requested.").arg(peer));
 
-        m_httpHandler->send(mi, HHttpMessageCreator::createResponse(
-            Ok, *mi, service->description().toUtf8(), ContentType_TextXml));
-
+        sendResource(mi, requestHdr, m_serviceDescriptions.value(service));
         return;
     }
 
@@ -439,19 +583,19 @@ void HDeviceHostHttpServer::incomingUnknownGetRequest(
 
     if (!icon.isEmpty())
     {
-        QFile iconFile(icon.toLocalFile());
-        if (!iconFile.open(QIODevice::ReadOnly))
+        HStaticResource iconResource =
+            m_icons.value(device->rootDevice()).value(icon.toString());
+
+        if (!iconResource.isValid())
         {
-            HLOG_WARN(QString("Could not open icon file.").arg(icon.toLocalFile()));
+            HLOG_WARN(QString("Icon [%1] could not be loaded.").arg(icon.toString()));
             m_httpHandler->send(mi, HHttpMessageCreator::createResponse(InternalServerError, *mi));
             return;
         }
 
         HLOG_DBG(QString("Sending icon to [%1] as requested.").arg(peer));
 
-        m_httpHandler->send(mi, HHttpMessageCreator::createResponse(
-            Ok, *mi, iconFile.readAll(), ContentType_TextXml));
-
+        sendResource(mi, requestHdr, iconResource);
         return;
     }
 
@@ -36,8 +36,10 @@
 #include "../hdevicestorage_p.h"
 #include "../messages/hevent_messages_p.h"
 
+#include "../../http/hhttp_p.h"
 #include "../../http/hhttp_server_p.h"
 
+#include <QtCore/QHash>
 #include <QtCore/QPointer>
 
 namespace Herqq
@@ -71,6 +73,25 @@ public:
     inline bool isValid() const { return m_service; }
 };
 
+//
+// A response body that is encoded once and served from memory for as long as
+// the device host runs. The entity tag is strong and it is tied to the
+// configId of the root device the data belongs to.
+//
+class HStaticResource
+{
+public:
+
+    QByteArray m_data;
+    ContentType m_contentType;
+    QString m_etag;
+
+    HStaticResource();
+    HStaticResource(const QByteArray& data, ContentType, qint32 configId);
+
+    inline bool isValid() const { return !m_etag.isEmpty(); }
+};
+
 //
 // Internal class that provides minimal HTTP server functionality for the needs of
 // Device Host
@@ -89,6 +110,20 @@ private:
 
     QList<QPair<QPointer<HHttpAsyncOperation>, HOpInfo> > m_ops;
 
+    QHash<const HServerDevice*, HStaticResource> m_deviceDescriptions;
+    QHash<const HServerService*, HStaticResource> m_serviceDescriptions;
+
+    QHash<const HServerDevice*, QHash<QString, HStaticResource> > m_icons;
+    // The icons of each root device keyed by the icon URL found in the
+    // device description.
+
+    void addDevice(
+        const HServerDevice*, const HStaticResource& deviceDescription,
+        qint32 configId);
+
+    void sendResource(
+        HMessagingInfo*, const HHttpRequestHeader&, const HStaticResource&);
+
 protected:
 
     virtual void incomingSubscriptionRequest(
@@ -113,6 +148,12 @@ public:
         QObject* parent = 0);
 
     virtual ~HDeviceHostHttpServer();
+
+    // Encodes the device and service descriptions of the specified root device
+    // and its embedded devices, and stores them along with the contents of
+    // the icons, which are keyed by the icon URLs found in the device description.
+    void addRootDevice(
+        const HServerDevice*, const QHash<QString, QByteArray>& icons);
 };
 
 }
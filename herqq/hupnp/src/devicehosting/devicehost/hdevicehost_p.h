@@ -123,6 +123,9 @@ public: // methods
     void startNotifiers(HServerDeviceController*);
     void startNotifiers();
     bool createRootDevice(const HDeviceConfiguration*);
+    bool createRootDevice(
+        const HDeviceConfiguration*, const QString& deviceDescription);
+
     bool createRootDevices();
 
     inline static const QString& deviceDescriptionPostFix()
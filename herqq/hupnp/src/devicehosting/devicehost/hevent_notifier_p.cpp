@@ -28,6 +28,7 @@
 #include "../../devicemodel/server/hserverdevice.h"
 #include "../../devicemodel/server/hserverservice.h"
 #include "../../devicemodel/server/hserverstatevariable.h"
+#include "../../devicemodel/hdevicestatus.h"
 
 #include "../../dataelements/hudn.h"
 #include "../../dataelements/hdeviceinfo.h"
@@ -35,7 +36,9 @@
 #include "../../dataelements/hstatevariableinfo.h"
 
 #include "../../http/hhttp_messaginginfo_p.h"
+#include "../../http/hhttp_messagecreator_p.h"
 
+#include "../../socket/hmulticast_socket.h"
 #include "../../general/hlogger_p.h"
 
 #include <QtXml/QDomDocument>
@@ -49,7 +52,8 @@ namespace Upnp
 
 namespace
 {
-void getCurrentValues(QByteArray& msgBody, const HServerService* service)
+bool getCurrentValues(
+    QByteArray& msgBody, const HServerService* service, bool multicastOnly = false)
 {
     HLOG(H_AT, H_FUN);
 
@@ -65,6 +69,7 @@ void getCurrentValues(QByteArray& msgBody, const HServerService* service)
 
     dd.appendChild(propertySetElem);
 
+    bool found = false;
     HServerStateVariables stateVars = service->stateVariables();
     QHash<QString, HServerStateVariable*>::const_iterator ci = stateVars.constBegin();
     for(; ci != stateVars.constEnd(); ++ci)
@@ -73,7 +78,9 @@ void getCurrentValues(QByteArray& msgBody, const HServerService* service)
         Q_ASSERT(stateVar);
 
         const HStateVariableInfo& info = stateVar->info();
-        if (info.eventingType() == HStateVariableInfo::NoEvents)
+        if (info.eventingType() == HStateVariableInfo::NoEvents ||
+           (multicastOnly &&
+            info.eventingType() != HStateVariableInfo::UnicastAndMulticast))
         {
             continue;
         }
@@ -86,9 +93,12 @@ void getCurrentValues(QByteArray& msgBody, const HServerService* service)
 
         propertyElem.appendChild(variableElem);
         propertySetElem.appendChild(propertyElem);
+
+        found = true;
     }
 
     msgBody = dd.toByteArray();
+    return found;
 }
 }
 
@@ -102,7 +112,16 @@ HEventNotifier::HEventNotifier(
         QObject(parent),
             m_loggingIdentifier(loggingIdentifier),
             m_subscribers(),
-            m_configuration(configuration)
+            m_subscribersBySid(),
+            m_configuration(configuration),
+            m_connectionPool(
+                loggingIdentifier,
+                configuration.maxConnectionsPerHost(),
+                configuration.connectionIdleTimeout(),
+                this),
+            m_multicastSockets(),
+            m_multicastSocketsCreated(false),
+            m_multicastEventSources()
 {
 }
 
@@ -145,22 +164,18 @@ bool isSameService(HServerService* srv1, HServerService* srv2)
 }
 }
 
+QList<HServiceEventSubscriber*>::iterator HEventNotifier::eraseSubscriber(
+    QList<HServiceEventSubscriber*>::iterator it)
+{
+    m_subscribersBySid.remove((*it)->sid());
+    delete *it;
+    return m_subscribers.erase(it);
+}
+
 HServiceEventSubscriber* HEventNotifier::remoteClient(const HSid& sid) const
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
-
-    QList<HServiceEventSubscriber*>::const_iterator it =
-        m_subscribers.constBegin();
-
-    for(; it != m_subscribers.end(); ++it)
-    {
-        if ((*it)->sid() == sid)
-        {
-            return *it;
-        }
-    }
-
-    return 0;
+    return m_subscribersBySid.value(sid);
 }
 
 StatusCode HEventNotifier::addSubscriber(
@@ -217,9 +232,11 @@ StatusCode HEventNotifier::addSubscriber(
             service,
             sreq.callbacks().at(0),
             timeout,
+            m_connectionPool,
             this);
 
     m_subscribers.push_back(rc);
+    m_subscribersBySid.insert(rc->sid(), rc);
 
     *sid = rc->sid();
 
@@ -240,8 +257,7 @@ bool HEventNotifier::removeSubscriber(const HUnsubscribeRequest& req)
             HLOG_INFO(QString("removing subscriber [SID [%1]] from [%2]").arg(
                 req.sid().toString(), (*it)->location().toString()));
 
-            delete *it;
-            it = m_subscribers.erase(it);
+            it = eraseSubscriber(it);
 
             found = true;
         }
@@ -251,8 +267,7 @@ bool HEventNotifier::removeSubscriber(const HUnsubscribeRequest& req)
                 "removing an expired subscription [SID [%1]] from [%2]").arg(
                     (*it)->sid().toString(), (*it)->location().toString()));
 
-            delete *it;
-            it = m_subscribers.erase(it);
+            it = eraseSubscriber(it);
         }
         else
         {
@@ -276,31 +291,15 @@ StatusCode HEventNotifier::renewSubscription(
 
     Q_ASSERT(sid);
 
-    QList<HServiceEventSubscriber*>::iterator it = m_subscribers.begin();
-    for(; it != m_subscribers.end();)
+    HServiceEventSubscriber* sub = m_subscribersBySid.value(req.sid());
+    if (sub)
     {
-        HServiceEventSubscriber* sub = (*it);
-        if (sub->sid() == req.sid())
-        {
-            HLOG_INFO(QString("renewing subscription from [%1]").arg(
-                (*it)->location().toString()));
+        HLOG_INFO(QString("renewing subscription from [%1]").arg(
+            sub->location().toString()));
 
-            sub->renew(getSubscriptionTimeout(req));
-            *sid = sub->sid();
-            return Ok;
-        }
-        else if (sub->expired())
-        {
-            HLOG_INFO(QString("removing subscriber [SID [%1]] from [%2]").arg(
-                sub->sid().toString(), sub->location().toString()));
-
-            delete *it;
-            it = m_subscribers.erase(it);
-        }
-        else
-        {
-            ++it;
-        }
+        sub->renew(getSubscriptionTimeout(req));
+        *sid = sub->sid();
+        return Ok;
     }
 
     HLOG_WARN(QString("Cannot renew subscription. Invalid SID: [%1]").arg(
@@ -332,8 +331,7 @@ void HEventNotifier::stateChanged(const HServerService* source)
             HLOG_INFO(QString("removing subscriber [SID [%1]] from [%2]").arg(
                 sub->sid().toString(), sub->location().toString()));
 
-            delete *it;
-            it = m_subscribers.erase(it);
+            it = eraseSubscriber(it);
         }
         else
         {
@@ -341,7 +339,97 @@ void HEventNotifier::stateChanged(const HServerService* source)
         }
     }
 
-    // TODO add multicast event support
+    multicastNotify(source);
+}
+
+bool HEventNotifier::createMulticastSockets()
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    if (m_multicastSocketsCreated)
+    {
+        return !m_multicastSockets.isEmpty();
+    }
+
+    m_multicastSocketsCreated = true;
+
+    foreach(const QHostAddress& ha, m_configuration.networkAddressesToUse())
+    {
+        HMulticastSocket* socket = new HMulticastSocket(this);
+
+        // binding to the address selects the interface the events are sent from
+        if (!socket->QUdpSocket::bind(ha, 0))
+        {
+            HLOG_WARN(QString(
+                "Failed to bind a socket for multicast events to [%1]: %2").arg(
+                    ha.toString(), socket->errorString()));
+
+            delete socket;
+            continue;
+        }
+
+        // UDA v1.1 instructs the TTL of multicast events to default to 4
+        socket->setMulticastTtl(4);
+        m_multicastSockets.append(socket);
+    }
+
+    return !m_multicastSockets.isEmpty();
+}
+
+void HEventNotifier::multicastNotify(const HServerService* source)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    QByteArray msgBody;
+    if (!getCurrentValues(msgBody, source, true))
+    {
+        // none of the state variables is evented over multicast
+        return;
+    }
+
+    const HServerDevice* device = source->parentDevice();
+    HDiscoveryType usn(
+        device->info().udn(), source->info().serviceType(), LooseChecks);
+
+    HMulticastEventSource& eventSource =
+        m_multicastEventSources[
+            usn.toString().append(source->info().serviceId().toString())];
+
+    if (eventSource.m_lastBody == msgBody)
+    {
+        // the change concerned only variables that are evented over unicast
+        return;
+    }
+
+    if (!createMulticastSockets())
+    {
+        return;
+    }
+
+    eventSource.m_lastBody = msgBody;
+
+    HMulticastNotifyRequest req(
+        usn, source->info().serviceId(), eventSource.m_seq, "upnp:/info",
+        device->rootDevice()->deviceStatus().bootId(), msgBody);
+
+    // the sequence number wraps to 1, as with unicast events
+    eventSource.m_seq =
+        eventSource.m_seq == 0xffffffff ? 1 : eventSource.m_seq + 1;
+
+    QByteArray data = HHttpMessageCreator::create(req);
+
+    foreach(HMulticastSocket* socket, m_multicastSockets)
+    {
+        if (socket->writeDatagram(
+                data,
+                HMulticastNotifyRequest::multicastAddress(),
+                HMulticastNotifyRequest::multicastPort()) != data.size())
+        {
+            HLOG_WARN(QString(
+                "Failed to send multicast event from [%1]: %2").arg(
+                    socket->localAddress().toString(), socket->errorString()));
+        }
+    }
 }
 
 void HEventNotifier::initialNotify(
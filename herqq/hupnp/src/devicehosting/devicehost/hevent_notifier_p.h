@@ -31,9 +31,12 @@
 //
 
 #include "../../http/hhttp_p.h"
+#include "../../http/hhttp_connectionpool_p.h"
+#include "../messages/hsid_p.h"
 #include "../../general/hupnp_fwd.h"
 #include "../../general/hupnp_defs.h"
 
+#include <QtCore/QHash>
 #include <QtCore/QList>
 #include <QtCore/QObject>
 #include <QtCore/QByteArray>
@@ -44,13 +47,30 @@ namespace Herqq
 namespace Upnp
 {
 
-class HSid;
 class HTimeout;
 class HMessagingInfo;
 class HSubscribeRequest;
+class HMulticastSocket;
 class HUnsubscribeRequest;
 class HServiceEventSubscriber;
 
+//
+// The state of the multicast events of a single service
+//
+class HMulticastEventSource
+{
+public:
+
+    quint32 m_seq;
+    // the sequence number of the next multicast event
+
+    QByteArray m_lastBody;
+    // the body of the previous multicast event. a new event is sent only
+    // when a variable evented over multicast has changed.
+
+    inline HMulticastEventSource() : m_seq(0), m_lastBody() { }
+};
+
 //
 // Internal class used to notify event subscribers of events.
 //
@@ -67,12 +87,33 @@ private: // attributes
 
     QList<HServiceEventSubscriber*> m_subscribers;
 
+    QHash<HSid, HServiceEventSubscriber*> m_subscribersBySid;
+    // the subscribers above keyed by their SIDs
+
     HDeviceHostConfiguration& m_configuration;
 
+    HHttpConnectionPool m_connectionPool;
+    // keep-alive connections used to deliver events to the subscribers.
+    // subscribers sharing a callback host share the connections.
+
+    QList<HMulticastSocket*> m_multicastSockets;
+    bool m_multicastSocketsCreated;
+    // the sockets used to send multicast events, one per network address
+    // in use. the sockets are created when the first multicast event is sent.
+
+    QHash<QString, HMulticastEventSource> m_multicastEventSources;
+    // keyed by the USN and the service ID of the service
+
 private: // methods
 
     HTimeout getSubscriptionTimeout(const HSubscribeRequest&);
 
+    QList<HServiceEventSubscriber*>::iterator eraseSubscriber(
+        QList<HServiceEventSubscriber*>::iterator);
+
+    bool createMulticastSockets();
+    void multicastNotify(const HServerService*);
+
 private Q_SLOTS:
 
     void stateChanged(const Herqq::Upnp::HServerService* source);
@@ -57,13 +57,13 @@ bool HServiceEventSubscriber::send(HMessagingInfo* mi)
 
     HNotifyRequest req(m_location, m_sid, seq, message);
 
-    QByteArray data = HHttpMessageCreator::create(req, mi);
+    QByteArray header = HHttpMessageCreator::createHeader(req, mi);
 
     HLOG_DBG(QString(
         "Sending notification [seq: %1] to subscriber [%2] @ [%3]").arg(
             QString::number(seq), m_sid.toString(), m_location.toString()));
 
-    HHttpAsyncOperation* oper = m_asyncHttp.msgIo(mi, data);
+    HHttpAsyncOperation* oper = m_asyncHttp.msgIo(mi, header, req.data());
     if (!oper)
     {
         // notify failed
@@ -84,7 +84,8 @@ bool HServiceEventSubscriber::send(HMessagingInfo* mi)
 
 HServiceEventSubscriber::HServiceEventSubscriber(
     const QByteArray& loggingIdentifier, HServerService* service,
-    const QUrl location, const HTimeout& timeout, QObject* parent) :
+    const QUrl location, const HTimeout& timeout,
+    HHttpConnectionPool& connectionPool, QObject* parent) :
         QObject(parent),
             m_service(service),
             m_location(location),
@@ -93,7 +94,9 @@ HServiceEventSubscriber::HServiceEventSubscriber(
             m_timeout(timeout),
             m_timer(this),
             m_asyncHttp(loggingIdentifier, this),
-            m_socket(new QTcpSocket(this)),
+            m_connectionPool(connectionPool),
+            m_socket(0),
+            m_waitingForConnection(false),
             m_messagesToSend(),
             m_expired(false),
             m_loggingIdentifier(loggingIdentifier)
@@ -109,7 +112,8 @@ HServiceEventSubscriber::HServiceEventSubscriber(
     Q_ASSERT(ok); Q_UNUSED(ok)
 
     ok = connect(
-        m_socket.data(), SIGNAL(connected()), this, SLOT(send()));
+        &m_connectionPool, SIGNAL(connectionAvailable(QString, quint16)),
+        this, SLOT(connectionAvailable(QString, quint16)));
 
     Q_ASSERT(ok);
 
@@ -133,38 +137,125 @@ HServiceEventSubscriber::~HServiceEventSubscriber()
     HLOG_DBG(QString(
         "Subscription from [%1] with SID %2 cancelled").arg(
             m_location.toString(), m_sid.toString()));
+
+    releaseConnection(false);
 }
 
 bool HServiceEventSubscriber::connectToHost()
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
-    Q_ASSERT(QThread::currentThread() == m_socket->thread());
-    Q_ASSERT(m_socket.data());
+    if (m_socket)
+    {
+        Q_ASSERT(QThread::currentThread() == m_socket->thread());
 
-    QTcpSocket::SocketState state = m_socket->state();
+        QTcpSocket::SocketState state = m_socket->state();
 
-    if (state == QTcpSocket::ConnectedState)
-    {
-        return true;
+        if (state == QTcpSocket::ConnectedState)
+        {
+            return true;
+        }
+        else if (state == QTcpSocket::ConnectingState ||
+                 state == QTcpSocket::HostLookupState)
+        {
+            return false;
+        }
+
+        releaseConnection(false);
     }
-    else if (state == QTcpSocket::ConnectingState ||
-             state == QTcpSocket::HostLookupState)
+
+    m_socket = m_connectionPool.acquire(m_location);
+    if (!m_socket)
     {
+        // too many connections to the subscriber's host are already in use.
+        // the sending is resumed when one of them is released.
+        m_waitingForConnection = true;
         return false;
     }
 
-    m_socket->connectToHost(m_location.host(), m_location.port());
+    m_waitingForConnection = false;
+
+    if (m_socket->state() == QTcpSocket::ConnectedState)
+    {
+        return true;
+    }
+
+    bool ok = connect(m_socket, SIGNAL(connected()), this, SLOT(connected()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    ok = connect(
+        m_socket, SIGNAL(error(QAbstractSocket::SocketError)),
+        this, SLOT(error(QAbstractSocket::SocketError)));
+
+    Q_ASSERT(ok);
 
     return false;
 }
 
+void HServiceEventSubscriber::releaseConnection(bool keepAlive)
+{
+    if (!m_socket)
+    {
+        return;
+    }
+
+    QTcpSocket* sock = m_socket;
+    m_socket = 0;
+
+    sock->disconnect(this);
+    m_connectionPool.release(sock, keepAlive);
+}
+
+void HServiceEventSubscriber::connected()
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    Q_ASSERT(m_socket);
+    m_socket->disconnect(this);
+
+    send();
+}
+
+void HServiceEventSubscriber::error(QAbstractSocket::SocketError)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    // this can be called only when connecting to host
+
+    HLOG_WARN(QString(
+        "Could not connect to subscriber [sid: %1] @ [%2]: %3").arg(
+            m_sid.toString(), m_location.toString(), m_socket->errorString()));
+
+    releaseConnection(false);
+}
+
+void HServiceEventSubscriber::connectionAvailable(
+    const QString& host, quint16 port)
+{
+    if (!m_waitingForConnection ||
+        m_location.host().compare(host, Qt::CaseInsensitive) != 0 ||
+        m_location.port(80) != port)
+    {
+        return;
+    }
+
+    m_waitingForConnection = false;
+    send();
+}
+
 void HServiceEventSubscriber::msgIoComplete(HHttpAsyncOperation* operation)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
     operation->deleteLater();
 
+    if (m_socket == &operation->messagingInfo()->socket())
+    {
+        releaseConnection(
+            operation->state() == HHttpAsyncOperation::Succeeded &&
+            operation->messagingInfo()->keepAlive());
+    }
+
     if (operation->state() == HHttpAsyncOperation::Failed)
     {
         HLOG_WARN(QString(
@@ -211,19 +302,19 @@ void HServiceEventSubscriber::send()
     QByteArray message = m_messagesToSend.head();
     qint32 seq = m_seq++;
 
-    HMessagingInfo* mi = new HMessagingInfo(*m_socket, false, 10000);
+    HMessagingInfo* mi = new HMessagingInfo(*m_socket, true, 10000);
     // timeout specified by UDA v 1.1 is 30 seconds, but that seems absurd
     // in this context. however, if this causes problems change it back.
 
     HNotifyRequest req(m_location, m_sid, seq, message);
 
-    QByteArray data = HHttpMessageCreator::create(req, mi);
+    QByteArray header = HHttpMessageCreator::createHeader(req, mi);
 
     HLOG_DBG(QString(
         "Sending notification [seq: %1] to subscriber [%2] @ [%3]").arg(
             QString::number(seq), m_sid.toString(), m_location.toString()));
 
-    HHttpAsyncOperation* oper = m_asyncHttp.msgIo(mi, data);
+    HHttpAsyncOperation* oper = m_asyncHttp.msgIo(mi, header, req.data());
     if (!oper)
     {
         // notify failed
@@ -237,6 +328,8 @@ void HServiceEventSubscriber::send()
             "Could not send notify [seq: %1, sid: %2] to host @ [%3].").arg(
                 QString::number(seq), m_sid.toString(),
                 m_location.toString()));
+
+        releaseConnection(false);
     }
 }
 
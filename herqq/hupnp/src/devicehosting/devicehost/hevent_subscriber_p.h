@@ -32,6 +32,7 @@
 
 #include "../messages/hevent_messages_p.h"
 #include "../../http/hhttp_asynchandler_p.h"
+#include "../../http/hhttp_connectionpool_p.h"
 
 #include <QtCore/QQueue>
 #include <QtCore/QTimer>
@@ -67,7 +68,13 @@ private: // attributes
     QTimer m_timer;
     HHttpAsyncHandler m_asyncHttp;
 
-    QScopedPointer<QTcpSocket> m_socket;
+    HHttpConnectionPool& m_connectionPool;
+
+    QTcpSocket* m_socket;
+    // acquired from the connection pool for the duration of a notification
+
+    bool m_waitingForConnection;
+
     QQueue<QByteArray> m_messagesToSend;
 
     bool m_expired;
@@ -75,10 +82,14 @@ private: // attributes
     const QByteArray m_loggingIdentifier;
 
     bool connectToHost();
+    void releaseConnection(bool keepAlive);
 
 private Q_SLOTS:
 
     void send();
+    void connected();
+    void error(QAbstractSocket::SocketError);
+    void connectionAvailable(const QString& host, quint16 port);
     void msgIoComplete(HHttpAsyncOperation*);
     void subscriptionTimeout();
 
@@ -91,7 +102,7 @@ public:
     HServiceEventSubscriber(
         const QByteArray& loggingIdentifier,
         HServerService* service, const QUrl location, const HTimeout& timeout,
-        QObject* parent = 0);
+        HHttpConnectionPool& connectionPool, QObject* parent = 0);
 
     virtual ~HServiceEventSubscriber();
 
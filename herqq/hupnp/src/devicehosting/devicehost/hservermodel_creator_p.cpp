@@ -46,8 +46,6 @@
 
 #include "../../general/hlogger_p.h"
 
-#include <QtXml/QDomElement>
-
 namespace Herqq
 {
 
@@ -150,22 +148,14 @@ HDevicesSetupData HServerModelCreator::getDevicesSetupData(
     return HDevicesSetupData();
 }
 
-bool HServerModelCreator::parseStateVariables(
-    HServerService* service, QDomElement stateVariableElement)
+bool HServerModelCreator::createStateVariables(
+    HServerService* service, const QList<HStateVariableInfo>& svInfos)
 {
     HStateVariablesSetupData stateVariablesSetup =
         getStateVariablesSetupData(service);
 
-    while(!stateVariableElement.isNull())
+    foreach(const HStateVariableInfo& svInfo, svInfos)
     {
-        HStateVariableInfo svInfo;
-        if (!m_docParser.parseStateVariable(stateVariableElement, &svInfo))
-        {
-            m_lastError = convert(m_docParser.lastError());
-            m_lastErrorDescription = m_docParser.lastErrorDescription();
-            return false;
-        }
-
         QString name = svInfo.name();
         HStateVariableInfo setupData = stateVariablesSetup.get(name);
         if (!setupData.isValid() &&
@@ -207,9 +197,6 @@ bool HServerModelCreator::parseStateVariables(
 
         Q_ASSERT(ok); Q_UNUSED(ok)
 
-        stateVariableElement =
-            stateVariableElement.nextSiblingElement("stateVariable");
-
         stateVariablesSetup.remove(name);
     }
 
@@ -234,25 +221,15 @@ bool HServerModelCreator::parseStateVariables(
     return true;
 }
 
-bool HServerModelCreator::parseActions(
-    HServerService* service, QDomElement actionElement,
-    const HStateVariableInfos& svInfos)
+bool HServerModelCreator::createActions(
+    HServerService* service, const QList<HActionInfo>& actionInfos)
 {
     HActionsSetupData actionsSetupData = getActionsSetupData(service);
 
     QHash<QString, HActionInvoke> actionInvokes = service->createActionInvokes();
 
-    while(!actionElement.isNull())
+    foreach(const HActionInfo& actionInfo, actionInfos)
     {
-        HActionInfo actionInfo;
-        if (!m_docParser.parseActionInfo(
-                actionElement, svInfos, &actionInfo))
-        {
-            m_lastError = convert(m_docParser.lastError());
-            m_lastErrorDescription = m_docParser.lastErrorDescription();
-            return false;
-        }
-
         QString name = actionInfo.name();
 
         HActionInvoke actionInvoke = actionInvokes.value(name);
@@ -283,8 +260,6 @@ bool HServerModelCreator::parseActions(
 
         service->h_ptr->m_actions.insert(name, action.take());
 
-        actionElement = actionElement.nextSiblingElement("action");
-
         actionsSetupData.remove(name);
     }
 
@@ -314,55 +289,35 @@ bool HServerModelCreator::parseServiceDescription(HServerService* service)
     HLOG2(H_AT, H_FUN, m_creationParameters->m_loggingIdentifier);
     Q_ASSERT(service);
 
-    QDomDocument doc;
-    QDomElement firstSv, firstAction;
+    HServiceDescriptionData descriptionData;
     if (!m_docParser.parseServiceDescription(
-        service->h_ptr->m_serviceDescription, &doc, &firstSv, &firstAction))
+        service->h_ptr->m_serviceDescription, &descriptionData))
     {
         m_lastError = convert(m_docParser.lastError());
         m_lastErrorDescription = m_docParser.lastErrorDescription();
         return false;
     }
 
-    if (!parseStateVariables(service, firstSv))
+    if (!createStateVariables(service, descriptionData.m_stateVariables))
     {
         return false;
     }
 
-    HStateVariableInfos svInfos;
-    HServerStateVariables svs = service->stateVariables();
-    foreach(const QString& key, svs.keys())
-    {
-        svInfos.insert(key, svs.value(key)->info());
-    }
-
-    return parseActions(service, firstAction, svInfos);
+    return createActions(service, descriptionData.m_actions);
 }
 
-bool HServerModelCreator::parseServiceList(
-    const QDomElement& serviceListElement, HServerDevice* device,
+bool HServerModelCreator::createServices(
+    const QList<HServiceInfo>& serviceInfos, HServerDevice* device,
     QList<HServerService*>* retVal)
 {
     HLOG2(H_AT, H_FUN, m_creationParameters->m_loggingIdentifier);
 
     Q_ASSERT(device);
-    Q_ASSERT(!serviceListElement.isNull());
-
-    QDomElement serviceElement =
-        serviceListElement.firstChildElement("service");
 
     HServicesSetupData setupData = getServicesSetupData(device);
 
-    while(!serviceElement.isNull())
+    foreach(const HServiceInfo& info, serviceInfos)
     {
-        HServiceInfo info;
-        if (!m_docParser.parseServiceInfo(serviceElement, &info))
-        {
-            m_lastError = convert(m_docParser.lastError());
-            m_lastErrorDescription = m_docParser.lastErrorDescription();
-            return false;
-        }
-
         QScopedPointer<HServerService> service(
             m_creationParameters->creator()->createService(info, device->info()));
 
@@ -414,8 +369,6 @@ bool HServerModelCreator::parseServiceList(
 
         retVal->push_back(service.take());
 
-        serviceElement = serviceElement.nextSiblingElement("service");
-
         setupData.remove(info.serviceId());
     }
 
@@ -462,18 +415,12 @@ QList<QUrl> generateLocations(
 }
 }
 
-HServerDevice* HServerModelCreator::parseDevice(
-    const QDomElement& deviceElement, HServerDevice* parentDevice)
+HServerDevice* HServerModelCreator::createDevice(
+    const HDeviceDescriptionData& deviceData, HServerDevice* parentDevice)
 {
     HLOG2(H_AT, H_FUN, m_creationParameters->m_loggingIdentifier);
 
-    HDeviceInfo deviceInfo;
-    if (!m_docParser.parseDeviceInfo(deviceElement, &deviceInfo))
-    {
-        m_lastError = convert(m_docParser.lastError());
-        m_lastErrorDescription = m_docParser.lastErrorDescription();
-        return 0;
-    }
+    const HDeviceInfo& deviceInfo = deviceData.m_info;
 
     QScopedPointer<HServerDevice> device(
         m_creationParameters->creator()->createDevice(deviceInfo));
@@ -499,13 +446,10 @@ HServerDevice* HServerModelCreator::parseDevice(
     device->h_ptr->m_deviceDescription =
         m_creationParameters->m_deviceDescription;
 
-    QDomElement serviceListElement =
-        deviceElement.firstChildElement("serviceList");
-
-    if (!serviceListElement.isNull())
+    if (!deviceData.m_services.isEmpty())
     {
         HServerServices services;
-        if (!parseServiceList(serviceListElement, device.data(), &services))
+        if (!createServices(deviceData.m_services, device.data(), &services))
         {
             qDeleteAll(services);
             return 0;
@@ -516,18 +460,15 @@ HServerDevice* HServerModelCreator::parseDevice(
 
     HDevicesSetupData setupData = getDevicesSetupData(device.data());
 
-    QDomElement deviceListElement = deviceElement.firstChildElement("deviceList");
-    if (!deviceListElement.isNull())
+    if (!deviceData.m_embeddedDevices.isEmpty())
     {
         QList<HServerDevice*> embeddedDevices;
 
-        QDomElement embeddedDeviceElement =
-            deviceListElement.firstChildElement("device");
-
-        while(!embeddedDeviceElement.isNull())
+        foreach(const HDeviceDescriptionData& embeddedDeviceData,
+                deviceData.m_embeddedDevices)
         {
             HServerDevice* embeddedDevice =
-                parseDevice(embeddedDeviceElement, device.data());
+                createDevice(embeddedDeviceData, device.data());
 
             if (!embeddedDevice)
             {
@@ -536,9 +477,6 @@ HServerDevice* HServerModelCreator::parseDevice(
             }
 
             embeddedDevices.push_back(embeddedDevice);
-
-            embeddedDeviceElement =
-                embeddedDeviceElement.nextSiblingElement("device");
         }
 
         device->h_ptr->m_embeddedDevices = embeddedDevices;
@@ -578,25 +516,27 @@ HServerDevice* HServerModelCreator::createRootDevice()
 {
     HLOG2(H_AT, H_FUN, m_creationParameters->m_loggingIdentifier);
 
-    QDomDocument doc;
-    QDomElement rootElement;
-    if (!m_docParser.parseRoot(
-            m_creationParameters->m_deviceDescription, &doc, &rootElement))
+    HDeviceDescriptionData rootDeviceData;
+    qint32 configId = 0;
+    if (!m_docParser.parseDeviceDescription(
+            m_creationParameters->m_deviceDescription, &rootDeviceData,
+            &configId))
     {
         m_lastError = convert(m_docParser.lastError());
         m_lastErrorDescription = m_docParser.lastErrorDescription();
         return 0;
     }
 
-    QScopedPointer<HServerDevice> createdDevice(parseDevice(rootElement, 0));
+    QScopedPointer<HServerDevice> createdDevice(
+        createDevice(rootDeviceData, 0));
+
     if (!createdDevice)
     {
         return 0;
     }
 
     createdDevice->h_ptr->m_deviceStatus.reset(new HDeviceStatus());
-    createdDevice->h_ptr->m_deviceStatus->setConfigId(
-        m_docParser.readConfigId(rootElement));
+    createdDevice->h_ptr->m_deviceStatus->setConfigId(configId);
 
     createdDevice->h_ptr->m_locations =
         generateLocations(
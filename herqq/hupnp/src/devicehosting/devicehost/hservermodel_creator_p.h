@@ -127,25 +127,20 @@ private:
     HServicesSetupData getServicesSetupData(HServerDevice*);
     HDevicesSetupData getDevicesSetupData(HServerDevice*);
 
-    QList<QPair<QUrl, QByteArray> > parseIconList(
-        const QDomElement& iconListElement);
+    bool createStateVariables(
+        HServerService* service, const QList<HStateVariableInfo>&);
 
-    bool parseStateVariables(
-        HServerService* service, QDomElement stateVariableElement);
-
-    bool parseActions(
-        HServerService* service,
-        QDomElement actionElement,
-        const HStateVariableInfos& svInfos);
+    bool createActions(
+        HServerService* service, const QList<HActionInfo>&);
 
     bool parseServiceDescription(HServerService*);
 
-    bool parseServiceList(
-        const QDomElement& serviceListElement, HServerDevice*,
+    bool createServices(
+        const QList<HServiceInfo>&, HServerDevice*,
         QList<HServerService*>* retVal);
 
-    HServerDevice* parseDevice(
-        const QDomElement& deviceElement, HServerDevice* parentDevice);
+    HServerDevice* createDevice(
+        const HDeviceDescriptionData&, HServerDevice* parentDevice);
 
     inline ErrorType convert(DocumentErrorTypes type)
     {
@@ -12,11 +12,14 @@ HEADERS += \
     $$SRC_LOC/devicehosting/controlpoint/hcontrolpoint.h \
     $$SRC_LOC/devicehosting/controlpoint/hdevicebuild_p.h \
     $$SRC_LOC/devicehosting/controlpoint/hclientmodel_creator_p.h \
+    $$SRC_LOC/devicehosting/controlpoint/hclientservice_loader_p.h \
     $$SRC_LOC/devicehosting/controlpoint/hcontrolpoint_configuration.h \
     $$SRC_LOC/devicehosting/controlpoint/hcontrolpoint_configuration_p.h \
     $$SRC_LOC/devicehosting/controlpoint/hcontrolpoint_dataretriever_p.h \
     $$SRC_LOC/devicehosting/controlpoint/hevent_subscription_p.h \
     $$SRC_LOC/devicehosting/controlpoint/hevent_subscriptionmanager_p.h \
+    $$SRC_LOC/devicehosting/controlpoint/hdevice_expirywheel_p.h \
+    $$SRC_LOC/devicehosting/controlpoint/hmulticast_eventlistener_p.h \
     $$SRC_LOC/devicehosting/devicehost/hdevicehost_p.h \
     $$SRC_LOC/devicehosting/devicehost/hdevicehost.h \
     $$SRC_LOC/devicehosting/devicehost/hserverdevicecontroller_p.h \
@@ -42,11 +45,14 @@ SOURCES += \
     $$SRC_LOC/devicehosting/messages/htimeout_p.cpp \
     $$SRC_LOC/devicehosting/controlpoint/hcontrolpoint.cpp \
     $$SRC_LOC/devicehosting/controlpoint/hclientmodel_creator_p.cpp \
+    $$SRC_LOC/devicehosting/controlpoint/hclientservice_loader_p.cpp \
     $$SRC_LOC/devicehosting/controlpoint/hdevicebuild_p.cpp \
     $$SRC_LOC/devicehosting/controlpoint/hcontrolpoint_configuration.cpp \
     $$SRC_LOC/devicehosting/controlpoint/hcontrolpoint_dataretriever_p.cpp \
     $$SRC_LOC/devicehosting/controlpoint/hevent_subscription_p.cpp \
     $$SRC_LOC/devicehosting/controlpoint/hevent_subscriptionmanager_p.cpp \
+    $$SRC_LOC/devicehosting/controlpoint/hdevice_expirywheel_p.cpp \
+    $$SRC_LOC/devicehosting/controlpoint/hmulticast_eventlistener_p.cpp \
     $$SRC_LOC/devicehosting/devicehost/hdevicehost.cpp \
     $$SRC_LOC/devicehosting/devicehost/hservermodel_creator_p.cpp \
     $$SRC_LOC/devicehosting/devicehost/hdevicehost_dataretriever_p.cpp \
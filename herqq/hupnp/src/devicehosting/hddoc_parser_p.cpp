@@ -30,6 +30,8 @@
 
 #include "../general/hlogger_p.h"
 
+#include <QtCore/QXmlStreamReader>
+
 namespace Herqq
 {
 
@@ -46,554 +48,1063 @@ HDocParser::HDocParser(
 {
 }
 
-HStateVariableInfo HDocParser::parseStateVariableInfo_str(
-    const QString& name, const QVariant& defValue, const QDomElement& svElement,
-    HStateVariableInfo::EventingType evType, HInclusionRequirement incReq)
+namespace
 {
-    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
-
-    QStringList allowedValues;
+inline bool isElement(const QXmlStreamReader& reader, const char* name)
+{
+    return reader.name() == QLatin1String(name);
+}
 
-    QDomElement allowedValueListElement =
-        svElement.firstChildElement("allowedValueList");
+// Returns the text of the current element, which is how QDomElement::text()
+// used to read element values.
+inline QString readText(QXmlStreamReader& reader)
+{
+    return reader.readElementText(QXmlStreamReader::IncludeChildElements);
+}
 
-    if (!allowedValueListElement.isNull())
+qint32 toConfigId(const QStringRef& arg)
+{
+    bool ok = false;
+    qint32 retVal = arg.toString().toInt(&ok);
+    if (!ok || retVal < 0 || retVal > ((1 << 24)-1))
     {
-        QDomElement allowedValueElement =
-            allowedValueListElement.firstChildElement("allowedValue");
-
-        while(!allowedValueElement.isNull())
-        {
-            allowedValues.push_back(allowedValueElement.text());
-
-            allowedValueElement =
-                allowedValueElement.nextSiblingElement("allowedValue");
-        }
+        return 0;
     }
 
-    return HStateVariableInfo(
-        name, defValue, allowedValues, evType, incReq, &m_lastErrorDescription);
+    return retVal;
+}
 }
 
-HStateVariableInfo HDocParser::parseStateVariableInfo_numeric(
-    const QString& name, const QVariant& defValue, const QDomElement& svElement,
-    HStateVariableInfo::EventingType evType, HInclusionRequirement incReq,
-    HUpnpDataTypes::DataType dataTypeEnumValue)
+bool HDocParser::setReadError(
+    const QXmlStreamReader& reader, DocumentErrorTypes type)
 {
-    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
-
-    QDomElement allowedValueRangeElement =
-        svElement.firstChildElement("allowedValueRange");
-
-    if (allowedValueRangeElement.isNull())
-    {
-        return HStateVariableInfo(
-            name, dataTypeEnumValue, defValue, evType, incReq, &m_lastErrorDescription);
-    }
+    m_lastError = type;
+    m_lastErrorDescription = QString(
+        "Failed to parse the %1 description: [%2] @ line [%3].").arg(
+            type == InvalidDeviceDescriptionError ? "device" : "service",
+            reader.errorString(),
+            QString::number(reader.lineNumber()));
+
+    return false;
+}
 
-    QString minimumStr = readElementValue("minimum", allowedValueRangeElement);
+bool HDocParser::readSpecVersion(QXmlStreamReader& reader, QString* err)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
-    if (minimumStr.isEmpty())
+    QString minorVersion, majorVersion;
+    while(reader.readNextStartElement())
     {
-        QString descr = QString(
-            "State variable [%1] is missing a mandatory <minimum> element "
-            "within <allowedValueRange>.").arg(name);
-
-        if (m_cLevel == StrictChecks)
+        if (isElement(reader, "major"))
         {
-            m_lastError = InvalidServiceDescriptionError;
-            m_lastErrorDescription = descr;
-            return HStateVariableInfo();
+            majorVersion = readText(reader);
+        }
+        else if (isElement(reader, "minor"))
+        {
+            minorVersion = readText(reader);
         }
         else
         {
-            HLOG_WARN_NONSTD(descr);
-            minimumStr = QString::number(INT_MIN);
+            reader.skipCurrentElement();
         }
     }
 
-    QString maximumStr = readElementValue("maximum", allowedValueRangeElement);
-
-    if (maximumStr.isEmpty())
+    bool ok;
+    qint32 major = majorVersion.toInt(&ok);
+    if (!ok || major != 1)
     {
-        QString descr = QString(
-            "State variable [%1] is missing a mandatory <maximum> element "
-            "within <allowedValueRange>.").arg(name);
+        if (err) { *err = "Major element of <specVersion> is not 1."; }
+        return false;
+    }
 
-        if (m_cLevel == StrictChecks)
-        {
-            m_lastError = InvalidServiceDescriptionError;
-            m_lastErrorDescription = descr;
-            return HStateVariableInfo();
-        }
-        else
-        {
-            HLOG_WARN_NONSTD(descr);
-            maximumStr = QString::number(INT_MAX);
-        }
+    qint32 minor = minorVersion.toInt(&ok);
+    if (!ok || (minor != 1 && minor != 0))
+    {
+        if (err) { *err = "Minor element of <specVersion> is not 0 or 1."; }
+        return false;
     }
 
-    QString stepStr = readElementValue("step", allowedValueRangeElement);
+    return true;
+}
+
+QList<QUrl> HDocParser::readIconList(QXmlStreamReader& reader)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    QList<QUrl> retVal;
 
-    if (stepStr.isEmpty())
+    while(reader.readNextStartElement())
     {
-        if (HUpnpDataTypes::isRational(dataTypeEnumValue))
+        if (!isElement(reader, "icon"))
         {
-            bool ok = false;
-            double maxTmp = maximumStr.toDouble(&ok);
-            if (ok && maxTmp < 1)
+            reader.skipCurrentElement();
+            continue;
+        }
+
+        QUrl iconUrl;
+        while(reader.readNextStartElement())
+        {
+            if (isElement(reader, "url"))
             {
-                stepStr = QString::number(maxTmp / 10);
+                iconUrl = readText(reader);
             }
             else
             {
-                stepStr = "1.0";
+                reader.skipCurrentElement();
             }
         }
-        else
-        {
-            stepStr = "1";
-        }
+
+        retVal.append(QUrl(iconUrl.toString()));
     }
 
-    return HStateVariableInfo(
-        name, dataTypeEnumValue, defValue, minimumStr, maximumStr, stepStr,
-        evType, incReq, &m_lastErrorDescription);
+    return retVal;
 }
 
-bool HDocParser::parseActionArguments(
-    const QDomElement& argListElement,
-    const QHash<QString, HStateVariableInfo>& stateVars,
-    QVector<HActionArgument>* inArgs,
-    QVector<HActionArgument>* outArgs,
-    bool* hasRetVal)
+bool HDocParser::readDevice(
+    QXmlStreamReader& reader, HDeviceDescriptionData* data)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+    Q_ASSERT(data);
 
-    bool firstOutArgFound  = false;
-
-    QDomElement argumentElement = argListElement.firstChildElement("argument");
-    while(!argumentElement.isNull())
-    {
-        QString name = readElementValue("name", argumentElement);
-        QString dirStr = readElementValue("direction", argumentElement);
+    QString deviceType, friendlyName, manufacturer, manufacturerURL,
+            modelDescription, modelName, modelNumber, modelUrl, serialNumber,
+            udn, upc, presentationUrl;
 
-        bool retValWasDefined = false;
-        readElementValue("retval", argumentElement, &retValWasDefined);
+    bool presentationUrlWasDefined = false;
 
-        QString relatedSvStr =
-            readElementValue("relatedStateVariable", argumentElement);
+    QList<QUrl> icons;
 
-        if (!stateVars.contains(relatedSvStr))
+    while(reader.readNextStartElement())
+    {
+        QStringRef name = reader.name();
+        if (name == QLatin1String("deviceType"))
         {
-            m_lastError = InvalidServiceDescriptionError;
-            m_lastErrorDescription = QString(
-                "Invalid action argument: the specified <relatedStateVariable> "
-                "[%1] is undefined.").arg(relatedSvStr);
-
-            return false;
+            deviceType = readText(reader);
         }
-
-        HActionArgument createdArg;
-        if (dirStr.compare("out", Qt::CaseInsensitive) == 0)
+        else if (name == QLatin1String("friendlyName"))
         {
-            if (retValWasDefined)
-            {
-                if (firstOutArgFound)
-                {
-                    m_lastError = InvalidServiceDescriptionError;
-                    m_lastErrorDescription = QString(
-                        "Invalid action argument ordering: "
-                        "[retval] MUST be the first [out] argument.");
-
-                    return false;
-                }
-
-                *hasRetVal = true;
-            }
-
-            firstOutArgFound = true;
-
-            createdArg = HActionArgument(
-                name, stateVars.value(relatedSvStr), &m_lastErrorDescription);
-
-            if (!createdArg.isValid())
+            friendlyName = readText(reader);
+        }
+        else if (name == QLatin1String("manufacturer"))
+        {
+            manufacturer = readText(reader);
+        }
+        else if (name == QLatin1String("manufacturerURL"))
+        {
+            manufacturerURL = readText(reader);
+        }
+        else if (name == QLatin1String("modelDescription"))
+        {
+            modelDescription = readText(reader);
+        }
+        else if (name == QLatin1String("modelName"))
+        {
+            modelName = readText(reader);
+        }
+        else if (name == QLatin1String("modelNumber"))
+        {
+            modelNumber = readText(reader);
+        }
+        else if (name == QLatin1String("modelURL"))
+        {
+            modelUrl = readText(reader);
+        }
+        else if (name == QLatin1String("serialNumber"))
+        {
+            serialNumber = readText(reader);
+        }
+        else if (name == QLatin1String("UDN"))
+        {
+            udn = readText(reader);
+        }
+        else if (name == QLatin1String("UPC"))
+        {
+            upc = readText(reader);
+        }
+        else if (name == QLatin1String("presentationURL"))
+        {
+            presentationUrlWasDefined = true;
+            presentationUrl = readText(reader);
+        }
+        else if (name == QLatin1String("iconList"))
+        {
+            icons = readIconList(reader);
+        }
+        else if (name == QLatin1String("serviceList"))
+        {
+            if (!readServiceList(reader, &data->m_services))
             {
-                m_lastError = InvalidServiceDescriptionError;
-                m_lastErrorDescription = QString(
-                    "Invalid action argument: %1").arg(m_lastErrorDescription);
-
                 return false;
             }
-
-            outArgs->push_back(createdArg);
         }
-        else if (dirStr.compare("in", Qt::CaseInsensitive) == 0)
+        else if (name == QLatin1String("deviceList"))
         {
-            if (firstOutArgFound)
+            while(reader.readNextStartElement())
             {
-                m_lastError = InvalidServiceDescriptionError;
-                m_lastErrorDescription =
-                    "Invalid action argument order. Input arguments MUST all come "
-                    "before output arguments.";
-
-                return false;
-            }
-
-            createdArg = HActionArgument(name, stateVars.value(relatedSvStr));
+                if (!isElement(reader, "device"))
+                {
+                    reader.skipCurrentElement();
+                    continue;
+                }
 
-            if (!createdArg.isValid())
-            {
-                m_lastError = InvalidServiceDescriptionError;
-                m_lastErrorDescription = QString(
-                    "Invalid action argument: %1").arg(m_lastErrorDescription);
+                HDeviceDescriptionData embeddedDevice;
+                if (!readDevice(reader, &embeddedDevice))
+                {
+                    return false;
+                }
 
-                return false;
+                data->m_embeddedDevices.append(embeddedDevice);
             }
-
-            inArgs->push_back(createdArg);
         }
         else
         {
-            m_lastError = InvalidServiceDescriptionError;
-            m_lastErrorDescription = QString(
-                "Invalid action argument: "
-                "invalid [direction] value: [%1].").arg(dirStr);
-
-            return false;
+            reader.skipCurrentElement();
         }
-
-        argumentElement = argumentElement.nextSiblingElement("argument");
-    }
-
-    return true;
-}
-
-QList<QUrl> HDocParser::parseIconList(const QDomElement& iconListElement)
-{
-    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
-
-    QList<QUrl> retVal;
-
-    QDomElement iconElement = iconListElement.firstChildElement("icon");
-    while(!iconElement.isNull())
-    {
-        QUrl iconUrl = readElementValue("url", iconElement);
-
-        QString iconUrlAsStr = iconUrl.toString();
-        retVal.append(QUrl(iconUrlAsStr));
-
-        iconElement = iconElement.nextSiblingElement("icon");
     }
 
-    return retVal;
-}
-
-bool HDocParser::parseRoot(
-    const QString& docStr, QDomDocument* doc, QDomElement* rootEl)
-{
-    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
-
-    Q_ASSERT(doc);
-    Q_ASSERT(rootEl);
-
-    QString errMsg; qint32 errLine = 0;
-    if (!doc->setContent(docStr, false, &errMsg, &errLine))
+    if (reader.hasError())
     {
-        m_lastError = InvalidDeviceDescriptionError;
-        m_lastErrorDescription = QString(
-            "Failed to parse the device description: [%1] @ line [%2].").arg(
-                errMsg, QString::number(errLine));
-
-        return false;
+        return setReadError(reader, InvalidDeviceDescriptionError);
     }
 
-    QDomElement rootElement = doc->firstChildElement("root");
-
-    // "urn:schemas-upnp-org:device-1-0",
-
-    if (rootElement.isNull())
+    if (presentationUrlWasDefined && presentationUrl.isEmpty())
     {
-        m_lastError = InvalidDeviceDescriptionError;
-        m_lastErrorDescription =
-            "Invalid device description: missing <root> element.";
-
-        return false;
-    }
+        QString err = "Presentation URL should be defined if the "
+                      "corresponding element is used.";
 
-    if (!verifySpecVersion(rootElement, &m_lastErrorDescription))
-    {
         if (m_cLevel == StrictChecks)
         {
             m_lastError = InvalidDeviceDescriptionError;
+            m_lastErrorDescription = err;
             return false;
         }
         else
         {
-            HLOG_WARN_NONSTD(QString(
-                "Error in device description: %1").arg(m_lastErrorDescription));
+            HLOG_WARN(QString("Non-critical error in a device description: %1").arg(err));
         }
     }
 
-    QDomElement rootDeviceElement = rootElement.firstChildElement("device");
-    if (rootDeviceElement.isNull())
+    HDeviceInfo info(
+        HResourceType(deviceType),
+        friendlyName,
+        manufacturer,
+        manufacturerURL,
+        modelDescription,
+        modelName,
+        modelNumber,
+        QUrl(modelUrl),
+        serialNumber,
+        HUdn(udn),
+        upc,
+        icons,
+        QUrl(presentationUrl),
+        m_cLevel,
+        &m_lastErrorDescription);
+
+    if (!info.isValid(m_cLevel))
     {
         m_lastError = InvalidDeviceDescriptionError;
-        m_lastErrorDescription =
-            "Invalid device description: no valid root device definition "
-            "was found.";
+        m_lastErrorDescription = QString(
+            "Invalid device description: %1").arg(m_lastErrorDescription);
 
         return false;
     }
 
-    *rootEl = rootDeviceElement;
+    data->m_info = info;
     return true;
 }
 
-qint32 HDocParser::readConfigId(const QDomElement& rootElement)
+bool HDocParser::readServiceList(
+    QXmlStreamReader& reader, QList<HServiceInfo>* retVal)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
-    bool ok = false;
-
-    QString cid = readElementValue("configId", rootElement);
-    qint32 retVal = cid.toInt(&ok);
-    if (!ok || retVal < 0 || retVal > ((1 << 24)-1))
+    while(reader.readNextStartElement())
     {
-        return 0;
-    }
+        if (!isElement(reader, "service"))
+        {
+            reader.skipCurrentElement();
+            continue;
+        }
 
-    return retVal;
-}
+        HServiceInfo info;
+        if (!readServiceInfo(reader, &info))
+        {
+            return false;
+        }
 
-bool HDocParser::parseDeviceInfo(
-    const QDomElement& deviceElement, HDeviceInfo* info)
+        retVal->append(info);
+    }
+
+    return true;
+}
+
+bool HDocParser::readServiceInfo(
+    QXmlStreamReader& reader, HServiceInfo* serviceInfo)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
-    Q_ASSERT(info);
+    Q_ASSERT(serviceInfo);
 
-    QString deviceType       =
-        readElementValue("deviceType"      , deviceElement);
+    qint64 line = reader.lineNumber();
 
-    QString friendlyName     =
-        readElementValue("friendlyName"    , deviceElement);
+    QString serviceId, serviceType, scpdUrl, controlUrl, eventSubUrl;
+    bool serviceIdWasDefined = false, serviceTypeWasDefined = false,
+         scpdUrlWasDefined = false, controlUrlWasDefined = false,
+         eventSubUrlWasDefined = false;
 
-    QString manufacturer     =
-        readElementValue("manufacturer"    , deviceElement);
+    while(reader.readNextStartElement())
+    {
+        QStringRef name = reader.name();
+        if (name == QLatin1String("serviceId"))
+        {
+            serviceIdWasDefined = true;
+            serviceId = readText(reader);
+        }
+        else if (name == QLatin1String("serviceType"))
+        {
+            serviceTypeWasDefined = true;
+            serviceType = readText(reader);
+        }
+        else if (name == QLatin1String("SCPDURL"))
+        {
+            scpdUrlWasDefined = true;
+            scpdUrl = readText(reader);
+        }
+        else if (name == QLatin1String("controlURL"))
+        {
+            controlUrlWasDefined = true;
+            controlUrl = readText(reader);
+        }
+        else if (name == QLatin1String("eventSubURL"))
+        {
+            eventSubUrlWasDefined = true;
+            eventSubUrl = readText(reader);
+        }
+        else
+        {
+            reader.skipCurrentElement();
+        }
+    }
 
-    QString manufacturerURL  =
-        readElementValue("manufacturerURL" , deviceElement);
+    if (reader.hasError())
+    {
+        return setReadError(reader, InvalidDeviceDescriptionError);
+    }
 
-    QString modelDescription =
-        readElementValue("modelDescription", deviceElement);
+    QString missingElement;
+    if (!serviceIdWasDefined)
+    {
+        missingElement = "serviceId";
+    }
+    else if (!serviceTypeWasDefined)
+    {
+        missingElement = "serviceType";
+    }
+    else if (!scpdUrlWasDefined)
+    {
+        missingElement = "SCPDURL";
+    }
+    else if (!controlUrlWasDefined)
+    {
+        missingElement = "controlURL";
+    }
+    else if (!eventSubUrlWasDefined)
+    {
+        missingElement = "eventSubURL";
+    }
 
-    QString modelName        =
-        readElementValue("modelName"       , deviceElement);
+    if (!missingElement.isEmpty())
+    {
+        m_lastError = InvalidDeviceDescriptionError;
+        m_lastErrorDescription = QString(
+            "Invalid <service> definition @ line [%1]. "
+            "Missing mandatory <%2> element.").arg(
+                QString::number(line), missingElement);
 
-    QString modelNumber      =
-        readElementValue("modelNumber"     , deviceElement);
+        return false;
+    }
 
-    QUrl    modelUrl         =
-        readElementValue("modelURL"        , deviceElement);
+    HServiceInfo tmpServiceInfo(
+        HServiceId(serviceId), HResourceType(serviceType),
+        QUrl(controlUrl), QUrl(eventSubUrl), QUrl(scpdUrl),
+        InclusionMandatory, m_cLevel, &m_lastErrorDescription);
 
-    QString serialNumber     =
-        readElementValue("serialNumber"    , deviceElement);
+    if (!tmpServiceInfo.isValid(m_cLevel))
+    {
+        m_lastError = InvalidDeviceDescriptionError;
+        m_lastErrorDescription =
+            QString("Invalid <service> definition @ line [%1]: %2").arg(
+                QString::number(line), m_lastErrorDescription);
 
-    HUdn udn(readElementValue("UDN"        , deviceElement));
+        return false;
+    }
 
-    QString upc              =
-        readElementValue("UPC"             , deviceElement);
+    *serviceInfo = tmpServiceInfo;
+    return true;
+}
 
-    QDomElement iconListElement = deviceElement.firstChildElement("iconList");
-    QList<QUrl> icons;
-    if (!iconListElement.isNull())
+bool HDocParser::readStateVariableTable(
+    QXmlStreamReader& reader, QList<HStateVariableInfo>* retVal)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    while(reader.readNextStartElement())
     {
-        icons = parseIconList(iconListElement);
+        if (!isElement(reader, "stateVariable"))
+        {
+            reader.skipCurrentElement();
+            continue;
+        }
+
+        HStateVariableInfo svInfo;
+        if (!readStateVariable(reader, &svInfo))
+        {
+            return false;
+        }
+
+        retVal->append(svInfo);
     }
 
-    bool wasDefined = false;
+    return true;
+}
 
-    QString tmp = readElementValue("presentationURL", deviceElement, &wasDefined);
+HDocParser::ValueRange HDocParser::readAllowedValueRange(
+    QXmlStreamReader& reader)
+{
+    ValueRange retVal;
+    retVal.m_wasDefined = true;
 
-    if (wasDefined && tmp.isEmpty())
+    while(reader.readNextStartElement())
     {
-        QString err = "Presentation URL should be defined if the "
-                      "corresponding element is used.";
+        if (isElement(reader, "minimum"))
+        {
+            retVal.m_minimum = readText(reader);
+        }
+        else if (isElement(reader, "maximum"))
+        {
+            retVal.m_maximum = readText(reader);
+        }
+        else if (isElement(reader, "step"))
+        {
+            retVal.m_step = readText(reader);
+        }
+        else
+        {
+            reader.skipCurrentElement();
+        }
+    }
+
+    return retVal;
+}
+
+HStateVariableInfo HDocParser::createStateVariableInfo_numeric(
+    const QString& name, const QVariant& defValue, const ValueRange& range,
+    HStateVariableInfo::EventingType evType, HInclusionRequirement incReq,
+    HUpnpDataTypes::DataType dataTypeEnumValue)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    if (!range.m_wasDefined)
+    {
+        return HStateVariableInfo(
+            name, dataTypeEnumValue, defValue, evType, incReq, &m_lastErrorDescription);
+    }
+
+    QString minimumStr = range.m_minimum;
+
+    if (minimumStr.isEmpty())
+    {
+        QString descr = QString(
+            "State variable [%1] is missing a mandatory <minimum> element "
+            "within <allowedValueRange>.").arg(name);
 
         if (m_cLevel == StrictChecks)
         {
-            m_lastError = InvalidDeviceDescriptionError;
-            m_lastErrorDescription = err;
-            return false;
+            m_lastError = InvalidServiceDescriptionError;
+            m_lastErrorDescription = descr;
+            return HStateVariableInfo();
         }
         else
         {
-            HLOG_WARN(QString("Non-critical error in a device description: %1").arg(err));
+            HLOG_WARN_NONSTD(descr);
+            minimumStr = QString::number(INT_MIN);
         }
     }
 
-    QUrl presentationUrl(tmp);
+    QString maximumStr = range.m_maximum;
 
-    *info = HDeviceInfo(
-        HResourceType(deviceType),
-        friendlyName,
-        manufacturer,
-        manufacturerURL,
-        modelDescription,
-        modelName,
-        modelNumber,
-        modelUrl,
-        serialNumber,
-        udn,
-        upc,
-        icons,
-        presentationUrl,
-        m_cLevel,
-        &m_lastErrorDescription);
+    if (maximumStr.isEmpty())
+    {
+        QString descr = QString(
+            "State variable [%1] is missing a mandatory <maximum> element "
+            "within <allowedValueRange>.").arg(name);
+
+        if (m_cLevel == StrictChecks)
+        {
+            m_lastError = InvalidServiceDescriptionError;
+            m_lastErrorDescription = descr;
+            return HStateVariableInfo();
+        }
+        else
+        {
+            HLOG_WARN_NONSTD(descr);
+            maximumStr = QString::number(INT_MAX);
+        }
+    }
+
+    QString stepStr = range.m_step;
+
+    if (stepStr.isEmpty())
+    {
+        if (HUpnpDataTypes::isRational(dataTypeEnumValue))
+        {
+            bool ok = false;
+            double maxTmp = maximumStr.toDouble(&ok);
+            if (ok && maxTmp < 1)
+            {
+                stepStr = QString::number(maxTmp / 10);
+            }
+            else
+            {
+                stepStr = "1.0";
+            }
+        }
+        else
+        {
+            stepStr = "1";
+        }
+    }
+
+    return HStateVariableInfo(
+        name, dataTypeEnumValue, defValue, minimumStr, maximumStr, stepStr,
+        evType, incReq, &m_lastErrorDescription);
+}
+
+bool HDocParser::readStateVariable(
+    QXmlStreamReader& reader, HStateVariableInfo* svInfo)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    Q_ASSERT(svInfo);
+
+    qint64 line = reader.lineNumber();
+    QXmlStreamAttributes attributes = reader.attributes();
+
+    QString strSendEvents = attributes.hasAttribute("sendEvents") ?
+        attributes.value("sendEvents").toString() : QString("no");
+
+    bool bSendEvents = false;
+    if (strSendEvents.compare("yes", Qt::CaseInsensitive) == 0)
+    {
+        bSendEvents = true;
+    }
+    else if (strSendEvents.compare("no", Qt::CaseInsensitive) != 0)
+    {
+        m_lastError = InvalidServiceDescriptionError;
+        m_lastErrorDescription = QString(
+            "Invalid <stateVariable> definition @ line [%1]: "
+            "invalid value for [sendEvents] attribute.").arg(
+                QString::number(line));
+
+        return false;
+    }
+
+    QString strMulticast = attributes.hasAttribute("multicast") ?
+        attributes.value("multicast").toString() : QString("no");
+
+    bool bMulticast = false;
+    if (strMulticast.compare("yes", Qt::CaseInsensitive) == 0)
+    {
+        bMulticast = true;
+    }
+    else if (strMulticast.compare("no", Qt::CaseInsensitive) != 0)
+    {
+        m_lastError = InvalidServiceDescriptionError;
+        m_lastErrorDescription = QString(
+            "Invalid <stateVariable> definition @ line [%1]: "
+            "invalid value for [multicast] attribute.").arg(
+                QString::number(line));
+
+        return false;
+    }
+
+    HStateVariableInfo::EventingType evType = HStateVariableInfo::NoEvents;
+    if (bSendEvents)
+    {
+        evType = bMulticast ?
+            HStateVariableInfo::UnicastAndMulticast : HStateVariableInfo::UnicastOnly;
+    }
+
+    QString name, dataType, defaultValueStr;
+    bool defValueWasDefined = false;
+
+    QStringList allowedValues;
+
+    ValueRange range;
+    range.m_wasDefined = false;
+
+    while(reader.readNextStartElement())
+    {
+        QStringRef elementName = reader.name();
+        if (elementName == QLatin1String("name"))
+        {
+            name = readText(reader);
+        }
+        else if (elementName == QLatin1String("dataType"))
+        {
+            dataType = readText(reader);
+        }
+        else if (elementName == QLatin1String("defaultValue"))
+        {
+            defValueWasDefined = true;
+            defaultValueStr = readText(reader);
+        }
+        else if (elementName == QLatin1String("allowedValueList"))
+        {
+            while(reader.readNextStartElement())
+            {
+                if (isElement(reader, "allowedValue"))
+                {
+                    allowedValues.append(readText(reader));
+                }
+                else
+                {
+                    reader.skipCurrentElement();
+                }
+            }
+        }
+        else if (elementName == QLatin1String("allowedValueRange"))
+        {
+            range = readAllowedValueRange(reader);
+        }
+        else
+        {
+            reader.skipCurrentElement();
+        }
+    }
+
+    if (reader.hasError())
+    {
+        return setReadError(reader, InvalidServiceDescriptionError);
+    }
+
+    HUpnpDataTypes::DataType dtEnumValue = HUpnpDataTypes::dataType(dataType);
+
+    QVariant defaultValue =
+        defValueWasDefined ?
+            HUpnpDataTypes::convertToRightVariantType(
+                defaultValueStr, dtEnumValue) : QVariant();
+
+    HStateVariableInfo parsedInfo;
+
+    if (dtEnumValue == HUpnpDataTypes::string)
+    {
+        parsedInfo = HStateVariableInfo(
+            name,
+            defValueWasDefined ? defaultValueStr : QVariant(),
+            allowedValues,
+            evType,
+            InclusionMandatory,
+            &m_lastErrorDescription);
+    }
+    else if (HUpnpDataTypes::isNumeric(dtEnumValue))
+    {
+        parsedInfo = createStateVariableInfo_numeric(
+            name,
+            defaultValue,
+            range,
+            evType,
+            InclusionMandatory,
+            dtEnumValue);
+    }
+    else
+    {
+        parsedInfo = HStateVariableInfo(
+            name,
+            dtEnumValue,
+            defaultValue,
+            evType,
+            InclusionMandatory,
+            &m_lastErrorDescription);
+    }
+
+    if (!parsedInfo.isValid())
+    {
+        m_lastError = InvalidServiceDescriptionError;
+        m_lastErrorDescription =
+            QString("Invalid <stateVariable> [%1] definition: %2").arg(
+                name, m_lastErrorDescription);
+
+        return false;
+    }
+
+    *svInfo = parsedInfo;
+    return true;
+}
+
+void HDocParser::readActionList(
+    QXmlStreamReader& reader, QList<ActionDefinition>* retVal)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    while(reader.readNextStartElement())
+    {
+        if (!isElement(reader, "action"))
+        {
+            reader.skipCurrentElement();
+            continue;
+        }
+
+        ActionDefinition action;
+        readAction(reader, &action);
+        retVal->append(action);
+    }
+}
+
+void HDocParser::readAction(QXmlStreamReader& reader, ActionDefinition* action)
+{
+    while(reader.readNextStartElement())
+    {
+        if (isElement(reader, "name"))
+        {
+            action->m_name = readText(reader);
+        }
+        else if (isElement(reader, "argumentList"))
+        {
+            while(reader.readNextStartElement())
+            {
+                if (!isElement(reader, "argument"))
+                {
+                    reader.skipCurrentElement();
+                    continue;
+                }
+
+                ArgumentDefinition arg;
+                arg.m_retval = false;
+
+                while(reader.readNextStartElement())
+                {
+                    QStringRef name = reader.name();
+                    if (name == QLatin1String("name"))
+                    {
+                        arg.m_name = readText(reader);
+                    }
+                    else if (name == QLatin1String("direction"))
+                    {
+                        arg.m_direction = readText(reader);
+                    }
+                    else if (name == QLatin1String("relatedStateVariable"))
+                    {
+                        arg.m_relatedStateVariable = readText(reader);
+                    }
+                    else
+                    {
+                        if (name == QLatin1String("retval"))
+                        {
+                            arg.m_retval = true;
+                        }
+                        reader.skipCurrentElement();
+                    }
+                }
+
+                action->m_arguments.append(arg);
+            }
+        }
+        else
+        {
+            reader.skipCurrentElement();
+        }
+    }
+}
+
+bool HDocParser::createActionArguments(
+    const QList<ArgumentDefinition>& arguments,
+    const QHash<QString, HStateVariableInfo>& stateVars,
+    QVector<HActionArgument>* inArgs,
+    QVector<HActionArgument>* outArgs,
+    bool* hasRetVal)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    bool firstOutArgFound  = false;
+
+    foreach(const ArgumentDefinition& arg, arguments)
+    {
+        if (!stateVars.contains(arg.m_relatedStateVariable))
+        {
+            m_lastError = InvalidServiceDescriptionError;
+            m_lastErrorDescription = QString(
+                "Invalid action argument: the specified <relatedStateVariable> "
+                "[%1] is undefined.").arg(arg.m_relatedStateVariable);
+
+            return false;
+        }
+
+        HActionArgument createdArg;
+        if (arg.m_direction.compare("out", Qt::CaseInsensitive) == 0)
+        {
+            if (arg.m_retval)
+            {
+                if (firstOutArgFound)
+                {
+                    m_lastError = InvalidServiceDescriptionError;
+                    m_lastErrorDescription = QString(
+                        "Invalid action argument ordering: "
+                        "[retval] MUST be the first [out] argument.");
+
+                    return false;
+                }
+
+                *hasRetVal = true;
+            }
+
+            firstOutArgFound = true;
+
+            createdArg = HActionArgument(
+                arg.m_name, stateVars.value(arg.m_relatedStateVariable),
+                &m_lastErrorDescription);
+
+            if (!createdArg.isValid())
+            {
+                m_lastError = InvalidServiceDescriptionError;
+                m_lastErrorDescription = QString(
+                    "Invalid action argument: %1").arg(m_lastErrorDescription);
+
+                return false;
+            }
+
+            outArgs->push_back(createdArg);
+        }
+        else if (arg.m_direction.compare("in", Qt::CaseInsensitive) == 0)
+        {
+            if (firstOutArgFound)
+            {
+                m_lastError = InvalidServiceDescriptionError;
+                m_lastErrorDescription =
+                    "Invalid action argument order. Input arguments MUST all come "
+                    "before output arguments.";
+
+                return false;
+            }
+
+            createdArg = HActionArgument(
+                arg.m_name, stateVars.value(arg.m_relatedStateVariable));
+
+            if (!createdArg.isValid())
+            {
+                m_lastError = InvalidServiceDescriptionError;
+                m_lastErrorDescription = QString(
+                    "Invalid action argument: %1").arg(m_lastErrorDescription);
+
+                return false;
+            }
 
-    if (!info->isValid(m_cLevel))
-    {
-        m_lastError = InvalidDeviceDescriptionError;
-        m_lastErrorDescription = QString(
-            "Invalid device description: %1").arg(m_lastErrorDescription);
+            inArgs->push_back(createdArg);
+        }
+        else
+        {
+            m_lastError = InvalidServiceDescriptionError;
+            m_lastErrorDescription = QString(
+                "Invalid action argument: "
+                "invalid [direction] value: [%1].").arg(arg.m_direction);
 
-        return false;
+            return false;
+        }
     }
 
     return true;
 }
 
-bool HDocParser::parseServiceInfo(
-    const QDomElement& serviceDefinition, HServiceInfo* serviceInfo)
+bool HDocParser::createActionInfo(
+    const ActionDefinition& action,
+    const QHash<QString, HStateVariableInfo>& stateVars,
+    HActionInfo* ai)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
-    Q_ASSERT(serviceInfo);
-    Q_ASSERT(!serviceDefinition.isNull());
-
-    bool wasDefined = false;
-
-    HServiceId serviceId =
-        readElementValue("serviceId", serviceDefinition, &wasDefined);
+    bool hasRetVal = false;
+    QVector<HActionArgument> inputArguments;
+    QVector<HActionArgument> outputArguments;
 
-    if (!wasDefined)
+    if (!createActionArguments(
+            action.m_arguments,
+            stateVars,
+            &inputArguments,
+            &outputArguments,
+            &hasRetVal))
     {
-        m_lastError = InvalidDeviceDescriptionError;
         m_lastErrorDescription = QString(
-            "Invalid <service> definition. "
-            "Missing mandatory <serviceId> element:\n%1").arg(
-                toString(serviceDefinition));
+            "Invalid action [%1] definition: %2").arg(
+                action.m_name, m_lastErrorDescription);
 
         return false;
     }
 
-    HResourceType resourceType =
-        readElementValue("serviceType", serviceDefinition, &wasDefined);
+    HActionArguments inArgs(inputArguments);
+    HActionArguments outArgs(outputArguments);
+
+    HActionInfo actionInfo(
+        action.m_name, inArgs, outArgs, hasRetVal, InclusionMandatory,
+        &m_lastErrorDescription);
 
-    if (!wasDefined)
+    if (!actionInfo.isValid())
     {
-        m_lastError = InvalidDeviceDescriptionError;
+        m_lastError = InvalidServiceDescriptionError;
         m_lastErrorDescription = QString(
-            "Invalid <service> definition. "
-            "Missing mandatory <serviceType> element:\n%1").arg(
-                toString(serviceDefinition));
+            "Invalid <action> [%1] definition: %2").arg(
+                action.m_name, m_lastErrorDescription);
 
         return false;
     }
 
-    QUrl scpdUrl = readElementValue("SCPDURL", serviceDefinition, &wasDefined);
-    if (!wasDefined)
-    {
-        m_lastError = InvalidDeviceDescriptionError;
-        m_lastErrorDescription = QString(
-            "Invalid <service> definition. "
-            "Missing mandatory <SCPDURL> element:\n%1").arg(
-                toString(serviceDefinition));
+    *ai = actionInfo;
+    return true;
+}
 
-        return false;
-    }
+bool HDocParser::parseDeviceDescription(
+    const QString& docStr, HDeviceDescriptionData* rootDevice, qint32* configId)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
-    QUrl controlUrl =
-        readElementValue("controlURL" , serviceDefinition, &wasDefined);
+    Q_ASSERT(rootDevice);
+    Q_ASSERT(configId);
 
-    if (!wasDefined)
+    QXmlStreamReader reader(docStr);
+    if (!reader.readNextStartElement() || !isElement(reader, "root"))
     {
+        if (reader.hasError())
+        {
+            return setReadError(reader, InvalidDeviceDescriptionError);
+        }
+
         m_lastError = InvalidDeviceDescriptionError;
-        m_lastErrorDescription = QString(
-            "Invalid <service> definition. "
-            "Missing mandatory <controlURL> element:\n%1").arg(
-                toString(serviceDefinition));
+        m_lastErrorDescription =
+            "Invalid device description: missing <root> element.";
 
         return false;
     }
 
-    QUrl eventSubUrl =
-        readElementValue("eventSubURL", serviceDefinition, &wasDefined);
+    *configId = toConfigId(reader.attributes().value("configId"));
+
+    bool specVersionOk = false, rootDeviceFound = false;
+    QString specVersionErr = "Missing mandatory <specVersion> element.";
 
-    if (!wasDefined)
+    while(reader.readNextStartElement())
     {
-        m_lastError = InvalidDeviceDescriptionError;
-        m_lastErrorDescription = QString(
-            "Invalid <service> definition. "
-            "Missing mandatory <eventSubURL> element:\n%1").arg(
-                toString(serviceDefinition));
+        if (isElement(reader, "specVersion"))
+        {
+            specVersionOk = readSpecVersion(reader, &specVersionErr);
+        }
+        else if (isElement(reader, "device") && !rootDeviceFound)
+        {
+            if (!readDevice(reader, rootDevice))
+            {
+                return false;
+            }
 
-        return false;
+            rootDeviceFound = true;
+        }
+        else
+        {
+            reader.skipCurrentElement();
+        }
     }
 
-    HServiceInfo tmpServiceInfo(
-        serviceId, resourceType, controlUrl, eventSubUrl, scpdUrl,
-        InclusionMandatory, m_cLevel, &m_lastErrorDescription);
+    if (reader.hasError())
+    {
+        return setReadError(reader, InvalidDeviceDescriptionError);
+    }
 
-    if (!tmpServiceInfo.isValid(m_cLevel))
+    if (!specVersionOk)
+    {
+        m_lastErrorDescription = specVersionErr;
+        if (m_cLevel == StrictChecks)
+        {
+            m_lastError = InvalidDeviceDescriptionError;
+            return false;
+        }
+        else
+        {
+            HLOG_WARN_NONSTD(QString(
+                "Error in device description: %1").arg(m_lastErrorDescription));
+        }
+    }
+
+    if (!rootDeviceFound)
     {
         m_lastError = InvalidDeviceDescriptionError;
         m_lastErrorDescription =
-            QString("%1:\n%2").arg(
-                m_lastErrorDescription, toString(serviceDefinition));
+            "Invalid device description: no valid root device definition "
+            "was found.";
 
         return false;
     }
 
-    *serviceInfo = tmpServiceInfo;
     return true;
 }
 
 bool HDocParser::parseServiceDescription(
-    const QString& docStr, QDomDocument* doc,
-    QDomElement* stateVarElement, QDomElement* retVal)
+    const QString& docStr, HServiceDescriptionData* retVal)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
-    Q_ASSERT(stateVarElement);
     Q_ASSERT(retVal);
 
-    qint32 errLine;
-    QString errMsg;
-    if (!doc->setContent(docStr, false, &errMsg, &errLine))
+    QXmlStreamReader reader(docStr);
+    if (!reader.readNextStartElement() || !isElement(reader, "scpd"))
     {
+        if (reader.hasError())
+        {
+            return setReadError(reader, InvalidServiceDescriptionError);
+        }
+
         m_lastError = InvalidServiceDescriptionError;
-        m_lastErrorDescription = QString(
-            "Failed to parse the service description: [%1] @ line [%2].").arg(
-                errMsg, QString::number(errLine));
+        m_lastErrorDescription =
+            "Invalid service description: missing <scpd> element.";
 
         return false;
     }
-    //QDomNodeList scpdElementNodeList =
-        //tmp.elementsByTagNameNS("urn:schemas-upnp-org:service-1-0","scpd");
 
-    QDomElement scpdElement = doc->firstChildElement("scpd");
-    if (scpdElement.isNull())
+    bool specVersionOk = false, stateTableFound = false, actionListFound = false;
+    QString specVersionErr = "Missing mandatory <specVersion> element.";
+
+    QList<HStateVariableInfo> stateVariables;
+    QList<ActionDefinition> actions;
+
+    while(reader.readNextStartElement())
     {
-        m_lastError = InvalidServiceDescriptionError;
-        m_lastErrorDescription =
-            "Invalid service description: missing <scpd> element.";
+        if (isElement(reader, "specVersion"))
+        {
+            specVersionOk = readSpecVersion(reader, &specVersionErr);
+        }
+        else if (isElement(reader, "serviceStateTable") && !stateTableFound)
+        {
+            if (!readStateVariableTable(reader, &stateVariables))
+            {
+                return false;
+            }
 
-        return false;
+            stateTableFound = true;
+        }
+        else if (isElement(reader, "actionList") && !actionListFound)
+        {
+            readActionList(reader, &actions);
+            actionListFound = true;
+        }
+        else
+        {
+            reader.skipCurrentElement();
+        }
     }
 
-    if (!verifySpecVersion(scpdElement, &m_lastErrorDescription))
+    if (reader.hasError())
     {
+        return setReadError(reader, InvalidServiceDescriptionError);
+    }
+
+    if (!specVersionOk)
+    {
+        m_lastErrorDescription = specVersionErr;
         if (m_cLevel == StrictChecks)
         {
             m_lastError = InvalidServiceDescriptionError;
@@ -606,10 +1117,7 @@ bool HDocParser::parseServiceDescription(
         }
     }
 
-    QDomElement serviceStateTableElement =
-        scpdElement.firstChildElement("serviceStateTable");
-
-    if (serviceStateTableElement.isNull())
+    if (!stateTableFound)
     {
         m_lastError = InvalidServiceDescriptionError;
         m_lastErrorDescription =
@@ -618,10 +1126,7 @@ bool HDocParser::parseServiceDescription(
         return false;
     }
 
-    QDomElement stateVariableElement =
-        serviceStateTableElement.firstChildElement("stateVariable");
-
-    if (stateVariableElement.isNull())
+    if (stateVariables.isEmpty())
     {
         QString err = "Service description document does not have a "
                       "single <stateVariable> element. "
@@ -639,14 +1144,7 @@ bool HDocParser::parseServiceDescription(
         }
     }
 
-    QDomElement actionListElement = scpdElement.firstChildElement("actionList");
-    if (actionListElement.isNull())
-    {
-        return true;
-    }
-
-    QDomElement actionElement = actionListElement.firstChildElement("action");
-    if (actionElement.isNull())
+    if (actionListFound && actions.isEmpty())
     {
         QString err = "Service description document has <actionList> "
                       "element that has no <action> elements.";
@@ -663,200 +1161,26 @@ bool HDocParser::parseServiceDescription(
         }
     }
 
-    *stateVarElement = stateVariableElement;
-    *retVal = actionElement;
-    return true;
-}
-
-bool HDocParser::parseStateVariable(
-    const QDomElement& stateVariableElement, HStateVariableInfo* svInfo)
-{
-    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
-
-    Q_ASSERT(svInfo);
-
-    QString strSendEvents = stateVariableElement.attribute("sendEvents", "no");
-    bool bSendEvents      = false;
-    if (strSendEvents.compare("yes", Qt::CaseInsensitive) == 0)
-    {
-        bSendEvents = true;
-    }
-    else if (strSendEvents.compare("no", Qt::CaseInsensitive) != 0)
-    {
-        m_lastError = InvalidServiceDescriptionError;
-        m_lastErrorDescription = QString(
-            "Invalid <stateVariable> definition: "
-            "invalid value for [sendEvents] attribute:\n%1.").arg(
-                toString(stateVariableElement));
-
-        return false;
-    }
-
-    QString strMulticast  = stateVariableElement.attribute("multicast", "no");
-    bool bMulticast       = false;
-    if (strMulticast.compare("yes", Qt::CaseInsensitive) == 0)
-    {
-        bMulticast = true;
-    }
-    else if (strMulticast.compare("no", Qt::CaseInsensitive) != 0)
-    {
-        m_lastError = InvalidServiceDescriptionError;
-        m_lastErrorDescription = QString(
-            "Invalid <stateVariable> definition: "
-            "invalid value for [multicast]: %1.").arg(
-                toString(stateVariableElement));
-
-        return false;
-    }
-
-    HStateVariableInfo::EventingType evType = HStateVariableInfo::NoEvents;
-    if (bSendEvents)
-    {
-        evType = bMulticast ?
-            HStateVariableInfo::UnicastAndMulticast : HStateVariableInfo::UnicastOnly;
-    }
-
-    QString name = readElementValue("name", stateVariableElement);
-    QString dataType = readElementValue("dataType", stateVariableElement);
-
-    HUpnpDataTypes::DataType dtEnumValue = HUpnpDataTypes::dataType(dataType);
-
-    bool defValueWasDefined = false;
-    QString defaultValueStr = readElementValue(
-        "defaultValue", stateVariableElement, &defValueWasDefined);
-
-    QVariant defaultValue =
-        defValueWasDefined ?
-            HUpnpDataTypes::convertToRightVariantType(
-                defaultValueStr, dtEnumValue) : QVariant();
-
-    HStateVariableInfo parsedInfo;
-
-    if (dtEnumValue == HUpnpDataTypes::string)
-    {
-        parsedInfo = parseStateVariableInfo_str(
-            name,
-            defValueWasDefined ? defaultValueStr : QVariant(),
-            stateVariableElement,
-            evType,
-            InclusionMandatory);
-    }
-    else if (HUpnpDataTypes::isNumeric(dtEnumValue))
-    {
-        parsedInfo = parseStateVariableInfo_numeric(
-            name,
-            defaultValue,
-            stateVariableElement,
-            evType,
-            InclusionMandatory,
-            dtEnumValue);
-    }
-    else
-    {
-        parsedInfo = HStateVariableInfo(
-            name,
-            dtEnumValue,
-            defaultValue,
-            evType,
-            InclusionMandatory,
-            &m_lastErrorDescription);
-    }
-
-    if (!parsedInfo.isValid())
+    HStateVariableInfos svInfos;
+    foreach(const HStateVariableInfo& svInfo, stateVariables)
     {
-        m_lastError = InvalidServiceDescriptionError;
-        m_lastErrorDescription =
-            QString("Invalid <stateVariable> [%1] definition: %2").arg(
-                name, m_lastErrorDescription);
-
-        return false;
+        svInfos.insert(svInfo.name(), svInfo);
     }
 
-    *svInfo = parsedInfo;
-    return true;
-}
-
-bool HDocParser::parseActionInfo(
-    const QDomElement& actionElement,
-    const QHash<QString, HStateVariableInfo>& stateVars,
-    HActionInfo* ai)
-{
-    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
-
-    QString name = readElementValue("name", actionElement);
-
-    bool hasRetVal = false;
-    QVector<HActionArgument> inputArguments;
-    QVector<HActionArgument> outputArguments;
-
-    QDomElement argumentListElement =
-        actionElement.firstChildElement("argumentList");
-
-    if (!argumentListElement.isNull())
+    QList<HActionInfo> actionInfos;
+    foreach(const ActionDefinition& action, actions)
     {
-        if (!parseActionArguments(
-                argumentListElement,
-                stateVars,
-                &inputArguments,
-                &outputArguments,
-                &hasRetVal))
+        HActionInfo actionInfo;
+        if (!createActionInfo(action, svInfos, &actionInfo))
         {
-            m_lastErrorDescription = QString(
-                "Invalid action [%1] definition: %2").arg(
-                    name, m_lastErrorDescription);
-
             return false;
         }
-    }
-
-    HActionArguments inArgs(inputArguments);
-    HActionArguments outArgs(outputArguments);
-
-    HActionInfo actionInfo(
-        name, inArgs, outArgs, hasRetVal, InclusionMandatory, &m_lastErrorDescription);
-
-    if (!actionInfo.isValid())
-    {
-        m_lastError = InvalidServiceDescriptionError;
-        m_lastErrorDescription = QString(
-            "Invalid <action> [%1] definition: %2").arg(
-                name, m_lastErrorDescription);
-
-        return false;
-    }
-
-    *ai = actionInfo;
-    return true;
-}
-
-bool HDocParser::verifySpecVersion(const QDomElement& rootElement, QString* err)
-{
-    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
-
-    QDomElement specVersionElement = rootElement.firstChildElement("specVersion");
-    if (specVersionElement.isNull())
-    {
-        if (err) { *err = "Missing mandatory <specVersion> element."; }
-        return false;
-    }
-
-    QString minorVersion = readElementValue("minor", specVersionElement);
-    QString majorVersion = readElementValue("major", specVersionElement);
 
-    bool ok;
-    qint32 major = majorVersion.toInt(&ok);
-    if (!ok || major != 1)
-    {
-        if (err) { *err = "Major element of <specVersion> is not 1."; }
-        return false;
+        actionInfos.append(actionInfo);
     }
 
-    qint32 minor = minorVersion.toInt(&ok);
-    if (!ok || (minor != 1 && minor != 0))
-    {
-        if (err) { *err = "Minor element of <specVersion> is not 0 or 1."; }
-        return false;
-    }
+    retVal->m_stateVariables = stateVariables;
+    retVal->m_actions = actionInfos;
 
     return true;
 }
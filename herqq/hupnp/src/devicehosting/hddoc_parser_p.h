@@ -35,6 +35,7 @@
 #include "../general/hupnp_global.h"
 #include "../dataelements/hserviceid.h"
 #include "../dataelements/hactioninfo.h"
+#include "../dataelements/hdeviceinfo.h"
 #include "../dataelements/hserviceinfo.h"
 #include "../dataelements/hstatevariableinfo.h"
 
@@ -46,8 +47,7 @@
 #include <QtCore/QList>
 #include <QtCore/QString>
 
-class QDomElement;
-class QDomDocument;
+class QXmlStreamReader;
 
 namespace Herqq
 {
@@ -66,7 +66,34 @@ enum DocumentErrorTypes
 };
 
 //
-// The class that creates the HUPnP's device model from description files
+// The contents of a single <device> element of a device description.
+//
+class HDeviceDescriptionData
+{
+public:
+
+    HDeviceInfo m_info;
+    QList<HServiceInfo> m_services;
+    QList<HDeviceDescriptionData> m_embeddedDevices;
+};
+
+//
+// The contents of a service description.
+//
+class HServiceDescriptionData
+{
+public:
+
+    QList<HStateVariableInfo> m_stateVariables;
+    QList<HActionInfo> m_actions;
+};
+
+//
+// The class that reads device and service descriptions into the data elements
+// used to build the HUPnP's device model.
+//
+// The documents are read in a single pass using QXmlStreamReader. No DOM
+// tree is built.
 //
 class HDocParser
 {
@@ -74,31 +101,72 @@ H_DISABLE_COPY(HDocParser)
 
 private:
 
-    QList<QUrl> parseIconList(
-        const QDomElement& iconListElement);
+    // An <argument> as it appears in the service description. The arguments
+    // can be resolved only once the state variables are known, and the
+    // <actionList> usually precedes the <serviceStateTable>.
+    struct ArgumentDefinition
+    {
+        QString m_name;
+        QString m_direction;
+        QString m_relatedStateVariable;
+        bool m_retval;
+    };
+
+    struct ActionDefinition
+    {
+        QString m_name;
+        QList<ArgumentDefinition> m_arguments;
+    };
+
+    // The contents of an <allowedValueRange> element.
+    struct ValueRange
+    {
+        QString m_minimum;
+        QString m_maximum;
+        QString m_step;
+        bool m_wasDefined;
+    };
+
+    bool readSpecVersion(QXmlStreamReader&, QString* err);
+
+    QList<QUrl> readIconList(QXmlStreamReader&);
+
+    bool readDevice(QXmlStreamReader&, HDeviceDescriptionData*);
+    bool readServiceList(QXmlStreamReader&, QList<HServiceInfo>*);
+    bool readServiceInfo(QXmlStreamReader&, HServiceInfo*);
+
+    bool readStateVariableTable(
+        QXmlStreamReader&, QList<HStateVariableInfo>*);
 
-    bool parseActionArguments(
-        const QDomElement& argListElement,
+    bool readStateVariable(QXmlStreamReader&, HStateVariableInfo*);
+
+    ValueRange readAllowedValueRange(QXmlStreamReader&);
+
+    void readActionList(QXmlStreamReader&, QList<ActionDefinition>*);
+    void readAction(QXmlStreamReader&, ActionDefinition*);
+
+    bool createActionArguments(
+        const QList<ArgumentDefinition>&,
         const QHash<QString, HStateVariableInfo>&,
         QVector<HActionArgument>* inArgs,
         QVector<HActionArgument>* outArgs,
         bool* hasRetVal);
 
-    HStateVariableInfo parseStateVariableInfo_str(
-        const QString& name,
-        const QVariant& defValue,
-        const QDomElement& svElement,
-        HStateVariableInfo::EventingType,
-        HInclusionRequirement);
+    bool createActionInfo(
+        const ActionDefinition&,
+        const QHash<QString, HStateVariableInfo>&,
+        HActionInfo*);
 
-    HStateVariableInfo parseStateVariableInfo_numeric(
+    HStateVariableInfo createStateVariableInfo_numeric(
         const QString& name,
         const QVariant& defValue,
-        const QDomElement& svElement,
+        const ValueRange&,
         HStateVariableInfo::EventingType,
         HInclusionRequirement,
         HUpnpDataTypes::DataType dataTypeEnumValue);
 
+    bool setReadError(const QXmlStreamReader&, DocumentErrorTypes);
+
 private:
 
     const QByteArray m_loggingIdentifier;
@@ -113,27 +181,11 @@ public:
     inline QString lastErrorDescription() const { return m_lastErrorDescription; }
     inline DocumentErrorTypes lastError() const { return m_lastError; }
 
-    bool parseRoot(const QString& doc, QDomDocument*, QDomElement*);
-    qint32 readConfigId(const QDomElement&);
-    bool parseDeviceInfo(const QDomElement&, HDeviceInfo*);
-    bool parseServiceInfo(const QDomElement& serviceDefinition, HServiceInfo*);
+    bool parseDeviceDescription(
+        const QString& docStr, HDeviceDescriptionData*, qint32* configId);
 
     bool parseServiceDescription(
-        const QString& docStr,
-        QDomDocument* doc,
-        QDomElement* stateVarElement,
-        QDomElement* actionElement);
-
-    bool parseStateVariable(
-        const QDomElement& stateVariableElement,
-        HStateVariableInfo*);
-
-    bool parseActionInfo(
-        const QDomElement& actionElement,
-        const QHash<QString, HStateVariableInfo>&,
-        HActionInfo*);
-
-    bool verifySpecVersion(const QDomElement&, QString* err = 0);
+        const QString& docStr, HServiceDescriptionData*);
 };
 
 //
@@ -32,6 +32,7 @@
 
 #include "../general/hupnp_global_p.h"
 #include "../general/hlogger_p.h"
+#include "../utils/hmisc_utils_p.h"
 
 #include <HUpnpCore/HUdn>
 #include <HUpnpCore/HEndpoint>
@@ -39,6 +40,7 @@
 #include <HUpnpCore/HResourceType>
 
 #include <QtCore/QUrl>
+#include <QtCore/QHash>
 #include <QtCore/QList>
 #include <QtCore/QString>
 #include <QtCore/QByteArray>
@@ -339,12 +341,66 @@ private:
 
     QList<QPair<Device*, Controller*> > m_deviceControllers;
 
+    QHash<HUuidKey, Device*> m_devicesByUdn;
+    // every root and embedded device stored by this instance, keyed by
+    // the binary UUID of the UDN. only the root
+    // devices are required to have unique UDNs, and in case an embedded device
+    // shares its UDN with another device, the one found first in the device
+    // trees is stored here.
+
     QString m_lastError;
 
+private: // instance methods
+
+    void index(Device* device)
+    {
+        HUuidKey key(device->info().udn().toSimpleUuid());
+        if (!m_devicesByUdn.contains(key))
+        {
+            m_devicesByUdn.insert(key, device);
+        }
+
+        QList<Device*> devices = device->embeddedDevices();
+        foreach(Device* embeddedDevice, devices)
+        {
+            index(embeddedDevice);
+        }
+    }
+
+    // has to be called after the root device of the specified device has been
+    // removed from m_rootDevices
+    void unindex(Device* device)
+    {
+        HUdn udn = device->info().udn();
+        HUuidKey key(udn.toSimpleUuid());
+        if (m_devicesByUdn.value(key) == device)
+        {
+            m_devicesByUdn.remove(key);
+
+            QList<Device*> devices;
+            seekDevices(
+                m_rootDevices,
+                MatchFunctor<Device, UdnTester<Device> >(udn),
+                devices,
+                AllDevices);
+
+            if (!devices.isEmpty())
+            {
+                m_devicesByUdn.insert(key, devices.first());
+            }
+        }
+
+        QList<Device*> devices = device->embeddedDevices();
+        foreach(Device* embeddedDevice, devices)
+        {
+            unindex(embeddedDevice);
+        }
+    }
+
 public: // instance methods
 
     HDeviceStorage(const QByteArray& lid) :
-        m_loggingIdentifier(lid), m_rootDevices()
+        m_loggingIdentifier(lid), m_rootDevices(), m_devicesByUdn()
     {
     }
 
@@ -362,6 +418,7 @@ public: // instance methods
     {
         qDeleteAll(m_rootDevices);
         m_rootDevices.clear();
+        m_devicesByUdn.clear();
         for(int i = 0; i < m_deviceControllers.size(); ++i)
         {
             delete m_deviceControllers.at(i).second;
@@ -385,15 +442,20 @@ public: // instance methods
 
     Device* searchDeviceByUdn(const HUdn& udn, TargetDeviceType dts) const
     {
-        QList<Device*> devices;
+        if (dts == RootDevices)
+        {
+            foreach(Device* device, m_rootDevices)
+            {
+                if (device->info().udn() == udn)
+                {
+                    return device;
+                }
+            }
 
-        seekDevices(
-            m_rootDevices,
-            MatchFunctor<Device, UdnTester<Device> >(udn),
-            devices,
-            dts);
+            return 0;
+        }
 
-        return devices.size() > 0 ? devices[0] : 0;
+        return m_devicesByUdn.value(HUuidKey(udn.toSimpleUuid()));
     }
 
     bool searchValidLocation(
@@ -491,6 +553,7 @@ public: // instance methods
 
         m_rootDevices.push_back(root);
         m_deviceControllers.append(qMakePair(root, controller));
+        index(root);
 
         HLOG_DBG(QString("New root device [%1] added. Current device count is %2").arg(
             root->info().friendlyName(), QString::number(m_rootDevices.size())));
@@ -516,6 +579,8 @@ public: // instance methods
             return false;
         }
 
+        unindex(root);
+
         bool found = false;
         for(int i = 0; i < m_deviceControllers.size(); ++i)
         {
@@ -417,5 +417,111 @@ HNotifyRequest::RetVal HNotifyRequest::setContents(
     return Success;
 }
 
+/*******************************************************************************
+ * HMulticastNotifyRequest
+ *******************************************************************************/
+HMulticastNotifyRequest::HMulticastNotifyRequest() :
+    m_usn(), m_serviceId(), m_seq(0), m_level(), m_bootId(-1),
+    m_dataAsVariables(), m_data()
+{
+}
+
+HMulticastNotifyRequest::HMulticastNotifyRequest(
+    const HDiscoveryType& usn, const HServiceId& serviceId,
+    quint32 seq, const QString& level, qint32 bootId,
+    const QByteArray& contents) :
+        m_usn(), m_serviceId(), m_seq(0), m_level(), m_bootId(-1),
+        m_dataAsVariables(), m_data()
+{
+    HLOG(H_AT, H_FUN);
+
+    if (usn.type() != HDiscoveryType::SpecificServiceWithType ||
+        !serviceId.isValid(LooseChecks) || level.isEmpty() ||
+        contents.isEmpty())
+    {
+        return;
+    }
+
+    if (parseData(contents, m_dataAsVariables) != HNotifyRequest::Success)
+    {
+        return;
+    }
+
+    m_usn       = usn;
+    m_serviceId = serviceId;
+    m_seq       = seq;
+    m_level     = level;
+    m_bootId    = bootId;
+    m_data      = contents;
+}
+
+HMulticastNotifyRequest::~HMulticastNotifyRequest()
+{
+}
+
+QHostAddress HMulticastNotifyRequest::multicastAddress()
+{
+    static QHostAddress retVal("239.255.255.246");
+    return retVal;
+}
+
+HMulticastNotifyRequest::RetVal HMulticastNotifyRequest::setContents(
+    const QString& nt, const QString& nts, const QString& usn,
+    const QString& svcId, const QString& seq, const QString& level,
+    const QString& bootId, const QByteArray& contents)
+{
+    HLOG(H_AT, H_FUN);
+
+    HNt tmpNt(nt, nts);
+    if (tmpNt.type   () != HNt::Type_UpnpEvent ||
+        tmpNt.subType() != HNt::SubType_UpnpPropChange)
+    {
+        return PreConditionFailed;
+    }
+
+    HMulticastNotifyRequest tmp;
+
+    tmp.m_usn = HDiscoveryType(usn.trimmed(), LooseChecks);
+    if (tmp.m_usn.type() != HDiscoveryType::SpecificServiceWithType)
+    {
+        return BadRequest;
+    }
+
+    tmp.m_serviceId = HServiceId(svcId.trimmed());
+    if (!tmp.m_serviceId.isValid(LooseChecks))
+    {
+        return BadRequest;
+    }
+
+    bool ok = false;
+    tmp.m_seq = seq.trimmed().toUInt(&ok);
+    if (!ok)
+    {
+        return InvalidSequenceNr;
+    }
+
+    tmp.m_level = level.trimmed();
+
+    if (!bootId.isEmpty())
+    {
+        tmp.m_bootId = bootId.trimmed().toInt(&ok);
+        if (!ok || tmp.m_bootId < 0)
+        {
+            return BadRequest;
+        }
+    }
+
+    tmp.m_data = contents;
+
+    HNotifyRequest::RetVal rv = parseData(tmp.m_data, tmp.m_dataAsVariables);
+    if (rv != HNotifyRequest::Success)
+    {
+        return InvalidContents;
+    }
+
+    *this = tmp;
+    return Success;
+}
+
 }
 }
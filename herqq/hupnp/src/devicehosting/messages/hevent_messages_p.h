@@ -34,7 +34,9 @@
 #include "hsid_p.h"
 #include "htimeout_p.h"
 
+#include <HUpnpCore/HServiceId>
 #include <HUpnpCore/HProductTokens>
+#include <HUpnpCore/HDiscoveryType>
 
 #include <QtCore/QUrl>
 #include <QtCore/QList>
@@ -43,6 +45,7 @@
 #include <QtCore/QByteArray>
 
 class QString;
+class QHostAddress;
 
 namespace Herqq
 {
@@ -299,6 +302,77 @@ public:
     inline Variables  variables() const { return m_dataAsVariables; }
 };
 
+//
+// Class that represents the multicast event message specified in UDA v1.1.
+// The message is sent over UDP to 239.255.255.246:7900 and it is not bound
+// to any subscription.
+//
+class HMulticastNotifyRequest
+{
+public:
+
+    enum RetVal
+    {
+        Success = 0,
+        PreConditionFailed = -1,
+        InvalidContents = -2,
+        InvalidSequenceNr = -3,
+        BadRequest = -4
+    };
+
+    typedef HNotifyRequest::Variables Variables;
+
+private:
+
+    HDiscoveryType m_usn;
+    HServiceId m_serviceId;
+    quint32    m_seq;
+    QString    m_level;
+    qint32     m_bootId;
+    Variables  m_dataAsVariables;
+    QByteArray m_data;
+
+public:
+
+    HMulticastNotifyRequest();
+
+    HMulticastNotifyRequest(
+        const HDiscoveryType& usn, const HServiceId& serviceId,
+        quint32 seq, const QString& level, qint32 bootId,
+        const QByteArray& contents);
+
+    ~HMulticastNotifyRequest();
+
+    // the group and port to which the multicast events are sent
+    static QHostAddress multicastAddress();
+    inline static quint16 multicastPort() { return 7900; }
+
+    RetVal setContents(
+        const QString& nt, const QString& nts, const QString& usn,
+        const QString& svcId, const QString& seq, const QString& level,
+        const QString& bootId, const QByteArray& contents);
+
+    inline bool isValid(bool strict) const
+    {
+        return m_serviceId.isValid(strict ? StrictChecks : LooseChecks);
+        // if this is defined then everything else is defined as well
+    }
+
+    inline HNt nt() const
+    {
+        return HNt(HNt::Type_UpnpEvent, HNt::SubType_UpnpPropChange);
+    }
+
+    inline const HDiscoveryType& usn() const { return m_usn; }
+    inline const HServiceId& serviceId() const { return m_serviceId; }
+
+    inline quint32    seq      () const { return m_seq            ; }
+    inline QString    level    () const { return m_level          ; }
+    inline qint32     bootId   () const { return m_bootId         ; }
+    inline QByteArray data     () const { return m_data           ; }
+    inline Variables  variables() const { return m_dataAsVariables; }
+};
+
 }
 }
 
@@ -30,27 +30,30 @@ namespace Upnp
 {
 
 HSid::HSid() :
-    m_value(), m_valueAsStr()
+    m_value(), m_valueAsStr(), m_hash(0)
 {
 }
 
 HSid::HSid(const QUuid& sid) :
     m_value(sid), m_valueAsStr(
-        QString("uuid:%1").arg(sid.toString().remove('{').remove('}')))
+        QString("uuid:%1").arg(sid.toString().remove('{').remove('}'))),
+    m_hash(0)
 {
+    initHash();
 }
 
 HSid::HSid(const HSid& other) :
-    m_value(), m_valueAsStr()
+    m_value(), m_valueAsStr(), m_hash(0)
 {
     Q_ASSERT(&other != this);
 
     m_value = other.m_value;
     m_valueAsStr = other.m_valueAsStr;
+    m_hash = other.m_hash;
 }
 
 HSid::HSid(const QString& sid) :
-    m_value(), m_valueAsStr()
+    m_value(), m_valueAsStr(), m_hash(0)
 {
     QString tmp(sid.simplified());
     if (tmp.isEmpty())
@@ -69,18 +72,34 @@ HSid::HSid(const QString& sid) :
         m_value = QUuid(tmp);
         m_valueAsStr = QString("uuid:%1").arg(tmp);
     }
+
+    initHash();
 }
 
 HSid::~HSid()
 {
 }
 
+void HSid::initHash()
+{
+    if (!m_value.isNull())
+    {
+        m_hash = hash(m_value);
+    }
+    else
+    {
+        QByteArray data = m_valueAsStr.toLocal8Bit();
+        m_hash = hash(data.constData(), data.size());
+    }
+}
+
 HSid& HSid::operator=(const HSid& other)
 {
     Q_ASSERT(&other != this);
 
     m_value = other.m_value;
     m_valueAsStr = other.m_valueAsStr;
+    m_hash = other.m_hash;
     return *this;
 }
 
@@ -100,13 +119,23 @@ HSid& HSid::operator=(const QUuid& other)
 
 bool operator==(const HSid& sid1, const HSid& sid2)
 {
+    if (sid1.m_hash != sid2.m_hash)
+    {
+        return false;
+    }
+    else if (!sid1.m_value.isNull() || !sid2.m_value.isNull())
+    {
+        // SIDs carrying a UUID are compared in binary form. only the SIDs of
+        // the software that does not use UUIDs are compared as strings.
+        return sid1.m_value == sid2.m_value;
+    }
+
     return sid1.m_valueAsStr == sid2.m_valueAsStr;
 }
 
 quint32 qHash(const HSid& key)
 {
-    QByteArray data = key.toString().toLocal8Bit();
-    return hash(data.constData(), data.size());
+    return key.m_hash;
 }
 
 }
@@ -54,6 +54,12 @@ private:
     QUuid m_value;
     QString m_valueAsStr;
 
+    quint32 m_hash;
+    // computed from the UUID when the SID is valid and otherwise from
+    // the string form of the SID
+
+    void initHash();
+
 public:
 
     HSid();
@@ -0,0 +1,390 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hclientactiongroup.h"
+#include "hclientactiongroup_p.h"
+
+#include "../../general/hupnp_global_p.h"
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+/*******************************************************************************
+ * HClientActionGroupPrivate
+ ******************************************************************************/
+HClientActionGroupPrivate::HClientActionGroupPrivate() :
+    q_ptr(0),
+    m_invocations(),
+    m_inFlight(),
+    m_actionRefs(),
+    m_nextToStart(0),
+    m_completedCount(0),
+    m_maxConcurrent(16),
+    m_timeout(-1),
+    m_running(false),
+    m_timer()
+{
+    m_timer.setSingleShot(true);
+}
+
+HClientActionGroupPrivate::~HClientActionGroupPrivate()
+{
+}
+
+void HClientActionGroupPrivate::startNext()
+{
+    while(m_running && m_inFlight.size() < m_maxConcurrent &&
+          m_nextToStart < m_invocations.size())
+    {
+        qint32 index = m_nextToStart++;
+        HGroupInvocation& inv = m_invocations[index];
+
+        if (!inv.m_action)
+        {
+            complete(index, HClientActionOp(
+                UpnpUndefinedFailure, "The action has been deleted"));
+
+            continue;
+        }
+
+        HClientActionOp op = inv.m_action->beginInvoke(inv.m_inArgs);
+        if (op.returnValue() != UpnpInvocationInProgress)
+        {
+            // The invocation could not be dispatched
+            complete(index, op);
+            continue;
+        }
+
+        inv.m_op = op;
+        m_inFlight.insert(op.id(), index);
+    }
+}
+
+void HClientActionGroupPrivate::complete(qint32 index, const HClientActionOp& op)
+{
+    HGroupInvocation& inv = m_invocations[index];
+    Q_ASSERT(!inv.m_done);
+
+    inv.m_op = op;
+    inv.m_done = true;
+    ++m_completedCount;
+}
+
+void HClientActionGroupPrivate::abortRemaining(const QString& reason)
+{
+    // The running invocations are removed from the bookkeeping before they are
+    // aborted, since HClientAction reports an aborted invocation synchronously.
+    QHash<unsigned int, qint32> inFlight = m_inFlight;
+    m_inFlight.clear();
+
+    QHash<unsigned int, qint32>::const_iterator ci = inFlight.constBegin();
+    for(; ci != inFlight.constEnd(); ++ci)
+    {
+        HClientActionOp op = m_invocations[ci.value()].m_op;
+        op.setReturnValue(UpnpInvocationAborted);
+        op.setErrorDescription(reason);
+        complete(ci.value(), op);
+        op.abort();
+    }
+
+    for(; m_nextToStart < m_invocations.size(); ++m_nextToStart)
+    {
+        HClientActionOp op = m_invocations[m_nextToStart].m_op;
+        op.setReturnValue(UpnpInvocationAborted);
+        op.setErrorDescription(reason);
+        complete(m_nextToStart, op);
+    }
+}
+
+void HClientActionGroupPrivate::finish()
+{
+    Q_ASSERT(m_running);
+    Q_ASSERT(m_inFlight.isEmpty());
+
+    m_running = false;
+    m_timer.stop();
+
+    H_Q(HClientActionGroup);
+    emit q->invokeComplete(q);
+}
+
+/*******************************************************************************
+ * HClientActionGroup
+ ******************************************************************************/
+HClientActionGroup::HClientActionGroup(QObject* parent) :
+    QObject(parent),
+        h_ptr(new HClientActionGroupPrivate())
+{
+    h_ptr->q_ptr = this;
+
+    bool ok = connect(&h_ptr->m_timer, SIGNAL(timeout()), this, SLOT(timeout()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+}
+
+HClientActionGroup::~HClientActionGroup()
+{
+    if (h_ptr->m_running)
+    {
+        h_ptr->abortRemaining("The action group was deleted");
+    }
+
+    delete h_ptr;
+}
+
+void HClientActionGroup::invocationDone(
+    HClientAction*, const HClientActionOp& op)
+{
+    if (!h_ptr->m_inFlight.contains(op.id()))
+    {
+        // Not an invocation of this group
+        return;
+    }
+
+    h_ptr->complete(h_ptr->m_inFlight.take(op.id()), op);
+    h_ptr->startNext();
+
+    if (h_ptr->m_running && h_ptr->m_completedCount == h_ptr->m_invocations.size())
+    {
+        h_ptr->finish();
+    }
+}
+
+void HClientActionGroup::actionDestroyed(QObject* obj)
+{
+    h_ptr->m_actionRefs.remove(static_cast<HClientAction*>(obj));
+
+    if (!h_ptr->m_running)
+    {
+        return;
+    }
+
+    // The guarded pointers are cleared by the time the destroyed() signal
+    // is emitted, which identifies the invocations of the deleted action.
+    QHash<unsigned int, qint32>::iterator it = h_ptr->m_inFlight.begin();
+    while(it != h_ptr->m_inFlight.end())
+    {
+        qint32 index = it.value();
+        if (!h_ptr->m_invocations[index].m_action)
+        {
+            it = h_ptr->m_inFlight.erase(it);
+            h_ptr->complete(index, HClientActionOp(
+                UpnpUndefinedFailure, "The action has been deleted"));
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    h_ptr->startNext();
+
+    if (h_ptr->m_running && h_ptr->m_completedCount == h_ptr->m_invocations.size())
+    {
+        h_ptr->finish();
+    }
+}
+
+void HClientActionGroup::timeout()
+{
+    if (!h_ptr->m_running)
+    {
+        return;
+    }
+
+    h_ptr->abortRemaining("The invocations did not complete in time");
+    h_ptr->finish();
+}
+
+qint32 HClientActionGroup::add(
+    HClientAction* action, const HActionArguments& inArgs)
+{
+    if (!action || h_ptr->m_running)
+    {
+        return -1;
+    }
+
+    if (!h_ptr->m_actionRefs.contains(action))
+    {
+        bool ok = connect(
+            action,
+            SIGNAL(invokeComplete(
+                Herqq::Upnp::HClientAction*, Herqq::Upnp::HClientActionOp)),
+            this,
+            SLOT(invocationDone(
+                Herqq::Upnp::HClientAction*, Herqq::Upnp::HClientActionOp)));
+        Q_ASSERT(ok); Q_UNUSED(ok)
+
+        ok = connect(
+            action, SIGNAL(destroyed(QObject*)),
+            this, SLOT(actionDestroyed(QObject*)));
+        Q_ASSERT(ok);
+    }
+
+    ++h_ptr->m_actionRefs[action];
+    h_ptr->m_invocations.append(HGroupInvocation(action, inArgs));
+
+    return h_ptr->m_invocations.size() - 1;
+}
+
+void HClientActionGroup::clear()
+{
+    if (h_ptr->m_running)
+    {
+        return;
+    }
+
+    foreach(HClientAction* action, h_ptr->m_actionRefs.keys())
+    {
+        action->disconnect(this);
+    }
+
+    h_ptr->m_actionRefs.clear();
+    h_ptr->m_invocations.clear();
+    h_ptr->m_nextToStart = 0;
+    h_ptr->m_completedCount = 0;
+}
+
+qint32 HClientActionGroup::size() const
+{
+    return h_ptr->m_invocations.size();
+}
+
+void HClientActionGroup::setMaxConcurrentInvocations(qint32 count)
+{
+    h_ptr->m_maxConcurrent = qMax(1, count);
+}
+
+qint32 HClientActionGroup::maxConcurrentInvocations() const
+{
+    return h_ptr->m_maxConcurrent;
+}
+
+void HClientActionGroup::setTimeout(qint32 msecs)
+{
+    h_ptr->m_timeout = msecs;
+}
+
+qint32 HClientActionGroup::timeout() const
+{
+    return h_ptr->m_timeout;
+}
+
+bool HClientActionGroup::beginInvoke()
+{
+    if (h_ptr->m_running || h_ptr->m_invocations.isEmpty())
+    {
+        return false;
+    }
+
+    QList<HGroupInvocation>::iterator it = h_ptr->m_invocations.begin();
+    for(; it != h_ptr->m_invocations.end(); ++it)
+    {
+        it->m_op = HClientActionOp(it->m_inArgs);
+        it->m_op.setReturnValue(UpnpInvocationInProgress);
+        it->m_done = false;
+    }
+
+    h_ptr->m_nextToStart = 0;
+    h_ptr->m_completedCount = 0;
+    h_ptr->m_running = true;
+
+    if (h_ptr->m_timeout >= 0)
+    {
+        h_ptr->m_timer.start(h_ptr->m_timeout);
+    }
+
+    h_ptr->startNext();
+
+    if (h_ptr->m_completedCount == h_ptr->m_invocations.size())
+    {
+        // None of the invocations could be dispatched. The completion is
+        // reported from the event loop so that the signal is never emitted
+        // before this call returns.
+        h_ptr->m_timer.start(0);
+    }
+
+    return true;
+}
+
+bool HClientActionGroup::isRunning() const
+{
+    return h_ptr->m_running;
+}
+
+void HClientActionGroup::abort()
+{
+    if (!h_ptr->m_running)
+    {
+        return;
+    }
+
+    h_ptr->abortRemaining("The invocations were aborted");
+    h_ptr->finish();
+}
+
+HClientAction* HClientActionGroup::action(qint32 index) const
+{
+    if (index < 0 || index >= h_ptr->m_invocations.size())
+    {
+        return 0;
+    }
+
+    return h_ptr->m_invocations.at(index).m_action;
+}
+
+HClientActionOp HClientActionGroup::result(qint32 index) const
+{
+    if (index < 0 || index >= h_ptr->m_invocations.size())
+    {
+        return HClientActionOp(UpnpUndefinedFailure, "Invalid index");
+    }
+
+    return h_ptr->m_invocations.at(index).m_op;
+}
+
+QList<HClientActionOp> HClientActionGroup::results() const
+{
+    QList<HClientActionOp> retVal;
+    foreach(const HGroupInvocation& inv, h_ptr->m_invocations)
+    {
+        retVal.append(inv.m_op);
+    }
+    return retVal;
+}
+
+qint32 HClientActionGroup::succeededCount() const
+{
+    qint32 retVal = 0;
+    foreach(const HGroupInvocation& inv, h_ptr->m_invocations)
+    {
+        if (inv.m_done && inv.m_op.returnValue() == UpnpSuccess)
+        {
+            ++retVal;
+        }
+    }
+    return retVal;
+}
+
+}
+}
@@ -0,0 +1,261 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HCLIENTACTIONGROUP_H_
+#define HCLIENTACTIONGROUP_H_
+
+#include <HUpnpCore/HClientActionOp>
+
+#include <QtCore/QList>
+#include <QtCore/QObject>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+class HClientActionGroupPrivate;
+
+/*!
+ * \brief This class is used to invoke a number of actions concurrently and
+ * to collect the results of the invocations.
+ *
+ * An %HClientActionGroup is useful when the same operation has to be run on
+ * a number of devices, such as when pausing every renderer of a zone. Instead of
+ * calling HClientAction::beginInvoke() for each device and tracking the
+ * HClientAction::invokeComplete() signals manually, you add the actions and
+ * their input arguments to a group and start the group:
+ *
+ * \code
+ *
+ * Herqq::Upnp::HClientActionGroup* group = new HClientActionGroup(this);
+ * foreach(Herqq::Upnp::HClientAction* pause, pauseActions)
+ * {
+ *     Herqq::Upnp::HActionArguments inArgs = pause->info().inputArguments();
+ *     inArgs.setValue("InstanceID", 0);
+ *     group->add(pause, inArgs);
+ * }
+ *
+ * group->setTimeout(3000);
+ *
+ * connect(
+ *     group, SIGNAL(invokeComplete(Herqq::Upnp::HClientActionGroup*)),
+ *     this, SLOT(pauseComplete(Herqq::Upnp::HClientActionGroup*)));
+ *
+ * group->beginInvoke();
+ *
+ * \endcode
+ *
+ * The invocations are dispatched concurrently, up to the limit set with
+ * setMaxConcurrentInvocations(). Invocations of different actions are sent to
+ * the network in parallel. Invocations targeting the same HClientAction
+ * are run one after the other, as HClientAction runs its invocations in order.
+ *
+ * \headerfile hclientactiongroup.h HClientActionGroup
+ *
+ * \ingroup hupnp_devicemodel
+ *
+ * \remarks This class has thread affinity. The instance and the actions added to
+ * it have to be used in the same thread.
+ *
+ * \sa HClientAction
+ */
+class H_UPNP_CORE_EXPORT HClientActionGroup :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HClientActionGroup)
+H_DECLARE_PRIVATE(HClientActionGroup)
+
+private Q_SLOTS:
+
+    void invocationDone(
+        Herqq::Upnp::HClientAction*, const Herqq::Upnp::HClientActionOp&);
+
+    void actionDestroyed(QObject*);
+    void timeout();
+
+private:
+
+    HClientActionGroupPrivate* h_ptr;
+
+public:
+
+    /*!
+     * \brief Creates a new, empty instance.
+     *
+     * \param parent specifies the parent \c QObject.
+     */
+    explicit HClientActionGroup(QObject* parent = 0);
+
+    /*!
+     * \brief Destroys the instance.
+     *
+     * Invocations that are still running are aborted.
+     */
+    virtual ~HClientActionGroup();
+
+    /*!
+     * \brief Adds an invocation to the group.
+     *
+     * \param action specifies the action to invoke.
+     *
+     * \param inArgs specifies the input arguments of the invocation.
+     *
+     * \return the index of the invocation in the group, or -1 in case the
+     * \a action is null or the group is running.
+     *
+     * \sa result()
+     */
+    qint32 add(HClientAction* action, const HActionArguments& inArgs);
+
+    /*!
+     * \brief Removes every invocation and result from the group.
+     *
+     * This does nothing if the group is running.
+     */
+    void clear();
+
+    /*!
+     * \brief Returns the number of invocations in the group.
+     *
+     * \return The number of invocations in the group.
+     */
+    qint32 size() const;
+
+    /*!
+     * \brief Specifies the maximum number of invocations that are run
+     * at the same time.
+     *
+     * \param count specifies the maximum number of invocations that are run
+     * at the same time. Values smaller than 1 are treated as 1. The default is 16.
+     */
+    void setMaxConcurrentInvocations(qint32 count);
+
+    /*!
+     * \brief Returns the maximum number of invocations that are run
+     * at the same time.
+     *
+     * \return The maximum number of invocations that are run at the same time.
+     */
+    qint32 maxConcurrentInvocations() const;
+
+    /*!
+     * \brief Specifies the time the group has to complete.
+     *
+     * When the timeout expires, the invocations that are still running are
+     * aborted, the ones not yet started are not sent and the group completes.
+     * The results of these invocations have the return value
+     * \c UpnpInvocationAborted.
+     *
+     * \param msecs specifies the timeout in milliseconds. A negative value
+     * means that there is no timeout, which is the default.
+     */
+    void setTimeout(qint32 msecs);
+
+    /*!
+     * \brief Returns the time the group has to complete.
+     *
+     * \return The time the group has to complete in milliseconds, or
+     * a negative value if there is no timeout.
+     */
+    qint32 timeout() const;
+
+    /*!
+     * \brief Starts the invocations of the group.
+     *
+     * The invokeComplete() signal is emitted once every invocation
+     * has completed, failed or been aborted.
+     *
+     * \return \e true in case the invocations were started. Otherwise
+     * the group is empty or already running.
+     */
+    bool beginInvoke();
+
+    /*!
+     * \brief Indicates whether the group is running.
+     *
+     * \return \e true in case the group is running.
+     */
+    bool isRunning() const;
+
+    /*!
+     * \brief Aborts the invocations that are still running and completes the group.
+     *
+     * This does nothing if the group is not running.
+     */
+    void abort();
+
+    /*!
+     * \brief Returns the action of the specified invocation.
+     *
+     * \param index specifies the index of the invocation.
+     *
+     * \return The action of the specified invocation. The returned pointer is
+     * null in case the index is invalid or the action has been deleted.
+     */
+    HClientAction* action(qint32 index) const;
+
+    /*!
+     * \brief Returns the result of the specified invocation.
+     *
+     * \param index specifies the index of the invocation.
+     *
+     * \return The result of the specified invocation. The return value of the
+     * returned object is \c UpnpInvocationInProgress for an invocation that has
+     * not completed.
+     */
+    HClientActionOp result(qint32 index) const;
+
+    /*!
+     * \brief Returns the results of the invocations in the order the
+     * invocations were added.
+     *
+     * \return The results of the invocations in the order the invocations
+     * were added.
+     */
+    QList<HClientActionOp> results() const;
+
+    /*!
+     * \brief Returns the number of invocations that succeeded.
+     *
+     * \return The number of invocations that succeeded.
+     */
+    qint32 succeededCount() const;
+
+Q_SIGNALS:
+
+    /*!
+     * \brief This signal is emitted when every invocation of the group has
+     * completed, failed or been aborted.
+     *
+     * \param source identifies the group.
+     *
+     * \sa results()
+     */
+    void invokeComplete(Herqq::Upnp::HClientActionGroup* source);
+};
+
+}
+}
+
+#endif /* HCLIENTACTIONGROUP_H_ */
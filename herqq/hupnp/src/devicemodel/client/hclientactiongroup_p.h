@@ -0,0 +1,112 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HCLIENTACTIONGROUP_P_H_
+#define HCLIENTACTIONGROUP_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "hclientaction.h"
+#include "hclientactionop.h"
+
+#include "../hactionarguments.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QTimer>
+#include <QtCore/QPointer>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+//
+// A single invocation of an HClientActionGroup
+//
+class HGroupInvocation
+{
+public:
+
+    QPointer<HClientAction> m_action;
+    HActionArguments m_inArgs;
+    HClientActionOp m_op;
+    bool m_done;
+
+    inline HGroupInvocation() :
+        m_action(), m_inArgs(), m_op(), m_done(false)
+    {
+    }
+
+    inline HGroupInvocation(HClientAction* action, const HActionArguments& inArgs) :
+        m_action(action), m_inArgs(inArgs), m_op(), m_done(false)
+    {
+    }
+};
+
+//
+// Implementation details of HClientActionGroup
+//
+class HClientActionGroupPrivate
+{
+H_DISABLE_COPY(HClientActionGroupPrivate)
+H_DECLARE_PUBLIC(HClientActionGroup)
+
+public:
+
+    HClientActionGroup* q_ptr;
+
+    QList<HGroupInvocation> m_invocations;
+
+    QHash<unsigned int, qint32> m_inFlight;
+    // the ids of the running invocations mapped to their indexes
+
+    QHash<HClientAction*, qint32> m_actionRefs;
+    // the number of invocations of each action in the group
+
+    qint32 m_nextToStart;
+    qint32 m_completedCount;
+    qint32 m_maxConcurrent;
+    qint32 m_timeout;
+    bool m_running;
+
+    QTimer m_timer;
+
+    HClientActionGroupPrivate();
+    ~HClientActionGroupPrivate();
+
+    void startNext();
+    void complete(qint32 index, const HClientActionOp& op);
+    void abortRemaining(const QString& reason);
+    void finish();
+};
+
+}
+}
+
+#endif /* HCLIENTACTIONGROUP_P_H_ */
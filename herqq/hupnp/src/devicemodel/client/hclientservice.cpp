@@ -39,12 +39,66 @@ namespace Upnp
  * HClientServicePrivate
  ******************************************************************************/
 HClientServicePrivate::HClientServicePrivate() :
-    m_stateVariablesConst()
+    m_stateVariablesConst(), m_loader(0), m_pendingVariables()
 {
 }
 
 HClientServicePrivate::~HClientServicePrivate()
 {
+    delete m_loader;
+}
+
+bool HClientServicePrivate::load()
+{
+    Q_ASSERT(m_loader);
+
+    // the loader is detached first, since creating the actions and the state
+    // variables goes through the same methods that request loading
+    HClientServiceLoader* loader = m_loader;
+    m_loader = 0;
+
+    if (!loader->load(static_cast<HDefaultClientService*>(q_ptr)))
+    {
+        // the loader has logged the reason. It is kept, so that the next
+        // access can try again.
+        m_loader = loader;
+        return false;
+    }
+
+    delete loader;
+
+    if (!m_pendingVariables.isEmpty())
+    {
+        QList<QPair<QString, QString> > variables = m_pendingVariables;
+        m_pendingVariables.clear();
+        updateVariables(variables, false);
+    }
+
+    return true;
+}
+
+void HClientServicePrivate::queueVariables(
+    const QList<QPair<QString, QString> >& variables)
+{
+    typedef QPair<QString, QString> Variable;
+    foreach(const Variable& variable, variables)
+    {
+        bool found = false;
+        for(qint32 i = 0; i < m_pendingVariables.size(); ++i)
+        {
+            if (m_pendingVariables[i].first == variable.first)
+            {
+                // only the latest value is of interest
+                m_pendingVariables[i].second = variable.second;
+                found = true;
+                break;
+            }
+        }
+        if (!found)
+        {
+            m_pendingVariables.append(variable);
+        }
+    }
 }
 
 bool HClientServicePrivate::addStateVariable(HDefaultClientStateVariable* sv)
@@ -101,18 +155,26 @@ const HServiceInfo& HClientService::info() const
     return h_ptr->m_serviceInfo;
 }
 
+bool HClientService::isLoaded() const
+{
+    return !h_ptr->m_loader;
+}
+
 QString HClientService::description() const
 {
+    h_ptr->requestLoad();
     return h_ptr->m_serviceDescription;
 }
 
 const HClientActions& HClientService::actions() const
 {
+    h_ptr->requestLoad();
     return h_ptr->m_actions;
 }
 
 const HClientStateVariables& HClientService::stateVariables() const
 {
+    h_ptr->requestLoad();
     return h_ptr->m_stateVariablesConst;
 }
 
@@ -126,11 +188,22 @@ void HClientService::notifyListeners()
 
 bool HClientService::isEvented() const
 {
+    if (h_ptr->m_loader)
+    {
+        // the state variables are not known yet. A service that has an event
+        // subscription URL is assumed to have evented state variables, which
+        // is what the UDA requires. The actual value is available once the
+        // service has been loaded.
+        h_ptr->requestLoad();
+        return !h_ptr->m_serviceInfo.eventSubUrl().isEmpty();
+    }
+
     return h_ptr->m_evented;
 }
 
 QVariant HClientService::value(const QString& stateVarName, bool* ok) const
 {
+    h_ptr->requestLoad();
     return h_ptr->value(stateVarName, ok);
 }
 
@@ -160,9 +233,41 @@ void HDefaultClientService::setDescription(const QString& description)
     h_ptr->m_serviceDescription = description;
 }
 
+void HDefaultClientService::setLoader(HClientServiceLoader* loader)
+{
+    Q_ASSERT(loader);
+    Q_ASSERT(!h_ptr->m_loader);
+    h_ptr->m_loader = loader;
+}
+
+void HDefaultClientService::prefetch()
+{
+    if (h_ptr->m_loader)
+    {
+        h_ptr->m_loader->prefetch(false);
+    }
+}
+
+void HDefaultClientService::descriptionRetrieved()
+{
+    if (h_ptr->m_loader && h_ptr->load())
+    {
+        emit loaded(this);
+    }
+}
+
 bool HDefaultClientService::updateVariables(
     const QList<QPair<QString, QString> >& variables, bool sendEvent)
 {
+    if (h_ptr->m_loader)
+    {
+        // the values are stored and applied once the service is loaded,
+        // which is started in the background.
+        h_ptr->queueVariables(variables);
+        h_ptr->m_loader->prefetch(false);
+        return true;
+    }
+
     return h_ptr->updateVariables(variables, sendEvent) != HClientServicePrivate::Failed;
 }
 
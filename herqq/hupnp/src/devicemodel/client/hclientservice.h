@@ -69,6 +69,18 @@ class HClientServicePrivate;
  * to the stateChanged() signal. You do not need to worry about UPnP eventing at all,
  * since HUPnP handles that for you.
  *
+ * <h2>Lazily loaded services</h2>
+ *
+ * When the HControlPoint is configured to load service descriptions lazily,
+ * a service may become available before its service description has been
+ * retrieved. Until then isLoaded() returns \e false and the service has no
+ * actions and no state variables. Accessing them starts retrieving the service
+ * description in the background, but it does not wait for it. The loaded()
+ * signal is emitted once the actions and the state variables have been
+ * created.
+ *
+ * \sa HControlPointConfiguration::setLazyServiceLoading()
+ *
  * \headerfile hclientservice.h HClientService
  *
  * \ingroup hupnp_devicemodel
@@ -122,30 +134,50 @@ public:
      */
     const HServiceInfo& info() const;
 
+    /*!
+     * \brief Indicates whether the actions and the state variables of the
+     * service have been created.
+     *
+     * \return \e true unless the service is loaded lazily and its service
+     * description has not been retrieved yet.
+     *
+     * \sa loaded(), HControlPointConfiguration::setLazyServiceLoading()
+     */
+    bool isLoaded() const;
+
     /*!
      * \brief Returns the full service description.
      *
-     * \return The full service description.
+     * \return The full service description. An empty string is returned
+     * in case the service is not loaded yet.
+     *
+     * \sa isLoaded()
      */
     QString description() const;
 
     /*!
      * \brief Returns the actions the service supports.
      *
-     * \return The actions the service supports.
+     * \return The actions the service supports. No actions are returned in case
+     * the service is not loaded yet.
      *
      * \remarks The ownership of the returned objects is not transferred.
      * Do \b not delete the returned objects.
+     *
+     * \sa isLoaded()
      */
     const HClientActions& actions() const;
 
     /*!
      * \brief Returns the state variables of the service.
      *
-     * \return The state variables of the service.
+     * \return The state variables of the service. No state variables are
+     * returned in case the service is not loaded yet.
      *
      * \remarks The ownership of the returned objects is not transferred.
      * Do \b not delete the returned objects.
+     *
+     * \sa isLoaded()
      */
     const HClientStateVariables& stateVariables() const;
 
@@ -156,8 +188,11 @@ public:
      * \return \e true in case the service contains one or more state variables
      * that are evented.
      *
-     * \remarks In case the service is not evented, the stateChanged() signal
+     * \remarks
+     * \li In case the service is not evented, the stateChanged() signal
      * will never be emitted and the notifyListeners() method does nothing.
+     * \li Until the service is loaded, it is considered evented in case it has
+     * an event subscription URL.
      */
     bool isEvented() const;
 
@@ -204,6 +239,19 @@ Q_SIGNALS:
      * resides. Do not connect to this signal from other threads.
      */
     void stateChanged(const Herqq::Upnp::HClientService* source);
+
+    /*!
+     * \brief This signal is emitted when the actions and the state variables of
+     * a lazily loaded service have been created.
+     *
+     * \param source specifies the service that was loaded.
+     *
+     * \remarks This signal has thread affinity to the thread where the object
+     * resides. Do not connect to this signal from other threads.
+     *
+     * \sa isLoaded()
+     */
+    void loaded(const Herqq::Upnp::HClientService* source);
 };
 
 }
@@ -38,8 +38,33 @@ namespace Herqq
 namespace Upnp
 {
 
+class HDefaultClientService;
 class HDefaultClientStateVariable;
 
+//
+// Creates the actions and the state variables of a service that was created
+// without them. This is the case when the control point is configured to
+// load service descriptions lazily.
+//
+class HClientServiceLoader
+{
+public:
+
+    virtual ~HClientServiceLoader() {}
+
+    // starts retrieving the service description in the background, unless
+    // it has been retrieved already or a retrieval is in progress. an urgent
+    // retrieval is run ahead of the prefetches. the service is notified in
+    // its own thread once the retrieval completes. never blocks.
+    virtual void prefetch(bool urgent) = 0;
+
+    // creates the actions and the state variables of the specified service
+    // from the retrieved service description. returns false in case the
+    // description has not been retrieved, in which case nothing is created.
+    // never blocks.
+    virtual bool load(HDefaultClientService*) = 0;
+};
+
 //
 // Implementation details of HClientService
 //
@@ -53,6 +78,13 @@ public: // attributes
 
     QHash<QString, const HClientStateVariable*> m_stateVariablesConst;
 
+    HClientServiceLoader* m_loader;
+    // non-null until the actions and the state variables have been created
+
+    QList<QPair<QString, QString> > m_pendingVariables;
+    // the state variable values received in events before the service
+    // was loaded
+
 public: // methods
 
     HClientServicePrivate();
@@ -60,6 +92,19 @@ public: // methods
     virtual ~HClientServicePrivate();
     bool addStateVariable(HDefaultClientStateVariable*);
 
+    bool load();
+
+    // starts loading the service in the background, if it is not loaded
+    inline void requestLoad()
+    {
+        if (m_loader)
+        {
+            m_loader->prefetch(true);
+        }
+    }
+
+    void queueVariables(const QList<QPair<QString, QString> >& variables);
+
     ReturnValue updateVariables(
         const QList<QPair<QString, QString> >& variables, bool sendEvent);
 };
@@ -33,8 +33,6 @@
 #include <HUpnpCore/HClientDevice>
 #include <HUpnpCore/HDeviceStatus>
 
-#include <QtCore/QTimer>
-
 namespace Herqq
 {
 
@@ -54,15 +52,10 @@ H_DISABLE_COPY(HDefaultClientDevice)
 
 private:
 
-    bool m_timedout;
-    QScopedPointer<QTimer> m_statusNotifier;
+    qint32 m_deviceTimeoutInSecs;
     QScopedPointer<HDeviceStatus> m_deviceStatus;
     qint32 m_configId;
 
-private Q_SLOTS:
-
-    void timeout_();
-
 public:
 
     HDefaultClientDevice(
@@ -78,14 +71,6 @@ public:
 
 public:
 
-    enum SearchCriteria
-    {
-        ThisOnly = 0,
-        EmbeddedDevices = 1,
-        Services = 2,
-        All = 3
-    };
-
     quint32 deviceTimeoutInSecs() const;
 
     inline HDeviceStatus* deviceStatus() const
@@ -94,18 +79,13 @@ public:
         return static_cast<HDefaultClientDevice*>(rootDevice())->deviceStatus();
     }
 
-    void startStatusNotifier(SearchCriteria searchCriteria);
-    void stopStatusNotifier(SearchCriteria searchCriteria);
-
     bool addLocation(const QUrl& location);
     void addLocations(const QList<QUrl>& locations);
     void clearLocations();
     HDefaultClientDevice* rootDevice() const;
-    bool isTimedout(SearchCriteria searchCriteria) const;
 
 Q_SIGNALS:
 
-    void statusTimeout(HDefaultClientDevice* source);
     void locationsChanged();
 
 };
@@ -40,6 +40,7 @@ namespace Herqq
 namespace Upnp
 {
 
+class HClientServiceLoader;
 class HDefaultClientDevice;
 class HDefaultClientStateVariable;
 
@@ -49,8 +50,14 @@ class HDefaultClientStateVariable;
 class HDefaultClientService :
     public HClientService
 {
+Q_OBJECT
 H_DISABLE_COPY(HDefaultClientService)
 
+private Q_SLOTS:
+
+    // invoked by the loader once it has retrieved the service description
+    void descriptionRetrieved();
+
 public:
 
     HDefaultClientService(const HServiceInfo&, HDefaultClientDevice* parentDevice);
@@ -58,6 +65,10 @@ public:
     void addStateVariable(HDefaultClientStateVariable*);
     void setDescription(const QString& description);
 
+    // takes the ownership of the loader
+    void setLoader(HClientServiceLoader*);
+    void prefetch();
+
     bool updateVariables(
         const QList<QPair<QString, QString> >& variables, bool sendEvent);
 
@@ -20,6 +20,8 @@ HEADERS += \
     $$SRC_LOC/devicemodel/hstatevariables_setupdata.h \
     $$SRC_LOC/devicemodel/client/hclientaction.h \
     $$SRC_LOC/devicemodel/client/hclientactionop.h \
+    $$SRC_LOC/devicemodel/client/hclientactiongroup.h \
+    $$SRC_LOC/devicemodel/client/hclientactiongroup_p.h \
     $$SRC_LOC/devicemodel/client/hclientadapterop.h \
     $$SRC_LOC/devicemodel/client/hclientadapter_p.h \
     $$SRC_LOC/devicemodel/client/hclientaction_p.h \
@@ -73,6 +75,7 @@ SOURCES += \
     $$SRC_LOC/devicemodel/client/hclientdevice_adapter.cpp \
     $$SRC_LOC/devicemodel/client/hclientaction.cpp \
     $$SRC_LOC/devicemodel/client/hclientactionop.cpp \
+    $$SRC_LOC/devicemodel/client/hclientactiongroup.cpp \
     $$SRC_LOC/devicemodel/client/hclientservice.cpp \
     $$SRC_LOC/devicemodel/client/hclientservice_adapter.cpp \
     $$SRC_LOC/devicemodel/client/hclientstatevariable.cpp \
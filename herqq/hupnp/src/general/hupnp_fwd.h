@@ -46,6 +46,7 @@ class HClientAction;
 class HClientDevice;
 class HClientService;
 class HClientActionOp;
+class HClientActionGroup;
 class HClientStateVariable;
 
 struct HNullValue;
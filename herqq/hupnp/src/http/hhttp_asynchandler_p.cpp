@@ -22,6 +22,7 @@
 #include "hhttp_asynchandler_p.h"
 #include "hhttp_messagecreator_p.h"
 #include "hhttp_utils_p.h"
+#include "hhttp_streamparser_p.h"
 
 #include "../general/hupnp_global_p.h"
 #include "../devicehosting/messages/hevent_messages_p.h"
@@ -41,13 +42,15 @@ HHttpAsyncOperation::HHttpAsyncOperation(
     bool waitingRequest, QObject* parent) :
         QObject(parent),
             m_mi(mi),
+            m_headerToSend(),
             m_dataToSend(),
             m_dataSend(0),
             m_dataSent(0),
             m_state(Internal_NotStarted),
-            m_headerRead(0),
-            m_dataRead(),
-            m_dataToRead(0),
+            m_parser(new HHttpStreamParser(waitingRequest)),
+            m_readTimer(),
+            m_readingBody(false),
+            m_timedOut(false),
             m_id(id),
             m_loggingIdentifier(loggingIdentifier),
             m_opType(waitingRequest ? ReceiveRequest : ReceiveResponse)
@@ -62,20 +65,27 @@ HHttpAsyncOperation::HHttpAsyncOperation(
         this, SLOT(error(QAbstractSocket::SocketError)));
 
     Q_ASSERT(ok);
+
+    m_readTimer.setSingleShot(true);
+    ok = connect(&m_readTimer, SIGNAL(timeout()), this, SLOT(readTimeout()));
+    Q_ASSERT(ok);
 }
 
 HHttpAsyncOperation::HHttpAsyncOperation(
     const QByteArray& loggingIdentifier, unsigned int id, HMessagingInfo* mi,
-    const QByteArray& data, bool sendOnly, QObject* parent) :
+    const QByteArray& header, const QByteArray& body, bool sendOnly,
+    QObject* parent) :
         QObject(parent),
             m_mi(mi),
-            m_dataToSend(data),
+            m_headerToSend(header),
+            m_dataToSend(body),
             m_dataSend(0),
             m_dataSent(0),
             m_state(Internal_NotStarted),
-            m_headerRead(0),
-            m_dataRead(),
-            m_dataToRead(0),
+            m_parser(new HHttpStreamParser(false)),
+            m_readTimer(),
+            m_readingBody(false),
+            m_timedOut(false),
             m_id(id),
             m_loggingIdentifier(loggingIdentifier),
             m_opType(sendOnly ? SendOnly : MsgIO)
@@ -96,12 +106,26 @@ HHttpAsyncOperation::HHttpAsyncOperation(
         this, SLOT(error(QAbstractSocket::SocketError)));
 
     Q_ASSERT(ok);
+
+    m_readTimer.setSingleShot(true);
+    ok = connect(&m_readTimer, SIGNAL(timeout()), this, SLOT(readTimeout()));
+    Q_ASSERT(ok);
 }
 
 HHttpAsyncOperation::~HHttpAsyncOperation()
 {
     delete m_mi;
-    delete m_headerRead;
+    delete m_parser;
+}
+
+QByteArray HHttpAsyncOperation::dataRead() const
+{
+    return m_parser->body();
+}
+
+const HHttpHeader* HHttpAsyncOperation::headerRead() const
+{
+    return m_parser->header();
 }
 
 void HHttpAsyncOperation::sendChunked()
@@ -177,9 +201,10 @@ void HHttpAsyncOperation::sendChunked()
 
     if (m_dataSent >= m_dataToSend.size())
     {
-        // write the "eof" == zero + crlf
-        const char eof[] = "0\r\n";
-        m_mi->socket().write(&eof[0], 3);
+        // write the last chunk, which is zero + crlf, followed by the crlf
+        // that ends the (empty) trailer
+        const char eof[] = "0\r\n\r\n";
+        m_mi->socket().write(&eof[0], 5);
         m_mi->socket().flush();
 
         if (m_opType == SendOnly)
@@ -188,234 +213,53 @@ void HHttpAsyncOperation::sendChunked()
             return;
         }
 
-        m_state = Internal_ReadingHeader;
+        startReading();
     }
 }
 
-void HHttpAsyncOperation::readBlob()
+qint64 HHttpAsyncOperation::writeBlob()
 {
-    QByteArray buf; buf.resize(m_dataToRead+1);
-    do
-    {
-        qint64 retVal = m_mi->socket().read(
-            buf.data(), qMin(static_cast<qint64>(buf.size()), m_dataToRead));
+    qint64 count = m_dataToSend.size() - m_dataSent;
 
-        if (retVal < 0)
-        {
-            m_mi->setLastErrorDescription(
-                QString("failed to read data: %1").arg(
-                    m_mi->socket().errorString()));
-
-            done_(Internal_Failed);
-            return;
-        }
-        else if (retVal > 0)
-        {
-            m_dataToRead -= retVal;
-            m_dataRead.append(QByteArray(buf.data(), retVal));
-        }
-        else
+    qint64 highWaterMark = m_mi->sendHighWaterMark();
+    if (highWaterMark > 0)
+    {
+        // a slow reader should not cause the entire body to be copied into
+        // the write buffer of the socket. the rest is written once the
+        // socket has flushed enough of its buffer
+        count = qMin(count, highWaterMark - m_mi->socket().bytesToWrite());
+        if (count <= 0)
         {
-            break;
+            return 0;
         }
     }
-    while(m_dataToRead > 0);
-
-    if (m_dataToRead <= 0)
-    {
-        done_(Internal_FinishedSuccessfully);
-    }
-}
-
-bool HHttpAsyncOperation::readChunkedSizeLine()
-{
-    if (m_mi->socket().bytesAvailable() <= 0)
-    {
-        return false;
-    }
-
-    QByteArray buf;
-    if (!HHttpUtils::readLines(m_mi->socket(), buf, 1))
-    {
-        // No size line. It should be available at this point.
-        m_mi->setLastErrorDescription("missing chunk-size line");
-        done_(Internal_Failed);
-        return false;
-    }
 
-    qint32 endOfSize = buf.indexOf(';');
-    if (endOfSize < 0)
-    {
-        // no extensions
-        endOfSize = buf.size() - 2; // 2 == crlf
-    }
-    QByteArray sizeLine = buf.left(endOfSize);
+    qint64 written =
+        m_mi->socket().write(m_dataToSend.data() + m_dataSent, count);
 
-    bool ok = false;
-    qint32 chunkSize = sizeLine.toInt(&ok, 16);
-    if (!ok || chunkSize < 0)
+    if (written > 0)
     {
-        m_mi->setLastErrorDescription(
-            QString("invalid chunk-size line: %1").arg(
-                  QString::fromUtf8(sizeLine)));
-
-        done_(Internal_Failed);
-        return false;
-    }
-
-    if (chunkSize == 0)
-    {
-        // the last chunk, ignore possible trailers
-        done_(Internal_FinishedSuccessfully);
-        return false;
-    }
-
-    m_dataToRead = chunkSize;
-    m_state = Internal_ReadingChunk;
-
-    return true;
-}
-
-bool HHttpAsyncOperation::readChunk()
-{
-    QByteArray tmp;
-    tmp.resize(m_dataToRead);
-
-    qint32 read = m_mi->socket().read(tmp.data(), tmp.size());
-
-    if (read < 0)
-    {
-        m_mi->setLastErrorDescription(QString(
-            "failed to read chunk: %1").arg(m_mi->socket().errorString()));
-
-        done_(Internal_Failed);
-        return false;
-    }
-    else if (read == 0)
-    {
-        // couldn't read the entire chunk in one pass
-        return false;
-    }
-
-    tmp.resize(read);
-    m_dataRead.append(tmp);
-
-    m_dataToRead -= read;
-    if (m_dataToRead > 0)
-    {
-        // couldn't read the entire chunk in one pass
-        return false;
-    }
-
-    // if here, the entire chunk data is read.
-    // clear the remaining crlf and move to the next chunk
-
-    char c;
-    m_mi->socket().getChar(&c);
-    m_mi->socket().getChar(&c);
-
-    m_state = Internal_ReadingChunkSizeLine;
-
-    return true;
-}
-
-bool HHttpAsyncOperation::readHeader()
-{
-    if (!HHttpUtils::readLines(m_mi->socket(), m_dataRead, 2))
-    {
-        m_mi->setLastErrorDescription(QString(
-            "failed to read HTTP header: %1").arg(m_mi->socket().errorString()));
-
-        done_(Internal_Failed);
-        return false;
-    }
-
-    if (m_opType == ReceiveRequest)
-    {
-        m_headerRead = new HHttpRequestHeader(QString::fromUtf8(m_dataRead));
-    }
-    else
-    {
-        m_headerRead = new HHttpResponseHeader(QString::fromUtf8(m_dataRead));
-    }
-
-    m_dataRead.clear();
-
-    if (!m_headerRead->isValid())
-    {
-        m_mi->setLastErrorDescription("read invalid HTTP header");
-        done_(Internal_Failed);
-        return false;
-    }
-
-    m_mi->setKeepAlive(HHttpUtils::keepAlive(*m_headerRead));
-
-    if (m_headerRead->hasContentLength())
-    {
-        m_dataToRead = m_headerRead->contentLength();
-        if (m_dataToRead == 0)
-        {
-            done_(Internal_FinishedSuccessfully);
-            return false;
-        }
-    }
-    else if (m_headerRead->value("TRANSFER-ENCODING") != "chunked")
-    {
-        done_(Internal_FinishedSuccessfully);
-        return false;
+        m_dataSent += written;
     }
 
-    m_state = Internal_ReadingData;
-    return true;
+    return written;
 }
 
-bool HHttpAsyncOperation::readData()
+void HHttpAsyncOperation::startReading()
 {
-    if (!m_mi->socket().bytesAvailable())
-    {
-        return false;
-    }
+    m_state = Internal_Reading;
 
-    bool chunked = m_headerRead->value("TRANSFER-ENCODING") == "chunked";
-    if (chunked)
+    if (m_mi->headerReadTimeout() > 0)
     {
-        if (m_headerRead->hasContentLength())
-        {
-            m_mi->setLastErrorDescription("read invalid HTTP header where both "
-                "TRANSFER-ENCODING and CONTENT-LENGTH where defined");
-
-            done_(Internal_Failed);
-            return false;
-        }
-
-        m_state = Internal_ReadingChunkSizeLine;
+        m_readTimer.start(m_mi->headerReadTimeout());
     }
-    else
-    {
-        if (m_headerRead->hasContentLength())
-        {
-            readBlob();
-        }
-        else
-        {
-            // not chunked and content length is not specified ==>
-            // no way to know what to expect ==> read all that is available
-            QByteArray body = m_mi->socket().readAll();
-            m_dataRead.append(body);
-
-            done_(Internal_FinishedSuccessfully);
-            return false;
-        }
-    }
-
-    return true;
 }
 
 bool HHttpAsyncOperation::run()
 {
-    if (m_dataToSend.isEmpty())
+    if (m_headerToSend.isEmpty())
     {
-        m_state = Internal_ReadingHeader;
+        startReading();
         return true;
     }
 
@@ -425,37 +269,31 @@ bool HHttpAsyncOperation::run()
         return false;
     }
 
-    qint32 indexOfData = m_dataToSend.indexOf("\r\n\r\n");
-    Q_ASSERT(indexOfData > 0);
-
-    if (m_mi->chunkedInfo().max() > 0 &&
-        m_dataToSend.size() - indexOfData > m_mi->chunkedInfo().max())
+    qint64 headerSent = m_mi->socket().write(m_headerToSend);
+    if (headerSent != m_headerToSend.size())
     {
-        // send the http header first (it is expected that the header has been
-        // properly setup for chunked transfer, as it should be, since this is
-        // private stuff not influenced by public input)
-
-        qint32 endOfHdr = m_dataToSend.indexOf("\r\n\r\n") + 4;
-        m_dataSent = m_mi->socket().write(m_dataToSend.data(), endOfHdr);
+        m_mi->setLastErrorDescription(QString(
+            "failed to send HTTP header %1").arg(
+                m_mi->socket().errorString()));
 
-        if (m_dataSent != endOfHdr)
-        {
-            m_mi->setLastErrorDescription(QString(
-                "failed to send HTTP header %1").arg(
-                    m_mi->socket().errorString()));
+        done_(Internal_Failed, false);
+        return false;
+    }
 
-            done_(Internal_Failed, false);
-            return false;
-        }
+    if (m_mi->chunkedInfo().max() > 0 &&
+        m_dataToSend.size() > m_mi->chunkedInfo().max())
+    {
+        // it is expected that the header has been properly setup for chunked
+        // transfer, as it should be, since this is private stuff not
+        // influenced by public input
 
         m_state = Internal_WritingChunkedSizeLine;
         sendChunked();
     }
     else
     {
-        m_dataSent = m_mi->socket().write(m_dataToSend);
-
-        if (m_dataSent < 0)
+        m_dataSent = 0;
+        if (!m_dataToSend.isEmpty() && writeBlob() < 0)
         {
             m_mi->setLastErrorDescription(
                 QString("failed to send data: %1").arg(
@@ -489,6 +327,7 @@ bool HHttpAsyncOperation::run()
 void HHttpAsyncOperation::done_(InternalState state, bool emitSignal)
 {
     m_mi->socket().disconnect(this);
+    m_readTimer.stop();
 
     Q_ASSERT((state == Internal_FinishedSuccessfully && (headerRead() || m_opType == SendOnly)) ||
               state != Internal_FinishedSuccessfully);
@@ -506,11 +345,7 @@ void HHttpAsyncOperation::bytesWritten(qint64)
     {
         if (m_dataSent < m_dataToSend.size())
         {
-            qint64 dataSent = m_mi->socket().write(
-                m_dataToSend.data() + m_dataSent,
-                m_dataToSend.size() - m_dataSent);
-
-            if (dataSent < 0)
+            if (writeBlob() < 0)
             {
                 m_mi->setLastErrorDescription(
                     QString("failed to send data: %1").arg(
@@ -519,8 +354,6 @@ void HHttpAsyncOperation::bytesWritten(qint64)
                 done_(Internal_Failed);
                 return;
             }
-
-            m_dataSent += dataSent;
         }
 
         if (m_dataSent >= m_dataToSend.size())
@@ -531,7 +364,7 @@ void HHttpAsyncOperation::bytesWritten(qint64)
             }
             else
             {
-                m_state = Internal_ReadingHeader;
+                startReading();
             }
         }
     }
@@ -544,92 +377,77 @@ void HHttpAsyncOperation::bytesWritten(qint64)
 
 void HHttpAsyncOperation::readyRead()
 {
-    if (m_state == Internal_ReadingHeader)
+    if (m_state != Internal_Reading)
     {
-        if (!readHeader())
-        {
-            return;
-        }
+        return;
     }
 
-    if (m_state == Internal_ReadingData)
+    HHttpStreamParser::State state =
+        m_parser->parse(m_mi->socket(), m_mi->receiveBuffer());
+
+    if (state == HHttpStreamParser::Failed)
     {
-        if (!readData())
-        {
-            return;
-        }
+        m_mi->setLastErrorDescription(m_parser->errorDescription());
+        done_(Internal_Failed);
     }
-
-    for(; m_state == Internal_ReadingChunkSizeLine ||
-          m_state == Internal_ReadingChunk;)
+    else if (state == HHttpStreamParser::Finished)
+    {
+        m_mi->setKeepAlive(HHttpUtils::keepAlive(*m_parser->header()));
+        done_(Internal_FinishedSuccessfully);
+    }
+    else if (state != HHttpStreamParser::ReadingHeader && !m_readingBody)
     {
-        // the request contained chunked data
+        m_readingBody = true;
 
-        if (m_state == Internal_ReadingChunkSizeLine)
+        if (m_mi->bodyReadTimeout() > 0)
         {
-            if (!readChunkedSizeLine())
-            {
-                // no more data available at the moment
-                return;
-            }
+            m_readTimer.start(m_mi->bodyReadTimeout());
         }
-
-        if (m_state == Internal_ReadingChunk)
+        else
         {
-            if (!readChunk())
-            {
-                // no more data available at the moment
-                return;
-            }
+            m_readTimer.stop();
         }
     }
 }
 
-void HHttpAsyncOperation::error(QAbstractSocket::SocketError err)
+void HHttpAsyncOperation::readTimeout()
 {
-    if (err != QAbstractSocket::RemoteHostClosedError)
+    if (m_state != Internal_Reading)
     {
-        done_(Internal_Failed);
         return;
     }
-    else if (m_state >= Internal_Failed && m_state < Internal_ReadingHeader)
+
+    m_timedOut = true;
+
+    m_mi->setLastErrorDescription(
+        m_readingBody ? "timed out while reading HTTP body" :
+                        "timed out while reading HTTP header");
+
+    done_(Internal_Failed);
+}
+
+void HHttpAsyncOperation::error(QAbstractSocket::SocketError err)
+{
+    if (err != QAbstractSocket::RemoteHostClosedError)
     {
         done_(Internal_Failed);
         return;
     }
-    else if (m_dataToRead > 0)
+    else if (m_state != Internal_Reading)
     {
-        m_mi->setLastErrorDescription(
-            "remote host closed connection before all data could be read");
-
         done_(Internal_Failed);
         return;
     }
-    else if (m_state == Internal_ReadingHeader)
-    {
-        if (m_dataRead.size() <= 0)
-        {
-            m_mi->setLastErrorDescription(
-                QString("failed to read HTTP header: %1").arg(m_mi->socket().errorString()));
-            done_(Internal_Failed);
-            return;
-        }
 
-        if (m_opType == ReceiveRequest)
-        {
-            m_headerRead = new HHttpRequestHeader(QString::fromUtf8(m_dataRead));
-        }
-        else
-        {
-            m_headerRead = new HHttpResponseHeader(QString::fromUtf8(m_dataRead));
-        }
+    // read whatever the remote host managed to send before closing the
+    // connection
+    m_parser->parse(m_mi->socket(), m_mi->receiveBuffer());
 
-        if (!m_headerRead->isValid())
-        {
-            m_mi->setLastErrorDescription("read invalid HTTP header");
-            done_(Internal_Failed);
-            return;
-        }
+    if (!m_parser->endOfStream(m_mi->receiveBuffer()))
+    {
+        m_mi->setLastErrorDescription(m_parser->errorDescription());
+        done_(Internal_Failed);
+        return;
     }
 
     // at this point a header is successfully read and possibly some data ==>
@@ -653,10 +471,7 @@ HHttpAsyncOperation::State HHttpAsyncOperation::state() const
     case Internal_WritingChunk:
         return Writing;
 
-    case Internal_ReadingHeader:
-    case Internal_ReadingData:
-    case Internal_ReadingChunkSizeLine:
-    case Internal_ReadingChunk:
+    case Internal_Reading:
         return Reading;
 
     case Internal_FinishedSuccessfully:
@@ -701,12 +516,23 @@ void HHttpAsyncHandler::done(unsigned int id)
 HHttpAsyncOperation* HHttpAsyncHandler::msgIo(
     HMessagingInfo* mi, const QByteArray& req)
 {
-    Q_ASSERT(mi);
     Q_ASSERT(!req.isEmpty());
 
+    qint32 endOfHdr = req.indexOf("\r\n\r\n") + 4;
+    Q_ASSERT(endOfHdr > 4);
+
+    return msgIo(mi, req.left(endOfHdr), req.mid(endOfHdr));
+}
+
+HHttpAsyncOperation* HHttpAsyncHandler::msgIo(
+    HMessagingInfo* mi, const QByteArray& header, const QByteArray& body)
+{
+    Q_ASSERT(mi);
+    Q_ASSERT(!header.isEmpty());
+
     HHttpAsyncOperation* ao =
         new HHttpAsyncOperation(
-            m_loggingIdentifier, ++m_lastIdUsed, mi, req, false, this);
+            m_loggingIdentifier, ++m_lastIdUsed, mi, header, body, false, this);
 
     bool ok = connect(ao, SIGNAL(done(unsigned int)), this, SLOT(done(unsigned int)));
 
@@ -727,22 +553,35 @@ HHttpAsyncOperation* HHttpAsyncHandler::msgIo(
 HHttpAsyncOperation* HHttpAsyncHandler::msgIo(
     HMessagingInfo* mi, HHttpRequestHeader& reqHdr, const QtSoapMessage& soapMsg)
 {
-    QByteArray dataToSend =
+    QByteArray body = soapMsg.toXmlString().toUtf8();
+
+    QByteArray header =
         HHttpMessageCreator::setupData(
-            reqHdr, soapMsg.toXmlString().toUtf8(), *mi, ContentType_TextXml);
+            reqHdr, body.size(), *mi, ContentType_TextXml);
 
-    return msgIo(mi, dataToSend);
+    return msgIo(mi, header, body);
 }
 
 HHttpAsyncOperation* HHttpAsyncHandler::send(
     HMessagingInfo* mi, const QByteArray& data)
 {
-    Q_ASSERT(mi);
     Q_ASSERT(!data.isEmpty());
 
+    qint32 endOfHdr = data.indexOf("\r\n\r\n") + 4;
+    Q_ASSERT(endOfHdr > 4);
+
+    return send(mi, data.left(endOfHdr), data.mid(endOfHdr));
+}
+
+HHttpAsyncOperation* HHttpAsyncHandler::send(
+    HMessagingInfo* mi, const QByteArray& header, const QByteArray& body)
+{
+    Q_ASSERT(mi);
+    Q_ASSERT(!header.isEmpty());
+
     HHttpAsyncOperation* ao =
         new HHttpAsyncOperation(
-            m_loggingIdentifier, ++m_lastIdUsed, mi, data, true, this);
+            m_loggingIdentifier, ++m_lastIdUsed, mi, header, body, true, this);
 
     bool ok = connect(ao, SIGNAL(done(unsigned int)), this, SLOT(done(unsigned int)));
     Q_ASSERT(ok); Q_UNUSED(ok)
@@ -37,6 +37,7 @@
 #include "hhttp_messaginginfo_p.h"
 
 #include <QtCore/QHash>
+#include <QtCore/QTimer>
 #include <QtCore/QObject>
 #include <QtCore/QByteArray>
 #include <QtNetwork/QAbstractSocket>
@@ -50,6 +51,7 @@ namespace Upnp
 {
 
 class HHttpAsyncHandler;
+class HHttpStreamParser;
 
 //
 //
@@ -80,17 +82,19 @@ private:
         Internal_WritingBlob,
         Internal_WritingChunkedSizeLine,
         Internal_WritingChunk,
-        Internal_ReadingHeader,
-        Internal_ReadingData,
-        Internal_ReadingChunkSizeLine,
-        Internal_ReadingChunk,
+        Internal_Reading,
         Internal_FinishedSuccessfully
     };
 
     HMessagingInfo* m_mi;
 
+    QByteArray m_headerToSend;
+    // the HTTP header which will be sent to the target socket
+
     QByteArray m_dataToSend;
-    // the data which will be sent to the target socket
+    // the body which will be sent to the target socket after the header.
+    // the header and the body are kept apart so that neither has to be
+    // copied into a buffer containing the entire message
 
     qint64 m_dataSend;
     // used only with chunked encoding when a chunk cannot be sent in full and
@@ -102,16 +106,17 @@ private:
     InternalState m_state;
     // the current state of this "state machine"
 
-    HHttpHeader* m_headerRead;
-    // the http reader read from the target socket
+    HHttpStreamParser* m_parser;
+    // reads the http message from the target socket
     // (request / response, depends of the setup)
 
-    QByteArray m_dataRead;
-    // the response data that is currently read from the target socket
+    QTimer m_readTimer;
+    // enforces the header and body read timeouts of the messaging info
+
+    bool m_readingBody;
+    // whether the header has been read and the read timer measures the body
 
-    qint64 m_dataToRead;
-    // the amount of data that should be available (once the operation is
-    // successfully completed)
+    bool m_timedOut;
 
     unsigned int m_id;
     // id for the operation
@@ -124,16 +129,9 @@ private:
 private:
 
     void sendChunked();
+    qint64 writeBlob();
 
-    void readBlob();
-    bool readChunkedSizeLine();
-    bool readChunk();
-
-    // the return value of these two methods indicate if it is okay to continue
-    // the operation. when returned false, the operation has signaled completion
-    // and thus must be aborted immediately.
-    bool readHeader();
-    bool readData();
+    void startReading();
 
     bool run();
     void done_(InternalState state, bool emitSignal = true);
@@ -142,6 +140,7 @@ private Q_SLOTS:
 
     void bytesWritten(qint64);
     void readyRead();
+    void readTimeout();
     void error(QAbstractSocket::SocketError);
 
 public:
@@ -161,7 +160,8 @@ public:
 
     HHttpAsyncOperation(
         const QByteArray& loggingIdentifier, unsigned int id, HMessagingInfo* mi,
-        const QByteArray& data, bool sendOnly, QObject* parent);
+        const QByteArray& header, const QByteArray& body, bool sendOnly,
+        QObject* parent);
 
     virtual ~HHttpAsyncOperation();
 
@@ -170,10 +170,10 @@ public:
     inline unsigned int id() const { return m_id; }
 
     // the data of the response
-    inline QByteArray dataRead() const { return m_dataRead; }
+    QByteArray dataRead() const;
 
     // the header of the response
-    inline const HHttpHeader* headerRead() const { return m_headerRead; }
+    const HHttpHeader* headerRead() const;
 
     inline HMessagingInfo* messagingInfo() const { return m_mi; }
 
@@ -185,6 +185,9 @@ public:
 
     inline OpType opType() const { return m_opType; }
 
+    // whether the operation failed due to a read timeout
+    inline bool timedOut() const { return m_timedOut; }
+
 Q_SIGNALS:
 
     void done(unsigned int);
@@ -232,6 +235,15 @@ public:
     // NOT any sooner!
     HHttpAsyncOperation* msgIo(HMessagingInfo* mi, const QByteArray& data);
 
+    //
+    // \param mi
+    // \param header contains the HTTP header of the message.
+    // \param body contains the body of the message, which is sent right
+    // after the header.
+    //
+    HHttpAsyncOperation* msgIo(
+        HMessagingInfo* mi, const QByteArray& header, const QByteArray& body);
+
     //
     // Helper overload
     //
@@ -243,6 +255,12 @@ public:
     //
     HHttpAsyncOperation* send(HMessagingInfo*, const QByteArray& data);
 
+    //
+    // Sends the header and then the body, see msgIo()
+    //
+    HHttpAsyncOperation* send(
+        HMessagingInfo*, const QByteArray& header, const QByteArray& body);
+
     //
     // waitingRequest == expecting to receive HHttpRequestHeader, otherwise
     // expecting to receive HHttpResponseHeader
@@ -0,0 +1,289 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hhttp_connectionpool_p.h"
+
+#include "../general/hlogger_p.h"
+
+#include <QtCore/QUrl>
+#include <QtNetwork/QTcpSocket>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+/*******************************************************************************
+ * HHttpConnectionPool
+ ******************************************************************************/
+HHttpConnectionPool::HHttpConnectionPool(
+    const QByteArray& loggingIdentifier, qint32 maxConnectionsPerHost,
+    qint32 idleTimeout, QObject* parent) :
+        QObject(parent),
+            m_loggingIdentifier(loggingIdentifier),
+            m_maxConnectionsPerHost(maxConnectionsPerHost),
+            m_idleTimeout(idleTimeout),
+            m_connections(),
+            m_idleConnections(),
+            m_idleSince(),
+            m_connectionCounts(),
+            m_evictionTimer(this),
+            m_statistics()
+{
+    bool ok = connect(
+        &m_evictionTimer, SIGNAL(timeout()), this, SLOT(evictIdleConnections()));
+
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    if (m_idleTimeout > 0)
+    {
+        m_evictionTimer.setInterval(qMax(500, m_idleTimeout / 2));
+    }
+}
+
+HHttpConnectionPool::~HHttpConnectionPool()
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    HLOG_DBG(QString(
+        "Connection pool statistics: created [%1], reused [%2], evicted [%3], "
+        "discarded [%4], deferred [%5]").arg(
+            QString::number(m_statistics.m_connectionsCreated),
+            QString::number(m_statistics.m_connectionsReused),
+            QString::number(m_statistics.m_connectionsEvicted),
+            QString::number(m_statistics.m_connectionsDiscarded),
+            QString::number(m_statistics.m_acquisitionsDeferred)));
+
+    clear();
+}
+
+void HHttpConnectionPool::removeIdle(QTcpSocket* sock)
+{
+    if (!m_idleSince.remove(sock))
+    {
+        return;
+    }
+
+    HostKey key = m_connections.value(sock);
+
+    QHash<HostKey, QList<QTcpSocket*> >::iterator it =
+        m_idleConnections.find(key);
+
+    if (it != m_idleConnections.end())
+    {
+        it->removeOne(sock);
+        if (it->isEmpty())
+        {
+            m_idleConnections.erase(it);
+        }
+    }
+}
+
+void HHttpConnectionPool::discard(QTcpSocket* sock)
+{
+    Q_ASSERT(m_connections.contains(sock));
+
+    removeIdle(sock);
+
+    HostKey key = m_connections.take(sock);
+
+    qint32& count = m_connectionCounts[key];
+    if (--count <= 0)
+    {
+        m_connectionCounts.remove(key);
+    }
+
+    sock->disconnect(this);
+    if (sock->state() != QAbstractSocket::UnconnectedState)
+    {
+        sock->disconnectFromHost();
+    }
+    sock->deleteLater();
+
+    emit connectionAvailable(key.first, key.second);
+}
+
+void HHttpConnectionPool::evictIdleConnections()
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    QList<QTcpSocket*> expired;
+
+    QHash<QTcpSocket*, QElapsedTimer>::const_iterator ci =
+        m_idleSince.constBegin();
+    for(; ci != m_idleSince.constEnd(); ++ci)
+    {
+        if (ci.value().elapsed() >= m_idleTimeout)
+        {
+            expired.append(ci.key());
+        }
+    }
+
+    foreach(QTcpSocket* sock, expired)
+    {
+        ++m_statistics.m_connectionsEvicted;
+        discard(sock);
+    }
+
+    if (m_idleSince.isEmpty())
+    {
+        m_evictionTimer.stop();
+    }
+}
+
+void HHttpConnectionPool::connectionClosed()
+{
+    QTcpSocket* sock = qobject_cast<QTcpSocket*>(sender());
+    if (!sock || !m_idleSince.contains(sock))
+    {
+        // connections in use are handled by their current user
+        return;
+    }
+
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+    HLOG_DBG(QString("Idle connection to [%1:%2] closed by peer").arg(
+        sock->peerName(), QString::number(sock->peerPort())));
+
+    discard(sock);
+}
+
+QTcpSocket* HHttpConnectionPool::acquire(const QUrl& url)
+{
+    return acquire(url.host(), url.port(80));
+}
+
+QTcpSocket* HHttpConnectionPool::acquire(const QString& host, quint16 port)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    HostKey key(host.toLower(), port);
+
+    QHash<HostKey, QList<QTcpSocket*> >::iterator it =
+        m_idleConnections.find(key);
+
+    while(it != m_idleConnections.end() && !it->isEmpty())
+    {
+        QTcpSocket* sock = it->last();
+        removeIdle(sock);
+
+        if (sock->state() == QTcpSocket::ConnectedState &&
+            !sock->bytesAvailable())
+        {
+            ++m_statistics.m_connectionsReused;
+            return sock;
+        }
+
+        // the connection is half-closed or the peer has sent something
+        // unexpected; either way it cannot be used for a new request
+        discard(sock);
+        it = m_idleConnections.find(key);
+    }
+
+    if (m_maxConnectionsPerHost > 0 &&
+        m_connectionCounts.value(key) >= m_maxConnectionsPerHost)
+    {
+        ++m_statistics.m_acquisitionsDeferred;
+        return 0;
+    }
+
+    QTcpSocket* sock = new QTcpSocket(this);
+
+    bool ok = connect(sock, SIGNAL(disconnected()), this, SLOT(connectionClosed()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    m_connections.insert(sock, key);
+    ++m_connectionCounts[key];
+    ++m_statistics.m_connectionsCreated;
+
+    sock->connectToHost(host, port);
+
+    return sock;
+}
+
+void HHttpConnectionPool::release(QTcpSocket* sock, bool keepAlive)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    Q_ASSERT(sock);
+
+    if (!m_connections.contains(sock) || m_idleSince.contains(sock))
+    {
+        return;
+    }
+
+    // the previous user may have left connections to the socket's signals
+    sock->disconnect();
+
+    bool ok = connect(sock, SIGNAL(disconnected()), this, SLOT(connectionClosed()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    if (!keepAlive || m_idleTimeout <= 0 ||
+        sock->state() != QTcpSocket::ConnectedState || sock->bytesAvailable())
+    {
+        ++m_statistics.m_connectionsDiscarded;
+        discard(sock);
+        return;
+    }
+
+    HostKey key = m_connections.value(sock);
+
+    m_idleConnections[key].append(sock);
+    m_idleSince[sock].start();
+
+    if (!m_evictionTimer.isActive())
+    {
+        m_evictionTimer.start();
+    }
+
+    emit connectionAvailable(key.first, key.second);
+}
+
+bool HHttpConnectionPool::owns(const QTcpSocket* sock) const
+{
+    return m_connections.contains(const_cast<QTcpSocket*>(sock));
+}
+
+qint32 HHttpConnectionPool::connectionCount() const
+{
+    return m_connections.size();
+}
+
+qint32 HHttpConnectionPool::idleConnectionCount() const
+{
+    return m_idleSince.size();
+}
+
+void HHttpConnectionPool::clear()
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    m_evictionTimer.stop();
+
+    QList<QTcpSocket*> idle = m_idleSince.keys();
+    foreach(QTcpSocket* sock, idle)
+    {
+        discard(sock);
+    }
+}
+
+}
+}
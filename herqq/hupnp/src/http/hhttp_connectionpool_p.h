@@ -0,0 +1,196 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HHTTP_CONNECTIONPOOL_P_H_
+#define HHTTP_CONNECTIONPOOL_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "../general/hupnp_defs.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QPair>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QTimer>
+#include <QtCore/QObject>
+#include <QtCore/QString>
+
+class QUrl;
+class QTcpSocket;
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+//
+// Counters describing how an HHttpConnectionPool has been utilized.
+//
+class HHttpConnectionPoolStatistics
+{
+public:
+
+    quint32 m_connectionsCreated;
+    // the number of new TCP connections opened by the pool
+
+    quint32 m_connectionsReused;
+    // the number of times an idle keep-alive connection was handed out
+    // instead of opening a new one
+
+    quint32 m_connectionsEvicted;
+    // the number of idle connections closed due to the idle timeout
+
+    quint32 m_connectionsDiscarded;
+    // the number of connections closed upon release, since they could not
+    // be kept alive
+
+    quint32 m_acquisitionsDeferred;
+    // the number of acquisitions that were refused due to the
+    // per-host connection limit
+
+    inline HHttpConnectionPoolStatistics() :
+        m_connectionsCreated(0), m_connectionsReused(0),
+        m_connectionsEvicted(0), m_connectionsDiscarded(0),
+        m_acquisitionsDeferred(0)
+    {
+    }
+};
+
+//
+// A pool of keep-alive TCP connections keyed by (host, port).
+//
+// Sockets acquired from the pool are owned by the pool and they have to be
+// returned using release() once the HTTP exchange is complete. A socket returned
+// from acquire() is either connected (a reused keep-alive connection) or
+// connecting, in which case the caller has to wait for the connected() or
+// error() signal of the socket before using it.
+//
+// When the per-host connection limit is reached acquire() returns null and
+// the caller should retry once connectionAvailable() is emitted for the host.
+//
+// This class is not thread-safe.
+//
+class HHttpConnectionPool :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HHttpConnectionPool)
+
+private:
+
+    typedef QPair<QString, quint16> HostKey;
+
+    const QByteArray m_loggingIdentifier;
+
+    qint32 m_maxConnectionsPerHost;
+    // the maximum number of connections (idle + in use) to a single host.
+    // zero or negative means no limit.
+
+    qint32 m_idleTimeout;
+    // the time in milliseconds an idle connection is kept open.
+    // zero or negative disables keep-alive altogether.
+
+    QHash<QTcpSocket*, HostKey> m_connections;
+    // every connection owned by the pool, idle or in use
+
+    QHash<HostKey, QList<QTcpSocket*> > m_idleConnections;
+    // connections available for reuse, the most recently released last
+
+    QHash<QTcpSocket*, QElapsedTimer> m_idleSince;
+    // measures how long each idle connection has been idle. a monotonic clock
+    // is used, so that changes to the system time do not affect eviction
+
+    QHash<HostKey, qint32> m_connectionCounts;
+
+    QTimer m_evictionTimer;
+
+    HHttpConnectionPoolStatistics m_statistics;
+
+private:
+
+    void discard(QTcpSocket*);
+    void removeIdle(QTcpSocket*);
+
+private Q_SLOTS:
+
+    void evictIdleConnections();
+    void connectionClosed();
+
+Q_SIGNALS:
+
+    // emitted when a connection to the specified host has been released back
+    // to the pool or closed, i.e. when a previously refused acquire()
+    // may succeed
+    void connectionAvailable(const QString& host, quint16 port);
+
+public:
+
+    HHttpConnectionPool(
+        const QByteArray& loggingIdentifier,
+        qint32 maxConnectionsPerHost, qint32 idleTimeout,
+        QObject* parent = 0);
+
+    virtual ~HHttpConnectionPool();
+
+    QTcpSocket* acquire(const QString& host, quint16 port);
+    QTcpSocket* acquire(const QUrl& url);
+
+    // returns the socket into the pool. if keepAlive is false or the
+    // socket is not in a reusable state, the connection is closed.
+    void release(QTcpSocket*, bool keepAlive);
+
+    bool owns(const QTcpSocket*) const;
+
+    qint32 connectionCount() const;
+    qint32 idleConnectionCount() const;
+
+    inline const HHttpConnectionPoolStatistics& statistics() const
+    {
+        return m_statistics;
+    }
+
+    inline qint32 maxConnectionsPerHost() const
+    {
+        return m_maxConnectionsPerHost;
+    }
+
+    inline qint32 idleTimeout() const
+    {
+        return m_idleTimeout;
+    }
+
+    // closes every idle connection. the connections in use are not affected
+    // and they are pooled or closed as usual when they are released.
+    void clear();
+};
+
+}
+}
+
+#endif /* HHTTP_CONNECTIONPOOL_P_H_ */
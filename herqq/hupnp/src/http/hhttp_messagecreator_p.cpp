@@ -30,6 +30,10 @@
 
 #include "../general/hupnp_global_p.h"
 
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtNetwork/QHostAddress>
+
 #include <QtSoapMessage>
 
 namespace Herqq
@@ -117,69 +121,164 @@ QString contentTypeToString(ContentType ct)
     case ContentType_OctetStream:
         retVal = "application/octet-stream";
         break;
+    case ContentType_ImagePng:
+        retVal = "image/png";
+        break;
+    case ContentType_ImageJpeg:
+        retVal = "image/jpeg";
+        break;
+    case ContentType_ImageGif:
+        retVal = "image/gif";
+        break;
+    case ContentType_ImageBmp:
+        retVal = "image/bmp";
+        break;
     default:
         ;
     }
     return retVal;
 }
 
-void getStatusInfo(StatusCode sc, qint32* statusCode, QString* reasonPhrase)
+//
+// The messages HUPnP sends most often, such as the responses to action
+// invocations and event notifications, differ from each other only in a few
+// header fields. The fixed parts are pre-rendered below and the variable
+// parts are appended as bytes, which avoids building these messages through
+// HHttpHeader and the QString conversions it requires.
+//
+const char* statusLine(StatusCode sc)
 {
     switch(sc)
     {
     case Ok:
-        *statusCode = 200;
-        *reasonPhrase = "OK";
-        break;
+        return "HTTP/1.1 200 OK\r\n";
 
     case BadRequest:
-        *statusCode = 400;
-        *reasonPhrase = "Bad Request";
-        break;
+        return "HTTP/1.1 400 Bad Request\r\n";
 
     case IncompatibleHeaderFields:
-        *statusCode = 400;
-        *reasonPhrase = "Incompatible header fields";
-        break;
+        return "HTTP/1.1 400 Incompatible header fields\r\n";
 
     case Unauthorized:
-        *statusCode = 401;
-        *reasonPhrase = "Unauthorized";
-        break;
+        return "HTTP/1.1 401 Unauthorized\r\n";
 
     case Forbidden:
-        *statusCode = 403;
-        *reasonPhrase = "Forbidden";
-        break;
+        return "HTTP/1.1 403 Forbidden\r\n";
 
     case NotFound:
-        *statusCode = 404;
-        *reasonPhrase = "Not Found";
-        break;
+        return "HTTP/1.1 404 Not Found\r\n";
 
     case MethotNotAllowed:
-        *statusCode = 405;
-        *reasonPhrase = "Method Not Allowed";
-        break;
+        return "HTTP/1.1 405 Method Not Allowed\r\n";
 
     case PreconditionFailed:
-        *statusCode = 412;
-        *reasonPhrase = "Precondition Failed";
-        break;
+        return "HTTP/1.1 412 Precondition Failed\r\n";
 
     case InternalServerError:
-        *statusCode = 500;
-        *reasonPhrase = "Internal Server Error";
-        break;
+        return "HTTP/1.1 500 Internal Server Error\r\n";
 
     case ServiceUnavailable:
-        *statusCode = 503;
-        *reasonPhrase = "Service Unavailable";
-        break;
+        return "HTTP/1.1 503 Service Unavailable\r\n";
 
     default:
         Q_ASSERT(false);
+        return "HTTP/1.1 500 Internal Server Error\r\n";
+    }
+}
+
+const char* contentTypeField(ContentType ct)
+{
+    switch(ct)
+    {
+    case ContentType_TextXml:
+        return "CONTENT-TYPE: text/xml; charset=\"utf-8\"\r\n";
+    case ContentType_OctetStream:
+        return "CONTENT-TYPE: application/octet-stream\r\n";
+    case ContentType_ImagePng:
+        return "CONTENT-TYPE: image/png\r\n";
+    case ContentType_ImageJpeg:
+        return "CONTENT-TYPE: image/jpeg\r\n";
+    case ContentType_ImageGif:
+        return "CONTENT-TYPE: image/gif\r\n";
+    case ContentType_ImageBmp:
+        return "CONTENT-TYPE: image/bmp\r\n";
+    default:
+        return 0;
+    }
+}
+
+const char NotifyFields[] =
+    "NT: upnp:event\r\n"
+    "NTS: upnp:propchange\r\n";
+
+const qint32 HeaderReservation = 512;
+
+QMutex s_dateMutex;
+uint s_dateSecs = 0;
+QByteArray s_date;
+
+// the value of the DATE header field changes only once a second, so it is
+// rendered once and shared by all the messages created during that second
+QByteArray currentDate()
+{
+    QDateTime now = QDateTime::currentDateTime();
+    uint secs = now.toTime_t();
+
+    QMutexLocker lock(&s_dateMutex);
+    if (secs != s_dateSecs || s_date.isEmpty())
+    {
+        s_date = now.toString(HHttpUtils::rfc1123DateFormat()).toLatin1();
+        s_dateSecs = secs;
+    }
+
+    return s_date;
+}
+
+inline void appendField(QByteArray& hdr, const char* name, const QByteArray& value)
+{
+    hdr.append(name).append(": ").append(value).append("\r\n");
+}
+
+// appends the fields setupData() sets to every message and the empty line
+// that ends the header
+void appendCommonFields(
+    QByteArray& hdr, const HMessagingInfo& mi, qint64 bodySizeInBytes,
+    ContentType ct)
+{
+    appendField(hdr, "DATE", currentDate());
+
+    const char* contentType = contentTypeField(ct);
+    if (contentType)
+    {
+        hdr.append(contentType);
+    }
+
+    hdr.append("EXT: \r\n");
+
+    HProductTokens serverTokens = mi.serverInfo();
+    if (!serverTokens.isEmpty())
+    {
+        appendField(hdr, "SERVER", serverTokens.toString().toUtf8());
+    }
+
+    if (!mi.keepAlive())
+    {
+        hdr.append("CONNECTION: close\r\n");
+    }
+
+    appendField(hdr, "HOST", mi.hostInfo().toUtf8());
+
+    if (mi.chunkedInfo().max() > 0 &&
+        bodySizeInBytes > mi.chunkedInfo().max())
+    {
+        hdr.append("TRANSFER-ENCODING: chunked\r\n");
+    }
+    else
+    {
+        appendField(hdr, "CONTENT-LENGTH", QByteArray::number(bodySizeInBytes));
     }
+
+    hdr.append("\r\n");
 }
 
 }
@@ -260,40 +359,65 @@ QByteArray HHttpMessageCreator::setupData(
 QByteArray HHttpMessageCreator::createResponse(
     StatusCode sc, const HMessagingInfo& mi)
 {
-    return createResponse(sc, mi, QByteArray(), ContentType_Undefined);
+    return createHeaderData(sc, mi, 0, ContentType_Undefined);
 }
 
 QByteArray HHttpMessageCreator::createHeaderData(
     StatusCode sc, const HMessagingInfo& mi, qint64 bodySizeInBytes,
-    ContentType ct)
+    ContentType ct, const QString& etag)
 {
-    qint32 statusCode = 0;
-    QString reasonPhrase = "";
+    QByteArray hdr;
+    hdr.reserve(HeaderReservation);
 
-    getStatusInfo(sc, &statusCode, &reasonPhrase);
+    hdr.append(statusLine(sc));
 
-    HHttpResponseHeader responseHdr(statusCode, reasonPhrase);
-    return setupData(responseHdr, bodySizeInBytes, mi, ct);
+    if (!etag.isEmpty())
+    {
+        appendField(hdr, "ETAG", etag.toLatin1());
+    }
+
+    appendCommonFields(hdr, mi, bodySizeInBytes, ct);
+    return hdr;
 }
 
 QByteArray HHttpMessageCreator::createResponse(
     StatusCode sc, const HMessagingInfo& mi, const QByteArray& body, ContentType ct)
 {
-    qint32 statusCode = 0;
-    QString reasonPhrase;
-
-    getStatusInfo(sc, &statusCode, &reasonPhrase);
+    QByteArray msg = createHeaderData(sc, mi, body.size(), ct);
+    msg.append(body);
 
-    HHttpResponseHeader responseHdr(statusCode, reasonPhrase);
-    return setupData(responseHdr, body, mi, ct);
+    return msg;
 }
 
-QByteArray HHttpMessageCreator::setupData(
-    const HMessagingInfo& mi, qint32 statusCode, const QString& reasonPhrase,
-    const QString& body, ContentType ct)
+QByteArray HHttpMessageCreator::createNotModifiedResponse(
+    const HMessagingInfo& mi, const QString& etag)
 {
-    HHttpResponseHeader responseHdr(statusCode, reasonPhrase);
-    return setupData(responseHdr, body.toUtf8(), mi, ct);
+    HLOG(H_AT, H_FUN);
+
+    // A 304 response never has a body and the headers describing the body
+    // of the 200 response are left out, which is why appendCommonFields()
+    // is not used.
+    QByteArray hdr;
+    hdr.reserve(HeaderReservation);
+
+    hdr.append("HTTP/1.1 304 Not Modified\r\n");
+
+    appendField(hdr, "DATE", currentDate());
+    appendField(hdr, "ETAG", etag.toLatin1());
+
+    HProductTokens serverTokens = mi.serverInfo();
+    if (!serverTokens.isEmpty())
+    {
+        appendField(hdr, "SERVER", serverTokens.toString().toUtf8());
+    }
+
+    if (!mi.keepAlive())
+    {
+        hdr.append("CONNECTION: close\r\n");
+    }
+
+    hdr.append("\r\n");
+    return hdr;
 }
 
 QByteArray HHttpMessageCreator::createResponse(
@@ -315,33 +439,71 @@ QByteArray HHttpMessageCreator::createResponse(
     detail->insert(new QtSoapSimpleType(QtSoapQName("errorDescription"), description));
     soapFaultResponse.addFaultDetail(detail);
 
-    return setupData(
-        mi,
-        httpStatusCode,
-        httpReasonPhrase,
-        soapFaultResponse.toXmlString(),
-        ContentType_TextXml);
+    QByteArray body = soapFaultResponse.toXmlString().toUtf8();
+
+    QByteArray msg;
+    msg.reserve(HeaderReservation + body.size());
+
+    msg.append("HTTP/1.1 ").append(QByteArray::number(httpStatusCode)).append(
+        ' ').append(httpReasonPhrase.toUtf8()).append("\r\n");
+
+    appendCommonFields(msg, mi, body.size(), ContentType_TextXml);
+
+    msg.append(body);
+    return msg;
 }
 
-QByteArray HHttpMessageCreator::create(
+QByteArray HHttpMessageCreator::createHeader(
     const HNotifyRequest& req, HMessagingInfo* mi)
 {
     Q_ASSERT(req.isValid(true));
 
-    HHttpRequestHeader reqHdr;
-    reqHdr.setContentType("Content-type: text/xml; charset=\"utf-8\"");
+    mi->setHostInfo(req.callback());
+
+    QByteArray hdr;
+    hdr.reserve(HeaderReservation);
 
-    reqHdr.setRequest(
-        "NOTIFY", extractRequestPart(req.callback().toString()));
+    hdr.append("NOTIFY ").append(
+        extractRequestPart(req.callback().toString()).toUtf8()).append(
+            " HTTP/1.1\r\n");
 
-    mi->setHostInfo(req.callback());
+    hdr.append(NotifyFields);
+    appendField(hdr, "SID", req.sid().toString().toLatin1());
+    appendField(hdr, "SEQ", QByteArray::number(req.seq()));
+
+    appendCommonFields(hdr, *mi, req.data().size(), ContentType_TextXml);
+    return hdr;
+}
+
+QByteArray HHttpMessageCreator::create(const HMulticastNotifyRequest& req)
+{
+    Q_ASSERT(req.isValid(false));
+
+    QByteArray msg;
+    msg.reserve(HeaderReservation + req.data().size());
+
+    msg.append("NOTIFY * HTTP/1.1\r\n");
+
+    appendField(msg, "HOST", QString("%1:%2").arg(
+        HMulticastNotifyRequest::multicastAddress().toString(),
+        QString::number(HMulticastNotifyRequest::multicastPort())).toLatin1());
+
+    msg.append(contentTypeField(ContentType_TextXml));
+    appendField(msg, "USN", req.usn().toString().toUtf8());
+    appendField(msg, "SVCID", req.serviceId().toString().toUtf8());
+    msg.append(NotifyFields);
+    appendField(msg, "SEQ", QByteArray::number(req.seq()));
+    appendField(msg, "LVL", req.level().toLatin1());
+
+    if (req.bootId() >= 0)
+    {
+        appendField(msg, "BOOTID.UPNP.ORG", QByteArray::number(req.bootId()));
+    }
 
-    reqHdr.setValue("SID", req.sid().toString());
-    reqHdr.setValue("SEQ", QString::number(req.seq()));
-    reqHdr.setValue("NT" , "upnp:event");
-    reqHdr.setValue("NTS", "upnp:propchange");
+    appendField(msg, "CONTENT-LENGTH", QByteArray::number(req.data().size()));
+    msg.append("\r\n").append(req.data());
 
-    return setupData(reqHdr, req.data(), *mi, ContentType_TextXml);
+    return msg;
 }
 
 QByteArray HHttpMessageCreator::create(
@@ -444,6 +606,35 @@ int HHttpMessageCreator::create(
     return retVal;
 }
 
+int HHttpMessageCreator::create(
+    const HHttpRequestHeader& reqHdr, const QByteArray& body,
+    HMulticastNotifyRequest& req)
+{
+    HLOG(H_AT, H_FUN);
+
+    QString nt     = reqHdr.value("NT"   );
+    QString nts    = reqHdr.value("NTS"  );
+    QString usn    = reqHdr.value("USN"  );
+    QString svcId  = reqHdr.value("SVCID");
+    QString seqStr = reqHdr.value("SEQ"  );
+    QString level  = reqHdr.value("LVL"  );
+    QString bootId = reqHdr.value("BOOTID.UPNP.ORG");
+
+    if (level.isEmpty())
+    {
+        // the field is mandatory, but there is little point in rejecting
+        // an otherwise valid event because of it
+        level = "upnp:/info";
+    }
+
+    HMulticastNotifyRequest nreq;
+    HMulticastNotifyRequest::RetVal retVal =
+        nreq.setContents(nt, nts, usn, svcId, seqStr, level, bootId, body);
+
+    req = nreq;
+    return retVal;
+}
+
 int HHttpMessageCreator::create(
     const HHttpRequestHeader& reqHdr, HSubscribeRequest& req)
 {
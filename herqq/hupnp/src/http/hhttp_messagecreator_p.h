@@ -45,6 +45,7 @@ namespace Upnp
 {
 
 class HNotifyRequest;
+class HMulticastNotifyRequest;
 class HSubscribeRequest;
 class HUnsubscribeRequest;
 class HSubscribeResponse;
@@ -61,21 +62,15 @@ class H_UPNP_CORE_EXPORT HHttpMessageCreator
 {
 H_FORCE_SINGLETON(HHttpMessageCreator)
 
-private:
+public:
 
-    static QByteArray setupData(
-        const HMessagingInfo&, qint32 statusCode,
-        const QString& reasonPhrase, const QString& body,
-        ContentType);
+    static QByteArray setupData(HHttpHeader& hdr, const HMessagingInfo&);
 
+    // creates only the header, the body is expected to be sent separately
     static QByteArray setupData(
-        HHttpHeader& reqHdr, qint64 bodySizeBytesInBytes, const HMessagingInfo& mi,
+        HHttpHeader& reqHdr, qint64 bodySizeInBytes, const HMessagingInfo& mi,
         ContentType);
 
-public:
-
-    static QByteArray setupData(HHttpHeader& hdr, const HMessagingInfo&);
-
     static QByteArray setupData(
         HHttpHeader& hdr, const QByteArray& body, const HMessagingInfo&,
         ContentType);
@@ -83,17 +78,27 @@ public:
     static QByteArray createResponse(
         StatusCode sc, const HMessagingInfo& mi);
 
+    // creates only the header, the body is expected to be sent separately
     static QByteArray createHeaderData(
-        StatusCode, const HMessagingInfo&, qint64 bodySizeInBytes, ContentType);
+        StatusCode, const HMessagingInfo&, qint64 bodySizeInBytes, ContentType,
+        const QString& etag = QString());
 
     static QByteArray createResponse(
         StatusCode, const HMessagingInfo&, const QByteArray& body,
         ContentType);
 
+    static QByteArray createNotModifiedResponse(
+        const HMessagingInfo&, const QString& etag);
+
     static QByteArray createResponse(
         const HMessagingInfo&, qint32 actionErrCode, const QString& msg=QString());
 
-    static QByteArray create(const HNotifyRequest&     , HMessagingInfo*);
+    // creates only the header, the body is HNotifyRequest::data()
+    static QByteArray createHeader(const HNotifyRequest&, HMessagingInfo*);
+
+    // creates the entire datagram, as a multicast event is sent over UDP
+    static QByteArray create(const HMulticastNotifyRequest&);
+
     static QByteArray create(const HSubscribeRequest&  , const HMessagingInfo&);
     static QByteArray create(const HUnsubscribeRequest&, HMessagingInfo*);
     static QByteArray create(const HSubscribeResponse& , const HMessagingInfo&);
@@ -102,6 +107,10 @@ public:
         const HHttpRequestHeader& reqHdr, const QByteArray& body,
         HNotifyRequest& req);
 
+    static int create(
+        const HHttpRequestHeader& reqHdr, const QByteArray& body,
+        HMulticastNotifyRequest& req);
+
     static int create(
         const HHttpRequestHeader& reqHdr, HSubscribeRequest& req);
 
@@ -39,7 +39,8 @@ HMessagingInfo::HMessagingInfo(
     QPair<QTcpSocket*, bool> sock, qint32 receiveTimeoutForNoData) :
         m_sock(), m_keepAlive(false),
         m_receiveTimeoutForNoData(receiveTimeoutForNoData),
-        m_chunkedInfo(), m_msecsToWaitOnSend(-1)
+        m_chunkedInfo(), m_msecsToWaitOnSend(-1),
+        m_headerReadTimeout(-1), m_bodyReadTimeout(-1), m_sendHighWaterMark(0)
 {
     m_sock = qMakePair(QPointer<QTcpSocket>(sock.first), sock.second);
 }
@@ -48,7 +49,8 @@ HMessagingInfo::HMessagingInfo(
     QTcpSocket& sock, qint32 receiveTimeoutForNoData) :
         m_sock(), m_keepAlive(false),
         m_receiveTimeoutForNoData(receiveTimeoutForNoData),
-        m_chunkedInfo(), m_msecsToWaitOnSend(-1)
+        m_chunkedInfo(), m_msecsToWaitOnSend(-1),
+        m_headerReadTimeout(-1), m_bodyReadTimeout(-1), m_sendHighWaterMark(0)
 {
     m_sock = qMakePair(QPointer<QTcpSocket>(&sock), false);
 }
@@ -57,7 +59,8 @@ HMessagingInfo::HMessagingInfo(
     QPair<QTcpSocket*, bool> sock, bool keepAlive, qint32 receiveTimeoutForNoData) :
         m_sock(), m_keepAlive(keepAlive),
         m_receiveTimeoutForNoData(receiveTimeoutForNoData),
-        m_msecsToWaitOnSend(-1)
+        m_msecsToWaitOnSend(-1),
+        m_headerReadTimeout(-1), m_bodyReadTimeout(-1), m_sendHighWaterMark(0)
 {
     m_sock = qMakePair(QPointer<QTcpSocket>(sock.first), sock.second);
 }
@@ -66,7 +69,8 @@ HMessagingInfo::HMessagingInfo(
     QTcpSocket& sock, bool keepAlive, qint32 receiveTimeoutForNoData) :
         m_sock(), m_keepAlive(keepAlive),
         m_receiveTimeoutForNoData(receiveTimeoutForNoData),
-        m_msecsToWaitOnSend(-1)
+        m_msecsToWaitOnSend(-1),
+        m_headerReadTimeout(-1), m_bodyReadTimeout(-1), m_sendHighWaterMark(0)
 {
     m_sock = qMakePair(QPointer<QTcpSocket>(&sock), false);
 }
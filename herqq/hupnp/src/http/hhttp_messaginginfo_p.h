@@ -27,6 +27,7 @@
 
 #include <QtCore/QPair>
 #include <QtCore/QString>
+#include <QtCore/QByteArray>
 #include <QtCore/QPointer>
 #include <QtNetwork/QTcpSocket>
 
@@ -105,6 +106,24 @@ private:
 
     HProductTokens m_serverTokens;
 
+    qint32 m_headerReadTimeout;
+    // the time in milliseconds a receive may take before the entire HTTP
+    // header is read. zero or negative means no limit.
+
+    qint32 m_bodyReadTimeout;
+    // the time in milliseconds a receive may take to read the body once the
+    // header is read. zero or negative means no limit.
+
+    qint64 m_sendHighWaterMark;
+    // the number of bytes the socket's write buffer may contain before
+    // a send stops writing and waits for the buffer to drain.
+    // zero or negative means no limit.
+
+    QByteArray m_receiveBuffer;
+    // scratch space for the incoming HTTP header and chunk-size lines, which
+    // is kept for the lifetime of the connection so that it can be reused
+    // by every message read from it
+
 public:
 
      //
@@ -207,6 +226,37 @@ public:
     {
         return m_serverTokens;
     }
+
+    inline void setReadTimeouts(qint32 headerTimeout, qint32 bodyTimeout)
+    {
+        m_headerReadTimeout = headerTimeout;
+        m_bodyReadTimeout = bodyTimeout;
+    }
+
+    inline qint32 headerReadTimeout() const
+    {
+        return m_headerReadTimeout;
+    }
+
+    inline qint32 bodyReadTimeout() const
+    {
+        return m_bodyReadTimeout;
+    }
+
+    inline void setSendHighWaterMark(qint64 bytes)
+    {
+        m_sendHighWaterMark = bytes;
+    }
+
+    inline qint64 sendHighWaterMark() const
+    {
+        return m_sendHighWaterMark;
+    }
+
+    inline QByteArray& receiveBuffer()
+    {
+        return m_receiveBuffer;
+    }
 };
 
 
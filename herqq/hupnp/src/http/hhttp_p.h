@@ -41,7 +41,11 @@ enum ContentType
     ContentType_Undefined,
     ContentType_TextPlain,   // text/plain
     ContentType_TextXml,     // "text/xml; charset=\"utf-8\""
-    ContentType_OctetStream  // "application/octet-stream"
+    ContentType_OctetStream, // "application/octet-stream"
+    ContentType_ImagePng,    // "image/png"
+    ContentType_ImageJpeg,   // "image/jpeg"
+    ContentType_ImageGif,    // "image/gif"
+    ContentType_ImageBmp     // "image/bmp"
 };
 
 enum StatusCode
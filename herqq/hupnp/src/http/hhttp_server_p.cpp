@@ -39,6 +39,7 @@
 #include <QtCore/QString>
 #include <QtCore/QByteArray>
 #include <QtNetwork/QTcpSocket>
+#include <QtNetwork/QHostAddress>
 
 namespace Herqq
 {
@@ -65,6 +66,10 @@ void HHttpServer::Server::incomingConnection(qint32 socketDescriptor)
 HHttpServer::HHttpServer(const QByteArray& loggingIdentifier, QObject* parent) :
     QObject(parent),
         m_servers(),
+        m_limits(),
+        m_statistics(),
+        m_connections(),
+        m_connectionsPerPeer(),
         m_loggingIdentifier(loggingIdentifier),
         m_httpHandler(new HHttpAsyncHandler(m_loggingIdentifier, this)),
         m_chunkedInfo(),
@@ -171,6 +176,11 @@ void HHttpServer::msgIoComplete(HHttpAsyncOperation* op)
     HMessagingInfo* mi = op->messagingInfo();
     if (op->state() == HHttpAsyncOperation::Failed)
     {
+        if (op->timedOut() && op->opType() == HHttpAsyncOperation::ReceiveRequest)
+        {
+            ++m_statistics.m_connectionsTimedOut;
+        }
+
         HLOG_DBG(QString("HTTP failure: [%1]").arg(mi->lastErrorDescription()));
         return;
     }
@@ -214,11 +224,42 @@ void HHttpServer::processRequest(qint32 socketDescriptor)
     client->setSocketDescriptor(socketDescriptor);
 
     QString peer = peerAsStr(*client);
-    HLOG_DBG(QString("Incoming connection from [%1]").arg(peer));
+    QString peerAddress = client->peerAddress().toString();
 
     HMessagingInfo* mi = new HMessagingInfo(qMakePair(client, true));
     mi->setChunkedInfo(m_chunkedInfo);
     mi->setServerInfo(HSysInfo::instance().herqqProductTokens());
+
+    if (!admit(peerAddress))
+    {
+        ++m_statistics.m_connectionsRejected;
+
+        HLOG_WARN(QString(
+            "Connection limit reached, rejecting connection from [%1]").arg(peer));
+
+        mi->setKeepAlive(false);
+        m_httpHandler->send(
+            mi, HHttpMessageCreator::createResponse(ServiceUnavailable, *mi));
+
+        return;
+    }
+
+    HLOG_DBG(QString("Incoming connection from [%1]").arg(peer));
+
+    ++m_statistics.m_connectionsAccepted;
+
+    m_connections.insert(client, peerAddress);
+    ++m_connectionsPerPeer[peerAddress];
+
+    bool ok = connect(
+        client, SIGNAL(destroyed(QObject*)),
+        this, SLOT(connectionDestroyed(QObject*)));
+
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    mi->setReadTimeouts(m_limits.m_headerReadTimeout, m_limits.m_bodyReadTimeout);
+    mi->setSendHighWaterMark(m_limits.m_sendHighWaterMark);
+
     if (!m_httpHandler->receive(mi, true))
     {
         HLOG_WARN(QString(
@@ -226,6 +267,42 @@ void HHttpServer::processRequest(qint32 socketDescriptor)
     }
 }
 
+bool HHttpServer::admit(const QString& peerAddress) const
+{
+    if (m_limits.m_maxConnections > 0 &&
+        m_connections.size() >= m_limits.m_maxConnections)
+    {
+        return false;
+    }
+
+    if (m_limits.m_maxConnectionsPerPeer > 0 &&
+        m_connectionsPerPeer.value(peerAddress) >= m_limits.m_maxConnectionsPerPeer)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+void HHttpServer::connectionDestroyed(QObject* socket)
+{
+    // the socket is partially destroyed at this point and it is used
+    // only as a key
+    QHash<QObject*, QString>::iterator it = m_connections.find(socket);
+    if (it == m_connections.end())
+    {
+        return;
+    }
+
+    QHash<QString, qint32>::iterator pit = m_connectionsPerPeer.find(it.value());
+    if (pit != m_connectionsPerPeer.end() && --pit.value() <= 0)
+    {
+        m_connectionsPerPeer.erase(pit);
+    }
+
+    m_connections.erase(it);
+}
+
 void HHttpServer::processNotifyMessage(
     HMessagingInfo* mi, const HHttpRequestHeader& hdr, const QByteArray& body)
 {
@@ -632,5 +709,10 @@ qint32 HHttpServer::maxBytesToLoad() const
     return m_maxBytesToLoad;
 }
 
+void HHttpServer::setLimits(const HHttpServerLimits& limits)
+{
+    m_limits = limits;
+}
+
 }
 }
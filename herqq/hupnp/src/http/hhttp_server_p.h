@@ -34,6 +34,7 @@
 #include <HUpnpCore/private/hhttp_asynchandler_p.h>
 #include <HUpnpCore/private/hhttp_messaginginfo_p.h>
 
+#include <QtCore/QHash>
 #include <QtNetwork/QTcpServer>
 
 class QUrl;
@@ -51,6 +52,66 @@ class HSubscribeRequest;
 class HUnsubscribeRequest;
 class HInvokeActionRequest;
 
+//
+// Limits an HHttpServer applies to the connections it accepts.
+//
+class HHttpServerLimits
+{
+public:
+
+    qint32 m_maxConnections;
+    // the maximum number of simultaneous connections accepted.
+    // zero or negative means no limit.
+
+    qint32 m_maxConnectionsPerPeer;
+    // the maximum number of simultaneous connections accepted from a single
+    // network address. zero or negative means no limit.
+
+    qint32 m_headerReadTimeout;
+    // the time in milliseconds a client has to send the header of a request,
+    // which includes the time an idle keep-alive connection is kept open.
+    // zero or negative means no limit.
+
+    qint32 m_bodyReadTimeout;
+    // the time in milliseconds a client has to send the body of a request
+    // once the header is read. zero or negative means no limit.
+
+    qint64 m_sendHighWaterMark;
+    // the number of bytes of a response that may be waiting in the write
+    // buffer of a connection before the rest of the response is held back.
+    // zero or negative means no limit.
+
+    inline HHttpServerLimits() :
+        m_maxConnections(128), m_maxConnectionsPerPeer(16),
+        m_headerReadTimeout(15000), m_bodyReadTimeout(30000),
+        m_sendHighWaterMark(256 * 1024)
+    {
+    }
+};
+
+//
+// Counters describing the connections an HHttpServer has handled.
+//
+class HHttpServerStatistics
+{
+public:
+
+    quint32 m_connectionsAccepted;
+
+    quint32 m_connectionsRejected;
+    // the number of connections refused due to the connection limits
+
+    quint32 m_connectionsTimedOut;
+    // the number of connections closed since a request was not received
+    // in time
+
+    inline HHttpServerStatistics() :
+        m_connectionsAccepted(0), m_connectionsRejected(0),
+        m_connectionsTimedOut(0)
+    {
+    }
+};
+
 //
 // Private class for handling HTTP server duties needed in UPnP messaging
 //
@@ -81,11 +142,20 @@ private:
 private Q_SLOTS:
 
     void msgIoComplete(HHttpAsyncOperation* op);
+    void connectionDestroyed(QObject*);
 
 private:
 
     QList<Server*> m_servers;
 
+    HHttpServerLimits m_limits;
+    HHttpServerStatistics m_statistics;
+
+    QHash<QObject*, QString> m_connections;
+    // the accepted connections and the network addresses of their peers
+
+    QHash<QString, qint32> m_connectionsPerPeer;
+
 protected:
 
     const QByteArray m_loggingIdentifier;
@@ -99,6 +169,7 @@ private:
     void processResponse(HHttpAsyncOperation*);
 
     void processRequest(qint32 socketDescriptor);
+    bool admit(const QString& peerAddress) const;
 
     void processNotifyMessage(
         HMessagingInfo*, const HHttpRequestHeader&, const QByteArray& body);
@@ -164,6 +235,17 @@ public:
     void close();
 
     qint32 maxBytesToLoad() const;
+
+    // the limits apply to connections accepted after the call
+    void setLimits(const HHttpServerLimits&);
+    inline const HHttpServerLimits& limits() const { return m_limits; }
+
+    inline const HHttpServerStatistics& statistics() const
+    {
+        return m_statistics;
+    }
+
+    inline qint32 connectionCount() const { return m_connections.size(); }
 };
 
 }
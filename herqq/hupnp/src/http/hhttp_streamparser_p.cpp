@@ -0,0 +1,530 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hhttp_streamparser_p.h"
+#include "hhttp_header_p.h"
+
+#include <QtCore/QIODevice>
+
+#include <cstring>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace
+{
+const qint32 MaxLineBufferSize = 64 * 1024;
+// the maximum size of an HTTP header, which also limits the size of
+// a chunk-size line
+
+const qint64 MaxBodySize = 1 << 30;
+
+const qint64 MaxBodyReservation = 1024 * 1024;
+// the maximum amount of memory reserved for a body up front, based on the
+// content length announced by the remote host
+
+inline qint32 indexOf(const char* data, qint32 size, char c, qint32 from)
+{
+    const void* found = memchr(data + from, c, size - from);
+    return found ? static_cast<const char*>(found) - data : -1;
+}
+
+inline bool isWhitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+inline void trim(const char* data, qint32* start, qint32* end)
+{
+    while(*start < *end && isWhitespace(data[*start]))
+    {
+        ++(*start);
+    }
+    while(*end > *start && isWhitespace(data[*end - 1]))
+    {
+        --(*end);
+    }
+}
+
+inline bool equalsIgnoreCase(const char* data, qint32 size, const char* str)
+{
+    qint32 len = static_cast<qint32>(qstrlen(str));
+    return size == len && qstrnicmp(data, str, len) == 0;
+}
+
+inline bool endsWithIgnoreCase(const char* data, qint32 size, const char* str)
+{
+    qint32 len = static_cast<qint32>(qstrlen(str));
+    return size >= len && qstrnicmp(data + size - len, str, len) == 0;
+}
+
+// fails in case the value is larger than MaxBodySize, which also keeps
+// the value from overflowing
+bool parseDecimal(const char* data, qint32 size, qint64* retVal)
+{
+    if (size <= 0)
+    {
+        return false;
+    }
+
+    qint64 value = 0;
+    for(qint32 i = 0; i < size; ++i)
+    {
+        if (data[i] < '0' || data[i] > '9')
+        {
+            return false;
+        }
+
+        value = value * 10 + (data[i] - '0');
+        if (value > MaxBodySize)
+        {
+            return false;
+        }
+    }
+
+    *retVal = value;
+    return true;
+}
+
+inline qint32 hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    else if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+    else if (c >= 'A' && c <= 'F')
+    {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+}
+
+/*******************************************************************************
+ * HHttpStreamParser
+ ******************************************************************************/
+HHttpStreamParser::HHttpStreamParser(bool requestExpected) :
+    m_requestExpected(requestExpected),
+    m_state(ReadingHeader),
+    m_header(0),
+    m_body(),
+    m_lineLength(0),
+    m_lineStart(0),
+    m_bodyRemaining(0),
+    m_terminatorRemaining(0),
+    m_errorDescription()
+{
+}
+
+HHttpStreamParser::~HHttpStreamParser()
+{
+    delete m_header;
+}
+
+void HHttpStreamParser::fail(const QString& errorDescription)
+{
+    m_errorDescription = errorDescription;
+    m_state = Failed;
+}
+
+bool HHttpStreamParser::readLine(QIODevice& device, QByteArray& lineBuffer)
+{
+    for(;;)
+    {
+        qint64 available = device.bytesAvailable();
+        if (available <= 0)
+        {
+            return false;
+        }
+
+        if (m_lineLength >= MaxLineBufferSize)
+        {
+            fail("HTTP header is too large");
+            return false;
+        }
+
+        qint32 room = static_cast<qint32>(
+            qMin(available, static_cast<qint64>(MaxLineBufferSize - m_lineLength)));
+
+        if (lineBuffer.size() < m_lineLength + room + 1)
+        {
+            // QIODevice::readLine() terminates the data with '\0'. The buffer
+            // is only ever grown, which keeps its memory around for the next
+            // line and the next message.
+            lineBuffer.resize(m_lineLength + room + 1);
+        }
+
+        qint64 read = device.readLine(lineBuffer.data() + m_lineLength, room + 1);
+        if (read < 0)
+        {
+            fail(QString("failed to read data: %1").arg(device.errorString()));
+            return false;
+        }
+        else if (read == 0)
+        {
+            return false;
+        }
+
+        m_lineLength += static_cast<qint32>(read);
+        if (lineBuffer.at(m_lineLength - 1) == '\n')
+        {
+            return true;
+        }
+    }
+}
+
+bool HHttpStreamParser::readBody(QIODevice& device)
+{
+    qint64 available = device.bytesAvailable();
+    if (available <= 0)
+    {
+        return false;
+    }
+
+    // the header and the chunk-size lines are checked against MaxBodySize,
+    // which keeps the size of the body well within the range of qint32
+    Q_ASSERT(m_body.size() + m_bodyRemaining <= MaxBodySize);
+
+    qint32 size = m_body.size();
+    qint32 count = static_cast<qint32>(qMin(available, m_bodyRemaining));
+
+    m_body.resize(size + count);
+
+    qint64 read = device.read(m_body.data() + size, count);
+    if (read < 0)
+    {
+        m_body.resize(size);
+        fail(QString("failed to read data: %1").arg(device.errorString()));
+        return false;
+    }
+    else if (read < count)
+    {
+        m_body.resize(size + static_cast<qint32>(read));
+    }
+
+    m_bodyRemaining -= read;
+    if (m_bodyRemaining > 0)
+    {
+        return false;
+    }
+
+    if (m_state == ReadingChunk)
+    {
+        m_terminatorRemaining = 2;
+        m_state = ReadingChunkTerminator;
+    }
+    else
+    {
+        m_state = Finished;
+    }
+
+    return true;
+}
+
+bool HHttpStreamParser::parseHeader(const QByteArray& lineBuffer)
+{
+    const char* data = lineBuffer.constData();
+    const qint32 size = m_lineLength;
+
+    bool chunked = false, hasContentLength = false;
+    qint64 contentLength = 0;
+
+    // Only the fields that frame the body are needed here. The start line and
+    // the rest of the fields are parsed by HHttpHeader.
+    qint32 lineStart = indexOf(data, size, '\n', 0) + 1;
+    while(lineStart > 0 && lineStart < size)
+    {
+        qint32 lineEnd = indexOf(data, size, '\n', lineStart);
+        if (lineEnd < 0)
+        {
+            lineEnd = size;
+        }
+
+        qint32 colon = indexOf(data, lineEnd, ':', lineStart);
+        if (colon > lineStart)
+        {
+            qint32 valueStart = colon + 1, valueEnd = lineEnd;
+            trim(data, &valueStart, &valueEnd);
+
+            const char* name = data + lineStart;
+            qint32 nameSize = colon - lineStart;
+
+            if (equalsIgnoreCase(name, nameSize, "content-length"))
+            {
+                if (!parseDecimal(
+                        data + valueStart, valueEnd - valueStart, &contentLength))
+                {
+                    fail(QString("invalid or too large Content-Length: [%1]").arg(
+                        QString::fromLatin1(
+                            data + valueStart, valueEnd - valueStart)));
+
+                    return false;
+                }
+
+                hasContentLength = true;
+            }
+            else if (equalsIgnoreCase(name, nameSize, "transfer-encoding"))
+            {
+                // chunked is always the last transfer-coding applied
+                chunked = endsWithIgnoreCase(
+                    data + valueStart, valueEnd - valueStart, "chunked");
+            }
+        }
+
+        lineStart = lineEnd + 1;
+    }
+
+    QString header = QString::fromUtf8(data, size);
+    m_lineLength = m_lineStart = 0;
+
+    if (m_requestExpected)
+    {
+        m_header = new HHttpRequestHeader(header);
+    }
+    else
+    {
+        m_header = new HHttpResponseHeader(header);
+    }
+
+    if (!m_header->isValid())
+    {
+        fail("read invalid HTTP header");
+        return false;
+    }
+
+    if (chunked)
+    {
+        if (hasContentLength)
+        {
+            fail("read invalid HTTP header where both "
+                 "TRANSFER-ENCODING and CONTENT-LENGTH where defined");
+
+            return false;
+        }
+
+        m_state = ReadingChunkSizeLine;
+    }
+    else if (contentLength > 0)
+    {
+        m_body.reserve(static_cast<qint32>(qMin(contentLength, MaxBodyReservation)));
+        m_bodyRemaining = contentLength;
+        m_state = ReadingBody;
+    }
+    else
+    {
+        // no body or no way to know what to expect
+        m_state = Finished;
+    }
+
+    return true;
+}
+
+bool HHttpStreamParser::parseChunkSizeLine(const QByteArray& lineBuffer)
+{
+    const char* data = lineBuffer.constData();
+
+    qint64 chunkSize = 0;
+    qint32 i = 0;
+    for(; i < m_lineLength; ++i)
+    {
+        qint32 value = hexValue(data[i]);
+        if (value < 0)
+        {
+            break;
+        }
+
+        chunkSize = chunkSize * 16 + value;
+        if (m_body.size() + chunkSize > MaxBodySize)
+        {
+            fail("HTTP message body is too large");
+            return false;
+        }
+    }
+
+    // the size may be followed by chunk extensions, which are ignored
+    if (i == 0 ||
+        (i < m_lineLength && data[i] != ';' && !isWhitespace(data[i])))
+    {
+        qint32 end = m_lineLength;
+        trim(data, &i, &end);
+
+        fail(QString("invalid chunk-size line: %1").arg(
+            QString::fromLatin1(data, end)));
+
+        return false;
+    }
+
+    m_lineLength = 0;
+
+    if (chunkSize == 0)
+    {
+        // The last chunk. The possible trailer fields and the empty line
+        // ending the message have to be read as well, since otherwise they
+        // would be left in front of the next message on the connection.
+        m_state = ReadingTrailer;
+        return true;
+    }
+
+    m_bodyRemaining = chunkSize;
+    m_state = ReadingChunk;
+    return true;
+}
+
+HHttpStreamParser::State HHttpStreamParser::parse(
+    QIODevice& device, QByteArray& lineBuffer)
+{
+    while(m_state != Finished && m_state != Failed)
+    {
+        switch(m_state)
+        {
+        case ReadingHeader:
+
+            if (!readLine(device, lineBuffer))
+            {
+                return m_state;
+            }
+
+            if (m_lineLength - m_lineStart <= 2 &&
+                (lineBuffer.at(m_lineStart) == '\r' ||
+                 lineBuffer.at(m_lineStart) == '\n'))
+            {
+                if (m_lineStart == 0)
+                {
+                    // an empty line before the start line is ignored
+                    m_lineLength = 0;
+                }
+                else if (!parseHeader(lineBuffer))
+                {
+                    return m_state;
+                }
+            }
+            else
+            {
+                m_lineStart = m_lineLength;
+            }
+            break;
+
+        case ReadingBody:
+        case ReadingChunk:
+
+            if (!readBody(device))
+            {
+                return m_state;
+            }
+            break;
+
+        case ReadingChunkSizeLine:
+
+            if (!readLine(device, lineBuffer) || !parseChunkSizeLine(lineBuffer))
+            {
+                return m_state;
+            }
+            break;
+
+        case ReadingChunkTerminator:
+        {
+            char c;
+            while(m_terminatorRemaining > 0 && device.getChar(&c))
+            {
+                --m_terminatorRemaining;
+            }
+
+            if (m_terminatorRemaining > 0)
+            {
+                return m_state;
+            }
+
+            m_state = ReadingChunkSizeLine;
+            break;
+        }
+
+        case ReadingTrailer:
+        {
+            if (!readLine(device, lineBuffer))
+            {
+                return m_state;
+            }
+
+            // the trailer fields are ignored
+            bool emptyLine = m_lineLength <= 2 &&
+                (lineBuffer.at(0) == '\r' || lineBuffer.at(0) == '\n');
+
+            m_lineLength = 0;
+
+            if (emptyLine)
+            {
+                m_state = Finished;
+            }
+            break;
+        }
+
+        default:
+            Q_ASSERT(false);
+            return m_state;
+        }
+    }
+
+    return m_state;
+}
+
+bool HHttpStreamParser::endOfStream(QByteArray& lineBuffer)
+{
+    if (m_state == Failed)
+    {
+        return false;
+    }
+    else if (m_bodyRemaining > 0)
+    {
+        fail("remote host closed connection before all data could be read");
+        return false;
+    }
+    else if (m_state == ReadingHeader)
+    {
+        if (m_lineLength <= 0)
+        {
+            fail("failed to read HTTP header");
+            return false;
+        }
+
+        if (!parseHeader(lineBuffer))
+        {
+            return false;
+        }
+        else if (m_state != Finished)
+        {
+            fail("remote host closed connection before all data could be read");
+            return false;
+        }
+    }
+
+    m_state = Finished;
+    return true;
+}
+
+}
+}
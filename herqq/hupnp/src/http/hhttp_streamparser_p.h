@@ -0,0 +1,146 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HHTTP_STREAMPARSER_P_H_
+#define HHTTP_STREAMPARSER_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include <HUpnpCore/HUpnp>
+
+#include <QtCore/QString>
+#include <QtCore/QByteArray>
+
+class QIODevice;
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+class HHttpHeader;
+
+//
+// Incremental parser for a single HTTP/1.1 message read from a stream.
+//
+// The parser consumes only the bytes that belong to the message it is reading
+// and it can be fed whenever new data becomes available. The header and the
+// chunk-size lines are collected into a line buffer provided by the caller,
+// which is expected to keep the same buffer for the lifetime of the connection
+// so that its memory can be reused. The fields that frame the message body
+// are located directly from the received bytes and the body is read straight
+// into its final buffer, including the data of each chunk.
+//
+class HHttpStreamParser
+{
+H_DISABLE_COPY(HHttpStreamParser)
+
+public:
+
+    enum State
+    {
+        ReadingHeader,
+        ReadingBody,
+        ReadingChunkSizeLine,
+        ReadingChunk,
+        ReadingChunkTerminator,
+        ReadingTrailer,
+        Finished,
+        Failed
+    };
+
+private:
+
+    const bool m_requestExpected;
+
+    State m_state;
+
+    HHttpHeader* m_header;
+
+    QByteArray m_body;
+
+    qint32 m_lineLength;
+    // the number of bytes of the line buffer that are in use
+
+    qint32 m_lineStart;
+    // the index of the line currently read into the line buffer
+
+    qint64 m_bodyRemaining;
+    // the number of bytes still to be read of the body, or of the current
+    // chunk when chunked encoding is used
+
+    qint32 m_terminatorRemaining;
+    // the number of bytes of the CRLF following a chunk still to be read
+
+    QString m_errorDescription;
+
+    bool readLine(QIODevice&, QByteArray& lineBuffer);
+    bool readBody(QIODevice&);
+
+    bool parseHeader(const QByteArray& lineBuffer);
+    bool parseChunkSizeLine(const QByteArray& lineBuffer);
+
+    void fail(const QString& errorDescription);
+
+public:
+
+    //
+    // requestExpected == the message is expected to be a request, otherwise
+    // it is expected to be a response
+    //
+    explicit HHttpStreamParser(bool requestExpected);
+    ~HHttpStreamParser();
+
+    //
+    // Reads as much of the message from the device as is available and returns
+    // the state of the parser.
+    //
+    State parse(QIODevice&, QByteArray& lineBuffer);
+
+    //
+    // Completes the message when the remote host has closed the connection.
+    // Returns false in case the data read so far does not form a message.
+    //
+    bool endOfStream(QByteArray& lineBuffer);
+
+    inline State state() const { return m_state; }
+
+    // the header of the message, if it has been read
+    inline const HHttpHeader* header() const { return m_header; }
+
+    inline QByteArray body() const { return m_body; }
+
+    inline qint64 bytesRemaining() const { return m_bodyRemaining; }
+
+    inline QString errorDescription() const { return m_errorDescription; }
+};
+
+}
+}
+
+#endif /* HHTTP_STREAMPARSER_P_H_ */
@@ -5,7 +5,9 @@ HEADERS += \
     $$SRC_LOC/http/hhttp_server_p.h \
     $$SRC_LOC/http/hhttp_asynchandler_p.h \
     $$SRC_LOC/http/hhttp_messaginginfo_p.h \
-    $$SRC_LOC/http/hhttp_messagecreator_p.h
+    $$SRC_LOC/http/hhttp_messagecreator_p.h \
+    $$SRC_LOC/http/hhttp_streamparser_p.h \
+    $$SRC_LOC/http/hhttp_connectionpool_p.h
 
 EXPORTED_PRIVATE_HEADERS += \
     $$SRC_LOC/http/hhttp_p.h \
@@ -22,4 +24,6 @@ SOURCES += \
     $$SRC_LOC/http/hhttp_server_p.cpp \
     $$SRC_LOC/http/hhttp_asynchandler_p.cpp \
     $$SRC_LOC/http/hhttp_messaginginfo_p.cpp \
-    $$SRC_LOC/http/hhttp_messagecreator_p.cpp
+    $$SRC_LOC/http/hhttp_messagecreator_p.cpp \
+    $$SRC_LOC/http/hhttp_streamparser_p.cpp \
+    $$SRC_LOC/http/hhttp_connectionpool_p.cpp
@@ -22,6 +22,7 @@
 #include "hssdp.h"
 #include "hssdp_p.h"
 #include "hdiscovery_messages.h"
+#include "hssdp_prefilter_p.h"
 #include "hssdp_messagecreator_p.h"
 
 #include "../dataelements/hdiscoverytype.h"
@@ -33,6 +34,7 @@
 #include "../utils/hmisc_utils_p.h"
 
 #include <QtCore/QUrl>
+#include <QtCore/QThread>
 #include <QtCore/QString>
 #include <QtCore/QDateTime>
 #include <QtCore/QStringList>
@@ -145,6 +147,205 @@ inline HEndpoint multicastEndpoint()
 }
 }
 
+/*******************************************************************************
+ * HSsdpIoWorker
+ ******************************************************************************/
+HSsdpIoWorker::HSsdpIoWorker(
+    HSsdpPrivate* owner, const QHostAddress& addressToBind) :
+        QObject(),
+            m_owner(owner),
+            m_addressToBind(addressToBind),
+            m_multicastSocket(0),
+            m_unicastSocket(0),
+            m_unicastEndpoint(),
+            m_incoming(1024),
+            m_outgoing(256),
+            m_deliveryPending(0),
+            m_sendPending(0),
+            m_maxQueueDepth(0),
+            m_droppedMessages(0),
+            m_droppedDatagrams(0)
+{
+    Q_ASSERT(m_owner);
+}
+
+HSsdpIoWorker::~HSsdpIoWorker()
+{
+    Q_ASSERT(!m_unicastSocket && !m_multicastSocket);
+}
+
+bool HSsdpIoWorker::start()
+{
+    HLOG2(H_AT, H_FUN, m_owner->m_loggingIdentifier);
+
+    // the sockets are created here so that they are owned by the I/O thread
+    m_multicastSocket = new HMulticastSocket(this);
+    m_unicastSocket   = new QUdpSocket(this);
+
+    bool ok = connect(
+        m_multicastSocket, SIGNAL(readyRead()),
+        this, SLOT(multicastMessageReceived()));
+
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    ok = connect(
+        m_unicastSocket, SIGNAL(readyRead()),
+        this, SLOT(unicastMessageReceived()));
+
+    Q_ASSERT(ok);
+
+    if (!m_owner->bindSockets(
+            m_multicastSocket, m_unicastSocket, m_addressToBind))
+    {
+        stop();
+        return false;
+    }
+
+    m_unicastEndpoint = HEndpoint(
+        m_unicastSocket->localAddress(), m_unicastSocket->localPort());
+
+    return true;
+}
+
+void HSsdpIoWorker::stop()
+{
+    HLOG2(H_AT, H_FUN, m_owner->m_loggingIdentifier);
+
+    // send whatever was queued before the shutdown, such as ssdp:byebye
+    // announcements
+    sendQueued();
+
+    HSsdpPrivate::unbindSockets(m_multicastSocket, m_unicastSocket);
+
+    delete m_unicastSocket; m_unicastSocket = 0;
+    delete m_multicastSocket; m_multicastSocket = 0;
+}
+
+void HSsdpIoWorker::unicastMessageReceived()
+{
+    messageReceived(m_unicastSocket, 0);
+}
+
+void HSsdpIoWorker::multicastMessageReceived()
+{
+    HEndpoint ep = multicastEndpoint();
+    messageReceived(m_multicastSocket, &ep);
+}
+
+void HSsdpIoWorker::messageReceived(QUdpSocket* socket, const HEndpoint* dest)
+{
+    HLOG2(H_AT, H_FUN, m_owner->m_loggingIdentifier);
+
+    bool enqueued = false;
+    while(socket->hasPendingDatagrams())
+    {
+        QHostAddress ha; quint16 port;
+
+        QByteArray buf;
+        buf.resize(socket->pendingDatagramSize() + 1);
+
+        qint64 read = socket->readDatagram(buf.data(), buf.size(), &ha, &port);
+        if (read < 0)
+        {
+            HLOG_WARN(QString("Read failed: %1").arg(socket->errorString()));
+            break;
+        }
+
+        buf.truncate(read);
+
+        HEndpoint source(ha, port);
+        HEndpoint destination(
+            dest ? *dest :
+                HEndpoint(socket->localAddress(), socket->localPort()));
+
+        HSsdpReceivedMessage rcvdMsg;
+        if (!m_owner->parse(buf, source, destination, &rcvdMsg))
+        {
+            continue;
+        }
+
+        if (!m_incoming.enqueue(rcvdMsg))
+        {
+            // the owner thread is not keeping up
+            m_droppedMessages.fetchAndAddRelaxed(1);
+            continue;
+        }
+
+        enqueued = true;
+
+        qint32 depth = m_incoming.size();
+        qint32 maxDepth = m_maxQueueDepth;
+        while(depth > maxDepth &&
+              !m_maxQueueDepth.testAndSetRelaxed(maxDepth, depth))
+        {
+            maxDepth = m_maxQueueDepth;
+        }
+    }
+
+    if (enqueued && m_deliveryPending.testAndSetOrdered(0, 1))
+    {
+        bool ok = QMetaObject::invokeMethod(
+            m_owner->q_ptr, "ioMessagesAvailable", Qt::QueuedConnection);
+
+        Q_ASSERT(ok); Q_UNUSED(ok)
+    }
+}
+
+void HSsdpIoWorker::sendQueued()
+{
+    m_sendPending.fetchAndStoreOrdered(0);
+
+    if (!m_unicastSocket)
+    {
+        return;
+    }
+
+    QPair<QByteArray, HEndpoint> datagram;
+    while(m_outgoing.dequeue(&datagram))
+    {
+        quint16 port = datagram.second.portNumber();
+        if (!port) { port = 1900; }
+
+        qint64 written = m_unicastSocket->writeDatagram(
+            datagram.first, datagram.second.hostAddress(), port);
+
+        if (written != datagram.first.size())
+        {
+            HLOG_DBG(m_unicastSocket->errorString());
+        }
+    }
+}
+
+bool HSsdpIoWorker::send(const QByteArray& data, const HEndpoint& receiver)
+{
+    if (!m_outgoing.enqueue(qMakePair(data, receiver)))
+    {
+        m_droppedDatagrams.fetchAndAddRelaxed(1);
+        return false;
+    }
+
+    if (m_sendPending.testAndSetOrdered(0, 1))
+    {
+        bool ok = QMetaObject::invokeMethod(
+            this, "sendQueued", Qt::QueuedConnection);
+
+        Q_ASSERT(ok); Q_UNUSED(ok)
+    }
+
+    return true;
+}
+
+bool HSsdpIoWorker::takeMessage(HSsdpReceivedMessage* msg)
+{
+    return m_incoming.dequeue(msg);
+}
+
+void HSsdpIoWorker::deliveryStarted()
+{
+    // any message enqueued from now on results in a new notification
+    m_deliveryPending.fetchAndStoreOrdered(0);
+}
+
 /*******************************************************************************
  * HSsdpPrivate
  ******************************************************************************/
@@ -155,6 +356,10 @@ HSsdpPrivate::HSsdpPrivate(
         m_unicastSocket  (0),
         q_ptr            (qptr),
         m_allowedMessages(HSsdp::All),
+        m_prefilter(0),
+        m_useIoThread(false),
+        m_ioThread(0),
+        m_ioWorker(0),
         m_lastError()
 {
 }
@@ -442,6 +647,11 @@ bool HSsdpPrivate::send(const QByteArray& data, const HEndpoint& receiver)
 {
     Q_ASSERT(isInitialized());
 
+    if (m_ioWorker)
+    {
+        return m_ioWorker->send(data, receiver);
+    }
+
     quint16 port = receiver.portNumber();
     if (!port) { port = 1900; }
 
@@ -451,33 +661,37 @@ bool HSsdpPrivate::send(const QByteArray& data, const HEndpoint& receiver)
     return retVal == data.size();
 }
 
-void HSsdpPrivate::processResponse(const QString& msg, const HEndpoint& source)
+bool HSsdpPrivate::parseResponse(
+    const QString& msg, const HEndpoint& source, HSsdpReceivedMessage* rcvdMsg)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
+    if (!isAllowed(HSsdp::DiscoveryResponse))
+    {
+        return false;
+    }
+
     HHttpResponseHeader hdr(msg);
     if (!hdr.isValid())
     {
         HLOG_WARN("Ignoring a malformed HTTP response.");
-        return;
+        return false;
     }
 
-    if (m_allowedMessages & HSsdp::DiscoveryResponse)
+    if (!parseDiscoveryResponse(hdr, &rcvdMsg->m_discoveryResponse))
     {
-        HDiscoveryResponse rcvdMsg;
-        if (!parseDiscoveryResponse(hdr, &rcvdMsg))
-        {
-            HLOG_WARN(QString("Ignoring invalid message from [%1]: %2").arg(
-                source.toString(), msg));
-        }
-        else if (!q_ptr->incomingDiscoveryResponse(rcvdMsg, source))
-        {
-            emit q_ptr->discoveryResponseReceived(rcvdMsg, source);
-        }
+        HLOG_WARN(QString("Ignoring invalid message from [%1]: %2").arg(
+            source.toString(), msg));
+
+        return false;
     }
+
+    rcvdMsg->m_type = HSsdpReceivedMessage::DiscoveryResponse;
+    return true;
 }
 
-void HSsdpPrivate::processNotify(const QString& msg, const HEndpoint& source)
+bool HSsdpPrivate::parseNotify(
+    const QString& msg, HSsdpReceivedMessage* rcvdMsg)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
@@ -485,56 +699,56 @@ void HSsdpPrivate::processNotify(const QString& msg, const HEndpoint& source)
     if (!hdr.isValid())
     {
         HLOG_WARN("Ignoring an invalid HTTP NOTIFY request.");
-        return;
+        return false;
     }
 
     QString nts = hdr.value("NTS");
     if (nts.compare(QString("ssdp:alive"), Qt::CaseInsensitive) == 0)
     {
-        if (m_allowedMessages & HSsdp::DeviceAvailable)
+        if (isAllowed(HSsdp::DeviceAvailable))
         {
-            HResourceAvailable rcvdMsg;
-            if (!parseDeviceAvailable(hdr, &rcvdMsg))
+            if (!parseDeviceAvailable(hdr, &rcvdMsg->m_resourceAvailable))
             {
                 HLOG_WARN(QString(
                     "Ignoring an invalid ssdp:alive announcement:\n%1").arg(msg));
+
+                return false;
             }
-            else if (!q_ptr->incomingDeviceAvailableAnnouncement(rcvdMsg, source))
-            {
-                emit q_ptr->resourceAvailableReceived(rcvdMsg, source);
-            }
+
+            rcvdMsg->m_type = HSsdpReceivedMessage::ResourceAvailable;
+            return true;
         }
     }
     else if (nts.compare(QString("ssdp:byebye"), Qt::CaseInsensitive) == 0)
     {
-        if (m_allowedMessages & HSsdp::DeviceUnavailable)
+        if (isAllowed(HSsdp::DeviceUnavailable))
         {
-            HResourceUnavailable rcvdMsg;
-            if (!parseDeviceUnavailable(hdr, &rcvdMsg))
+            if (!parseDeviceUnavailable(hdr, &rcvdMsg->m_resourceUnavailable))
             {
                 HLOG_WARN(QString(
                     "Ignoring an invalid ssdp:byebye announcement:\n%1").arg(msg));
+
+                return false;
             }
-            else if (!q_ptr->incomingDeviceUnavailableAnnouncement(rcvdMsg, source))
-            {
-                emit q_ptr->resourceUnavailableReceived(rcvdMsg, source);
-            }
+
+            rcvdMsg->m_type = HSsdpReceivedMessage::ResourceUnavailable;
+            return true;
         }
     }
     else if (nts.compare(QString("ssdp:update"), Qt::CaseInsensitive) == 0)
     {
-        if (m_allowedMessages & HSsdp::DeviceUpdate)
+        if (isAllowed(HSsdp::DeviceUpdate))
         {
-            HResourceUpdate rcvdMsg;
-            if (!parseDeviceUpdate(hdr, &rcvdMsg))
+            if (!parseDeviceUpdate(hdr, &rcvdMsg->m_resourceUpdate))
             {
                 HLOG_WARN(QString(
                     "Ignoring invalid ssdp:update announcement:\n%1").arg(msg));
+
+                return false;
             }
-            else if (!q_ptr->incomingDeviceUpdateAnnouncement(rcvdMsg, source))
-            {
-                emit q_ptr->deviceUpdateReceived(rcvdMsg, source);
-            }
+
+            rcvdMsg->m_type = HSsdpReceivedMessage::ResourceUpdate;
+            return true;
         }
     }
     else
@@ -542,78 +756,202 @@ void HSsdpPrivate::processNotify(const QString& msg, const HEndpoint& source)
         HLOG_WARN(QString(
             "Ignoring an invalid SSDP presence announcement: [%1].").arg(nts));
     }
+
+    return false;
 }
 
-void HSsdpPrivate::processSearch(
-    const QString& msg, const HEndpoint& source, const HEndpoint& destination)
+bool HSsdpPrivate::parseSearch(
+    const QString& msg, const HEndpoint& source, const HEndpoint& destination,
+    HSsdpReceivedMessage* rcvdMsg)
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
 
+    if (!isAllowed(HSsdp::DiscoveryRequest))
+    {
+        return false;
+    }
+
     HHttpRequestHeader hdr(msg);
     if (!hdr.isValid())
     {
         HLOG_WARN("Ignoring an invalid HTTP M-SEARCH request.");
-        return;
+        return false;
     }
 
-    if (m_allowedMessages & HSsdp::DiscoveryRequest)
+    if (!parseDiscoveryRequest(hdr, &rcvdMsg->m_discoveryRequest))
     {
-        HSsdp::DiscoveryRequestMethod type = destination.isMulticast() ?
-            HSsdp::MulticastDiscovery : HSsdp::UnicastDiscovery;
+        HLOG_WARN(QString("Ignoring invalid message from [%1]: %2").arg(
+            source.toString(), msg));
 
-        HDiscoveryRequest rcvdMsg;
-        if (!parseDiscoveryRequest(hdr, &rcvdMsg))
+        return false;
+    }
+
+    rcvdMsg->m_requestMethod = destination.isMulticast() ?
+        HSsdp::MulticastDiscovery : HSsdp::UnicastDiscovery;
+
+    rcvdMsg->m_type = HSsdpReceivedMessage::DiscoveryRequest;
+    return true;
+}
+
+bool HSsdpPrivate::parse(
+    const QByteArray& datagram, const HEndpoint& source,
+    const HEndpoint& destination, HSsdpReceivedMessage* rcvdMsg)
+{
+    Q_ASSERT(rcvdMsg);
+
+    if (m_prefilter && !m_prefilter->accept(datagram, source.hostAddress()))
+    {
+        return false;
+    }
+
+    QString msg(QString::fromUtf8(datagram.constData(), datagram.size()));
+    rcvdMsg->m_source = source;
+
+    if (msg.startsWith("NOTIFY * HTTP/1.1", Qt::CaseInsensitive))
+    {
+        // Possible presence announcement
+        return parseNotify(msg, rcvdMsg);
+    }
+    else if (msg.startsWith("M-SEARCH * HTTP/1.1", Qt::CaseInsensitive))
+    {
+        // Possible discovery request.
+        return parseSearch(msg, source, destination, rcvdMsg);
+    }
+
+    // Possible discovery response
+    return parseResponse(msg, source, rcvdMsg);
+}
+
+void HSsdpPrivate::dispatch(const HSsdpReceivedMessage& rcvdMsg)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    const HEndpoint& source = rcvdMsg.m_source;
+
+    switch(rcvdMsg.m_type)
+    {
+    case HSsdpReceivedMessage::DiscoveryRequest:
+        if (!q_ptr->incomingDiscoveryRequest(
+                rcvdMsg.m_discoveryRequest, source, rcvdMsg.m_requestMethod))
+        {
+            emit q_ptr->discoveryRequestReceived(
+                rcvdMsg.m_discoveryRequest, source, rcvdMsg.m_requestMethod);
+        }
+        break;
+
+    case HSsdpReceivedMessage::DiscoveryResponse:
+        if (!q_ptr->incomingDiscoveryResponse(
+                rcvdMsg.m_discoveryResponse, source))
+        {
+            emit q_ptr->discoveryResponseReceived(
+                rcvdMsg.m_discoveryResponse, source);
+        }
+        break;
+
+    case HSsdpReceivedMessage::ResourceAvailable:
+        if (!q_ptr->incomingDeviceAvailableAnnouncement(
+                rcvdMsg.m_resourceAvailable, source))
         {
-            HLOG_WARN(QString("Ignoring invalid message from [%1]: %2").arg(
-                source.toString(), msg));
+            emit q_ptr->resourceAvailableReceived(
+                rcvdMsg.m_resourceAvailable, source);
         }
-        else if (!q_ptr->incomingDiscoveryRequest(rcvdMsg, source, type))
+        break;
+
+    case HSsdpReceivedMessage::ResourceUnavailable:
+        if (!q_ptr->incomingDeviceUnavailableAnnouncement(
+                rcvdMsg.m_resourceUnavailable, source))
         {
-            emit q_ptr->discoveryRequestReceived(rcvdMsg, source, type);
+            emit q_ptr->resourceUnavailableReceived(
+                rcvdMsg.m_resourceUnavailable, source);
         }
+        break;
+
+    case HSsdpReceivedMessage::ResourceUpdate:
+        if (!q_ptr->incomingDeviceUpdateAnnouncement(
+                rcvdMsg.m_resourceUpdate, source))
+        {
+            emit q_ptr->deviceUpdateReceived(rcvdMsg.m_resourceUpdate, source);
+        }
+        break;
+
+    default:
+        Q_ASSERT(false);
     }
 }
 
-void HSsdpPrivate::clear()
+void HSsdpPrivate::dispatchQueuedMessages()
 {
-    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
-    if (m_multicastSocket &&
-        m_multicastSocket->state() == QUdpSocket::BoundState)
+    Q_ASSERT(m_ioWorker);
+
+    m_ioWorker->deliveryStarted();
+
+    HSsdpReceivedMessage rcvdMsg;
+    while(m_ioWorker->takeMessage(&rcvdMsg))
     {
-        m_multicastSocket->leaveMulticastGroup(
-            multicastAddress(), m_unicastSocket->localAddress());
+        dispatch(rcvdMsg);
+        if (!m_ioWorker)
+        {
+            // the receiver of a message shut down the instance
+            break;
+        }
     }
-    delete m_unicastSocket; m_unicastSocket = 0;
-    delete m_multicastSocket; m_multicastSocket = 0;
 }
 
-bool HSsdpPrivate::init(const QHostAddress& addressToBind)
+void HSsdpPrivate::unbindSockets(
+    HMulticastSocket* multicastSocket, QUdpSocket* unicastSocket)
+{
+    if (multicastSocket && unicastSocket &&
+        multicastSocket->state() == QUdpSocket::BoundState)
+    {
+        multicastSocket->leaveMulticastGroup(
+            multicastAddress(), unicastSocket->localAddress());
+    }
+}
+
+void HSsdpPrivate::clear()
 {
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
-    Q_ASSERT(!isInitialized());
 
-    m_multicastSocket = new HMulticastSocket(q_ptr);
-    m_unicastSocket   = new QUdpSocket(q_ptr);
+    if (m_ioWorker)
+    {
+        bool ok = QMetaObject::invokeMethod(
+            m_ioWorker, "stop", Qt::BlockingQueuedConnection);
 
-    bool ok = QObject::connect(
-        m_multicastSocket, SIGNAL(readyRead()),
-        q_ptr, SLOT(multicastMessageReceived()));
+        Q_ASSERT(ok); Q_UNUSED(ok)
 
-    Q_ASSERT(ok); Q_UNUSED(ok)
+        m_ioThread->quit();
+        m_ioThread->wait();
 
-    ok = QObject::connect(
-        m_unicastSocket, SIGNAL(readyRead()),
-        q_ptr, SLOT(unicastMessageReceived()));
+        HLOG_DBG(QString(
+            "SSDP I/O thread stopped. Maximum queue depth: [%1], "
+            "dropped incoming messages: [%2], dropped outgoing datagrams: [%3]").arg(
+                QString::number(m_ioWorker->maxQueueDepth()),
+                QString::number(m_ioWorker->droppedMessages()),
+                QString::number(m_ioWorker->droppedDatagrams())));
 
-    Q_ASSERT(ok);
+        delete m_ioWorker; m_ioWorker = 0;
+        delete m_ioThread; m_ioThread = 0;
+    }
+
+    unbindSockets(m_multicastSocket, m_unicastSocket);
 
-    if (!m_multicastSocket->bind(1900))
+    delete m_unicastSocket; m_unicastSocket = 0;
+    delete m_multicastSocket; m_multicastSocket = 0;
+}
+
+bool HSsdpPrivate::bindSockets(
+    HMulticastSocket* multicastSocket, QUdpSocket* unicastSocket,
+    const QHostAddress& addressToBind)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+
+    if (!multicastSocket->bind(1900))
     {
         HLOG_WARN("Failed to bind multicast socket for listening");
         return false;
     }
 
-    if (!m_multicastSocket->joinMulticastGroup(
+    if (!multicastSocket->joinMulticastGroup(
             multicastAddress(), addressToBind))
     {
         HLOG_WARN(QString("Could not join %1").arg(
@@ -627,14 +965,14 @@ bool HSsdpPrivate::init(const QHostAddress& addressToBind)
             addressToBind.toString()));
 
     // always attempt to bind to the 1900 first
-    if (!m_unicastSocket->bind(addressToBind, 1900))
+    if (!unicastSocket->bind(addressToBind, 1900))
     {
         HLOG_DBG("Could not bind UDP unicast socket to port 1900");
 
         // the range is specified by the UDA 1.1 standard
         for(qint32 i = 49152; i < 65535; ++i)
         {
-            if (m_unicastSocket->bind(addressToBind, i))
+            if (unicastSocket->bind(addressToBind, i))
             {
                 HLOG_DBG(QString("Unicast UDP socket bound to port [%1].").arg(
                     QString::number(i)));
@@ -648,12 +986,64 @@ bool HSsdpPrivate::init(const QHostAddress& addressToBind)
         HLOG_DBG("Unicast UDP socket bound to port 1900");
     }
 
-    if (m_unicastSocket->state() != QUdpSocket::BoundState)
+    if (unicastSocket->state() != QUdpSocket::BoundState)
     {
         HLOG_WARN(QString(
             "Failed to bind UDP unicast socket on address.").arg(
                 addressToBind.toString()));
 
+        unbindSockets(multicastSocket, unicastSocket);
+        return false;
+    }
+
+    return true;
+}
+
+bool HSsdpPrivate::init(const QHostAddress& addressToBind)
+{
+    HLOG2(H_AT, H_FUN, m_loggingIdentifier);
+    Q_ASSERT(!isInitialized());
+
+    if (m_useIoThread)
+    {
+        m_ioThread = new QThread();
+        m_ioWorker = new HSsdpIoWorker(this, addressToBind);
+        m_ioWorker->moveToThread(m_ioThread);
+        m_ioThread->start();
+
+        bool started = false;
+        bool ok = QMetaObject::invokeMethod(
+            m_ioWorker, "start", Qt::BlockingQueuedConnection,
+            Q_RETURN_ARG(bool, started));
+
+        Q_ASSERT(ok); Q_UNUSED(ok)
+
+        if (!started)
+        {
+            clear();
+            return false;
+        }
+
+        return true;
+    }
+
+    m_multicastSocket = new HMulticastSocket(q_ptr);
+    m_unicastSocket   = new QUdpSocket(q_ptr);
+
+    bool ok = QObject::connect(
+        m_multicastSocket, SIGNAL(readyRead()),
+        q_ptr, SLOT(multicastMessageReceived()));
+
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    ok = QObject::connect(
+        m_unicastSocket, SIGNAL(readyRead()),
+        q_ptr, SLOT(unicastMessageReceived()));
+
+    Q_ASSERT(ok);
+
+    if (!bindSockets(m_multicastSocket, m_unicastSocket, addressToBind))
+    {
         clear();
         return false;
     }
@@ -678,25 +1068,16 @@ void HSsdpPrivate::messageReceived(QUdpSocket* socket, const HEndpoint* dest)
         return;
     }
 
-    QString msg(QString::fromUtf8(buf, read));
+    buf.truncate(read);
+
     HEndpoint source(ha, port);
     HEndpoint destination(
         dest ? *dest : HEndpoint(socket->localAddress(), socket->localPort()));
 
-    if (msg.startsWith("NOTIFY * HTTP/1.1", Qt::CaseInsensitive))
-    {
-        // Possible presence announcement
-        processNotify(msg, source);
-    }
-    else if (msg.startsWith("M-SEARCH * HTTP/1.1", Qt::CaseInsensitive))
-    {
-        // Possible discovery request.
-        processSearch(msg, source, destination);
-    }
-    else
+    HSsdpReceivedMessage rcvdMsg;
+    if (parse(buf, source, destination, &rcvdMsg))
     {
-        // Possible discovery response
-        processResponse(msg, source);
+        dispatch(rcvdMsg);
     }
 }
 
@@ -731,14 +1112,37 @@ void HSsdp::multicastMessageReceived()
     h_ptr->messageReceived(h_ptr->m_multicastSocket, &ep);
 }
 
+void HSsdp::ioMessagesAvailable()
+{
+    if (h_ptr->m_ioWorker)
+    {
+        h_ptr->dispatchQueuedMessages();
+    }
+}
+
+void HSsdp::setIoThreadEnabled(bool enable)
+{
+    if (!isInitialized())
+    {
+        h_ptr->m_useIoThread = enable;
+    }
+}
+
+bool HSsdp::isIoThreadEnabled() const
+{
+    return h_ptr->m_useIoThread;
+}
+
 void HSsdp::setFilter(AllowedMessages allowedMessages)
 {
-    h_ptr->m_allowedMessages = allowedMessages;
+    // the filter is read by the I/O thread, in case it is enabled
+    h_ptr->m_allowedMessages.fetchAndStoreRelaxed(
+        static_cast<int>(allowedMessages));
 }
 
 HSsdp::AllowedMessages HSsdp::filter() const
 {
-    return h_ptr->m_allowedMessages;
+    return AllowedMessages(static_cast<int>(h_ptr->m_allowedMessages));
 }
 
 bool HSsdp::init()
@@ -773,6 +1177,11 @@ bool HSsdp::isInitialized() const
 
 HEndpoint HSsdp::unicastEndpoint() const
 {
+    if (h_ptr->m_ioWorker)
+    {
+        return h_ptr->m_ioWorker->unicastEndpoint();
+    }
+
     return HEndpoint(
         h_ptr->m_unicastSocket->localAddress(),
         h_ptr->m_unicastSocket->localPort());
@@ -831,7 +1240,7 @@ qint32 send(HSsdpPrivate* hptr, const Msg& msg, const HEndpoint& receiver,
         {
             ++sent;
         }
-        else
+        else if (hptr->m_unicastSocket)
         {
             HLOG_DBG(hptr->m_unicastSocket->errorString());
         }
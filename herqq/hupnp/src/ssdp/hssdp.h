@@ -92,6 +92,7 @@ private Q_SLOTS:
 
     void unicastMessageReceived();
     void multicastMessageReceived();
+    void ioMessagesAvailable();
 
 protected:
 
@@ -271,6 +272,10 @@ public:
      * \param allowedMessages defines the message types the instance should
      * accept for further processing. Other message types will be silently ignored.
      *
+     * \remarks The filter can be changed after init(), also when the I/O thread
+     * is enabled. The new filter applies to the messages processed after
+     * the call.
+     *
      * \sa filter()
      */
     void setFilter(AllowedMessages allowedMessages);
@@ -333,6 +338,40 @@ public:
      */
     HEndpoint unicastEndpoint() const;
 
+    /*!
+     * \brief Specifies whether the socket I/O is run in a dedicated thread.
+     *
+     * When enabled, the datagrams are received, filtered, parsed and sent
+     * in a thread owned by the instance. Only the parsed messages are handed
+     * to the thread of the instance, where the virtual methods are called and
+     * the signals are emitted as usual. This way a busy event loop in the thread
+     * of the instance does not cause incoming datagrams to be dropped by the
+     * operating system.
+     *
+     * This is disabled by default.
+     *
+     * \param enable specifies whether the socket I/O is run in a dedicated
+     * thread.
+     *
+     * \remarks
+     * \li this has to be called before the instance is initialized. The call
+     * is ignored otherwise.
+     * \li when enabled, the messages sent are queued to the I/O thread and
+     * the functions sending them return the number of messages queued.
+     *
+     * \sa isIoThreadEnabled()
+     */
+    void setIoThreadEnabled(bool enable);
+
+    /*!
+     * \brief Indicates whether the socket I/O is run in a dedicated thread.
+     *
+     * \return \e true in case the socket I/O is run in a dedicated thread.
+     *
+     * \sa setIoThreadEnabled()
+     */
+    bool isIoThreadEnabled() const;
+
     /*!
      * Sends the specified device availability announcement.
      *
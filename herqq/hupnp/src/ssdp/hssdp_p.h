@@ -37,12 +37,17 @@
 #include "../general/hupnp_defs.h"
 #include "../http/hhttp_header_p.h"
 #include "../socket/hmulticast_socket.h"
+#include "../utils/hspsc_queue_p.h"
 
+#include <QtCore/QPair>
+#include <QtCore/QObject>
 #include <QtCore/QByteArray>
+#include <QtCore/QAtomicInt>
+#include <QtNetwork/QHostAddress>
 
 class QUrl;
+class QThread;
 class QString;
-class QHostAddress;
 
 namespace Herqq
 {
@@ -51,6 +56,117 @@ namespace Upnp
 {
 
 class HSsdp;
+class HSsdpPrivate;
+class HSsdpPrefilter;
+
+//
+// A parsed SSDP message of any type
+//
+class HSsdpReceivedMessage
+{
+public:
+
+    enum Type
+    {
+        Undefined = 0,
+        DiscoveryRequest,
+        DiscoveryResponse,
+        ResourceAvailable,
+        ResourceUnavailable,
+        ResourceUpdate
+    };
+
+    Type m_type;
+    HEndpoint m_source;
+
+    HSsdp::DiscoveryRequestMethod m_requestMethod;
+    // meaningful only with discovery requests
+
+    HDiscoveryRequest m_discoveryRequest;
+    HDiscoveryResponse m_discoveryResponse;
+    HResourceAvailable m_resourceAvailable;
+    HResourceUnavailable m_resourceUnavailable;
+    HResourceUpdate m_resourceUpdate;
+    // only the member matching the type is set
+
+    inline HSsdpReceivedMessage() :
+        m_type(Undefined), m_source(),
+        m_requestMethod(HSsdp::MulticastDiscovery),
+        m_discoveryRequest(), m_discoveryResponse(), m_resourceAvailable(),
+        m_resourceUnavailable(), m_resourceUpdate()
+    {
+    }
+};
+
+//
+// Runs the socket I/O of an HSsdp in a dedicated thread.
+//
+// The worker lives in the I/O thread, where it owns the sockets, reads and
+// parses the incoming datagrams and writes the outgoing ones. The parsed
+// messages are handed to the thread of the HSsdp through a single-producer /
+// single-consumer lock-free queue, and the outgoing datagrams travel the other
+// way through another such queue. The receiving side is notified with
+// a queued call only when the queue turns non-empty, which means a burst of
+// messages costs a single event.
+//
+class HSsdpIoWorker :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HSsdpIoWorker)
+
+private:
+
+    HSsdpPrivate* m_owner;
+    const QHostAddress m_addressToBind;
+
+    HMulticastSocket* m_multicastSocket;
+    QUdpSocket* m_unicastSocket;
+    HEndpoint m_unicastEndpoint;
+
+    HSpscQueue<HSsdpReceivedMessage> m_incoming;
+    HSpscQueue<QPair<QByteArray, HEndpoint> > m_outgoing;
+
+    QAtomicInt m_deliveryPending;
+    QAtomicInt m_sendPending;
+
+    QAtomicInt m_maxQueueDepth;
+    QAtomicInt m_droppedMessages;
+    QAtomicInt m_droppedDatagrams;
+
+    void messageReceived(QUdpSocket*, const HEndpoint*);
+
+private Q_SLOTS:
+
+    void unicastMessageReceived();
+    void multicastMessageReceived();
+    void sendQueued();
+
+public Q_SLOTS:
+
+    // these are invoked in the I/O thread using a blocking queued connection
+    bool start();
+    void stop();
+
+public:
+
+    HSsdpIoWorker(HSsdpPrivate* owner, const QHostAddress& addressToBind);
+    virtual ~HSsdpIoWorker();
+
+    // the rest are called from the thread of the owner
+
+    bool send(const QByteArray& data, const HEndpoint& receiver);
+    bool takeMessage(HSsdpReceivedMessage*);
+    void deliveryStarted();
+
+    // valid once start() has succeeded
+    inline HEndpoint unicastEndpoint() const { return m_unicastEndpoint; }
+
+    inline qint32 queueDepth() { return m_incoming.size(); }
+    inline qint32 maxQueueDepth() const { return m_maxQueueDepth; }
+    inline qint32 droppedMessages() const { return m_droppedMessages; }
+    inline qint32 droppedDatagrams() const { return m_droppedDatagrams; }
+};
 
 //
 // Implementation details of HSsdp
@@ -84,7 +200,23 @@ public: // attributes
 
     HSsdp* q_ptr;
 
-    HSsdp::AllowedMessages m_allowedMessages;
+    QAtomicInt m_allowedMessages;
+    // the HSsdp::AllowedMessages. written by the owner and read by the I/O
+    // thread, if one is used
+
+    inline bool isAllowed(HSsdp::AllowedMessage type) const
+    {
+        return static_cast<int>(m_allowedMessages) & type;
+    }
+
+    HSsdpPrefilter* m_prefilter;
+    // optional filter run against the raw datagrams before they are parsed.
+    // this is not owned.
+
+    bool m_useIoThread;
+    QThread* m_ioThread;
+    HSsdpIoWorker* m_ioWorker;
+    // used instead of the sockets above when the I/O thread is enabled
 
     QString m_lastError;
 
@@ -99,14 +231,29 @@ public: // methods
 
     inline bool isInitialized() const
     {
-        return m_unicastSocket && m_multicastSocket;
+        return (m_unicastSocket && m_multicastSocket) || m_ioWorker;
     }
 
-    void processNotify(const QString& msg, const HEndpoint& source);
-    void processSearch(const QString& msg, const HEndpoint& source,
-                       const HEndpoint& destination);
+    bool bindSockets(HMulticastSocket*, QUdpSocket*, const QHostAddress&);
+    static void unbindSockets(HMulticastSocket*, QUdpSocket*);
+
+    bool parseNotify(const QString& msg, HSsdpReceivedMessage*);
+
+    bool parseSearch(
+        const QString& msg, const HEndpoint& source,
+        const HEndpoint& destination, HSsdpReceivedMessage*);
+
+    bool parseResponse(
+        const QString& msg, const HEndpoint& source, HSsdpReceivedMessage*);
+
+    // this may be called from the I/O thread, which is why it must not
+    // touch state the thread of the owner uses once initialized
+    bool parse(
+        const QByteArray& datagram, const HEndpoint& source,
+        const HEndpoint& destination, HSsdpReceivedMessage*);
 
-    void processResponse(const QString& msg, const HEndpoint& source);
+    void dispatch(const HSsdpReceivedMessage&);
+    void dispatchQueuedMessages();
 
     bool send(const QByteArray& data, const HEndpoint& receiver);
 
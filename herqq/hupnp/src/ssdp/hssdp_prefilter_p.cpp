@@ -0,0 +1,313 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hssdp_prefilter_p.h"
+
+#include "../dataelements/hudn.h"
+#include "../dataelements/hresourcetype.h"
+
+#include <cstring>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace
+{
+inline char toLower(char c)
+{
+    return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+}
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+// case-insensitive comparison of the specified header name against
+// a lower-case literal
+bool nameIs(const char* name, qint32 length, const char* expected)
+{
+    qint32 expectedLength = static_cast<qint32>(std::strlen(expected));
+    if (length != expectedLength)
+    {
+        return false;
+    }
+
+    for(qint32 i = 0; i < length; ++i)
+    {
+        if (toLower(name[i]) != expected[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// case-insensitive check whether the value begins with the specified
+// lower-case prefix
+bool startsWith(const char* value, qint32 length, const QByteArray& prefix)
+{
+    if (length < prefix.size())
+    {
+        return false;
+    }
+
+    for(qint32 i = 0; i < prefix.size(); ++i)
+    {
+        if (toLower(value[i]) != prefix[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+}
+
+HSsdpPrefilter::HSsdpPrefilter() :
+    m_resourceTypes(), m_acceptedUdns(), m_rejectedUdns(), m_subnets(),
+    m_accepted(0), m_rejected(0)
+{
+}
+
+void HSsdpPrefilter::setResourceTypes(const QList<HResourceType>& types)
+{
+    m_resourceTypes.clear();
+    foreach(const HResourceType& type, types)
+    {
+        if (!type.isValid())
+        {
+            continue;
+        }
+
+        QByteArray prefix =
+            type.toString(
+                HResourceType::UrnPrefix | HResourceType::Domain |
+                HResourceType::Type | HResourceType::TypeSuffix).toUtf8().toLower();
+
+        prefix.append(':');
+
+        m_resourceTypes.append(qMakePair(prefix, type.version()));
+    }
+}
+
+void HSsdpPrefilter::setAcceptedUdns(const QList<HUdn>& udns)
+{
+    m_acceptedUdns.clear();
+    foreach(const HUdn& udn, udns)
+    {
+        m_acceptedUdns.insert(udn.toString().toUtf8().toLower());
+    }
+}
+
+void HSsdpPrefilter::setRejectedUdns(const QList<HUdn>& udns)
+{
+    m_rejectedUdns.clear();
+    foreach(const HUdn& udn, udns)
+    {
+        m_rejectedUdns.insert(udn.toString().toUtf8().toLower());
+    }
+}
+
+void HSsdpPrefilter::setSubnets(const QList<QPair<QHostAddress, int> >& subnets)
+{
+    m_subnets = subnets;
+}
+
+bool HSsdpPrefilter::isEmpty() const
+{
+    return m_resourceTypes.isEmpty() && m_acceptedUdns.isEmpty() &&
+           m_rejectedUdns.isEmpty() && m_subnets.isEmpty();
+}
+
+bool HSsdpPrefilter::acceptType(const char* value, qint32 length) const
+{
+    if (m_resourceTypes.isEmpty())
+    {
+        return true;
+    }
+
+    for(qint32 i = 0; i < m_resourceTypes.size(); ++i)
+    {
+        const QPair<QByteArray, qint32>& type = m_resourceTypes.at(i);
+        if (!startsWith(value, length, type.first))
+        {
+            continue;
+        }
+
+        bool ok = false;
+        qint32 version = QByteArray(
+            value + type.first.size(), length - type.first.size()).toInt(&ok);
+
+        if (ok && version >= type.second)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool HSsdpPrefilter::acceptUdn(const char* value, qint32 length) const
+{
+    if (m_acceptedUdns.isEmpty() && m_rejectedUdns.isEmpty())
+    {
+        return true;
+    }
+
+    // the UDN is the part of the USN preceding the "::", if any
+    qint32 udnLength = 0;
+    for(; udnLength < length; ++udnLength)
+    {
+        if (value[udnLength] == ':' && udnLength + 1 < length &&
+            value[udnLength + 1] == ':')
+        {
+            break;
+        }
+    }
+
+    QByteArray udn(value, udnLength);
+    udn = udn.toLower();
+
+    if (m_rejectedUdns.contains(udn))
+    {
+        return false;
+    }
+
+    return m_acceptedUdns.isEmpty() || m_acceptedUdns.contains(udn);
+}
+
+bool HSsdpPrefilter::accept(
+    const QByteArray& datagram, const QHostAddress& source)
+{
+    const char* data = datagram.constData();
+    const qint32 size = datagram.size();
+
+    if (startsWith(data, size, QByteArray("m-search ")))
+    {
+        return true;
+    }
+
+    if (!m_subnets.isEmpty())
+    {
+        bool inSubnet = false;
+        for(qint32 i = 0; i < m_subnets.size(); ++i)
+        {
+            if (source.isInSubnet(m_subnets.at(i)))
+            {
+                inSubnet = true;
+                break;
+            }
+        }
+
+        if (!inSubnet)
+        {
+            m_rejected.fetchAndAddRelaxed(1);
+            return false;
+        }
+    }
+
+    bool typeChecked = m_resourceTypes.isEmpty();
+    bool udnChecked = m_acceptedUdns.isEmpty() && m_rejectedUdns.isEmpty();
+
+    // skip the request / status line
+    qint32 pos = datagram.indexOf('\n');
+    while(pos >= 0 && pos + 1 < size && !(typeChecked && udnChecked))
+    {
+        qint32 lineStart = pos + 1;
+        qint32 lineEnd = datagram.indexOf('\n', lineStart);
+        if (lineEnd < 0)
+        {
+            lineEnd = size;
+        }
+
+        qint32 end = lineEnd;
+        if (end > lineStart && data[end - 1] == '\r')
+        {
+            --end;
+        }
+
+        if (end == lineStart)
+        {
+            // the end of the headers
+            break;
+        }
+
+        qint32 colon = lineStart;
+        while(colon < end && data[colon] != ':') { ++colon; }
+
+        if (colon < end)
+        {
+            qint32 nameEnd = colon;
+            while(nameEnd > lineStart && isSpace(data[nameEnd - 1])) { --nameEnd; }
+
+            qint32 valueStart = colon + 1;
+            while(valueStart < end && isSpace(data[valueStart])) { ++valueStart; }
+
+            qint32 valueEnd = end;
+            while(valueEnd > valueStart && isSpace(data[valueEnd - 1])) { --valueEnd; }
+
+            const char* name = data + lineStart;
+            qint32 nameLength = nameEnd - lineStart;
+            const char* value = data + valueStart;
+            qint32 valueLength = valueEnd - valueStart;
+
+            if (!typeChecked &&
+                (nameIs(name, nameLength, "nt") || nameIs(name, nameLength, "st")))
+            {
+                if (!acceptType(value, valueLength))
+                {
+                    m_rejected.fetchAndAddRelaxed(1);
+                    return false;
+                }
+                typeChecked = true;
+            }
+            else if (!udnChecked && nameIs(name, nameLength, "usn"))
+            {
+                if (!acceptUdn(value, valueLength))
+                {
+                    m_rejected.fetchAndAddRelaxed(1);
+                    return false;
+                }
+                udnChecked = true;
+            }
+        }
+
+        pos = lineEnd < size ? lineEnd : -1;
+    }
+
+    if (!typeChecked || !udnChecked)
+    {
+        // the datagram lacks the header fields required by the filter
+        m_rejected.fetchAndAddRelaxed(1);
+        return false;
+    }
+
+    m_accepted.fetchAndAddRelaxed(1);
+    return true;
+}
+
+}
+}
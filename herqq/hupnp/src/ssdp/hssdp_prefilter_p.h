@@ -0,0 +1,114 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HSSDP_PREFILTER_P_H_
+#define HSSDP_PREFILTER_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "../general/hupnp_defs.h"
+
+#include <QtCore/QSet>
+#include <QtCore/QList>
+#include <QtCore/QAtomicInt>
+#include <QtCore/QPair>
+#include <QtCore/QByteArray>
+#include <QtNetwork/QHostAddress>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+class HUdn;
+class HResourceType;
+
+//
+// A filter that is run against raw SSDP datagrams before they are parsed.
+//
+// The filter is "compiled" from lists of accepted resource types, accepted
+// and rejected UDNs and accepted source subnets into byte strings, which are
+// matched against the NT, ST and USN header fields of a datagram without
+// constructing any HTTP header or discovery message objects.
+//
+// M-SEARCH requests are never filtered, since they do not describe
+// resources.
+//
+class HSsdpPrefilter
+{
+H_DISABLE_COPY(HSsdpPrefilter)
+
+private:
+
+    QList<QPair<QByteArray, qint32> > m_resourceTypes;
+    // the resource type without the version, lower-cased and ending with
+    // a colon, and the minimum accepted version
+
+    QSet<QByteArray> m_acceptedUdns;
+    QSet<QByteArray> m_rejectedUdns;
+    // lower-cased "uuid:..." strings
+
+    QList<QPair<QHostAddress, int> > m_subnets;
+
+    QAtomicInt m_accepted;
+    QAtomicInt m_rejected;
+    // the filter is shared by the SSDP handlers, which may run accept() in
+    // their own I/O threads
+
+    bool acceptType(const char* value, qint32 length) const;
+    bool acceptUdn(const char* value, qint32 length) const;
+
+public:
+
+    HSsdpPrefilter();
+
+    void setResourceTypes(const QList<HResourceType>&);
+    void setAcceptedUdns(const QList<HUdn>&);
+    void setRejectedUdns(const QList<HUdn>&);
+    void setSubnets(const QList<QPair<QHostAddress, int> >&);
+
+    // returns true in case the filter has no criteria and accepts everything
+    bool isEmpty() const;
+
+    bool accept(const QByteArray& datagram, const QHostAddress& source);
+
+    inline quint32 acceptedCount() const
+    {
+        return static_cast<quint32>(static_cast<int>(m_accepted));
+    }
+
+    inline quint32 rejectedCount() const
+    {
+        return static_cast<quint32>(static_cast<int>(m_rejected));
+    }
+};
+
+}
+}
+
+#endif /* HSSDP_PREFILTER_P_H_ */
@@ -1,10 +1,12 @@
 HEADERS += \
     $$SRC_LOC/ssdp/hssdp.h \
     $$SRC_LOC/ssdp/hssdp_p.h \
+    $$SRC_LOC/ssdp/hssdp_prefilter_p.h \
     $$SRC_LOC/ssdp/hdiscovery_messages.h \
 	$$SRC_LOC/ssdp/hssdp_messagecreator_p.h
 
 SOURCES += \
     $$SRC_LOC/ssdp/hssdp.cpp \
+    $$SRC_LOC/ssdp/hssdp_prefilter_p.cpp \
     $$SRC_LOC/ssdp/hdiscovery_messages.cpp \
 	$$SRC_LOC/ssdp/hssdp_messagecreator_p.cpp
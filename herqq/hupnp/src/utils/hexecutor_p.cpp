@@ -0,0 +1,411 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hexecutor_p.h"
+
+#include "../general/hlogger_p.h"
+
+#include <QtCore/QThread>
+#include <QtCore/QMutexLocker>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace
+{
+const qint32 PriorityCount = HExecutorTask::DescriptionPriority + 1;
+
+QMutex s_sharedMutex;
+HExecutor* s_shared = 0;
+qint32 s_sharedReferences = 0;
+}
+
+/*******************************************************************************
+ * HExecutorTask
+ ******************************************************************************/
+HExecutorTask::HExecutorTask(Priority priority, const void* group) :
+    m_priority(priority), m_group(group), m_autoDelete(true)
+{
+}
+
+HExecutorTask::~HExecutorTask()
+{
+}
+
+/*******************************************************************************
+ * HExecutor::Worker
+ ******************************************************************************/
+class HExecutor::Worker :
+    public QThread
+{
+H_DISABLE_COPY(Worker)
+
+private:
+
+    HExecutor* m_owner;
+
+protected:
+
+    virtual void run()
+    {
+        m_owner->workerLoop(this);
+    }
+
+public:
+
+    QMutex m_queueMutex;
+    QList<HExecutorTask*> m_queues[PriorityCount];
+
+    Worker(HExecutor* owner) :
+        m_owner(owner), m_queueMutex()
+    {
+    }
+
+    inline HExecutor* owner() const { return m_owner; }
+};
+
+/*******************************************************************************
+ * HExecutor
+ ******************************************************************************/
+HExecutor::HExecutor(qint32 workerCount) :
+    m_workers(), m_mutex(), m_taskAvailable(), m_groupDone(),
+    m_outstanding(), m_nextWorker(0), m_exiting(false), m_statistics()
+{
+    for(qint32 i = 0; i < PriorityCount; ++i)
+    {
+        m_pending[i] = 0;
+    }
+
+    if (workerCount <= 0)
+    {
+        workerCount = qMax(2, QThread::idealThreadCount());
+    }
+
+    for(qint32 i = 0; i < workerCount; ++i)
+    {
+        m_workers.append(new Worker(this));
+    }
+
+    foreach(Worker* worker, m_workers)
+    {
+        worker->start();
+    }
+}
+
+HExecutor::~HExecutor()
+{
+    shutdown();
+    qDeleteAll(m_workers);
+}
+
+HExecutor* HExecutor::acquireShared()
+{
+    QMutexLocker locker(&s_sharedMutex);
+    if (!s_shared)
+    {
+        s_shared = new HExecutor();
+    }
+
+    ++s_sharedReferences;
+    return s_shared;
+}
+
+void HExecutor::releaseShared()
+{
+    QMutexLocker locker(&s_sharedMutex);
+    Q_ASSERT(s_sharedReferences > 0);
+
+    if (--s_sharedReferences == 0)
+    {
+        delete s_shared; s_shared = 0;
+    }
+}
+
+HExecutor::Worker* HExecutor::currentWorker() const
+{
+    Worker* worker = dynamic_cast<Worker*>(QThread::currentThread());
+    return worker && worker->owner() == this ? worker : 0;
+}
+
+bool HExecutor::hasPending() const
+{
+    for(qint32 i = 0; i < PriorityCount; ++i)
+    {
+        if (m_pending[i] > 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool HExecutor::submit(HExecutorTask* task)
+{
+    Q_ASSERT(task);
+
+    QMutexLocker locker(&m_mutex);
+    if (m_exiting)
+    {
+        locker.unlock();
+        if (task->autoDelete())
+        {
+            delete task;
+        }
+        return false;
+    }
+
+    ++m_pending[task->priority()];
+    ++m_outstanding[task->group()];
+    ++m_statistics.m_tasksSubmitted;
+
+    Worker* worker = currentWorker();
+    if (!worker)
+    {
+        worker = m_workers.at(m_nextWorker++ % m_workers.size());
+    }
+
+    QMutexLocker queueLocker(&worker->m_queueMutex);
+    worker->m_queues[task->priority()].append(task);
+    queueLocker.unlock();
+
+    m_taskAvailable.wakeOne();
+    return true;
+}
+
+HExecutorTask* HExecutor::take(Worker* worker)
+{
+    qint32 workerIndex = m_workers.indexOf(worker);
+
+    for(qint32 priority = 0; priority < PriorityCount; ++priority)
+    {
+        HExecutorTask* task = 0;
+        bool stolen = false;
+
+        QMutexLocker ownLocker(&worker->m_queueMutex);
+        if (!worker->m_queues[priority].isEmpty())
+        {
+            task = worker->m_queues[priority].takeLast();
+        }
+        ownLocker.unlock();
+
+        for(qint32 i = 1; !task && i < m_workers.size(); ++i)
+        {
+            Worker* victim = m_workers.at((workerIndex + i) % m_workers.size());
+
+            QMutexLocker victimLocker(&victim->m_queueMutex);
+            if (!victim->m_queues[priority].isEmpty())
+            {
+                task = victim->m_queues[priority].takeFirst();
+                stolen = true;
+            }
+        }
+
+        if (task)
+        {
+            QMutexLocker locker(&m_mutex);
+            --m_pending[priority];
+            if (stolen)
+            {
+                ++m_statistics.m_tasksStolen;
+            }
+
+            return task;
+        }
+    }
+
+    return 0;
+}
+
+void HExecutor::finished(const void* group, qint32 count)
+{
+    // m_mutex has to be locked
+    QHash<const void*, qint32>::iterator it = m_outstanding.find(group);
+    Q_ASSERT(it != m_outstanding.end());
+
+    it.value() -= count;
+    if (it.value() <= 0)
+    {
+        m_outstanding.erase(it);
+        m_groupDone.wakeAll();
+    }
+}
+
+void HExecutor::workerLoop(Worker* worker)
+{
+    for(;;)
+    {
+        HExecutorTask* task = take(worker);
+        if (!task)
+        {
+            QMutexLocker locker(&m_mutex);
+            while(!m_exiting && !hasPending())
+            {
+                m_taskAvailable.wait(&m_mutex);
+            }
+
+            if (m_exiting)
+            {
+                // the queued tasks are cancelled by shutdown()
+                return;
+            }
+
+            continue;
+        }
+
+        // a task that is not auto deleted may be deleted by its owner as soon
+        // as it has been run
+        const void* group = task->group();
+        bool autoDelete = task->autoDelete();
+
+        task->run();
+
+        if (autoDelete)
+        {
+            delete task;
+        }
+
+        QMutexLocker locker(&m_mutex);
+        ++m_statistics.m_tasksCompleted;
+        finished(group, 1);
+    }
+}
+
+void HExecutor::cancel(const void* group)
+{
+    Q_ASSERT_X(!currentWorker(), H_AT, "A task cannot cancel tasks");
+
+    QList<HExecutorTask*> cancelled;
+
+    QMutexLocker locker(&m_mutex);
+    foreach(Worker* worker, m_workers)
+    {
+        QMutexLocker queueLocker(&worker->m_queueMutex);
+        for(qint32 priority = 0; priority < PriorityCount; ++priority)
+        {
+            QList<HExecutorTask*>& queue = worker->m_queues[priority];
+            for(qint32 i = queue.size() - 1; i >= 0; --i)
+            {
+                if (queue.at(i)->group() == group)
+                {
+                    cancelled.append(queue.takeAt(i));
+                    --m_pending[priority];
+                }
+            }
+        }
+    }
+
+    if (!cancelled.isEmpty())
+    {
+        m_statistics.m_tasksCancelled += cancelled.size();
+        finished(group, cancelled.size());
+    }
+
+    locker.unlock();
+
+    foreach(HExecutorTask* task, cancelled)
+    {
+        if (task->autoDelete())
+        {
+            delete task;
+        }
+    }
+
+    wait(group);
+}
+
+void HExecutor::wait(const void* group)
+{
+    Q_ASSERT_X(!currentWorker(), H_AT, "A task cannot wait for tasks");
+
+    QMutexLocker locker(&m_mutex);
+    while(m_outstanding.value(group) > 0)
+    {
+        m_groupDone.wait(&m_mutex);
+    }
+}
+
+void HExecutor::shutdown()
+{
+    Q_ASSERT_X(!currentWorker(), H_AT, "A task cannot shut down the executor");
+
+    QList<HExecutorTask*> cancelled;
+
+    QMutexLocker locker(&m_mutex);
+    if (m_exiting)
+    {
+        return;
+    }
+
+    m_exiting = true;
+
+    foreach(Worker* worker, m_workers)
+    {
+        QMutexLocker queueLocker(&worker->m_queueMutex);
+        for(qint32 priority = 0; priority < PriorityCount; ++priority)
+        {
+            foreach(HExecutorTask* task, worker->m_queues[priority])
+            {
+                finished(task->group(), 1);
+                cancelled.append(task);
+            }
+
+            m_pending[priority] -= worker->m_queues[priority].size();
+            worker->m_queues[priority].clear();
+        }
+    }
+
+    m_statistics.m_tasksCancelled += cancelled.size();
+    m_taskAvailable.wakeAll();
+
+    locker.unlock();
+
+    foreach(HExecutorTask* task, cancelled)
+    {
+        if (task->autoDelete())
+        {
+            delete task;
+        }
+    }
+
+    foreach(Worker* worker, m_workers)
+    {
+        worker->wait();
+    }
+}
+
+qint32 HExecutor::queueDepth(HExecutorTask::Priority priority) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_pending[priority];
+}
+
+HExecutorStatistics HExecutor::statistics() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_statistics;
+}
+
+}
+}
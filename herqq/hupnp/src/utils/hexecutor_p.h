@@ -0,0 +1,218 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HEXECUTOR_P_H_
+#define HEXECUTOR_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "../general/hupnp_defs.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QWaitCondition>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+class HExecutor;
+
+//
+// A unit of work run by an HExecutor.
+//
+// Every task belongs to a group, which is usually the object that submitted
+// it. The group is used to wait for, or to cancel, the tasks of a single
+// user of a shared executor.
+//
+class HExecutorTask
+{
+H_DISABLE_COPY(HExecutorTask)
+friend class HExecutor;
+
+public:
+
+    //
+    // The priorities in the order in which the tasks are picked.
+    //
+    enum Priority
+    {
+        ActionPriority = 0,
+        DeviceBuildPriority,
+        DescriptionPriority
+    };
+
+private:
+
+    const Priority m_priority;
+    const void* const m_group;
+    bool m_autoDelete;
+
+public:
+
+    explicit HExecutorTask(Priority priority, const void* group = 0);
+    virtual ~HExecutorTask() = 0;
+
+    virtual void run() = 0;
+
+    inline Priority priority() const { return m_priority; }
+    inline const void* group() const { return m_group; }
+
+    // when true, the executor deletes the task after it has been run or
+    // cancelled. the default is true.
+    inline bool autoDelete() const { return m_autoDelete; }
+    inline void setAutoDelete(bool arg) { m_autoDelete = arg; }
+};
+
+//
+// Counters describing how an HExecutor has been utilized.
+//
+class HExecutorStatistics
+{
+public:
+
+    quint32 m_tasksSubmitted;
+    quint32 m_tasksCompleted;
+
+    quint32 m_tasksStolen;
+    // the number of tasks a worker took from the queue of another worker
+
+    quint32 m_tasksCancelled;
+    // the number of tasks removed from the queues before they were run
+
+    inline HExecutorStatistics() :
+        m_tasksSubmitted(0), m_tasksCompleted(0), m_tasksStolen(0),
+        m_tasksCancelled(0)
+    {
+    }
+};
+
+//
+// A work-stealing executor.
+//
+// Each worker thread has a queue of its own for every priority. A task
+// submitted by a worker is put into the queue of that worker, other tasks are
+// distributed to the workers in turn. A worker runs the most recently queued
+// task of its own queue and when its queue is empty it takes the oldest task
+// from the queue of another worker. Tasks of a higher priority are always
+// picked before the tasks of a lower priority.
+//
+// The executor shared by every control point and device host of a process
+// is accessed through acquireShared() and releaseShared().
+//
+// This class is thread-safe.
+//
+class HExecutor
+{
+H_DISABLE_COPY(HExecutor)
+
+private:
+
+    class Worker;
+
+    QList<Worker*> m_workers;
+
+    mutable QMutex m_mutex;
+    // guards the members below. when a queue of a worker is locked as well,
+    // this has to be locked first.
+
+    QWaitCondition m_taskAvailable;
+    QWaitCondition m_groupDone;
+
+    qint32 m_pending[HExecutorTask::DescriptionPriority + 1];
+    // the number of queued tasks of each priority
+
+    QHash<const void*, qint32> m_outstanding;
+    // the number of queued and running tasks of each group
+
+    quint32 m_nextWorker;
+
+    bool m_exiting;
+
+    HExecutorStatistics m_statistics;
+
+    Worker* currentWorker() const;
+    bool hasPending() const;
+
+    HExecutorTask* take(Worker*);
+    void finished(const void* group, qint32 count);
+
+    void workerLoop(Worker*);
+
+public:
+
+    //
+    // workerCount == the number of worker threads. if this is zero or negative
+    // the number is based on the number of processor cores.
+    //
+    explicit HExecutor(qint32 workerCount = 0);
+
+    // calls shutdown()
+    ~HExecutor();
+
+    static HExecutor* acquireShared();
+    static void releaseShared();
+
+    //
+    // Queues the task. The executor takes the ownership of a task that is to
+    // be auto deleted. Returns false if the executor is shutting down, in which
+    // case an auto deleted task is deleted right away.
+    //
+    bool submit(HExecutorTask*);
+
+    //
+    // Removes the queued tasks of the group and waits for its running tasks
+    // to complete. Must not be called from a task.
+    //
+    void cancel(const void* group);
+
+    //
+    // Waits for every queued and running task of the group to complete.
+    // Must not be called from a task.
+    //
+    void wait(const void* group);
+
+    //
+    // Cancels every queued task and waits for the running tasks to complete.
+    // The executor accepts no tasks after this.
+    //
+    void shutdown();
+
+    qint32 queueDepth(HExecutorTask::Priority) const;
+
+    inline qint32 workerCount() const { return m_workers.size(); }
+
+    HExecutorStatistics statistics() const;
+};
+
+}
+}
+
+#endif /* HEXECUTOR_P_H_ */
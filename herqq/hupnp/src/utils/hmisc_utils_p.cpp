@@ -41,6 +41,38 @@ unsigned long hash(const char *str, int n)
     return hash_value;
 }
 
+quint32 hash(const QUuid& uuid)
+{
+    quint32 hash_value = uuid.data1;
+
+    hash_value ^= (quint32(uuid.data2) << 16) | uuid.data3;
+
+    hash_value ^=
+        (quint32(uuid.data4[0]) << 24) | (quint32(uuid.data4[1]) << 16) |
+        (quint32(uuid.data4[2]) << 8)  |  quint32(uuid.data4[3]);
+
+    hash_value ^=
+        (quint32(uuid.data4[4]) << 24) | (quint32(uuid.data4[5]) << 16) |
+        (quint32(uuid.data4[6]) << 8)  |  quint32(uuid.data4[7]);
+
+    return hash_value;
+}
+
+HUuidKey::HUuidKey(const QString& value) :
+    m_uuid(value), m_value(), m_hash(0)
+{
+    if (!m_uuid.isNull())
+    {
+        m_hash = hash(m_uuid);
+    }
+    else
+    {
+        m_value = value;
+        QByteArray data = value.toLocal8Bit();
+        m_hash = hash(data.constData(), data.size());
+    }
+}
+
 QHostAddress findBindableHostAddress()
 {
     QHostAddress address = QHostAddress::LocalHost;
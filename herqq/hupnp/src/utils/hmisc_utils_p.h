@@ -24,6 +24,9 @@
 
 #include <HUpnpCore/HUpnp>
 
+#include <QtCore/QUuid>
+#include <QtCore/QString>
+
 class QHostAddress;
 
 //
@@ -44,6 +47,57 @@ namespace Herqq
  */
 H_UPNP_CORE_EXPORT unsigned long hash(const char* str, int n);
 
+//
+// Hashes the 128 bits of a UUID without converting it to a string.
+//
+H_UPNP_CORE_EXPORT quint32 hash(const QUuid&);
+
+//
+// A UUID used as a key of a QHash. The hash value is computed once, when the
+// key is created, and the keys are compared in binary form.
+//
+// A key created from a string that is not a valid UUID, such as the UDN of
+// some legacy devices, is hashed and compared by the string.
+//
+class H_UPNP_CORE_EXPORT HUuidKey
+{
+private:
+
+    QUuid m_uuid;
+    QString m_value;
+    quint32 m_hash;
+
+public:
+
+    inline HUuidKey() : m_uuid(), m_value(), m_hash(0) {}
+    inline HUuidKey(const QUuid& uuid) :
+        m_uuid(uuid), m_value(), m_hash(hash(uuid))
+    {
+    }
+
+    explicit HUuidKey(const QString&);
+
+    inline const QUuid& uuid() const { return m_uuid; }
+    inline const QString& value() const { return m_value; }
+    inline quint32 hashValue() const { return m_hash; }
+};
+
+inline bool operator==(const HUuidKey& key1, const HUuidKey& key2)
+{
+    return key1.hashValue() == key2.hashValue() &&
+           key1.uuid() == key2.uuid() && key1.value() == key2.value();
+}
+
+inline bool operator!=(const HUuidKey& key1, const HUuidKey& key2)
+{
+    return !(key1 == key2);
+}
+
+inline quint32 qHash(const HUuidKey& key)
+{
+    return key.hashValue();
+}
+
 H_UPNP_CORE_EXPORT QHostAddress findBindableHostAddress();
 
 H_UPNP_CORE_EXPORT bool toBool(const QString&, bool* ok);
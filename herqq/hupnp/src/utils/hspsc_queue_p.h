@@ -0,0 +1,135 @@
+/*
+ *  Copyright (C) 2010, 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP (HUPnP) library.
+ *
+ *  Herqq UPnP is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Herqq UPnP. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HSPSC_QUEUE_P_H_
+#define HSPSC_QUEUE_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "hglobal.h"
+
+#include <QtCore/QAtomicInt>
+
+namespace Herqq
+{
+
+//
+// A bounded lock-free queue for exactly one producer thread and exactly one
+// consumer thread.
+//
+// The capacity is rounded up to a power of two. The producer owns the tail
+// index and the consumer owns the head index; each thread publishes its index
+// with release semantics and reads the index of the other thread with acquire
+// semantics, which makes the slot contents visible to the other side without
+// locking.
+//
+template<typename T>
+class HSpscQueue
+{
+H_DISABLE_COPY(HSpscQueue)
+
+private:
+
+    T* m_buffer;
+    qint32 m_mask;
+
+    QAtomicInt m_head;
+    QAtomicInt m_tail;
+
+    static inline qint32 load(QAtomicInt& value)
+    {
+        return value.fetchAndAddAcquire(0);
+    }
+
+public:
+
+    explicit HSpscQueue(qint32 capacity) :
+        m_buffer(0), m_mask(0), m_head(0), m_tail(0)
+    {
+        qint32 size = 2;
+        while(size < capacity) { size <<= 1; }
+
+        m_buffer = new T[size];
+        m_mask = size - 1;
+    }
+
+    ~HSpscQueue()
+    {
+        delete[] m_buffer;
+    }
+
+    inline qint32 capacity() const { return m_mask + 1; }
+
+    // producer side.
+    // returns false in case the queue is full, in which case the item
+    // is not enqueued.
+    bool enqueue(const T& item)
+    {
+        qint32 tail = load(m_tail);
+        if (tail - load(m_head) > m_mask)
+        {
+            return false;
+        }
+
+        m_buffer[tail & m_mask] = item;
+        m_tail.fetchAndStoreRelease(tail + 1);
+
+        return true;
+    }
+
+    // consumer side.
+    // returns false in case the queue is empty.
+    bool dequeue(T* item)
+    {
+        Q_ASSERT(item);
+
+        qint32 head = load(m_head);
+        if (head == load(m_tail))
+        {
+            return false;
+        }
+
+        T& slot = m_buffer[head & m_mask];
+        *item = slot;
+        slot = T();
+        // releases the resources held by the item as soon as possible
+
+        m_head.fetchAndStoreRelease(head + 1);
+
+        return true;
+    }
+
+    // may be called from either side; the value is a snapshot
+    inline qint32 size()
+    {
+        return load(m_tail) - load(m_head);
+    }
+};
+
+}
+
+#endif /* HSPSC_QUEUE_P_H_ */
@@ -3,7 +3,8 @@ HEADERS += \
     $$SRC_LOC/hfunctor.h \
     $$SRC_LOC/hglobal.h \
     $$SRC_LOC/hsysutils_p.h \
-    $$SRC_LOC/hthreadpool_p.h
+    $$SRC_LOC/hspsc_queue_p.h \
+    $$SRC_LOC/hexecutor_p.h
     
 EXPORTED_PRIVATE_HEADERS += \
     $$SRC_LOC/hmisc_utils_p.h
@@ -11,4 +12,4 @@ EXPORTED_PRIVATE_HEADERS += \
 SOURCES += \
     $$SRC_LOC/hmisc_utils_p.cpp \
     $$SRC_LOC/hsysutils_p.cpp \
-    $$SRC_LOC/hthreadpool_p.cpp
+    $$SRC_LOC/hexecutor_p.cpp
@@ -0,0 +1 @@
+#include "../../../src/cds_model/datasource/hcds_datasource_snapshot.h"
@@ -19,6 +19,8 @@ HEADERS += \
     $$SRC_LOC/cds_model/datasource/habstract_cds_datasource.h \
     $$SRC_LOC/cds_model/datasource/hcds_datasource_p.h \
     $$SRC_LOC/cds_model/datasource/hcds_datasource.h \
+    $$SRC_LOC/cds_model/datasource/hcds_datasource_snapshot.h \
+    $$SRC_LOC/cds_model/datasource/hcds_datasource_snapshot_p.h \
     $$SRC_LOC/cds_model/datasource/hrootdir.h \
     $$SRC_LOC/cds_model/datasource/hfsys_datasource.h \
     $$SRC_LOC/cds_model/datasource/hfsys_datasource_p.h \
@@ -126,6 +128,7 @@ SOURCES += \
     $$SRC_LOC/cds_model/hscheduledtime.cpp \
     $$SRC_LOC/cds_model/datasource/habstract_cds_datasource.cpp \
     $$SRC_LOC/cds_model/datasource/hcds_datasource.cpp \
+    $$SRC_LOC/cds_model/datasource/hcds_datasource_snapshot.cpp \
     $$SRC_LOC/cds_model/datasource/hrootdir.cpp \
     $$SRC_LOC/cds_model/datasource/hfsys_datasource.cpp \
     $$SRC_LOC/cds_model/datasource/hcds_datasource_configuration.cpp \
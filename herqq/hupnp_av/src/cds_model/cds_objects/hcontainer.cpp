@@ -222,6 +222,15 @@ bool HContainer::hasChildId(const QString& childId) const
     return h->m_childIds.contains(childId);
 }
 
+void HContainer::notifyContainerModified(const HContainerEventInfo& info)
+{
+    emit containerModified(this, info);
+    if (h_ptr->m_observer)
+    {
+        h_ptr->m_observer->containerModified(this, info);
+    }
+}
+
 void HContainer::setChildIds(const QSet<QString>& childIds)
 {
     H_D(HContainer);
@@ -237,8 +246,8 @@ void HContainer::setChildIds(const QSet<QString>& childIds)
         if (!copy.contains(id))
         {
             it = h->m_childIds.erase(it);
-            emit containerModified(
-                this, HContainerEventInfo(HContainerEventInfo::ChildRemoved, id));
+            notifyContainerModified(
+                HContainerEventInfo(HContainerEventInfo::ChildRemoved, id));
         }
         else
         {
@@ -250,8 +259,8 @@ void HContainer::setChildIds(const QSet<QString>& childIds)
     foreach(const QString& id, copy)
     {
         h->m_childIds.insert(id);
-        emit containerModified(
-            this, HContainerEventInfo(HContainerEventInfo::ChildAdded, id));
+        notifyContainerModified(
+            HContainerEventInfo(HContainerEventInfo::ChildAdded, id));
     }
 
     if (differentExpectedCount)
@@ -271,8 +280,8 @@ void HContainer::addChildIds(const QSet<QString>& childIds)
         {
             h->m_childIds.insert(id);
 
-            emit containerModified(
-                this, HContainerEventInfo(HContainerEventInfo::ChildAdded, id));
+            notifyContainerModified(
+                HContainerEventInfo(HContainerEventInfo::ChildAdded, id));
 
             modified = true;
         }
@@ -292,8 +301,8 @@ void HContainer::addChildId(const QString& childId)
     {
         h->m_childIds.insert(childId);
 
-        emit containerModified(
-            this, HContainerEventInfo(HContainerEventInfo::ChildAdded, childId));
+        notifyContainerModified(
+            HContainerEventInfo(HContainerEventInfo::ChildAdded, childId));
 
         setExpectedChildCount(h->m_childIds.size());
     }
@@ -307,8 +316,8 @@ void HContainer::removeChildId(const QString& childId)
     {
         h->m_childIds.remove(childId);
 
-        emit containerModified(
-            this, HContainerEventInfo(HContainerEventInfo::ChildRemoved, childId));
+        notifyContainerModified(
+            HContainerEventInfo(HContainerEventInfo::ChildRemoved, childId));
 
         setExpectedChildCount(h->m_childIds.size());
     }
@@ -325,8 +334,8 @@ void HContainer::removeChildIds(const QSet<QString>& childIDs)
         {
             h->m_childIds.remove(id);
 
-            emit containerModified(
-                this, HContainerEventInfo(HContainerEventInfo::ChildRemoved, id));
+            notifyContainerModified(
+                HContainerEventInfo(HContainerEventInfo::ChildRemoved, id));
 
             modified = true;
         }
@@ -269,6 +269,14 @@ protected:
     // Documented in HClonable
     virtual void doClone(HClonable* target) const;
 
+    //
+    // \internal
+    //
+    // Emits containerModified() and informs the data source that owns the
+    // container.
+    //
+    void notifyContainerModified(const HContainerEventInfo& info);
+
 public:
 
      /*!
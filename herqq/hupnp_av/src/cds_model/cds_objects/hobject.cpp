@@ -24,6 +24,8 @@
 #include "hcontainer.h"
 #include "hitem.h"
 
+#include "../hgenre.h"
+#include "../hpersonwithrole.h"
 #include "../../common/hresource.h"
 #include "../../common/hprotocolinfo.h"
 #include "../model_mgmt/hcdsproperty.h"
@@ -32,7 +34,9 @@
 #include <HUpnpCore/private/hlogger_p.h>
 #include <HUpnpCore/private/hmisc_utils_p.h>
 
+#include <QtCore/QUrl>
 #include <QtCore/QMutex>
+#include <QtCore/QStringList>
 #include <QtCore/QXmlStreamWriter>
 
 /*!
@@ -190,14 +194,208 @@ bool operator==(const HObjectEventInfo& obj1, const HObjectEventInfo& obj2)
 /*******************************************************************************
  * HObjectPrivate
  ******************************************************************************/
+namespace
+{
+// The pool of interned property values. Each distinct value is reference
+// counted by the objects that store it and removed from the pool once the
+// last of them releases it. The pool is split into stripes that are locked
+// independently, which keeps the objects that are created in different
+// threads from contending for a single lock.
+class HInternedValues
+{
+public:
+
+    enum
+    {
+        StripeCount = 16
+    };
+
+    class Entry
+    {
+    public:
+
+        QVariant m_value;
+        qint32 m_refs;
+
+        inline Entry() : m_value(), m_refs(0) {}
+    };
+
+    QMutex m_mutexes[StripeCount];
+    QHash<QString, Entry> m_values[StripeCount];
+
+    static inline qint32 stripe(const QString& key)
+    {
+        return static_cast<qint32>(qHash(key) % StripeCount);
+    }
+};
+
+HInternedValues s_internedValues;
+
+// Only the properties whose values are expected to repeat across the objects
+// of a library are interned. Values that are mostly unique, such as
+// parent IDs and album art URIs, would only add to the size of the pool.
+bool isInternable(qint32 prop)
+{
+    switch(prop)
+    {
+    case HCdsProperties::upnp_class:
+    case HCdsProperties::dc_creator:
+    case HCdsProperties::dc_publisher:
+    case HCdsProperties::dc_contributor:
+    case HCdsProperties::upnp_artist:
+    case HCdsProperties::upnp_actor:
+    case HCdsProperties::upnp_author:
+    case HCdsProperties::upnp_producer:
+    case HCdsProperties::upnp_director:
+    case HCdsProperties::upnp_album:
+    case HCdsProperties::upnp_genre:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool appendKey(const QVariant& value, QString* key)
+{
+    const QChar sep(0x1f);
+
+    key->append(QString::number(value.userType())).append(sep);
+    if (value.type() == QVariant::String)
+    {
+        key->append(value.toString());
+    }
+    else if (value.type() == QVariant::StringList)
+    {
+        key->append(value.toStringList().join(QString(sep)));
+    }
+    else if (value.type() == QVariant::Url)
+    {
+        key->append(value.toUrl().toString());
+    }
+    else if (value.userType() == qMetaTypeId<HPersonWithRole>())
+    {
+        HPersonWithRole person = value.value<HPersonWithRole>();
+        key->append(person.name()).append(sep).append(person.role());
+    }
+    else if (value.userType() == qMetaTypeId<HGenre>())
+    {
+        HGenre genre = value.value<HGenre>();
+        key->append(genre.name()).append(sep).append(genre.id()).append(sep).
+            append(genre.extended().join(QString(sep)));
+    }
+    else
+    {
+        return false;
+    }
+
+    key->append(QChar(0x1e));
+    return true;
+}
+
+// Returns false in case the value is not of a kind that is interned.
+bool internKey(qint32 prop, const QVariant& value, QString* key)
+{
+    if (!isInternable(prop) || value.isNull())
+    {
+        return false;
+    }
+
+    key->append(QString::number(prop)).append(QChar(0x1e));
+    if (value.type() == QVariant::List)
+    {
+        foreach(const QVariant& var, value.toList())
+        {
+            if (!appendKey(var, key))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    return appendKey(value, key);
+}
+
+// Returns the pooled copy of the specified value and adds a reference to it,
+// or returns the value itself in case the value is not of a kind that
+// is interned. Every call has to be paired with a call to release().
+QVariant intern(qint32 prop, const QVariant& value)
+{
+    QString key;
+    if (!internKey(prop, value, &key))
+    {
+        return value;
+    }
+
+    qint32 stripe = HInternedValues::stripe(key);
+
+    QMutexLocker locker(&s_internedValues.m_mutexes[stripe]);
+    HInternedValues::Entry& entry = s_internedValues.m_values[stripe][key];
+    if (!entry.m_refs++)
+    {
+        entry.m_value = value;
+    }
+    return entry.m_value;
+}
+
+void release(qint32 prop, const QVariant& value)
+{
+    QString key;
+    if (!internKey(prop, value, &key))
+    {
+        return;
+    }
+
+    qint32 stripe = HInternedValues::stripe(key);
+
+    QMutexLocker locker(&s_internedValues.m_mutexes[stripe]);
+    QHash<QString, HInternedValues::Entry>& values =
+        s_internedValues.m_values[stripe];
+
+    QHash<QString, HInternedValues::Entry>::iterator it = values.find(key);
+    Q_ASSERT(it != values.end());
+    if (it != values.end() && !--it->m_refs)
+    {
+        values.erase(it);
+    }
+}
+
+// Returns the index of the first value that is not stored for a property
+// less than the specified property.
+qint32 lowerBound(const QVector<QPair<qint32, QVariant> >& values, qint32 prop)
+{
+    qint32 low = 0, high = values.size();
+    while (low < high)
+    {
+        qint32 mid = (low + high) / 2;
+        if (values[mid].first < prop)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return low;
+}
+}
+
 HObjectPrivate::HObjectPrivate(const QString& clazz, HObject::CdsType cdsType) :
-    m_properties(),
+    m_values(),
     m_cdsType(cdsType),
-    m_disabledProperties()
+    m_observer(0)
 {
     Q_ASSERT(cdsType != HObject::UndefinedCdsType);
     Q_UNUSED(regMetaT)
 
+    for (qint32 i = 0; i < PropertyMaskWords; ++i)
+    {
+        m_properties[i] = 0;
+        m_disabledProperties[i] = 0;
+    }
+
     const HCdsProperties& inst = HCdsProperties::instance();
     insert(inst.get(HCdsProperties::dlite_id));
     insert(inst.get(HCdsProperties::dlite_parentId));
@@ -213,6 +411,79 @@ HObjectPrivate::HObjectPrivate(const QString& clazz, HObject::CdsType cdsType) :
 
 HObjectPrivate::~HObjectPrivate()
 {
+    releaseValues();
+}
+
+void HObjectPrivate::releaseValues()
+{
+    for (qint32 i = 0; i < m_values.size(); ++i)
+    {
+        release(m_values[i].first, m_values[i].second);
+    }
+    m_values.clear();
+}
+
+void HObjectPrivate::setValues(const QVector<QPair<qint32, QVariant> >& values)
+{
+    releaseValues();
+
+    m_values.reserve(values.size());
+    for (qint32 i = 0; i < values.size(); ++i)
+    {
+        m_values.append(
+            qMakePair(values[i].first, intern(values[i].first, values[i].second)));
+    }
+}
+
+QVariant HObjectPrivate::value(qint32 prop) const
+{
+    qint32 i = lowerBound(m_values, prop);
+    if (i < m_values.size() && m_values[i].first == prop)
+    {
+        return m_values[i].second;
+    }
+    return HCdsProperties::instance().get(
+        static_cast<HCdsProperties::Property>(prop)).defaultValue();
+}
+
+void HObjectPrivate::setValue(qint32 prop, const QVariant& value)
+{
+    qint32 i = lowerBound(m_values, prop);
+    if (i < m_values.size() && m_values[i].first == prop)
+    {
+        QVariant oldValue = m_values[i].second;
+        m_values[i].second = intern(prop, value);
+        release(prop, oldValue);
+    }
+    else
+    {
+        m_values.insert(i, qMakePair(prop, intern(prop, value)));
+    }
+}
+
+QHash<QString, QVariant> HObjectPrivate::properties() const
+{
+    QHash<QString, QVariant> retVal;
+
+    const HCdsProperties& inst = HCdsProperties::instance();
+    for (qint32 prop = 1, i = 0; prop < PropertyMaskWords * 64; ++prop)
+    {
+        if (!hasProperty(prop))
+        {
+            continue;
+        }
+
+        while (i < m_values.size() && m_values[i].first < prop) { ++i; }
+
+        const HCdsPropertyInfo& info =
+            inst.get(static_cast<HCdsProperties::Property>(prop));
+
+        retVal.insert(info.name(),
+            i < m_values.size() && m_values[i].first == prop ?
+                m_values[i].second : info.defaultValue());
+    }
+
+    return retVal;
 }
 
 /*******************************************************************************
@@ -263,39 +534,42 @@ bool HObject::isInitialized() const
 
 bool HObject::hasCdsProperty(const QString& property) const
 {
-    return h_ptr->m_properties.contains(property);
+    return h_ptr->hasProperty(HCdsProperties::instance().get(property).type());
 }
 
 bool HObject::hasCdsProperty(HCdsProperties::Property property) const
 {
-    return h_ptr->m_properties.contains(HCdsProperties::instance().get(property).name());
+    return h_ptr->hasProperty(property);
 }
 
 bool HObject::isCdsPropertySet(const QString& property) const
 {
-    QVariant var = h_ptr->m_properties.value(property);
-    return var.isValid() && !var.isNull();
+    return isCdsPropertySet(HCdsProperties::instance().get(property).type());
 }
 
 bool HObject::isCdsPropertySet(HCdsProperties::Property property) const
 {
-    QVariant var = h_ptr->m_properties.value(HCdsProperties::instance().get(property).name());
+    if (!h_ptr->hasProperty(property))
+    {
+        return false;
+    }
+    QVariant var = h_ptr->value(property);
     return var.isValid() && !var.isNull();
 }
 
 bool HObject::setCdsProperty(const QString& property, const QVariant& value)
 {
-    if (h_ptr->m_properties.contains(property))
+    const HCdsPropertyInfo& info = HCdsProperties::instance().get(property);
+    if (h_ptr->hasProperty(info.type()))
     {
-        QVariant oldValue = h_ptr->m_properties.value(property);
-        h_ptr->m_properties.insert(property, value);
-        const HCdsPropertyInfo& info = HCdsProperties::instance().get(property);
-        if (info.isValid() &&
-            info.type() != HCdsProperties::upnp_objectUpdateID &&
+        QVariant oldValue = h_ptr->value(info.type());
+        h_ptr->setValue(info.type(), value);
+        notifyChanged();
+        if (info.type() != HCdsProperties::upnp_objectUpdateID &&
             info.type() != HCdsProperties::upnp_containerUpdateID &&
             info.type() != HCdsProperties::upnp_totalDeletedChildCount)
         {
-            emit objectModified(this, HObjectEventInfo(property, oldValue, value));
+            notifyObjectModified(HObjectEventInfo(property, oldValue, value));
         }
         return true;
     }
@@ -304,17 +578,18 @@ bool HObject::setCdsProperty(const QString& property, const QVariant& value)
 
 bool HObject::setCdsProperty(HCdsProperties::Property property, const QVariant& value)
 {
-    const HCdsPropertyInfo& info = HCdsProperties::instance().get(property);
-    if (h_ptr->m_properties.contains(info.name()))
+    if (h_ptr->hasProperty(property))
     {
-        QVariant oldValue = h_ptr->m_properties.value(info.name());
-        h_ptr->m_properties.insert(info.name(), value);
+        QVariant oldValue = h_ptr->value(property);
+        h_ptr->setValue(property, value);
+        notifyChanged();
         if (property != HCdsProperties::upnp_objectUpdateID &&
             property != HCdsProperties::upnp_containerUpdateID &&
             property != HCdsProperties::upnp_totalDeletedChildCount &&
             property != HCdsProperties::dlite_res)
         {
-            emit objectModified(this, HObjectEventInfo(info.name(), oldValue, value));
+            notifyObjectModified(HObjectEventInfo(
+                HCdsProperties::instance().get(property).name(), oldValue, value));
         }
         return true;
     }
@@ -323,25 +598,16 @@ bool HObject::setCdsProperty(HCdsProperties::Property property, const QVariant&
 
 bool HObject::getCdsProperty(const QString& property, QVariant* value) const
 {
-    Q_ASSERT(value);
-
-    if (h_ptr->m_properties.contains(property))
-    {
-        *value = h_ptr->m_properties.value(property);
-        return true;
-    }
-
-    return false;
+    return getCdsProperty(HCdsProperties::instance().get(property).type(), value);
 }
 
 bool HObject::getCdsProperty(HCdsProperties::Property property, QVariant* value) const
 {
     Q_ASSERT(value);
 
-    const HCdsPropertyInfo& info = HCdsProperties::instance().get(property);
-    if (h_ptr->m_properties.contains(info.name()))
+    if (h_ptr->hasProperty(property))
     {
-        *value = h_ptr->m_properties.value(info.name());
+        *value = h_ptr->value(property);
         return true;
     }
 
@@ -350,15 +616,12 @@ bool HObject::getCdsProperty(HCdsProperties::Property property, QVariant* value)
 
 bool HObject::isCdsPropertyActive(const QString& property) const
 {
-    if (!hasCdsProperty(property)) { return false; }
-    return !h_ptr->m_disabledProperties.contains(property);
+    return isCdsPropertyActive(HCdsProperties::instance().get(property).type());
 }
 
 bool HObject::isCdsPropertyActive(HCdsProperties::Property property) const
 {
-    if (!hasCdsProperty(property)) { return false; }
-    const HCdsPropertyInfo& info = HCdsProperties::instance().get(property);
-    return !h_ptr->m_disabledProperties.contains(info.name());
+    return h_ptr->hasProperty(property) && !h_ptr->isDisabled(property);
 }
 
 bool HObject::isValid() const
@@ -418,23 +681,33 @@ bool HObject::enableCdsProperty(const QString& property, bool arg)
         return false;
     }
 
-    if (arg)
+    qint32 prop = HCdsProperties::instance().get(property).type();
+    if (arg && !h_ptr->isDisabled(prop))
     {
-        if (!h_ptr->m_disabledProperties.contains(property))
-        {
-            return false;
-        }
-        else
-        {
-            h_ptr->m_disabledProperties.removeOne(property);
-        }
+        return false;
     }
-    else if (!h_ptr->m_disabledProperties.contains(property))
+
+    HObjectPrivate::set(h_ptr->m_disabledProperties, prop, !arg);
+    notifyChanged();
+
+    return true;
+}
+
+void HObject::notifyChanged()
+{
+    if (h_ptr->m_observer)
     {
-        h_ptr->m_disabledProperties.append(property);
+        h_ptr->m_observer->objectChanged(this);
     }
+}
 
-    return true;
+void HObject::notifyObjectModified(const HObjectEventInfo& info)
+{
+    emit objectModified(this, info);
+    if (h_ptr->m_observer)
+    {
+        h_ptr->m_observer->objectModified(this, info);
+    }
 }
 
 bool HObject::validate() const
@@ -466,14 +739,18 @@ void HObject::doClone(HClonable* target) const
     if (obj)
     {
         obj->h_ptr->m_cdsType = h_ptr->m_cdsType;
-        obj->h_ptr->m_disabledProperties = h_ptr->m_disabledProperties;
-        obj->h_ptr->m_properties = h_ptr->m_properties;
+        for (qint32 i = 0; i < HObjectPrivate::PropertyMaskWords; ++i)
+        {
+            obj->h_ptr->m_properties[i] = h_ptr->m_properties[i];
+            obj->h_ptr->m_disabledProperties[i] = h_ptr->m_disabledProperties[i];
+        }
+        obj->h_ptr->setValues(h_ptr->m_values);
     }
 }
 
 QHash<QString, QVariant> HObject::cdsProperties() const
 {
-    return h_ptr->m_properties;
+    return h_ptr->properties();
 }
 
 bool HObject::neverPlayable() const
@@ -216,6 +216,7 @@ H_DISABLE_COPY(HObject)
 H_DECLARE_PRIVATE(HObject)
 
 friend class HCdsDidlLiteSerializerPrivate;
+friend class HAbstractCdsDataSourcePrivate;
 
 public:
 
@@ -596,6 +597,18 @@ protected: // attributes
     // Documented in HClonable
     virtual void doClone(HClonable* target) const;
 
+    //
+    // \internal
+    //
+    // Informs the data source that owns the object that the object has changed.
+    //
+    void notifyChanged();
+
+    //
+    // Emits objectModified() and informs the data source that owns the object.
+    //
+    void notifyObjectModified(const HObjectEventInfo& info);
+
 public:
 
     /*!
@@ -31,12 +31,14 @@
 //
 
 #include <HUpnpAv/HObject>
+#include <HUpnpAv/HCdsProperties>
 #include <HUpnpAv/HCdsPropertyInfo>
 
 #include <QtCore/QHash>
+#include <QtCore/QPair>
 #include <QtCore/QString>
+#include <QtCore/QVector>
 #include <QtCore/QVariant>
-#include <QtCore/QLinkedList>
 
 namespace Herqq
 {
@@ -70,7 +72,33 @@ QList<T> toList(const QList<QVariant>& values)
 }
 
 //
+// Receives the modification notifications of the objects owned by a data
+// source. A data source registers itself as the observer of every object it
+// takes, which is considerably cheaper than a signal-slot connection per object.
 //
+class HObjectObserver
+{
+public:
+
+    virtual ~HObjectObserver() {}
+
+    // called whenever the state of the object changes, including the changes
+    // for which no modification event is signaled
+    virtual void objectChanged(HObject*) = 0;
+
+    virtual void objectModified(HObject*, const HObjectEventInfo&) = 0;
+    virtual void containerModified(HContainer*, const HContainerEventInfo&) = 0;
+};
+
+//
+// Implementation details of HObject.
+//
+// The properties an object has are stored as a bit per
+// HCdsProperties::Property and only the values that have been set are stored.
+// A property that has not been set has the default value of the property.
+// The values of the properties that often repeat across the objects of a
+// library, such as the class, the album and the artist, are interned so that
+// the objects share a single copy of each distinct value.
 //
 class HObjectPrivate
 {
@@ -78,21 +106,78 @@ H_DISABLE_COPY(HObjectPrivate)
 
 public:
 
-    QHash<QString, QVariant> m_properties;
+    enum
+    {
+        PropertyMaskWords = 2
+    };
+
+    quint64 m_properties[PropertyMaskWords];
+    // the properties the object has
+
+    quint64 m_disabledProperties[PropertyMaskWords];
+
+    QVector<QPair<qint32, QVariant> > m_values;
+    // the values that have been set, sorted by the property. the interned
+    // values are released when they are replaced or the object is deleted
+
     HObject::CdsType m_cdsType;
-    QLinkedList<QString> m_disabledProperties;
+
+    HObjectObserver* m_observer;
+    // the data source that owns the object, if any
 
     HObjectPrivate(const QString& clazz, HObject::CdsType cdsType);
     virtual ~HObjectPrivate();
 
+    static inline bool test(const quint64* mask, qint32 prop)
+    {
+        return prop > 0 && prop < PropertyMaskWords * 64 &&
+            (mask[prop >> 6] & (Q_UINT64_C(1) << (prop & 63)));
+    }
+
+    static inline void set(quint64* mask, qint32 prop, bool enable)
+    {
+        Q_ASSERT(prop >= 0 && prop < PropertyMaskWords * 64);
+        if (enable)
+        {
+            mask[prop >> 6] |= Q_UINT64_C(1) << (prop & 63);
+        }
+        else
+        {
+            mask[prop >> 6] &= ~(Q_UINT64_C(1) << (prop & 63));
+        }
+    }
+
+    inline bool hasProperty(qint32 prop) const
+    {
+        return test(m_properties, prop);
+    }
+
+    inline bool isDisabled(qint32 prop) const
+    {
+        return test(m_disabledProperties, prop);
+    }
+
+    // returns the default value of the property in case it has not been set
+    QVariant value(qint32 prop) const;
+
+    void setValue(qint32 prop, const QVariant&);
+
+    // replaces every value with the specified values
+    void setValues(const QVector<QPair<qint32, QVariant> >&);
+    void releaseValues();
+
+    QHash<QString, QVariant> properties() const;
+
     inline void insert(const HCdsPropertyInfo& arg)
     {
-        m_properties.insert(arg.name(), arg.defaultValue());
+        set(m_properties, arg.type(), true);
     }
 
     inline void insert(const QString& arg, const QVariant& var)
     {
-        m_properties.insert(arg, var);
+        qint32 prop = HCdsProperties::instance().get(arg).type();
+        set(m_properties, prop, true);
+        setValue(prop, var);
     }
 };
 
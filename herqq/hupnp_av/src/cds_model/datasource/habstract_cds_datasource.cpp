@@ -21,6 +21,7 @@
 
 #include "habstract_cds_datasource.h"
 #include "habstract_cds_datasource_p.h"
+#include "hcds_datasource_snapshot_p.h"
 #include "hcds_datasource_configuration.h"
 #include "../cds_objects/hitem.h"
 #include "../cds_objects/hcontainer.h"
@@ -47,14 +48,19 @@ namespace Av
  *******************************************************************************/
 HAbstractCdsDataSourcePrivate::HAbstractCdsDataSourcePrivate() :
     m_configuration(0), m_objectsById(), m_objectIdsByParentId(),
-    m_initialized(false), q_ptr(0)
+    m_initialized(false), m_bulkAdd(false), m_bulkAddIds(), m_snapshot(),
+    m_snapshotMutex(), m_snapshotPublished(false), m_snapshotVersion(0),
+    m_snapshotDirtyIds(), q_ptr(0)
 {
 }
 
 HAbstractCdsDataSourcePrivate::HAbstractCdsDataSourcePrivate(
     const HCdsDataSourceConfiguration& conf) :
         m_configuration(conf.clone()), m_objectsById(),
-        m_objectIdsByParentId(), m_initialized(false), q_ptr(0)
+        m_objectIdsByParentId(), m_initialized(false), m_bulkAdd(false),
+        m_bulkAddIds(), m_snapshot(), m_snapshotMutex(),
+        m_snapshotPublished(false), m_snapshotVersion(0), m_snapshotDirtyIds(),
+        q_ptr(0)
 {
 }
 
@@ -66,23 +72,35 @@ HAbstractCdsDataSourcePrivate::~HAbstractCdsDataSourcePrivate()
 
 void HAbstractCdsDataSourcePrivate::add(HObject* obj)
 {
-    bool ok = QObject::connect(
-        obj,
-        SIGNAL(objectModified(Herqq::Upnp::Av::HObject*, Herqq::Upnp::Av::HObjectEventInfo)),
-        q_ptr,
-        SLOT(objectModified_(Herqq::Upnp::Av::HObject*, Herqq::Upnp::Av::HObjectEventInfo)));
-    Q_ASSERT(ok); Q_UNUSED(ok)
+    // The data source is informed of the modifications directly, since
+    // a signal-slot connection per object gets expensive with large libraries.
+    obj->h_ptr->m_observer = this;
 
     m_objectsById.insert(obj->id(), obj);
+    markDirty(obj->id());
+}
+
+void HAbstractCdsDataSourcePrivate::objectChanged(HObject* source)
+{
+    markDirty(source->id());
+}
 
-    if (obj->isContainer())
+void HAbstractCdsDataSourcePrivate::objectModified(
+    HObject* source, const HObjectEventInfo& eventInfo)
+{
+    if (!m_bulkAdd)
     {
-        ok = QObject::connect(
-            obj,
-            SIGNAL(containerModified(Herqq::Upnp::Av::HContainer*, Herqq::Upnp::Av::HContainerEventInfo)),
-            q_ptr,
-            SLOT(containerModified_(Herqq::Upnp::Av::HContainer*, Herqq::Upnp::Av::HContainerEventInfo)));
-        Q_ASSERT(ok);
+        q_ptr->objectModified_(source, eventInfo);
+    }
+}
+
+void HAbstractCdsDataSourcePrivate::containerModified(
+    HContainer* source, const HContainerEventInfo& eventInfo)
+{
+    markDirty(source->id());
+    if (!m_bulkAdd)
+    {
+        q_ptr->containerModified_(source, eventInfo);
     }
 }
 
@@ -122,7 +140,13 @@ bool HAbstractCdsDataSourcePrivate::add(
         Q_ASSERT(false);
     }
 
-    if (retVal && pid != "-1")
+    if (retVal && m_bulkAdd)
+    {
+        // The parent-child relationships are resolved once the bulk add is
+        // committed.
+        m_bulkAddIds.insert(id);
+    }
+    else if (retVal && pid != "-1")
     {
         if (!m_objectsById.contains(pid))
         {
@@ -173,6 +197,57 @@ bool HAbstractCdsDataSourcePrivate::add(
     return retVal;
 }
 
+void HAbstractCdsDataSourcePrivate::linkBulkAdded()
+{
+    // Group the added objects by their parents first, so that every parent
+    // is looked up and updated only once.
+    QHash<QString, QSet<QString> > childIdsByParentId;
+    foreach(const QString& id, m_bulkAddIds)
+    {
+        HObject* obj = m_objectsById.value(id);
+        Q_ASSERT(obj);
+
+        QString pid = obj->parentId();
+        if (pid != "-1")
+        {
+            childIdsByParentId[pid].insert(id);
+        }
+
+        QSet<QString>* children = m_objectIdsByParentId.take(id);
+        if (children)
+        {
+            // The object is the parent of objects that were added before it.
+            childIdsByParentId[id].unite(*children);
+            delete children;
+        }
+    }
+
+    QHash<QString, QSet<QString> >::const_iterator it =
+        childIdsByParentId.constBegin();
+
+    for(; it != childIdsByParentId.constEnd(); ++it)
+    {
+        HObject* parent = m_objectsById.value(it.key());
+        if (parent)
+        {
+            Q_ASSERT(parent->isContainer());
+            static_cast<HContainer*>(parent)->addChildIds(it.value());
+        }
+        else
+        {
+            // The parent object is not in control of this data source. Store
+            // the IDs in case the parent is added later on.
+            QSet<QString>* pids = m_objectIdsByParentId.value(it.key());
+            if (!pids)
+            {
+                pids = new QSet<QString>();
+                m_objectIdsByParentId.insert(it.key(), pids);
+            }
+            pids->unite(it.value());
+        }
+    }
+}
+
 /*******************************************************************************
  * HAbstractCdsDataSource
  *******************************************************************************/
@@ -412,12 +487,57 @@ bool HAbstractCdsDataSource::add(HObject* object, AddFlag addFlag)
     return h_ptr->add(object, addFlag);
 }
 
+bool HAbstractCdsDataSource::beginBulkAdd(qint32 expectedCount)
+{
+    if (h_ptr->m_bulkAdd)
+    {
+        return false;
+    }
+
+    if (expectedCount > 0)
+    {
+        h_ptr->m_objectsById.reserve(h_ptr->m_objectsById.size() + expectedCount);
+        h_ptr->m_bulkAddIds.reserve(expectedCount);
+    }
+
+    h_ptr->m_bulkAdd = true;
+    return true;
+}
+
+qint32 HAbstractCdsDataSource::commitBulkAdd()
+{
+    if (!h_ptr->m_bulkAdd)
+    {
+        return 0;
+    }
+
+    h_ptr->linkBulkAdded();
+    h_ptr->m_bulkAdd = false;
+
+    QSet<QString> addedIds = h_ptr->m_bulkAddIds;
+    h_ptr->m_bulkAddIds.clear();
+
+    if (!addedIds.isEmpty())
+    {
+        emit objectsAdded(addedIds);
+    }
+
+    return addedIds.size();
+}
+
+bool HAbstractCdsDataSource::isBulkAddInProgress() const
+{
+    return h_ptr->m_bulkAdd;
+}
+
 bool HAbstractCdsDataSource::remove(const QString& id)
 {
     if (h_ptr->m_objectsById.contains(id))
     {
         delete h_ptr->m_objectsById.value(id);
         h_ptr->m_objectsById.remove(id);
+        h_ptr->m_bulkAddIds.remove(id);
+        h_ptr->markDirty(id);
         return true;
     }
     return false;
@@ -433,6 +553,8 @@ qint32 HAbstractCdsDataSource::remove(const HObjects& objects)
         {
             delete h_ptr->m_objectsById.value(id);
             h_ptr->m_objectsById.remove(id);
+            h_ptr->m_bulkAddIds.remove(id);
+            h_ptr->markDirty(id);
             ++removed;
         }
     }
@@ -448,6 +570,8 @@ qint32 HAbstractCdsDataSource::remove(const QSet<QString>& ids)
         {
             delete h_ptr->m_objectsById.value(id);
             h_ptr->m_objectsById.remove(id);
+            h_ptr->m_bulkAddIds.remove(id);
+            h_ptr->markDirty(id);
             ++removed;
         }
     }
@@ -458,8 +582,81 @@ void HAbstractCdsDataSource::clear()
 {
     qDeleteAll(h_ptr->m_objectsById);
     h_ptr->m_objectsById.clear();
+    h_ptr->m_bulkAddIds.clear();
     qDeleteAll(h_ptr->m_objectIdsByParentId);
     h_ptr->m_objectIdsByParentId.clear();
+
+    // The next snapshot is built from scratch.
+    h_ptr->m_snapshotPublished = false;
+    h_ptr->m_snapshotDirtyIds.clear();
+}
+
+namespace
+{
+QSharedPointer<HObject> snapshotCopy(const HObject* obj)
+{
+    HObject* copy = obj->clone();
+
+    // The copy is shared between snapshot versions and it is deleted by
+    // whichever thread releases the last version referring to it. An object
+    // without thread affinity can be deleted from any thread.
+    copy->moveToThread(0);
+
+    return QSharedPointer<HObject>(copy);
+}
+}
+
+void HAbstractCdsDataSource::publishSnapshot()
+{
+    HCdsDataSourceSnapshotPrivate* snapshot;
+    if (h_ptr->m_snapshotPublished)
+    {
+        // The snapshot member is replaced only here, which is why it can be
+        // read without locking. It must not be detached, though.
+        const HCdsDataSourceSnapshot& current = h_ptr->m_snapshot;
+        snapshot = new HCdsDataSourceSnapshotPrivate(*current.h_ptr);
+        foreach(const QString& id, h_ptr->m_snapshotDirtyIds)
+        {
+            HObject* obj = h_ptr->m_objectsById.value(id);
+            if (obj)
+            {
+                snapshot->m_objectsById.insert(id, snapshotCopy(obj));
+            }
+            else
+            {
+                snapshot->m_objectsById.remove(id);
+            }
+        }
+    }
+    else
+    {
+        snapshot = new HCdsDataSourceSnapshotPrivate();
+        snapshot->m_objectsById.reserve(h_ptr->m_objectsById.size());
+
+        QHash<QString, HObject*>::const_iterator it =
+            h_ptr->m_objectsById.constBegin();
+
+        for(; it != h_ptr->m_objectsById.constEnd(); ++it)
+        {
+            snapshot->m_objectsById.insert(it.key(), snapshotCopy(it.value()));
+        }
+    }
+
+    snapshot->m_version = ++h_ptr->m_snapshotVersion;
+
+    h_ptr->m_snapshotPublished = true;
+    h_ptr->m_snapshotDirtyIds.clear();
+
+    HCdsDataSourceSnapshot newSnapshot(snapshot);
+
+    QMutexLocker locker(&h_ptr->m_snapshotMutex);
+    h_ptr->m_snapshot = newSnapshot;
+}
+
+HCdsDataSourceSnapshot HAbstractCdsDataSource::snapshot() const
+{
+    QMutexLocker locker(&h_ptr->m_snapshotMutex);
+    return h_ptr->m_snapshot;
 }
 
 }
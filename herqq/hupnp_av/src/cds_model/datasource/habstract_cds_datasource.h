@@ -23,6 +23,7 @@
 #define HABSTRACT_CDS_DATASOURCE_H_
 
 #include <HUpnpAv/HUpnpAv>
+#include <HUpnpAv/HCdsDataSourceSnapshot>
 
 #include <QtCore/QObject>
 
@@ -46,7 +47,8 @@ class HAbstractCdsDataSourcePrivate;
  *
  * \ingroup hupnp_av_cds_ds
  *
- * \remarks This class is not thread-safe.
+ * \remarks This class is not thread-safe. Use snapshot() to read the contents
+ * of the data source from other threads.
  *
  * \sa HAbstractCdsDataSourceConfiguration
  */
@@ -230,6 +232,49 @@ protected:
      */
     bool add(HObject* object, AddFlag addFlag=AddNewOnly);
 
+    /*!
+     * Starts adding a large number of objects to the data source.
+     *
+     * Until commitBulkAdd() is called, the objects passed to add() are stored
+     * into the data source, but their parent-child relationships are not
+     * resolved and no signals are emitted for them. This makes populating
+     * the data source considerably faster.
+     *
+     * \param expectedCount specifies the number of objects that are about to
+     * be added, if known. This is used to reserve capacity up front.
+     *
+     * \return \e true in case the bulk add was started. \e false is returned
+     * when a bulk add is already in progress.
+     *
+     * \remarks the modifications of the objects of the data source are not
+     * signaled until the bulk add is committed.
+     *
+     * \sa commitBulkAdd(), isBulkAddInProgress(), objectsAdded()
+     */
+    bool beginBulkAdd(qint32 expectedCount = 0);
+
+    /*!
+     * Completes the bulk add started with beginBulkAdd().
+     *
+     * The parent-child relationships of the added objects are resolved in a
+     * single pass and objectsAdded() is emitted once for all the objects that
+     * were added.
+     *
+     * \return The number of objects added during the bulk add.
+     *
+     * \sa beginBulkAdd()
+     */
+    qint32 commitBulkAdd();
+
+    /*!
+     * \brief Indicates if a bulk add is in progress.
+     *
+     * \return \e true in case a bulk add is in progress.
+     *
+     * \sa beginBulkAdd(), commitBulkAdd()
+     */
+    bool isBulkAddInProgress() const;
+
     /*!
      * Removes the specified object from the data source.
      *
@@ -482,6 +527,42 @@ public:
      */
     HContainers containers() const;
 
+    /*!
+     * Publishes a snapshot of the current contents of the data source.
+     *
+     * The objects that have been added, modified or removed since the
+     * previous snapshot was published are copied to the new snapshot and the
+     * rest of the objects are shared with the previous snapshot. The first
+     * snapshot copies every object in the data source.
+     *
+     * \remarks
+     * \li this has to be called from the thread in which the data source lives,
+     * as is the case with every method of this class except snapshot().
+     *
+     * \li the snapshots that have already been retrieved by calling snapshot()
+     * are not affected.
+     *
+     * \li once the first snapshot has been published, HContentDirectoryService
+     * publishes a new one after the changes it tracks, so that the objects it
+     * returns agree with the update IDs it events.
+     *
+     * \sa snapshot()
+     */
+    void publishSnapshot();
+
+    /*!
+     * \brief Returns the latest published snapshot of the data source.
+     *
+     * \return The latest published snapshot of the data source. The returned
+     * object is null if no snapshot has been published.
+     *
+     * \remarks this method is thread-safe and it does not wait for
+     * publishSnapshot() to complete.
+     *
+     * \sa publishSnapshot(), HCdsDataSourceSnapshot
+     */
+    HCdsDataSourceSnapshot snapshot() const;
+
 Q_SIGNALS:
 
     /*!
@@ -515,6 +596,19 @@ Q_SIGNALS:
      * \param source specifies the HObject that has been added.
      */
     void independentObjectAdded(Herqq::Upnp::Av::HObject* source);
+
+    /*!
+     * \brief This signal is emitted when a bulk add has been committed.
+     *
+     * This signal replaces the containerModified() and
+     * independentObjectAdded() signals that would have been emitted had the
+     * objects been added one at a time.
+     *
+     * \param objectIds specifies the IDs of the objects that were added.
+     *
+     * \sa commitBulkAdd()
+     */
+    void objectsAdded(const QSet<QString>& objectIds);
 };
 
 }
@@ -31,8 +31,12 @@
 //
 
 #include <HUpnpAv/HAbstractCdsDataSource>
+#include <HUpnpAv/HCdsDataSourceSnapshot>
+#include "../cds_objects/hobject_p.h"
 
+#include <QtCore/QSet>
 #include <QtCore/QHash>
+#include <QtCore/QMutex>
 #include <QtCore/QString>
 #include <QtCore/QScopedPointer>
 
@@ -48,7 +52,8 @@ namespace Av
 //
 //
 //
-class H_UPNP_AV_EXPORT HAbstractCdsDataSourcePrivate
+class H_UPNP_AV_EXPORT HAbstractCdsDataSourcePrivate :
+    public HObjectObserver
 {
 H_DISABLE_COPY(HAbstractCdsDataSourcePrivate)
 H_DECLARE_PUBLIC(HAbstractCdsDataSource)
@@ -62,6 +67,24 @@ public: // attributes
 
     bool m_initialized;
 
+    bool m_bulkAdd;
+    // when true, the objects are only stored until commitBulkAdd() is called
+    // and the modification notifications of the objects are not forwarded.
+
+    QSet<QString> m_bulkAddIds;
+    // the IDs of the objects added during the current bulk add
+
+    HCdsDataSourceSnapshot m_snapshot;
+    QMutex m_snapshotMutex;
+    // guards m_snapshot, which is the only member accessed from other threads
+
+    bool m_snapshotPublished;
+    quint32 m_snapshotVersion;
+
+    QSet<QString> m_snapshotDirtyIds;
+    // the IDs of the objects that have been added, modified or removed after
+    // the latest snapshot was published
+
     HAbstractCdsDataSource* q_ptr;
 
 public: // methods
@@ -72,6 +95,20 @@ public: // methods
 
     void add(HObject*);
     bool add(HObject*, HAbstractCdsDataSource::AddFlag addFlag);
+
+    void linkBulkAdded();
+
+    inline void markDirty(const QString& id)
+    {
+        if (m_snapshotPublished)
+        {
+            m_snapshotDirtyIds.insert(id);
+        }
+    }
+
+    virtual void objectChanged(HObject*);
+    virtual void objectModified(HObject*, const HObjectEventInfo&);
+    virtual void containerModified(HContainer*, const HContainerEventInfo&);
 };
 
 }
@@ -82,6 +82,8 @@ public:
     virtual ~HCdsDataSource();
 
     using HAbstractCdsDataSource::add;
+    using HAbstractCdsDataSource::beginBulkAdd;
+    using HAbstractCdsDataSource::commitBulkAdd;
     using HAbstractCdsDataSource::remove;
     using HAbstractCdsDataSource::clear;
     using HAbstractCdsDataSource::configuration;
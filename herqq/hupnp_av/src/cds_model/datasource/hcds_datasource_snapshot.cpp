@@ -0,0 +1,136 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hcds_datasource_snapshot.h"
+#include "hcds_datasource_snapshot_p.h"
+
+#include "../cds_objects/hitem.h"
+#include "../cds_objects/hcontainer.h"
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+/*******************************************************************************
+ * HCdsDataSourceSnapshot
+ *******************************************************************************/
+HCdsDataSourceSnapshot::HCdsDataSourceSnapshot() :
+    h_ptr(new HCdsDataSourceSnapshotPrivate())
+{
+}
+
+HCdsDataSourceSnapshot::HCdsDataSourceSnapshot(
+    HCdsDataSourceSnapshotPrivate* dd) :
+        h_ptr(dd)
+{
+}
+
+HCdsDataSourceSnapshot::HCdsDataSourceSnapshot(
+    const HCdsDataSourceSnapshot& other) :
+        h_ptr(other.h_ptr)
+{
+    Q_ASSERT(&other != this);
+}
+
+HCdsDataSourceSnapshot& HCdsDataSourceSnapshot::operator=(
+    const HCdsDataSourceSnapshot& other)
+{
+    Q_ASSERT(&other != this);
+    h_ptr = other.h_ptr;
+    return *this;
+}
+
+HCdsDataSourceSnapshot::~HCdsDataSourceSnapshot()
+{
+}
+
+bool HCdsDataSourceSnapshot::isNull() const
+{
+    return !h_ptr->m_version;
+}
+
+quint32 HCdsDataSourceSnapshot::version() const
+{
+    return h_ptr->m_version;
+}
+
+qint32 HCdsDataSourceSnapshot::count() const
+{
+    return h_ptr->m_objectsById.size();
+}
+
+HObject* HCdsDataSourceSnapshot::findObject(const QString& objectId) const
+{
+    return h_ptr->m_objectsById.value(objectId).data();
+}
+
+HObjects HCdsDataSourceSnapshot::findObjects(
+    const QSet<QString>& objectIds) const
+{
+    HObjects retVal;
+    foreach(const QString& objectId, objectIds)
+    {
+        HObject* obj = h_ptr->m_objectsById.value(objectId).data();
+        if (obj)
+        {
+            retVal.append(obj);
+        }
+    }
+    return retVal;
+}
+
+HItem* HCdsDataSourceSnapshot::findItem(const QString& itemId) const
+{
+    HObject* obj = findObject(itemId);
+    return obj && obj->isItem() ? static_cast<HItem*>(obj) : 0;
+}
+
+HContainer* HCdsDataSourceSnapshot::findContainer(
+    const QString& containerId) const
+{
+    HObject* obj = findObject(containerId);
+    return obj && obj->isContainer() ? static_cast<HContainer*>(obj) : 0;
+}
+
+HObjects HCdsDataSourceSnapshot::objects() const
+{
+    HObjects retVal;
+    retVal.reserve(h_ptr->m_objectsById.size());
+
+    QHash<QString, QSharedPointer<HObject> >::const_iterator it =
+        h_ptr->m_objectsById.constBegin();
+
+    for(; it != h_ptr->m_objectsById.constEnd(); ++it)
+    {
+        retVal.append(it.value().data());
+    }
+
+    return retVal;
+}
+
+}
+}
+}
@@ -0,0 +1,188 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HCDS_DATASOURCE_SNAPSHOT_H_
+#define HCDS_DATASOURCE_SNAPSHOT_H_
+
+#include <HUpnpAv/HUpnpAv>
+
+#include <QtCore/QSet>
+#include <QtCore/QString>
+#include <QtCore/QSharedDataPointer>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+class HCdsDataSourceSnapshotPrivate;
+
+/*!
+ * \brief This class provides a read-only view to the objects of a data source
+ * as they were when the snapshot was published.
+ *
+ * A data source and the objects it owns can be used only from the thread in
+ * which the data source lives. A snapshot can be used to read the contents of
+ * a data source from other threads while the data source is being modified.
+ * The thread that modifies the data source publishes a new snapshot by calling
+ * HAbstractCdsDataSource::publishSnapshot() and other threads retrieve
+ * the latest published snapshot with HAbstractCdsDataSource::snapshot().
+ *
+ * The objects of a snapshot are copies of the objects of the data source and
+ * the objects that are not modified between two snapshots are shared by the
+ * snapshots. A snapshot never changes once it has been published, which is
+ * why the contents of a snapshot can be read without locking.
+ *
+ * \headerfile hcds_datasource_snapshot.h HCdsDataSourceSnapshot
+ *
+ * \ingroup hupnp_av_cds_ds
+ *
+ * \remarks
+ * \li This class is thread-safe.
+ *
+ * \li The objects returned by this class are shared by every holder of the
+ * snapshot and they must not be modified. The objects remain valid as long as
+ * the snapshot they are retrieved from exists.
+ *
+ * \sa HAbstractCdsDataSource::snapshot(),
+ * HAbstractCdsDataSource::publishSnapshot()
+ */
+class H_UPNP_AV_EXPORT HCdsDataSourceSnapshot
+{
+friend class HAbstractCdsDataSource;
+
+private:
+
+    QSharedDataPointer<HCdsDataSourceSnapshotPrivate> h_ptr;
+    HCdsDataSourceSnapshot(HCdsDataSourceSnapshotPrivate*);
+
+public:
+
+    /*!
+     * \brief Creates a new, null instance.
+     *
+     * \sa isNull()
+     */
+    HCdsDataSourceSnapshot();
+
+    /*!
+     * \brief Copy constructor.
+     *
+     * Creates a copy of \c other.
+     */
+    HCdsDataSourceSnapshot(const HCdsDataSourceSnapshot& other);
+
+    /*!
+     * \brief Assignment operator.
+     *
+     * Copies the contents of \c other to this.
+     */
+    HCdsDataSourceSnapshot& operator=(const HCdsDataSourceSnapshot& other);
+
+    /*!
+     * \brief Destroys the instance.
+     */
+    ~HCdsDataSourceSnapshot();
+
+    /*!
+     * \brief Indicates if the object is null, i.e. it was not published by
+     * a data source.
+     *
+     * \return \e true in case the object is null.
+     */
+    bool isNull() const;
+
+    /*!
+     * \brief Returns the version of the snapshot.
+     *
+     * Each snapshot published by a data source has a version greater than
+     * the snapshot published before it.
+     *
+     * \return The version of the snapshot. A null snapshot has the version 0.
+     */
+    quint32 version() const;
+
+    /*!
+     * \brief Returns the number of objects in the snapshot.
+     *
+     * \return The number of objects in the snapshot.
+     */
+    qint32 count() const;
+
+    /*!
+     * Attempts to find an object with the given object ID.
+     *
+     * \param objectId specifies the object to be searched.
+     *
+     * \return The object with the given object ID, or null, if the snapshot
+     * does not contain an object with the specified ID.
+     *
+     * \sa findItem(), findContainer()
+     */
+    HObject* findObject(const QString& objectId) const;
+
+    /*!
+     * Attempts to find objects with the specified object IDs.
+     *
+     * \param objectIds specifies the object IDs to be searched.
+     *
+     * \return The objects with the given object IDs. IDs that are not found
+     * are ignored.
+     */
+    HObjects findObjects(const QSet<QString>& objectIds) const;
+
+    /*!
+     * Attempts to find an HItem with the given ID.
+     *
+     * \param itemId specifies the item to be searched.
+     *
+     * \return The HItem with the given ID, or null, if the snapshot
+     * does not contain an HItem with the specified ID.
+     */
+    HItem* findItem(const QString& itemId) const;
+
+    /*!
+     * Attempts to find an HContainer with the given ID.
+     *
+     * \param containerId specifies the container to be searched.
+     *
+     * \return The HContainer with the given ID, or null, if the snapshot
+     * does not contain an HContainer with the specified ID.
+     */
+    HContainer* findContainer(const QString& containerId) const;
+
+    /*!
+     * \brief Returns all the objects of the snapshot.
+     *
+     * \return all the objects of the snapshot.
+     */
+    HObjects objects() const;
+};
+
+}
+}
+}
+
+#endif /* HCDS_DATASOURCE_SNAPSHOT_H_ */
@@ -0,0 +1,76 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HCDS_DATASOURCE_SNAPSHOT_P_H_
+#define HCDS_DATASOURCE_SNAPSHOT_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include "hcds_datasource_snapshot.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QSharedData>
+#include <QtCore/QSharedPointer>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+//
+// Implementation details of HCdsDataSourceSnapshot.
+//
+// The objects are copies of the objects of the data source. A new version is
+// created from the previous one by copying the hash and replacing the objects
+// that have changed, which is why the unchanged objects are shared between
+// versions.
+//
+class HCdsDataSourceSnapshotPrivate :
+    public QSharedData
+{
+H_DISABLE_ASSIGN(HCdsDataSourceSnapshotPrivate)
+
+public:
+
+    QHash<QString, QSharedPointer<HObject> > m_objectsById;
+    quint32 m_version;
+
+    HCdsDataSourceSnapshotPrivate() :
+        m_objectsById(), m_version(0)
+    {
+    }
+};
+
+}
+}
+}
+
+#endif /* HCDS_DATASOURCE_SNAPSHOT_P_H_ */
@@ -124,6 +124,8 @@ bool HFileSystemDataSource::doInit()
 
     const HFileSystemDataSourceConfiguration* conf = configuration();
     HRootDirs rootDirs = conf->rootDirs();
+
+    beginBulkAdd();
     foreach(const HRootDir& rootDir, rootDirs)
     {
         QList<HCdsObjectData*> items;
@@ -132,11 +134,13 @@ bool HFileSystemDataSource::doInit()
             if (!h->add(items))
             {
                 qDeleteAll(items);
+                commitBulkAdd();
                 return false;
             }
         }
         qDeleteAll(items);
     }
+    commitBulkAdd();
 
     return true;
 }
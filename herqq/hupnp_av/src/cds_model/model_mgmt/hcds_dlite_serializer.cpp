@@ -102,35 +102,29 @@ void addNamespaces(QXmlStreamReader& reader)
     reader.addExtraNamespaceDeclaration(xsi);
 }
 
-QString saveItemToXml(QXmlStreamReader& reader)
+QString saveElementToXml(QXmlStreamReader& reader)
 {
-    Q_ASSERT(reader.name() == "item" || reader.name() == "container");
+    Q_ASSERT(reader.tokenType() == QXmlStreamReader::StartElement);
 
     QString retVal;
     QXmlStreamWriter writer(&retVal);
 
-    writer.writeStartElement(reader.name().toString());
+    writer.writeStartElement(reader.qualifiedName().toString());
+    writer.writeAttributes(reader.attributes());
 
-    while(!reader.atEnd() && reader.readNext())
+    qint32 depth = 1;
+    while(depth > 0 && !reader.atEnd())
     {
-        switch(reader.tokenType())
+        switch(reader.readNext())
         {
         case QXmlStreamReader::StartElement:
-            if (reader.name() == "item" || reader.name() == "container")
-            {
-                goto end;
-            }
-
+            ++depth;
             writer.writeStartElement(reader.qualifiedName().toString());
             writer.writeAttributes(reader.attributes());
             break;
 
         case QXmlStreamReader::EndElement:
-            if (reader.name() == "item" || reader.name() == "container")
-            {
-                goto end;
-            }
-
+            --depth;
             writer.writeEndElement();
             break;
 
@@ -139,13 +133,10 @@ QString saveItemToXml(QXmlStreamReader& reader)
             break;
 
         default:
-            continue;
+            break;
         }
     }
 
-end:
-    writer.writeEndElement();
-
     return retVal;
 }
 }
@@ -193,7 +184,8 @@ inline HObject* createBookmarkFolder() { return HBookmarkFolder::create(); }
 }
 
 HCdsDidlLiteSerializerPrivate::HCdsDidlLiteSerializerPrivate() :
-    m_creatorFunctions(), m_lastErrorDescription()
+    m_creatorFunctions(), m_elementMappings(), m_attributeMappings(),
+    m_lastErrorDescription()
 {
     m_creatorFunctions.insert(HItem::sClass(), createItem);
     m_creatorFunctions.insert(HImageItem::sClass(), createImageItem);
@@ -237,69 +229,73 @@ HCdsDidlLiteSerializerPrivate::~HCdsDidlLiteSerializerPrivate()
 {
 }
 
-bool HCdsDidlLiteSerializerPrivate::serializePropertyFromAttribute(
-    HObject* object, const QString& xmlTokenName, const QString& attributeValue)
+const HCdsPropertyMapping& HCdsDidlLiteSerializerPrivate::elementMapping(
+    const QString& name)
 {
-    HLOG(H_AT, H_FUN);
+    QHash<QString, HCdsPropertyMapping>::iterator it =
+        m_elementMappings.find(name);
 
-    QString cdsName = QString("@%1").arg(xmlTokenName);
-    if (!object->hasCdsProperty(cdsName))
+    if (it == m_elementMappings.end())
     {
-        return false;
-    }
-
-    HCdsProperty prop = HCdsPropertyDb::instance().property(cdsName);
-    if (!prop.isValid())
-    {
-        return false;
+        HCdsPropertyMapping mapping;
+        mapping.m_cdsName = name;
+        mapping.m_property = HCdsPropertyDb::instance().property(name);
+        if (mapping.m_property.isValid())
+        {
+            mapping.m_multiValued =
+                mapping.m_property.info().propertyFlags() &
+                    HCdsPropertyInfo::MultiValued;
+
+            const HCdsPropertyInfo& info = HCdsProperties::instance().get(name);
+            mapping.m_tracksChanges = info.isValid() && (
+                info.type() == HCdsProperties::upnp_objectUpdateID ||
+                info.type() == HCdsProperties::upnp_containerUpdateID ||
+                info.type() == HCdsProperties::upnp_totalDeletedChildCount);
+        }
+        it = m_elementMappings.insert(name, mapping);
     }
 
-    HCdsPropertyHandler hnd = prop.handler();
-
-    QVariant value(attributeValue);
-    value.convert(prop.info().defaultValue().type());
-    /*if (!hnd.inSerializer()(xmlTokenName, &value, 0))
-    {
-        return false;
-    }*/
+    return it.value();
+}
 
-    HValidator validator = hnd.validator();
-    if (validator && !validator(value))
-    {
-        return false;
-    }
+const HCdsPropertyMapping& HCdsDidlLiteSerializerPrivate::attributeMapping(
+    const QString& name)
+{
+    QHash<QString, HCdsPropertyMapping>::iterator it =
+        m_attributeMappings.find(name);
 
-    if (!object->setCdsProperty(cdsName, value))
+    if (it == m_attributeMappings.end())
     {
-        return false;
+        HCdsPropertyMapping mapping;
+        mapping.m_cdsName = QString("@%1").arg(name);
+        mapping.m_property = HCdsPropertyDb::instance().property(mapping.m_cdsName);
+        it = m_attributeMappings.insert(name, mapping);
     }
 
-    return true;
+    return it.value();
 }
 
-bool HCdsDidlLiteSerializerPrivate::serializePropertyFromElement(
-    HObject* object, const QString& propertyName, QXmlStreamReader& reader)
+bool HCdsDidlLiteSerializerPrivate::serializePropertyFromAttribute(
+    HObject* object, const QString& xmlTokenName, const QString& attributeValue)
 {
     HLOG(H_AT, H_FUN);
 
-    if (!object->hasCdsProperty(propertyName))
+    const HCdsPropertyMapping& mapping = attributeMapping(xmlTokenName);
+    if (!mapping.m_property.isValid() ||
+        !object->hasCdsProperty(mapping.m_cdsName))
     {
         return false;
     }
 
-    HCdsProperty prop = HCdsPropertyDb::instance().property(propertyName);
-
-    if (!prop.isValid())
-    {
-        return object->serialize(propertyName, 0, &reader);
-    }
-
-    QVariant value;
+    const HCdsProperty& prop = mapping.m_property;
     HCdsPropertyHandler hnd = prop.handler();
-    if (hnd.inSerializer()(propertyName, &value, &reader) == false)
+
+    QVariant value(attributeValue);
+    value.convert(prop.info().defaultValue().type());
+    /*if (!hnd.inSerializer()(xmlTokenName, &value, 0))
     {
         return false;
-    }
+    }*/
 
     HValidator validator = hnd.validator();
     if (validator && !validator(value))
@@ -307,16 +303,12 @@ bool HCdsDidlLiteSerializerPrivate::serializePropertyFromElement(
         return false;
     }
 
-    if (prop.info().propertyFlags() & HCdsPropertyInfo::MultiValued)
+    if (!object->setCdsProperty(mapping.m_cdsName, value))
     {
-        QVariant tmp;
-        object->getCdsProperty(propertyName, &tmp);
-        QVariantList values = tmp.toList();
-        values.append(value);
-        return object->setCdsProperty(propertyName, values);
+        return false;
     }
 
-    return object->setCdsProperty(propertyName, value);
+    return true;
 }
 
 bool HCdsDidlLiteSerializerPrivate::serializeProperty(
@@ -417,107 +409,234 @@ HObject* HCdsDidlLiteSerializerPrivate::parseObject(
 
     QXmlStreamAttributes attrs = reader.attributes();
 
-    QString itemData = saveItemToXml(reader);
+    // The class of the object may be specified after any of the properties,
+    // which is why the properties are decoded first and set once the object
+    // has been created. This way the element is read only once.
+    QString clazz;
+    QList<QPair<HCdsPropertyMapping, QVariant> > values;
+    QList<QPair<QString, QString> > unknownElements;
 
-    QXmlStreamReader itemReader(itemData);
+    while(!reader.atEnd())
+    {
+        QXmlStreamReader::TokenType token = reader.readNext();
+        if (token == QXmlStreamReader::EndElement)
+        {
+            // Every child element is read entirely, so this ends the object.
+            break;
+        }
+        else if (token != QXmlStreamReader::StartElement)
+        {
+            continue;
+        }
 
-    if (xtype == HCdsDidlLiteSerializer::Document)
+        QString name = reader.qualifiedName().toString();
+        if (name == "upnp:class")
+        {
+            clazz = reader.readElementText().trimmed();
+            continue;
+        }
+        else if (name == "item" || name == "container")
+        {
+            HLOG_DBG(QString("Ignoring nested object element: %1").arg(name));
+            reader.skipCurrentElement();
+            continue;
+        }
+
+        const HCdsPropertyMapping& mapping = elementMapping(name);
+        if (!mapping.m_property.isValid())
+        {
+            // The object may still know how to deserialize the property.
+            unknownElements.append(qMakePair(name, saveElementToXml(reader)));
+            continue;
+        }
+
+        QVariant value;
+        HCdsPropertyHandler hnd = mapping.m_property.handler();
+        if (!hnd.inSerializer()(name, &value, &reader))
+        {
+            HLOG_DBG(QString("Couldn't serialize property: %1").arg(name));
+        }
+        else
+        {
+            HValidator validator = hnd.validator();
+            if (!validator || validator(value))
+            {
+                values.append(qMakePair(mapping, value));
+            }
+        }
+
+        if (reader.tokenType() == QXmlStreamReader::StartElement)
+        {
+            reader.skipCurrentElement();
+        }
+    }
+
+    if (reader.hasError())
     {
-        addNamespaces(itemReader);
+        return 0;
     }
-    else
+
+    HObjectCreator creator = m_creatorFunctions.value(clazz);
+    if (!creator)
     {
-        itemReader.setNamespaceProcessing(false);
+        m_lastErrorDescription =  QString("Unknown class: [%1]").arg(clazz);
+        return 0;
     }
 
-    while(!itemReader.atEnd() && itemReader.readNext())
+    QScopedPointer<HObject> object(creator());
+
+    foreach(const QXmlStreamAttribute& attr, attrs)
+    {
+        serializePropertyFromAttribute(
+            object.data(), attr.name().toString(), attr.value().toString());
+    }
+
+    bool tcoEnabled = false;
+
+    // The values of a multi-valued property are set at once.
+    QHash<QString, QVariantList> multiValues;
+    QStringList multiValueOrder;
+
+    for(qint32 i = 0; i < values.size(); ++i)
     {
-        if (itemReader.tokenType() == QXmlStreamReader::StartElement)
+        const HCdsPropertyMapping& mapping = values.at(i).first;
+        if (!object->hasCdsProperty(mapping.m_cdsName))
         {
-            if (itemReader.qualifiedName() != "upnp:class")
+            HLOG_DBG(QString("Couldn't serialize property: %1").arg(
+                mapping.m_cdsName));
+            continue;
+        }
+
+        if (mapping.m_multiValued)
+        {
+            if (!multiValues.contains(mapping.m_cdsName))
             {
-                continue;
+                QVariant tmp;
+                object->getCdsProperty(mapping.m_cdsName, &tmp);
+                multiValues.insert(mapping.m_cdsName, tmp.toList());
+                multiValueOrder.append(mapping.m_cdsName);
             }
+            multiValues[mapping.m_cdsName].append(values.at(i).second);
         }
-        else
+        else if (object->setCdsProperty(mapping.m_cdsName, values.at(i).second))
         {
-            continue;
+            tcoEnabled = tcoEnabled || mapping.m_tracksChanges;
         }
+    }
 
-        QString clazz = itemReader.readElementText();
-        HObjectCreator creator = m_creatorFunctions.value(clazz);
-        if (!creator)
+    foreach(const QString& name, multiValueOrder)
+    {
+        if (object->setCdsProperty(name, multiValues.value(name)))
         {
-            m_lastErrorDescription =  QString("Unknown class: [%1]").arg(clazz);
-            return 0;
+            tcoEnabled = tcoEnabled || elementMapping(name).m_tracksChanges;
         }
+    }
 
-        QScopedPointer<HObject> object(creator());
-
-        foreach(const QXmlStreamAttribute& attr, attrs)
+    for(qint32 i = 0; i < unknownElements.size(); ++i)
+    {
+        const QString& name = unknownElements.at(i).first;
+        if (!object->hasCdsProperty(name))
         {
-            serializePropertyFromAttribute(
-                object.data(), attr.name().toString(), attr.value().toString());
+            HLOG_DBG(QString("Couldn't serialize property: %1").arg(name));
+            continue;
         }
 
-        bool tcoEnabled = false;
-
-        itemReader.clear();
+        QXmlStreamReader elementReader(unknownElements.at(i).second);
         if (xtype == HCdsDidlLiteSerializer::Document)
         {
-            addNamespaces(itemReader);
+            addNamespaces(elementReader);
         }
         else
         {
-            itemReader.setNamespaceProcessing(false);
+            elementReader.setNamespaceProcessing(false);
         }
-        itemReader.addData(itemData);
 
-        while(!itemReader.atEnd() && itemReader.readNext())
+        if (elementReader.readNextStartElement())
         {
-            if (itemReader.tokenType() == QXmlStreamReader::StartElement)
+            object->serialize(name, 0, &elementReader);
+        }
+    }
+
+    if (tcoEnabled)
+    {
+        object->setTrackChangesOption(true);
+    }
+
+    return object->validate() ? object.take() : 0;
+}
+
+bool HCdsDidlLiteSerializerPrivate::parse(
+    const QString& didlLiteDoc, HCdsDidlLiteSerializer::XmlType inputType,
+    HObjects* objects, HObjectCallback* callback)
+{
+    HLOG(H_AT, H_FUN);
+    Q_ASSERT(objects || callback);
+
+    QXmlStreamReader reader(didlLiteDoc);
+
+    if (inputType == HCdsDidlLiteSerializer::Document)
+    {
+        addNamespaces(reader);
+        if (reader.readNextStartElement())
+        {
+            if (reader.name().compare("DIDL-Lite", Qt::CaseInsensitive) != 0)
             {
-                QString name = itemReader.qualifiedName().toString();
+                m_lastErrorDescription = "Missing mandatory DIDL-Lite element";
+                return false;
+            }
+        }
+    }
+    else
+    {
+        reader.setNamespaceProcessing(false);
+    }
 
-                if (name == "upnp:class")
-                {
-                    continue;
-                }
-                else if (!serializePropertyFromElement(object.data(), name, itemReader))
-                {
-                    if (name == "item" || name == "container")
-                    {
-                        continue;
-                    }
-                    else
-                    {
-                        HLOG_DBG(QString("Couldn't serialize property: %1").arg(name));
-                    }
-                }
-                else if (!tcoEnabled)
+    while(!reader.atEnd() && reader.readNext())
+    {
+        switch(reader.tokenType())
+        {
+        case QXmlStreamReader::StartElement:
+            {
+                QStringRef name = reader.name();
+                if (name == "item" || name == "container")
                 {
-                    const HCdsPropertyInfo& info = HCdsProperties::instance().get(name);
-                    if (info.isValid() && (
-                            info.type() == HCdsProperties::upnp_objectUpdateID ||
-                            info.type() == HCdsProperties::upnp_containerUpdateID ||
-                            info.type() == HCdsProperties::upnp_totalDeletedChildCount)
-                        )
-                    {
-                        tcoEnabled = true;
-                    }
+                     HObject* obj = parseObject(reader, inputType);
+                     if (!obj)
+                     {
+                         if (reader.hasError())
+                         {
+                             m_lastErrorDescription = QString(
+                                 "Parse failed: [%1]").arg(reader.errorString());
+                         }
+                         return false;
+                     }
+
+                     if (!callback)
+                     {
+                         objects->append(obj);
+                     }
+                     else if (!(*callback)(obj))
+                     {
+                         m_lastErrorDescription = "Serialization aborted";
+                         return false;
+                     }
                 }
             }
+            break;
+        default:
+            break;
         }
+    }
 
-        if (tcoEnabled)
-        {
-            object->setTrackChangesOption(true);
-        }
+    if (reader.error() != QXmlStreamReader::NoError)
+    {
+        m_lastErrorDescription =
+            QString("Parse failed: [%1]").arg(reader.errorString());
 
-        return object->validate() ? object.take() : 0;
+        return false;
     }
 
-    return 0;
+    return true;
 }
 
 void HCdsDidlLiteSerializerPrivate::writeDidlLiteDocumentInfo(
@@ -558,57 +677,12 @@ QString HCdsDidlLiteSerializer::lastErrorDescription() const
 bool HCdsDidlLiteSerializer::serializeFromXml(
     const QString& didlLiteDoc, HObjects* retVal, XmlType inputType)
 {
-    HLOG(H_AT, H_FUN);
     Q_ASSERT(retVal);
 
-    QXmlStreamReader reader(didlLiteDoc);
-
-    if (inputType == Document)
-    {
-        addNamespaces(reader);
-        if (reader.readNextStartElement())
-        {
-            if (reader.name().compare("DIDL-Lite", Qt::CaseInsensitive) != 0)
-            {
-                h_ptr->m_lastErrorDescription = "Missing mandatory DIDL-Lite element";
-                return false;
-            }
-        }
-    }
-    else
-    {
-        reader.setNamespaceProcessing(false);
-    }
-
     HObjects tmp;
-    while(!reader.atEnd() && reader.readNext())
+    if (!h_ptr->parse(didlLiteDoc, inputType, &tmp, 0))
     {
-        switch(reader.tokenType())
-        {
-        case QXmlStreamReader::StartElement:
-            {
-                QStringRef name = reader.name();
-                if (name == "item" || name == "container")
-                {
-                     HObject* obj = h_ptr->parseObject(reader, inputType);
-                     if (!obj)
-                     {
-                         return false;
-                     }
-                     tmp.append(obj);
-                }
-            }
-            break;
-        default:
-            break;
-        }
-    }
-
-    if (reader.error() != QXmlStreamReader::NoError)
-    {
-        h_ptr->m_lastErrorDescription =
-            QString("Parse failed: [%1]").arg(reader.errorString());
-
+        qDeleteAll(tmp);
         return false;
     }
 
@@ -616,6 +690,16 @@ bool HCdsDidlLiteSerializer::serializeFromXml(
     return true;
 }
 
+bool HCdsDidlLiteSerializer::serializeFromXml(
+    const QString& didlLiteDoc, const HObjectCallback& callback,
+    XmlType inputType)
+{
+    Q_ASSERT(callback);
+
+    HObjectCallback cb(callback);
+    return h_ptr->parse(didlLiteDoc, inputType, 0, &cb);
+}
+
 QString HCdsDidlLiteSerializer::serializeToXml(
     const HObject& object, XmlType xmlType)
 {
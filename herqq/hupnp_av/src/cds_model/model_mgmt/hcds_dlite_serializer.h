@@ -24,6 +24,8 @@
 
 #include <HUpnpAv/HUpnpAv>
 
+#include <HUpnpCore/HFunctor>
+
 class QStringList;
 
 template <typename T>
@@ -40,6 +42,21 @@ namespace Av
 
 class HCdsDidlLiteSerializerPrivate;
 
+/*!
+ * This is a type definition for a callable entity that is called with every
+ * CDS object as soon as it has been decoded from a DIDL-Lite document.
+ *
+ * The ownership of the HObject is passed to the callable entity. The callable
+ * entity should return \e true in case the decoding should continue.
+ *
+ * \headerfile hcds_dlite_serializer.h HObjectCallback
+ *
+ * \ingroup hupnp_av_cds_om_mgmt
+ *
+ * \sa HCdsDidlLiteSerializer::serializeFromXml()
+ */
+typedef Functor<bool, H_TYPELIST_1(HObject*)> HObjectCallback;
+
 /*!
  * \brief This class is used to serialize the HUPnPAv CDS model from or to a
  * DIDL-Lite document.
@@ -119,6 +136,33 @@ public:
         const QString& didlLiteDoc, HObjects* retVal,
         XmlType inputType = Document);
 
+    /*!
+     * \brief Serializes HUPnPAv CDS objects from a DIDL-Lite document one
+     * at a time.
+     *
+     * Every object is passed to the specified callback as soon as it has been
+     * decoded, which enables the caller to process the objects while the rest
+     * of the document is being decoded.
+     *
+     * \param didlLiteDoc specifies the DIDL-Lite document.
+     *
+     * \param callback specifies the callable entity that is called with every
+     * decoded object. The ownership of the objects is passed to the callable
+     * entity. The decoding is stopped if the callable entity returns \e false.
+     *
+     * \param inputType specifies the XML type of the string passed to the method.
+     *
+     * \return \e true when the entire document was decoded successfully.
+     * The objects passed to the callback before a failure are not affected.
+     *
+     * \remarks Separate instances of this class can be used in different
+     * threads simultaneously. Note that the decoded objects belong to the
+     * thread that called this method.
+     */
+    bool serializeFromXml(
+        const QString& didlLiteDoc, const HObjectCallback& callback,
+        XmlType inputType = Document);
+
     /*!
      * \brief Serializes the specified HObject into a DIDL-Lite document.
      *
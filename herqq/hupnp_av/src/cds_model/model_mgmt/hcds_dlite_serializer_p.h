@@ -30,6 +30,7 @@
 // change or the file may be removed without of notice.
 //
 
+#include <HUpnpAv/HCdsProperty>
 #include <HUpnpAv/HCdsDidlLiteSerializer>
 
 #include <QtCore/QHash>
@@ -47,6 +48,27 @@ namespace Upnp
 namespace Av
 {
 
+//
+// The CDS property an XML element or attribute of DIDL-Lite maps to.
+//
+class HCdsPropertyMapping
+{
+public:
+
+    QString m_cdsName;
+    HCdsProperty m_property;
+    bool m_multiValued;
+
+    // Whether the presence of the property implies that the object
+    // has the track changes option enabled.
+    bool m_tracksChanges;
+
+    HCdsPropertyMapping() :
+        m_cdsName(), m_property(), m_multiValued(false), m_tracksChanges(false)
+    {
+    }
+};
+
 //
 // Implementation details of HCdsDidlLiteSerializer.
 //
@@ -58,21 +80,30 @@ public:
 
     QHash<QString, HObjectCreator> m_creatorFunctions;
 
+    // The property mappings of the element and attribute names encountered
+    // so far. This way the property database is consulted only once per name
+    // rather than once per element.
+    QHash<QString, HCdsPropertyMapping> m_elementMappings;
+    QHash<QString, HCdsPropertyMapping> m_attributeMappings;
+
     QString m_lastErrorDescription;
 
     HCdsDidlLiteSerializerPrivate();
     ~HCdsDidlLiteSerializerPrivate();
 
+    const HCdsPropertyMapping& elementMapping(const QString& name);
+    const HCdsPropertyMapping& attributeMapping(const QString& name);
+
     bool serializePropertyFromAttribute(
         HObject* object, const QString& xmlTokenName,
         const QString& attributeValue);
 
-    bool serializePropertyFromElement(
-        HObject* object, const QString& xmlTokenName,
-        QXmlStreamReader& reader);
-
     HObject* parseObject(QXmlStreamReader&, HCdsDidlLiteSerializer::XmlType);
 
+    bool parse(
+        const QString& didlLiteDoc, HCdsDidlLiteSerializer::XmlType,
+        HObjects* objects, HObjectCallback* callback);
+
     void writeDidlLiteDocumentInfo(QXmlStreamWriter&);
 
     bool serializeProperty(
@@ -100,7 +100,7 @@ HCdsProperties::HCdsProperties() :
     h_ptr->insert(obj);
 
     obj = HCdsPropertyInfo::create(
-        "@parentID", HCdsProperties::dlite_id, QVariant::String,
+        "@parentID", HCdsProperties::dlite_parentId, QVariant::String,
         HCdsPropertyInfo::PropertyFlags(HCdsPropertyInfo::Mandatory) | HCdsPropertyInfo::StandardType);
     h_ptr->insert(obj);
 
@@ -36,6 +36,7 @@
 #include <QtCore/QUrl>
 #include <QtCore/QSet>
 #include <QtCore/QString>
+#include <QtCore/QMetaObject>
 
 namespace Herqq
 {
@@ -50,7 +51,13 @@ namespace Av
  * HContentDirectoryAdapterPrivate
  ******************************************************************************/
 HContentDirectoryAdapterPrivate::HContentDirectoryAdapterPrivate() :
-    HClientServiceAdapterPrivate(HContentDirectoryInfo::supportedServiceType())
+    HClientServiceAdapterPrivate(HContentDirectoryInfo::supportedServiceType()),
+        m_resultCache(0),
+        m_cacheRequests(),
+        m_cachedResults(),
+        m_cacheGeneration(0),
+        m_cacheHits(0),
+        m_cacheMisses(0)
 {
 }
 
@@ -58,6 +65,159 @@ HContentDirectoryAdapterPrivate::~HContentDirectoryAdapterPrivate()
 {
 }
 
+QString HContentDirectoryAdapterPrivate::cacheKey(
+    HCachedSearchResult::Type type, const QString& objectId,
+    const QString& searchCriteria, const QSet<QString>& filter,
+    quint32 startingIndex, quint32 requestedCount,
+    const QStringList& sortCriteria)
+{
+    QStringList filterList = filter.toList();
+    qSort(filterList);
+
+    // The type and the object ID are the first two fields, which is relied
+    // upon when the cache is invalidated.
+    QStringList key;
+    key << QString::number(type) << objectId << searchCriteria
+        << filterList.join(",") << sortCriteria.join(",")
+        << QString::number(startingIndex) << QString::number(requestedCount);
+
+    return key.join("\n");
+}
+
+bool HContentDirectoryAdapterPrivate::takeCachedResult(
+    const QString& key, bool search, HClientAdapterOp<HSearchResult>* op)
+{
+    H_Q(HContentDirectoryAdapter);
+
+    HCachedSearchResult* entry = m_resultCache.object(key);
+    if (!entry)
+    {
+        ++m_cacheMisses;
+        return false;
+    }
+
+    ++m_cacheHits;
+
+    HClientAdapterOp<HSearchResult> retVal(entry->m_result);
+    retVal.setReturnValue(UpnpSuccess);
+    *op = retVal;
+
+    // The result is signaled asynchronously just as a result received from
+    // the network, since the user has to get the operation first.
+    if (m_cachedResults.isEmpty())
+    {
+        bool ok = QMetaObject::invokeMethod(
+            q, "deliverCachedResults", Qt::QueuedConnection);
+        Q_ASSERT(ok); Q_UNUSED(ok)
+    }
+    m_cachedResults.append(qMakePair(retVal, search));
+
+    return true;
+}
+
+void HContentDirectoryAdapterPrivate::addCacheRequest(
+    const HClientAdapterOp<HSearchResult>& op, const QString& key,
+    HCachedSearchResult::Type type, const QString& objectId)
+{
+    m_cacheRequests.insert(
+        op.id(), HResultCacheRequest(key, type, objectId, m_cacheGeneration));
+}
+
+void HContentDirectoryAdapterPrivate::cacheResult(
+    const HClientAdapterOp<HSearchResult>& op)
+{
+    if (m_cacheRequests.isEmpty())
+    {
+        return;
+    }
+
+    HResultCacheRequest request = m_cacheRequests.take(op.id());
+    if (request.m_key.isEmpty() || op.returnValue() != UpnpSuccess ||
+        request.m_generation != m_cacheGeneration)
+    {
+        return;
+    }
+
+    m_resultCache.insert(
+        request.m_key,
+        new HCachedSearchResult(request.m_type, request.m_objectId, op.value()));
+}
+
+void HContentDirectoryAdapterPrivate::invalidateCache(bool keepChildren)
+{
+    ++m_cacheGeneration;
+
+    if (!keepChildren)
+    {
+        m_resultCache.clear();
+        return;
+    }
+
+    QString childrenPrefix =
+        QString("%1\n").arg(QString::number(HCachedSearchResult::Children));
+
+    foreach(const QString& key, m_resultCache.keys())
+    {
+        if (!key.startsWith(childrenPrefix))
+        {
+            m_resultCache.remove(key);
+        }
+    }
+}
+
+void HContentDirectoryAdapterPrivate::invalidateContainers(
+    const QString& containerUpdateIds)
+{
+    QStringList values = containerUpdateIds.split(',', QString::SkipEmptyParts);
+    if (values.size() % 2)
+    {
+        invalidateCache(false);
+        return;
+    }
+
+    QHash<QString, quint32> updateIds;
+    for(qint32 i = 0; i < values.size(); i += 2)
+    {
+        updateIds.insert(values.at(i).trimmed(), values.at(i + 1).trimmed().toUInt());
+    }
+
+    if (updateIds.isEmpty())
+    {
+        return;
+    }
+
+    ++m_cacheGeneration;
+
+    foreach(const QString& key, m_resultCache.keys())
+    {
+        // The key starts with a single digit type followed by the object ID.
+        qint32 end = key.indexOf('\n', 2);
+        QString objectId = key.mid(2, end - 2);
+        if (!updateIds.contains(objectId))
+        {
+            continue;
+        }
+
+        // The children of a container are still valid if the container
+        // update ID returned with them matches the one reported.
+        // The metadata of the container is not, since its child count may
+        // have changed.
+        HCachedSearchResult* entry = m_resultCache.object(key);
+        if (entry->m_type != HCachedSearchResult::Children ||
+            entry->m_result.updateId() != updateIds.value(objectId))
+        {
+            m_resultCache.remove(key);
+        }
+    }
+}
+
+void HContentDirectoryAdapterPrivate::clearCache()
+{
+    ++m_cacheGeneration;
+    m_resultCache.clear();
+    m_cacheRequests.clear();
+}
+
 bool HContentDirectoryAdapterPrivate::getSearchCapabilities(
     HClientAction*, const HClientActionOp& op)
 {
@@ -151,7 +311,11 @@ bool HContentDirectoryAdapterPrivate::browse(
 
         searchResult = HSearchResult(result, numReturned, totalMatches, updateId);
     }
-    emit q->browseCompleted(q, takeOp(op, searchResult));
+
+    HClientAdapterOp<HSearchResult> adapterOp = takeOp(op, searchResult);
+    cacheResult(adapterOp);
+
+    emit q->browseCompleted(q, adapterOp);
 
     return false;
 }
@@ -172,7 +336,11 @@ bool HContentDirectoryAdapterPrivate::search(
 
         searchResult = HSearchResult(result, numReturned, totalMatches, updateId);
     }
-    emit q->searchCompleted(q, takeOp(op, searchResult));
+
+    HClientAdapterOp<HSearchResult> adapterOp = takeOp(op, searchResult);
+    cacheResult(adapterOp);
+
+    emit q->searchCompleted(q, adapterOp);
 
     return false;
 }
@@ -350,11 +518,64 @@ HContentDirectoryAdapter::~HContentDirectoryAdapter()
 void HContentDirectoryAdapter::lastChange(
     const HClientStateVariable*, const HStateVariableEvent& event)
 {
+    H_D(HContentDirectoryAdapter);
+
+    // The cache is invalidated before the event is signaled, so that
+    // the objects re-browsed in response are not served from the cache.
+    h->invalidateCache(false);
+
     emit lastChangeReceived(this, event.newValue().toString());
 }
 
+void HContentDirectoryAdapter::containerUpdateIds(
+    const HClientStateVariable*, const HStateVariableEvent& event)
+{
+    H_D(HContentDirectoryAdapter);
+
+    QString value = event.newValue().toString();
+    h->invalidateContainers(value);
+
+    emit containerUpdateIdsReceived(this, value);
+}
+
+void HContentDirectoryAdapter::systemUpdateId(
+    const HClientStateVariable*, const HStateVariableEvent&)
+{
+    H_D(HContentDirectoryAdapter);
+
+    // The cached children of containers are validated by ContainerUpdateIDs
+    // events, if the service sends them.
+    h->invalidateCache(
+        h->m_service->stateVariables().contains("ContainerUpdateIDs"));
+}
+
+void HContentDirectoryAdapter::deliverCachedResults()
+{
+    H_D(HContentDirectoryAdapter);
+
+    QList<QPair<HClientAdapterOp<HSearchResult>, bool> > results =
+        h->m_cachedResults;
+
+    h->m_cachedResults.clear();
+
+    for(qint32 i = 0; i < results.size(); ++i)
+    {
+        if (results.at(i).second)
+        {
+            emit searchCompleted(this, results.at(i).first);
+        }
+        else
+        {
+            emit browseCompleted(this, results.at(i).first);
+        }
+    }
+}
+
 bool HContentDirectoryAdapter::prepareService(HClientService* service)
 {
+    H_D(HContentDirectoryAdapter);
+    h->clearCache();
+
     const HClientStateVariable* lastChange = service->stateVariables().value("LastChange");
     if (lastChange)
     {
@@ -365,6 +586,33 @@ bool HContentDirectoryAdapter::prepareService(HClientService* service)
             SLOT(lastChange(const Herqq::Upnp::HClientStateVariable*,Herqq::Upnp::HStateVariableEvent)));
         Q_ASSERT(ok); Q_UNUSED(ok)
     }
+
+    const HClientStateVariable* containerUpdateIds =
+        service->stateVariables().value("ContainerUpdateIDs");
+
+    if (containerUpdateIds)
+    {
+        bool ok = connect(
+            containerUpdateIds,
+            SIGNAL(valueChanged(const Herqq::Upnp::HClientStateVariable*,Herqq::Upnp::HStateVariableEvent)),
+            this,
+            SLOT(containerUpdateIds(const Herqq::Upnp::HClientStateVariable*,Herqq::Upnp::HStateVariableEvent)));
+        Q_ASSERT(ok); Q_UNUSED(ok)
+    }
+
+    const HClientStateVariable* systemUpdateId =
+        service->stateVariables().value("SystemUpdateID");
+
+    if (systemUpdateId)
+    {
+        bool ok = connect(
+            systemUpdateId,
+            SIGNAL(valueChanged(const Herqq::Upnp::HClientStateVariable*,Herqq::Upnp::HStateVariableEvent)),
+            this,
+            SLOT(systemUpdateId(const Herqq::Upnp::HClientStateVariable*,Herqq::Upnp::HStateVariableEvent)));
+        Q_ASSERT(ok); Q_UNUSED(ok)
+    }
+
     return true;
 }
 
@@ -373,6 +621,40 @@ bool HContentDirectoryAdapter::isLastChangeEnabled() const
     return h_ptr->m_service->stateVariables().contains("LastChange");
 }
 
+void HContentDirectoryAdapter::setResultCacheSize(qint32 maxEntries)
+{
+    H_D(HContentDirectoryAdapter);
+    h->m_resultCache.setMaxCost(qMax(0, maxEntries));
+    if (maxEntries <= 0)
+    {
+        h->m_cacheRequests.clear();
+    }
+}
+
+qint32 HContentDirectoryAdapter::resultCacheSize() const
+{
+    const H_D(HContentDirectoryAdapter);
+    return h->m_resultCache.maxCost();
+}
+
+void HContentDirectoryAdapter::clearResultCache()
+{
+    H_D(HContentDirectoryAdapter);
+    h->clearCache();
+}
+
+qint32 HContentDirectoryAdapter::resultCacheHits() const
+{
+    const H_D(HContentDirectoryAdapter);
+    return h->m_cacheHits;
+}
+
+qint32 HContentDirectoryAdapter::resultCacheMisses() const
+{
+    const H_D(HContentDirectoryAdapter);
+    return h->m_cacheMisses;
+}
+
 HClientAdapterOp<QStringList> HContentDirectoryAdapter::getSearchCapabilities()
 {
     H_D(HContentDirectoryAdapter);
@@ -493,6 +775,24 @@ HClientAdapterOp<HSearchResult> HContentDirectoryAdapter::browse(
         return HClientAdapterOp<HSearchResult>::createInvalid(rc, "");
     }
 
+    QString cacheKey;
+    HCachedSearchResult::Type cacheType =
+        browseFlag == HContentDirectoryInfo::BrowseMetadata ?
+            HCachedSearchResult::Metadata : HCachedSearchResult::Children;
+
+    if (h->m_resultCache.maxCost() > 0)
+    {
+        cacheKey = HContentDirectoryAdapterPrivate::cacheKey(
+            cacheType, objectId, QString(), filter, startingIndex,
+            requestedCount, sortCriteria);
+
+        HClientAdapterOp<HSearchResult> cachedOp;
+        if (h->takeCachedResult(cacheKey, false, &cachedOp))
+        {
+            return cachedOp;
+        }
+    }
+
     HActionArguments inArgs = action->info().inputArguments();
     if (!inArgs.setValue("ObjectID", objectId))
     {
@@ -519,9 +819,16 @@ HClientAdapterOp<HSearchResult> HContentDirectoryAdapter::browse(
         return HClientAdapterOp<HSearchResult>::createInvalid(UpnpInvalidArgs, "");
     }
 
-    return h_ptr->beginInvoke<HSearchResult>(
+    HClientAdapterOp<HSearchResult> op = h_ptr->beginInvoke<HSearchResult>(
         action, inArgs,
         HActionInvokeCallback(h, &HContentDirectoryAdapterPrivate::browse));
+
+    if (!cacheKey.isEmpty())
+    {
+        h->addCacheRequest(op, cacheKey, cacheType, objectId);
+    }
+
+    return op;
 }
 
 HClientAdapterOp<HSearchResult> HContentDirectoryAdapter::search(
@@ -541,6 +848,20 @@ HClientAdapterOp<HSearchResult> HContentDirectoryAdapter::search(
         return HClientAdapterOp<HSearchResult>::createInvalid(rc, "");
     }
 
+    QString cacheKey;
+    if (h->m_resultCache.maxCost() > 0)
+    {
+        cacheKey = HContentDirectoryAdapterPrivate::cacheKey(
+            HCachedSearchResult::Search, containerId, searchCriteria, filter,
+            startingIndex, requestedCount, sortCriteria);
+
+        HClientAdapterOp<HSearchResult> cachedOp;
+        if (h->takeCachedResult(cacheKey, true, &cachedOp))
+        {
+            return cachedOp;
+        }
+    }
+
     HActionArguments inArgs = action->info().inputArguments();
     if (!inArgs.setValue("ContainerID", containerId))
     {
@@ -567,9 +888,17 @@ HClientAdapterOp<HSearchResult> HContentDirectoryAdapter::search(
         return HClientAdapterOp<HSearchResult>::createInvalid(UpnpInvalidArgs, "");
     }
 
-    return h_ptr->beginInvoke<HSearchResult>(
-            action, inArgs,
-            HActionInvokeCallback(h, &HContentDirectoryAdapterPrivate::search));
+    HClientAdapterOp<HSearchResult> op = h_ptr->beginInvoke<HSearchResult>(
+        action, inArgs,
+        HActionInvokeCallback(h, &HContentDirectoryAdapterPrivate::search));
+
+    if (!cacheKey.isEmpty())
+    {
+        h->addCacheRequest(
+            op, cacheKey, HCachedSearchResult::Search, containerId);
+    }
+
+    return op;
 }
 
 HClientAdapterOp<HCreateObjectResult> HContentDirectoryAdapter::createObject(
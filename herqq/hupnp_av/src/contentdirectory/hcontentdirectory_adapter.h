@@ -77,6 +77,16 @@ private Q_SLOTS:
         const Herqq::Upnp::HClientStateVariable*,
         const Herqq::Upnp::HStateVariableEvent&);
 
+    void containerUpdateIds(
+        const Herqq::Upnp::HClientStateVariable*,
+        const Herqq::Upnp::HStateVariableEvent&);
+
+    void systemUpdateId(
+        const Herqq::Upnp::HClientStateVariable*,
+        const Herqq::Upnp::HStateVariableEvent&);
+
+    void deliverCachedResults();
+
 protected:
 
     // Documented in HClientServiceAdapter.
@@ -107,6 +117,72 @@ public:
      */
     bool isLastChangeEnabled() const;
 
+    /*!
+     * \brief Specifies the maximum number of Browse and Search results cached
+     * by the instance.
+     *
+     * A browse() or search() with the same arguments as a previous invocation
+     * is completed from the cache without contacting the service. The least
+     * recently used results are discarded once the cache is full.
+     *
+     * The cached results are invalidated based on the \c SystemUpdateID,
+     * \c ContainerUpdateIDs and \c LastChange events sent by the service.
+     * The children of a container are kept valid as long as the
+     * \c ContainerUpdateIDs events report the container update ID returned
+     * with them. Because of this the cache should be enabled only when the
+     * service is subscribed to.
+     *
+     * \param maxEntries specifies the maximum number of cached results.
+     * A value of \c 0 disables the cache, which is the default.
+     *
+     * \remarks A result served from the cache is signaled using
+     * browseCompleted() or searchCompleted() once the control returns to the
+     * event loop.
+     *
+     * \sa resultCacheSize(), clearResultCache()
+     */
+    void setResultCacheSize(qint32 maxEntries);
+
+    /*!
+     * \brief Returns the maximum number of Browse and Search results cached
+     * by the instance.
+     *
+     * \return The maximum number of Browse and Search results cached
+     * by the instance. A value of \c 0 means that the cache is disabled.
+     *
+     * \sa setResultCacheSize()
+     */
+    qint32 resultCacheSize() const;
+
+    /*!
+     * \brief Removes every result from the cache.
+     *
+     * \sa setResultCacheSize()
+     */
+    void clearResultCache();
+
+    /*!
+     * \brief Returns the number of browse() and search() invocations
+     * completed from the cache.
+     *
+     * \return The number of browse() and search() invocations completed from
+     * the cache.
+     *
+     * \sa resultCacheMisses()
+     */
+    qint32 resultCacheHits() const;
+
+    /*!
+     * \brief Returns the number of browse() and search() invocations
+     * that had to be sent to the service while the cache was enabled.
+     *
+     * \return The number of browse() and search() invocations that had to be
+     * sent to the service while the cache was enabled.
+     *
+     * \sa resultCacheHits()
+     */
+    qint32 resultCacheMisses() const;
+
     /*!
      * \brief Retrieves the search capabilities supported by the device.
      *
@@ -819,6 +895,20 @@ Q_SIGNALS:
      */
     void lastChangeReceived(
         Herqq::Upnp::Av::HContentDirectoryAdapter* source, const QString& data);
+
+    /*!
+     * \brief This signal is emitted when a \e ContainerUpdateIDs event has been
+     * received from the ContentDirectoryService.
+     *
+     * \param source specifies the HContentDirectoryAdapter instance that
+     * sent the event.
+     *
+     * \param data specifies the comma-separated list of container ID and
+     * container update ID pairs, as defined in the ContentDirectory:3
+     * specification, section 2.3.8.
+     */
+    void containerUpdateIdsReceived(
+        Herqq::Upnp::Av::HContentDirectoryAdapter* source, const QString& data);
 };
 
 }
@@ -31,8 +31,15 @@
 //
 
 #include <HUpnpAv/HUpnpAv>
+#include <HUpnpAv/HSearchResult>
 #include <HUpnpCore/private/hclientservice_adapter_p.h>
 
+#include <QtCore/QSet>
+#include <QtCore/QHash>
+#include <QtCore/QPair>
+#include <QtCore/QCache>
+#include <QtCore/QStringList>
+
 namespace Herqq
 {
 
@@ -42,6 +49,68 @@ namespace Upnp
 namespace Av
 {
 
+//
+// A Browse or Search result stored in the result cache of
+// HContentDirectoryAdapter.
+//
+class HCachedSearchResult
+{
+public:
+
+    enum Type
+    {
+        Metadata,
+        Children,
+        Search
+    };
+
+    Type m_type;
+    QString m_objectId;
+    HSearchResult m_result;
+
+    HCachedSearchResult() :
+        m_type(Metadata), m_objectId(), m_result()
+    {
+    }
+
+    HCachedSearchResult(
+        Type type, const QString& objectId, const HSearchResult& result) :
+            m_type(type), m_objectId(objectId), m_result(result)
+    {
+    }
+};
+
+//
+// A Browse or Search invocation whose result is to be cached once received.
+//
+class HResultCacheRequest
+{
+public:
+
+    QString m_key;
+    HCachedSearchResult::Type m_type;
+    QString m_objectId;
+
+    // The value of HContentDirectoryAdapterPrivate::m_cacheGeneration when
+    // the request was sent. A result is not cached if the cache has been
+    // invalidated while the request was in progress.
+    quint32 m_generation;
+
+    HResultCacheRequest() :
+        m_key(), m_type(HCachedSearchResult::Metadata), m_objectId(),
+        m_generation(0)
+    {
+    }
+
+    HResultCacheRequest(
+        const QString& key, HCachedSearchResult::Type type,
+        const QString& objectId, quint32 generation) :
+            m_key(key), m_type(type), m_objectId(objectId),
+            m_generation(generation)
+    {
+    }
+};
+
 //
 // Implementation details of HContentDirectoryAdapter.
 //
@@ -53,9 +122,44 @@ H_DISABLE_COPY(HContentDirectoryAdapterPrivate)
 
 public:
 
+    // The cached Browse and Search results keyed by the arguments of
+    // the invocations. Every entry has a cost of one.
+    QCache<QString, HCachedSearchResult> m_resultCache;
+
+    // The pending invocations whose results are to be cached, keyed by
+    // the IDs of the operations returned to the user.
+    QHash<unsigned int, HResultCacheRequest> m_cacheRequests;
+
+    // The cache hits that are yet to be signaled. The boolean indicates
+    // whether the result is for a Search.
+    QList<QPair<HClientAdapterOp<HSearchResult>, bool> > m_cachedResults;
+
+    quint32 m_cacheGeneration;
+    qint32 m_cacheHits;
+    qint32 m_cacheMisses;
+
     HContentDirectoryAdapterPrivate();
     virtual ~HContentDirectoryAdapterPrivate();
 
+    static QString cacheKey(
+        HCachedSearchResult::Type, const QString& objectId,
+        const QString& searchCriteria, const QSet<QString>& filter,
+        quint32 startingIndex, quint32 requestedCount,
+        const QStringList& sortCriteria);
+
+    bool takeCachedResult(
+        const QString& key, bool search, HClientAdapterOp<HSearchResult>* op);
+
+    void addCacheRequest(
+        const HClientAdapterOp<HSearchResult>& op, const QString& key,
+        HCachedSearchResult::Type, const QString& objectId);
+
+    void cacheResult(const HClientAdapterOp<HSearchResult>& op);
+
+    void invalidateCache(bool keepChildren);
+    void invalidateContainers(const QString& containerUpdateIds);
+    void clearCache();
+
     bool getSearchCapabilities(
         HClientAction*, const HClientActionOp&);
 
@@ -50,7 +50,8 @@ namespace Av
  * HContentDirectoryServicePrivate
  ******************************************************************************/
 HContentDirectoryServicePrivate::HContentDirectoryServicePrivate() :
-    m_dataSource(0), m_lastEventSent(false), m_timer(), m_modificationEvents()
+    m_dataSource(0), m_lastEventSent(false), m_timer(), m_snapshotStale(false),
+    m_modificationEvents()
 {
 }
 
@@ -200,7 +201,15 @@ qint32 HContentDirectoryServicePrivate::browseDirectChildren(
     HLOG2(H_AT, H_FUN, m_loggingIdentifier);
     H_Q(HContentDirectoryService);
 
-    HContainer* container = m_dataSource->findContainer(containerId);
+    // The objects are read from the latest published snapshot, if the data
+    // source publishes snapshots. The snapshot has to be kept alive until the
+    // objects have been serialized.
+    HCdsDataSourceSnapshot snapshot = m_dataSource->snapshot();
+
+    HContainer* container = snapshot.isNull() ?
+        m_dataSource->findContainer(containerId) :
+        snapshot.findContainer(containerId);
+
     if (!container)
     {
         HLOG_WARN(QString(
@@ -227,7 +236,9 @@ qint32 HContentDirectoryServicePrivate::browseDirectChildren(
         return UpnpInvalidArgs;
     }
 
-    HObjects objects = m_dataSource->findObjects(childIDs);
+    HObjects objects = snapshot.isNull() ?
+        m_dataSource->findObjects(childIDs) : snapshot.findObjects(childIDs);
+
     Q_ASSERT(objects.size() == childIDs.size());
 
     if (!sortCriteria.isEmpty())
@@ -274,7 +285,11 @@ qint32 HContentDirectoryServicePrivate::browseMetadata(
         return UpnpInvalidArgs;
     }
 
-    HObject* object = m_dataSource->findObject(objectId);
+    HCdsDataSourceSnapshot snapshot = m_dataSource->snapshot();
+
+    HObject* object = snapshot.isNull() ?
+        m_dataSource->findObject(objectId) : snapshot.findObject(objectId);
+
     if (!object)
     {
         HLOG_WARN(QString(
@@ -316,6 +331,11 @@ void HContentDirectoryServicePrivate::enableChangeTracking()
         q, SLOT(independentObjectAdded(Herqq::Upnp::Av::HObject*)));
     Q_ASSERT(ok);
 
+    ok = QObject::connect(
+        m_dataSource, SIGNAL(objectsAdded(QSet<QString>)),
+        q, SLOT(objectsAdded(QSet<QString>)));
+    Q_ASSERT(ok);
+
     foreach(HObject* object, m_dataSource->objects())
     {
         object->setTrackChangesOption(true);
@@ -423,6 +443,21 @@ HContentDirectoryService::HContentDirectoryService(HAbstractCdsDataSource* dataS
 void HContentDirectoryService::timeout()
 {
     H_D(HContentDirectoryService);
+
+    if (h->m_snapshotStale)
+    {
+        h->m_snapshotStale = false;
+
+        // Browse and Search read the latest published snapshot, if the data
+        // source publishes snapshots, and it has to contain the update IDs
+        // that are evented. The changes of a single timer period are
+        // published together.
+        if (h->m_dataSource && !h->m_dataSource->snapshot().isNull())
+        {
+            h->m_dataSource->publishSnapshot();
+        }
+    }
+
     if (!h->m_lastEventSent && h->m_modificationEvents.size())
     {
         QString lastChangeData = h->generateLastChange();
@@ -452,6 +487,7 @@ void HContentDirectoryService::objectModified(
 
     source->setObjectUpdateId(sysUpdateId);
 
+    h->m_snapshotStale = true;
     h->m_modificationEvents.append(new HModificationEvent(source, einfo));
 }
 
@@ -488,6 +524,7 @@ void HContentDirectoryService::containerModified(
 
     source->setContainerUpdateId(sysUpdateId);
 
+    h->m_snapshotStale = true;
     h->m_modificationEvents.append(new HModificationEvent(source, einfo));
 }
 
@@ -497,6 +534,55 @@ void HContentDirectoryService::independentObjectAdded(HObject* source)
     //H_D(HContentDirectoryService);
 }
 
+void HContentDirectoryService::objectsAdded(const QSet<QString>& objectIds)
+{
+    H_D(HContentDirectoryService);
+
+    if (h->m_lastEventSent)
+    {
+        h->m_modificationEvents.clear();
+        h->m_lastEventSent = false;
+    }
+
+    quint32 sysUpdateId;
+    qint32 retVal = getSystemUpdateId(&sysUpdateId);
+    Q_ASSERT(retVal == UpnpSuccess); Q_UNUSED(retVal)
+
+    bool trackChanges = stateVariables().contains("LastChange");
+
+    QSet<HContainer*> modifiedContainers;
+    foreach(const QString& id, objectIds)
+    {
+        HObject* object = h->m_dataSource->findObject(id);
+        if (!object)
+        {
+            continue;
+        }
+
+        if (trackChanges && object->isItem())
+        {
+            object->setTrackChangesOption(true);
+        }
+
+        HContainer* parent = h->m_dataSource->findContainer(object->parentId());
+        if (parent)
+        {
+            HContainerEventInfo einfo(HContainerEventInfo::ChildAdded, id);
+            einfo.setUpdateId(sysUpdateId);
+
+            h->m_modificationEvents.append(new HModificationEvent(parent, einfo));
+            modifiedContainers.insert(parent);
+        }
+    }
+
+    foreach(HContainer* container, modifiedContainers)
+    {
+        container->setContainerUpdateId(sysUpdateId);
+    }
+
+    h->m_snapshotStale = true;
+}
+
 bool HContentDirectoryService::init()
 {
     H_D(HContentDirectoryService);
@@ -656,8 +742,11 @@ qint32 HContentDirectoryService::search(
     HLOG_INFO(QString("attempting to locate container with id %1").arg(
         containerId));
 
-    HContainer* container = qobject_cast<HContainer*>(
-        h->m_dataSource->findObject(containerId));
+    HCdsDataSourceSnapshot snapshot = h->m_dataSource->snapshot();
+
+    HContainer* container = snapshot.isNull() ?
+        h->m_dataSource->findContainer(containerId) :
+        snapshot.findContainer(containerId);
 
     if (!container)
     {
@@ -24,6 +24,8 @@
 
 #include <HUpnpAv/HAbstractContentDirectoryService>
 
+#include <QtCore/QSet>
+
 namespace Herqq
 {
 
@@ -70,6 +72,8 @@ private Q_SLOTS:
 
     void independentObjectAdded(Herqq::Upnp::Av::HObject* source);
 
+    void objectsAdded(const QSet<QString>& objectIds);
+
 protected:
 
     //
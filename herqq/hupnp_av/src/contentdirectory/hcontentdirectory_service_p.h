@@ -153,6 +153,10 @@ public:
     bool m_lastEventSent;
     QTimer m_timer;
 
+    bool m_snapshotStale;
+    // true when the data source has changed since its snapshot was last
+    // published by the service
+
     QList<HModificationEvent*> m_modificationEvents;
 
 public:
@@ -120,6 +120,7 @@ class HCdsFileSystemReader;
 class HFileSystemDataSource;
 class HAbstractCdsDataSource;
 class HCdsDidlLiteSerializer;
+class HCdsDataSourceSnapshot;
 class HCdsDataSourceConfiguration;
 class HFileSystemDataSourceConfiguration;
 ////////
@@ -32,12 +32,15 @@
 #include "../contentdirectory/hcontentdirectory_adapter.h"
 #include "../contentdirectory/hcontentdirectory_info.h"
 
+#include <HUpnpCore/HClientService>
 #include <HUpnpCore/private/hlogger_p.h>
 #include <HUpnpCore/private/hmisc_utils_p.h>
 
 #include <QtCore/QSet>
+#include <QtCore/QThread>
 #include <QtCore/QStringList>
 #include <QtCore/QXmlStreamReader>
+#include <QtCore/QtConcurrentRun>
 
 /*!
  * \defgroup hupnp_av_cds_browsing Browsing
@@ -64,9 +67,12 @@ public:
     QString m_objectId;
     HBrowseParams::BrowseType m_loadType;
     QSet<QString> m_filter;
+    quint32 m_pageSize;
+    qint32 m_maxConcurrentRequests;
 
     HBrowseParamsPrivate() :
-        m_objectId(), m_loadType(HBrowseParams::SingleItem), m_filter()
+        m_objectId(), m_loadType(HBrowseParams::SingleItem), m_filter(),
+        m_pageSize(0), m_maxConcurrentRequests(1)
     {
     }
 };
@@ -127,6 +133,16 @@ void HBrowseParams::setFilter(const QSet<QString>& filter)
     h_ptr->m_filter = filter;
 }
 
+void HBrowseParams::setPageSize(quint32 count)
+{
+    h_ptr->m_pageSize = count;
+}
+
+void HBrowseParams::setMaxConcurrentRequests(qint32 count)
+{
+    h_ptr->m_maxConcurrentRequests = qMax(1, count);
+}
+
 bool HBrowseParams::isValid() const
 {
     return !h_ptr->m_objectId.isEmpty();
@@ -147,9 +163,90 @@ QSet<QString> HBrowseParams::filter() const
     return h_ptr->m_filter;
 }
 
+quint32 HBrowseParams::pageSize() const
+{
+    return h_ptr->m_pageSize;
+}
+
+qint32 HBrowseParams::maxConcurrentRequests() const
+{
+    return h_ptr->m_maxConcurrentRequests;
+}
+
+/*******************************************************************************
+ * HDidlLiteParseTask
+ ******************************************************************************/
+HDidlLiteParseTask::HDidlLiteParseTask(
+    const QString& didlLite, QThread* targetThread) :
+        m_didlLite(didlLite),
+        m_targetThread(targetThread),
+        m_objects(),
+        m_succeeded(false),
+        m_errorDescription()
+{
+}
+
+HDidlLiteParseTask::~HDidlLiteParseTask()
+{
+    qDeleteAll(m_objects);
+}
+
+bool HDidlLiteParseTask::objectDecoded(HObject* object)
+{
+    // An object can be moved to another thread only by the thread
+    // it belongs to.
+    if (object->thread() != m_targetThread)
+    {
+        object->moveToThread(m_targetThread);
+    }
+    m_objects.append(object);
+    return true;
+}
+
+void HDidlLiteParseTask::run()
+{
+    HCdsDidlLiteSerializer serializer;
+    m_succeeded = serializer.serializeFromXml(
+        m_didlLite, HObjectCallback(this, &HDidlLiteParseTask::objectDecoded));
+
+    if (!m_succeeded)
+    {
+        m_errorDescription = serializer.lastErrorDescription();
+    }
+}
+
+HObjects HDidlLiteParseTask::takeObjects()
+{
+    HObjects retVal = m_objects;
+    m_objects.clear();
+    return retVal;
+}
+
 /*******************************************************************************
  * HMediaBrowserPrivate
  ******************************************************************************/
+namespace
+{
+// The size of a DIDL-Lite document in characters from which on it is decoded
+// in a worker thread.
+const qint32 AsyncParseThreshold = 64 * 1024;
+
+bool hasNextPage(
+    const HBrowseParams& params, const HBrowseRequest& request,
+    const HSearchResult& result, quint32* nextIndex)
+{
+    quint32 pageSize = params.pageSize();
+    *nextIndex = request.m_startingIndex + result.numberReturned();
+
+    // A TotalMatches of zero means that the server does not know
+    // the number of children.
+    return pageSize > 0 && result.numberReturned() > 0 &&
+        (result.totalMatches() > 0 ?
+            *nextIndex < result.totalMatches() :
+            result.numberReturned() >= pageSize);
+}
+}
+
 HMediaBrowserPrivate::HMediaBrowserPrivate(
     HMediaBrowser* parent) :
         QObject(parent),
@@ -159,11 +256,18 @@ HMediaBrowserPrivate::HMediaBrowserPrivate(
             m_dataSource(new HCdsDataSource()),
             m_currentUserOp(0),
             m_currentAutoOp(0),
+            m_syncParams(HBrowseParams::SingleItem),
+            m_lastUpdateId(0),
+            m_hasUpdateId(false),
+            m_containerUpdateIds(),
+            m_staleContainers(),
+            m_lastChangeParents(),
             m_lastErrorCode(0),
             m_lastErrorDescription(),
             q_ptr(0)
 {
     Q_ASSERT(parent);
+    m_syncParams.setFilter(QSet<QString>() << "res");
 }
 
 HMediaBrowserPrivate::~HMediaBrowserPrivate()
@@ -181,7 +285,10 @@ void HMediaBrowserPrivate::checkNextAutoOp()
     if (!m_autoOpQueue.isEmpty())
     {
         m_currentAutoOp.reset(m_autoOpQueue.dequeue());
-        browse(m_currentAutoOp.data());
+        if (!start(m_currentAutoOp.data()))
+        {
+            m_currentAutoOp.reset(0);
+        }
     }
 }
 
@@ -189,91 +296,365 @@ void HMediaBrowserPrivate::browseCompleted(
     HContentDirectoryAdapter*, const HClientAdapterOp<HSearchResult>& op)
 {
     HBrowseOp* browseOp = 0;
-    if (m_currentAutoOp && m_currentAutoOp->m_currentOp->id() == op.id())
+    HBrowseRequest* request = 0;
+    if (m_currentUserOp && (request = m_currentUserOp->findRequest(op)))
+    {
+        browseOp = m_currentUserOp.data();
+    }
+    else if (m_currentAutoOp && (request = m_currentAutoOp->findRequest(op)))
     {
         browseOp = m_currentAutoOp.data();
     }
-    else if (m_currentUserOp && m_currentUserOp->m_currentOp->id() != op.id())
+    else
     {
         return;
     }
-    else if (op.returnValue() != UpnpSuccess)
+
+    if (op.returnValue() == UpnpSuccess)
+    {
+        QString didlLite = op.value().result();
+        request->m_parseTask.reset(new HDidlLiteParseTask(didlLite, thread()));
+
+        if (didlLite.size() >= AsyncParseThreshold)
+        {
+            // Large results are decoded in a worker thread, so that the thread
+            // of the browser is not blocked. The request remains in progress
+            // until the decoding completes.
+            request->m_parseWatcher.reset(new QFutureWatcher<void>());
+
+            bool ok = connect(
+                request->m_parseWatcher.data(), SIGNAL(finished()),
+                this, SLOT(parseCompleted()));
+            Q_ASSERT(ok); Q_UNUSED(ok)
+
+            request->m_parseWatcher->setFuture(QtConcurrent::run(
+                request->m_parseTask.data(), &HDidlLiteParseTask::run));
+
+            return;
+        }
+
+        request->m_parseTask->run();
+    }
+
+    requestCompleted(browseOp, request);
+}
+
+void HMediaBrowserPrivate::parseCompleted()
+{
+    HBrowseOp* browseOp = 0;
+    HBrowseRequest* request = 0;
+    if (m_currentUserOp && (request = m_currentUserOp->findRequest(sender())))
     {
         browseOp = m_currentUserOp.data();
-        browseFailed(browseOp, op.errorDescription(), op.returnValue());
-        return;
+    }
+    else if (m_currentAutoOp && (request = m_currentAutoOp->findRequest(sender())))
+    {
+        browseOp = m_currentAutoOp.data();
     }
     else
     {
-        browseOp = m_currentUserOp.data();
+        return;
+    }
+
+    requestCompleted(browseOp, request);
+}
+
+void HMediaBrowserPrivate::requestCompleted(
+    HBrowseOp* browseOp, HBrowseRequest* request)
+{
+    browseOp->m_requests.removeOne(request);
+    QScopedPointer<HBrowseRequest> requestGuard(request);
+
+    if (browseOp->m_sync)
+    {
+        if (!syncCompleted(browseOp, request))
+        {
+            browseFailed(browseOp, "Could not dispatch a browse request");
+        }
+        else if (browseOp->isDone())
+        {
+            browseComplete(browseOp);
+        }
+        return;
+    }
+
+    const HClientAdapterOp<HSearchResult>& op = *request->m_op;
+    if (op.returnValue() != UpnpSuccess)
+    {
+        browseFailed(browseOp, op.errorDescription(), op.returnValue());
+        return;
     }
 
     HSearchResult result = op.value();
 
-    HObjects objects;
-    HCdsDidlLiteSerializer serializer;
-    if (!serializer.serializeFromXml(result.result(), &objects))
+    HDidlLiteParseTask* parseTask = request->m_parseTask.data();
+    if (!parseTask->m_succeeded)
     {
-        browseFailed(browseOp, serializer.lastErrorDescription());
+        browseFailed(browseOp, parseTask->m_errorDescription);
         return;
     }
-    else if (objects.size() > 0)
+
+    HObjects objects = parseTask->takeObjects();
+
+    QSet<QString> ids;
+    QStringList containerIds;
+    foreach(HObject* object, objects)
     {
-        browseOp->m_loadedObjects.append(objects);
-        m_dataSource->add(objects);
+        ids.insert(object->id());
+        if (object->isContainer())
+        {
+            containerIds.append(object->id());
+        }
+    }
+
+    if (!objects.isEmpty())
+    {
+        m_dataSource->beginBulkAdd(objects.size());
+        // The objects that are already in the data source are not added.
+        qDeleteAll(m_dataSource->add(objects));
+        m_dataSource->commitBulkAdd();
+
+        browseOp->m_objectsBrowsed += objects.size();
+    }
 
-        QSet<QString> ids;
-        foreach(HObject* object, objects)
+    const HBrowseParams& params = browseOp->m_loadParams;
+    HBrowseParams::BrowseType browseType = params.browseType();
+    if (request->m_metadata)
+    {
+        if ((browseType == HBrowseParams::ObjectAndDirectChildren ||
+             browseType == HBrowseParams::ObjectAndChildrenRecursively) &&
+            !containerIds.isEmpty())
         {
-            ids.insert(object->id());
+            browseOp->m_pendingContainers.prepend(containerIds.first());
         }
-        if (browseOp == m_currentUserOp.data())
+    }
+    else
+    {
+        quint32 nextIndex = 0;
+        if (hasNextPage(params, *request, result, &nextIndex))
+        {
+            // The next page of the container is requested right away using
+            // the slot of the completed request.
+            if (!dispatch(browseOp, new HBrowseRequest(
+                    request->m_objectId, false, nextIndex)))
+            {
+                browseFailed(browseOp, "Could not dispatch a browse request");
+                return;
+            }
+        }
+        else
+        {
+            m_containerUpdateIds.insert(request->m_objectId, result.updateId());
+        }
+
+        if (browseType == HBrowseParams::ObjectAndChildrenRecursively)
+        {
+            browseOp->m_pendingContainers.append(containerIds);
+        }
+    }
+
+    if (!schedule(browseOp))
+    {
+        browseFailed(browseOp, "Could not dispatch a browse request");
+        return;
+    }
+
+    if (browseOp == m_currentUserOp.data())
+    {
+        if (!ids.isEmpty())
         {
             emit owner()->objectsBrowsed(owner(), ids);
         }
+
+        if (browseOp != m_currentUserOp.data())
+        {
+            // The operation was cancelled or replaced by the user.
+            return;
+        }
+
+        emit owner()->browseProgress(
+            owner(), browseOp->m_objectsBrowsed,
+            browseOp->m_pendingContainers.size() + browseOp->m_requests.size());
+
+        if (browseOp != m_currentUserOp.data())
+        {
+            return;
+        }
     }
 
-    HBrowseParams::BrowseType loadType = browseOp->m_loadParams.browseType();
-    switch(loadType)
+    if (browseOp->isDone())
     {
-    case HBrowseParams::SingleItem:
-    case HBrowseParams::DirectChildren:
         browseComplete(browseOp);
-        break;
+    }
+}
 
-    case HBrowseParams::ObjectAndDirectChildren:
-        if (browseOp->m_indexUnderProcessing >= 0)
+bool HMediaBrowserPrivate::syncCompleted(
+    HBrowseOp* browseOp, HBrowseRequest* request)
+{
+    HLOG(H_AT, H_FUN);
+
+    const HClientAdapterOp<HSearchResult>& op = *request->m_op;
+
+    // A failed request does not abort the rest of the synchronization, since
+    // the requests are independent of each other.
+    if (op.returnValue() != UpnpSuccess)
+    {
+        HLOG_WARN(QString("Failed to synchronize object [%1]: %2").arg(
+            request->m_objectId, op.errorDescription()));
+
+        if (op.returnValue() == HContentDirectoryInfo::InvalidObjectId ||
+            op.returnValue() == HContentDirectoryInfo::NoSuchContainer)
         {
-            browseComplete(browseOp);
+            // The object has been removed from the server.
+            removeLocally(request->m_objectId);
+        }
+
+        browseOp->m_seenChildren.remove(request->m_objectId);
+        return schedule(browseOp);
+    }
+
+    HSearchResult result = op.value();
+
+    HDidlLiteParseTask* parseTask = request->m_parseTask.data();
+    if (!parseTask->m_succeeded)
+    {
+        HLOG_WARN(QString("Failed to synchronize object [%1]: %2").arg(
+            request->m_objectId, parseTask->m_errorDescription));
+
+        browseOp->m_seenChildren.remove(request->m_objectId);
+        return schedule(browseOp);
+    }
+
+    HObjects objects = parseTask->takeObjects();
+
+    QSet<QString> ids;
+    HObjects newObjects;
+    foreach(HObject* object, objects)
+    {
+        ids.insert(object->id());
+
+        // The mirrored objects are updated in place, so that the pointers
+        // the user may hold remain valid.
+        HObject* existing = m_dataSource->findObject(object->id());
+        if (existing)
+        {
+            refresh(existing, *object);
+            delete object;
         }
         else
         {
-            browseOp->m_indexUnderProcessing = 0;
-            browseOp->m_loadParams.setObjectId(objects.at(0)->id());
-            browse(browseOp);
+            newObjects.append(object);
         }
-        break;
+    }
 
-    case HBrowseParams::ObjectAndChildrenRecursively:
+    if (!newObjects.isEmpty())
     {
-        qint32 i = ++browseOp->m_indexUnderProcessing;
-        for(; i < browseOp->m_loadedObjects.size(); ++i)
+        m_dataSource->beginBulkAdd(newObjects.size());
+        qDeleteAll(m_dataSource->add(newObjects));
+        m_dataSource->commitBulkAdd();
+    }
+
+    browseOp->m_objectsBrowsed += objects.size();
+
+    if (!request->m_metadata)
+    {
+        browseOp->m_seenChildren[request->m_objectId].unite(ids);
+
+        quint32 nextIndex = 0;
+        if (hasNextPage(browseOp->m_loadParams, *request, result, &nextIndex))
         {
-            HObject* object = browseOp->m_loadedObjects.at(i);
-            if (object->isContainer())
+            if (!dispatch(browseOp, new HBrowseRequest(
+                    request->m_objectId, false, nextIndex)))
             {
-                browseOp->m_loadParams.setObjectId(object->id());
-                browseOp->m_indexUnderProcessing = i;
-                browse(browseOp);
-                return;
+                return false;
             }
         }
+        else
+        {
+            pruneChildren(browseOp, request->m_objectId);
+            m_containerUpdateIds.insert(request->m_objectId, result.updateId());
+            m_staleContainers.remove(request->m_objectId);
+        }
+    }
+
+    return schedule(browseOp);
+}
+
+void HMediaBrowserPrivate::refresh(HObject* object, const HObject& source)
+{
+    HCdsPropertyMap properties = source.cdsProperties();
+    HCdsPropertyMap::const_iterator it = properties.constBegin();
+    for(; it != properties.constEnd(); ++it)
+    {
+        QVariant value;
+        if (!object->getCdsProperty(it.key(), &value) || value != it.value())
+        {
+            // Only the changed properties are set, since every change is
+            // reported by the data source.
+            object->setCdsProperty(it.key(), it.value());
+        }
+    }
+}
 
-        if (i == browseOp->m_loadedObjects.size())
+void HMediaBrowserPrivate::removeLocally(const QString& id)
+{
+    HObject* object = m_dataSource->findObject(id);
+    if (!object)
+    {
+        return;
+    }
+
+    HContainer* parent = m_dataSource->findContainer(object->parentId());
+    if (parent)
+    {
+        parent->removeChildId(id);
+    }
+
+    // The descendants of a removed container are removed along with it.
+    QSet<QString> ids;
+    QStringList pending;
+    pending.append(id);
+    while(!pending.isEmpty())
+    {
+        QString nextId = pending.takeLast();
+        ids.insert(nextId);
+
+        m_containerUpdateIds.remove(nextId);
+        m_staleContainers.remove(nextId);
+
+        HContainer* container = m_dataSource->findContainer(nextId);
+        if (container)
         {
-            browseComplete(browseOp);
+            foreach(const QString& childId, container->childIds())
+            {
+                if (!ids.contains(childId))
+                {
+                    pending.append(childId);
+                }
+            }
         }
     }
+
+    m_dataSource->remove(ids);
+}
+
+void HMediaBrowserPrivate::pruneChildren(
+    HBrowseOp* browseOp, const QString& containerId)
+{
+    QSet<QString> seen = browseOp->m_seenChildren.take(containerId);
+
+    HContainer* container = m_dataSource->findContainer(containerId);
+    if (!container)
+    {
+        return;
+    }
+
+    foreach(const QString& childId, container->childIds())
+    {
+        if (!seen.contains(childId))
+        {
+            removeLocally(childId);
+        }
     }
 }
 
@@ -351,9 +732,58 @@ void HMediaBrowserPrivate::lastChangeReceived(
     }
 }
 
-void HMediaBrowserPrivate::autoBrowse(const HBrowseParams& params)
+void HMediaBrowserPrivate::containerUpdateIdsReceived(
+    HContentDirectoryAdapter*, const QString& data)
+{
+    HLOG(H_AT, H_FUN);
+
+    if (!m_autoUpdateEnabled)
+    {
+        return;
+    }
+
+    QStringList values = data.split(',', QString::SkipEmptyParts);
+    if (values.size() % 2)
+    {
+        HLOG_WARN(QString("Ignoring invalid ContainerUpdateIDs value: [%1]").arg(data));
+        return;
+    }
+
+    for(qint32 i = 0; i < values.size(); i += 2)
+    {
+        QString containerId = values.at(i).trimmed();
+        bool ok = false;
+        quint32 updateId = values.at(i + 1).trimmed().toUInt(&ok);
+        if (!ok || !m_dataSource->findContainer(containerId))
+        {
+            continue;
+        }
+
+        if (m_lastChangeParents.contains(containerId))
+        {
+            // The change was already processed from the LastChange event
+            // that was delivered along with this event.
+            m_containerUpdateIds.insert(containerId, updateId);
+        }
+        else if (!m_containerUpdateIds.contains(containerId) ||
+                  m_containerUpdateIds.value(containerId) != updateId)
+        {
+            m_staleContainers.insert(containerId, updateId);
+        }
+    }
+    m_lastChangeParents.clear();
+
+    const HClientService* service = m_contentDirectory->service();
+    if (service && !service->stateVariables().contains("LastChange"))
+    {
+        // Without LastChange events the changed containers have to be
+        // synchronized as they are reported.
+        sync(m_staleContainers.keys(), QStringList());
+    }
+}
+
+void HMediaBrowserPrivate::autoBrowse(HBrowseOp* newOp)
 {
-    HBrowseOp* newOp = new HBrowseOp(params);
     if (m_currentAutoOp || m_currentUserOp)
     {
         // Don't reset currently running auto update before its complete, and
@@ -364,52 +794,234 @@ void HMediaBrowserPrivate::autoBrowse(const HBrowseParams& params)
     else
     {
         m_currentAutoOp.reset(newOp);
-        browse(m_currentAutoOp.data());
+        if (!start(m_currentAutoOp.data()))
+        {
+            m_currentAutoOp.reset(0);
+        }
     }
 }
 
 void HMediaBrowserPrivate::update(const HCdsLastChangeInfos& data)
 {
+    // Every change increments the SystemUpdateID of the service and the
+    // updateID of a change is the SystemUpdateID after the change. A gap
+    // between consecutive values means that events have been missed.
+    bool missedEvents = false;
+
+    // The added and modified objects grouped by their parent container.
+    QHash<QString, QStringList> changes;
+    QSet<QString> parents;
+
     foreach(const HCdsLastChangeInfo& info, data)
     {
-        // TODO this properly
+        quint32 updateId = info.updateId();
+        if (m_hasUpdateId)
+        {
+            if (updateId == m_lastUpdateId)
+            {
+                // Already processed.
+                continue;
+            }
+            else if (updateId != m_lastUpdateId + 1)
+            {
+                missedEvents = true;
+            }
+        }
+        m_lastUpdateId = updateId;
+        m_hasUpdateId = true;
+
+        QString objectId = info.objectId();
         switch(info.eventType())
         {
         case HCdsLastChangeInfo::ObjectDeleted:
-             break;
+            {
+                HObject* object = m_dataSource->findObject(objectId);
+                if (object)
+                {
+                    QString parentId = object->parentId();
+                    if (changes.contains(parentId))
+                    {
+                        changes[parentId].removeAll(objectId);
+                    }
+                    parents.insert(parentId);
+                    removeLocally(objectId);
+                }
+            }
+            break;
         case HCdsLastChangeInfo::ObjectAdded:
+            // Only the parts of the content directory that have been
+            // browsed are mirrored.
+            if (m_dataSource->findContainer(info.parentId()))
+            {
+                QStringList& ids = changes[info.parentId()];
+                if (!ids.contains(objectId))
+                {
+                    ids.append(objectId);
+                }
+                parents.insert(info.parentId());
+            }
+            break;
         case HCdsLastChangeInfo::ObjectModified:
-             {
-                 HBrowseParams params(info.objectId(), HBrowseParams::SingleItem);
-                 autoBrowse(params);
-             }
-             break;
+            {
+                HObject* object = m_dataSource->findObject(objectId);
+                if (object)
+                {
+                    QStringList& ids = changes[object->parentId()];
+                    if (!ids.contains(objectId))
+                    {
+                        ids.append(objectId);
+                    }
+                    parents.insert(object->parentId());
+                }
+            }
+            break;
         default:
-             break;
+            break;
+        }
+    }
+
+    // A single change in a container is refreshed by browsing the metadata of
+    // the object, whereas several changes are coalesced into a single
+    // (paged) browse of the children of the container.
+    QStringList containerIds;
+    QHash<QString, QStringList>::const_iterator it = changes.constBegin();
+    for(; it != changes.constEnd(); ++it)
+    {
+        if (it.value().size() > 1 && m_dataSource->findContainer(it.key()))
+        {
+            containerIds.append(it.key());
         }
     }
+
+    if (missedEvents)
+    {
+        // The missed changes are recovered by synchronizing the containers
+        // known to be affected instead of browsing the entire mirror again.
+        HLOG(H_AT, H_FUN);
+        HLOG_WARN(QString(
+            "Missed LastChange events, synchronizing [%1] containers").arg(
+                QString::number(parents.size() + m_staleContainers.size())));
+
+        QSet<QString> resync = parents;
+        resync.unite(m_staleContainers.keys().toSet());
+        foreach(const QString& containerId, resync)
+        {
+            if (!containerIds.contains(containerId) &&
+                m_dataSource->findContainer(containerId))
+            {
+                containerIds.append(containerId);
+            }
+        }
+    }
+    else
+    {
+        foreach(const QString& parentId, parents)
+        {
+            if (m_staleContainers.contains(parentId))
+            {
+                m_containerUpdateIds.insert(
+                    parentId, m_staleContainers.take(parentId));
+            }
+        }
+    }
+    m_lastChangeParents = parents;
+
+    QStringList objectIds;
+    for(it = changes.constBegin(); it != changes.constEnd(); ++it)
+    {
+        if (!containerIds.contains(it.key()))
+        {
+            objectIds.append(it.value());
+        }
+    }
+
+    sync(containerIds, objectIds);
 }
 
-bool HMediaBrowserPrivate::browse(HBrowseOp* browseOp)
+void HMediaBrowserPrivate::sync(
+    const QStringList& containerIds, const QStringList& objectIds)
+{
+    if (containerIds.isEmpty() && objectIds.isEmpty())
+    {
+        return;
+    }
+
+    HBrowseOp* newOp = new HBrowseOp(m_syncParams, true);
+    newOp->m_pendingContainers = containerIds;
+    newOp->m_pendingObjects = objectIds;
+    autoBrowse(newOp);
+}
+
+bool HMediaBrowserPrivate::start(HBrowseOp* browseOp)
+{
+    const HBrowseParams& params = browseOp->m_loadParams;
+    if (browseOp->m_sync)
+    {
+        return schedule(browseOp);
+    }
+    else if (params.browseType() == HBrowseParams::DirectChildren)
+    {
+        browseOp->m_pendingContainers.append(params.objectId());
+        return schedule(browseOp);
+    }
+
+    return dispatch(browseOp, new HBrowseRequest(params.objectId(), true));
+}
+
+bool HMediaBrowserPrivate::dispatch(
+    HBrowseOp* browseOp, HBrowseRequest* request)
 {
     if (!m_contentDirectory)
     {
+        delete request;
         return false;
     }
 
+    const HBrowseParams& params = browseOp->m_loadParams;
+
     HClientAdapterOp<HSearchResult> op =
         m_contentDirectory->browse(
-            browseOp->m_loadParams.objectId(),
-            browseOp->m_indexUnderProcessing < 0 ?
+            request->m_objectId,
+            request->m_metadata ?
                 HContentDirectoryInfo::BrowseMetadata :
                 HContentDirectoryInfo::BrowseDirectChildren,
-            browseOp->m_loadParams.filter(),
-            0,
-            0,
+            params.filter(),
+            request->m_startingIndex,
+            request->m_metadata ? 0 : params.pageSize(),
             QStringList());
 
-    browseOp->m_currentOp.reset(new HClientAdapterOp<HSearchResult>(op));
+    request->m_op.reset(new HClientAdapterOp<HSearchResult>(op));
+    browseOp->m_requests.append(request);
+
+    return true;
+}
+
+bool HMediaBrowserPrivate::schedule(HBrowseOp* browseOp)
+{
+    qint32 maxRequests = browseOp->m_loadParams.maxConcurrentRequests();
+    while(browseOp->m_requests.size() < maxRequests)
+    {
+        HBrowseRequest* request = 0;
+        if (!browseOp->m_pendingContainers.isEmpty())
+        {
+            request = new HBrowseRequest(
+                browseOp->m_pendingContainers.takeFirst(), false);
+        }
+        else if (!browseOp->m_pendingObjects.isEmpty())
+        {
+            request = new HBrowseRequest(
+                browseOp->m_pendingObjects.takeFirst(), true);
+        }
+        else
+        {
+            break;
+        }
 
+        if (!dispatch(browseOp, request))
+        {
+            return false;
+        }
+    }
     return true;
 }
 
@@ -428,6 +1040,13 @@ void HMediaBrowserPrivate::reset()
     m_currentUserOp.reset(0);
     m_currentAutoOp.reset(0);
     qDeleteAll(m_autoOpQueue);
+    m_autoOpQueue.clear();
+
+    m_lastUpdateId = 0;
+    m_hasUpdateId = false;
+    m_containerUpdateIds.clear();
+    m_staleContainers.clear();
+    m_lastChangeParents.clear();
 }
 
 void HMediaBrowserPrivate::browseComplete(HBrowseOp* op)
@@ -509,6 +1128,13 @@ bool HMediaBrowser::reset(HClientService* cds)
         SLOT(lastChangeReceived(Herqq::Upnp::Av::HContentDirectoryAdapter*, QString)));
     Q_ASSERT(ok);
 
+    ok = connect(
+        h_ptr->m_contentDirectory,
+        SIGNAL(containerUpdateIdsReceived(Herqq::Upnp::Av::HContentDirectoryAdapter*, QString)),
+        h_ptr,
+        SLOT(containerUpdateIdsReceived(Herqq::Upnp::Av::HContentDirectoryAdapter*, QString)));
+    Q_ASSERT(ok);
+
     return true;
 }
 
@@ -536,6 +1162,13 @@ bool HMediaBrowser::reset(HContentDirectoryAdapter* cds, bool takeOwnership)
         SLOT(lastChangeReceived(Herqq::Upnp::Av::HContentDirectoryAdapter*, QString)));
     Q_ASSERT(ok);
 
+    ok = connect(
+        h_ptr->m_contentDirectory,
+        SIGNAL(containerUpdateIdsReceived(Herqq::Upnp::Av::HContentDirectoryAdapter*, QString)),
+        h_ptr,
+        SLOT(containerUpdateIdsReceived(Herqq::Upnp::Av::HContentDirectoryAdapter*, QString)));
+    Q_ASSERT(ok);
+
     return true;
 }
 
@@ -559,8 +1192,17 @@ bool HMediaBrowser::browse(const HBrowseParams& loadParams)
     {
         params.setFilter(QSet<QString>(params.filter()) << "res");
     }
+
+    h_ptr->m_syncParams = params;
+    h_ptr->m_syncParams.setBrowseType(HBrowseParams::SingleItem);
+
     h_ptr->m_currentUserOp.reset(new HBrowseOp(params));
-    return h_ptr->browse(h_ptr->m_currentUserOp.data());
+    if (!h_ptr->start(h_ptr->m_currentUserOp.data()))
+    {
+        h_ptr->m_currentUserOp.reset(0);
+        return false;
+    }
+    return true;
 }
 
 bool HMediaBrowser::browseAll()
@@ -607,11 +1249,26 @@ QString HMediaBrowser::lastErrorDescription() const
 
 void HMediaBrowser::cancel()
 {
-    if (h_ptr->m_currentUserOp.data())
+    // The pending requests of the operation are aborted when it is deleted.
+    h_ptr->m_currentUserOp.reset(0);
+}
+
+bool HMediaBrowser::prioritize(const QString& containerId)
+{
+    HBrowseOp* op = h_ptr->m_currentUserOp.data();
+    if (!op)
     {
-        h_ptr->m_currentUserOp->m_currentOp->abort();
-        h_ptr->m_currentUserOp.reset(0);
+        return false;
+    }
+
+    qint32 index = op->m_pendingContainers.indexOf(containerId);
+    if (index < 0)
+    {
+        return false;
     }
+
+    op->m_pendingContainers.move(index, 0);
+    return true;
 }
 
 bool HMediaBrowser::isAutoUpdateEnabled()
@@ -168,6 +168,37 @@ public:
      */
     void setFilter(const QSet<QString>& filter);
 
+    /*!
+     * \brief Specifies the maximum number of objects requested from the server
+     * in a single Browse action.
+     *
+     * The children of a container that has more children than this are
+     * requested one page at a time.
+     *
+     * \param count specifies the maximum number of objects requested from the
+     * server in a single Browse action. The value 0 means that all
+     * the children of a container are requested at once. This is the default.
+     *
+     * \sa pageSize()
+     */
+    void setPageSize(quint32 count);
+
+    /*!
+     * \brief Specifies the maximum number of Browse actions that may be
+     * in progress at the same time.
+     *
+     * The children of different containers can be browsed at the same time.
+     * This is useful only when the browse type is
+     * HBrowseParams::ObjectAndChildrenRecursively.
+     *
+     * \param count specifies the maximum number of Browse actions that may be
+     * in progress at the same time. Values smaller than 1 are treated as 1,
+     * which is the default.
+     *
+     * \sa maxConcurrentRequests()
+     */
+    void setMaxConcurrentRequests(qint32 count);
+
     /*!
      * \brief Indicates the validity of the object.
      *
@@ -204,6 +235,29 @@ public:
      * \sa setFilter()
      */
     QSet<QString> filter() const;
+
+    /*!
+     * \brief Returns the maximum number of objects requested from the server
+     * in a single Browse action.
+     *
+     * \return The maximum number of objects requested from the server
+     * in a single Browse action. The value 0 means that all the children of
+     * a container are requested at once.
+     *
+     * \sa setPageSize()
+     */
+    quint32 pageSize() const;
+
+    /*!
+     * \brief Returns the maximum number of Browse actions that may be
+     * in progress at the same time.
+     *
+     * \return The maximum number of Browse actions that may be
+     * in progress at the same time.
+     *
+     * \sa setMaxConcurrentRequests()
+     */
+    qint32 maxConcurrentRequests() const;
 };
 
 class HMediaBrowserPrivate;
@@ -377,6 +431,22 @@ public:
      */
     void cancel();
 
+    /*!
+     * Moves the specified container to the front of the containers that are
+     * yet to be browsed.
+     *
+     * Use this to have the children of the container the user is looking at
+     * browsed before the rest when the current browse operation is recursive.
+     *
+     * \param containerId specifies the ID of the container.
+     *
+     * \return \e true in case the container was waiting to be browsed by the
+     * current browse operation.
+     *
+     * \sa browse()
+     */
+    bool prioritize(const QString& containerId);
+
     /*!
      * Indicates if the object should automatically process LastChange events and
      * attempt to update its data source.
@@ -395,6 +465,14 @@ public:
      * \param enable specifies whether the object should automatically process
      * LastChange events and attempt to update its data source.
      *
+     * When enabled, deleted objects are removed from the data source right away,
+     * whereas the added and modified objects are re-browsed. Several changes
+     * within a container are coalesced into a single browse of the children
+     * of the container. If events are detected to have been missed,
+     * the affected containers are re-browsed and the objects no longer
+     * reported by the server are removed. The filter, page size and the number
+     * of concurrent requests of the latest browse() are used.
+     *
      * \sa isAutoUpdateEnabled()
      */
     void setAutoUpdate(bool enable);
@@ -440,6 +518,25 @@ Q_SIGNALS:
      */
     void objectsBrowsed(Herqq::Upnp::Av::HMediaBrowser* source, const QSet<QString>& ids);
 
+    /*!
+     * \brief This signal is emitted when a response to a Browse action of the
+     * current browse operation has been processed.
+     *
+     * \param source specifies the source of the event.
+     *
+     * \param objectsBrowsed specifies the number of objects browsed so far
+     * during the current browse operation.
+     *
+     * \param containersRemaining specifies the number of containers that are
+     * waiting to be browsed or that are being browsed. This grows as new
+     * containers are found during a recursive browse operation.
+     *
+     * \sa objectsBrowsed(), browseComplete()
+     */
+    void browseProgress(
+        Herqq::Upnp::Av::HMediaBrowser* source, qint32 objectsBrowsed,
+        qint32 containersRemaining);
+
     /*!
      * This signal is emitted when the instance has received LastChange data
      * from the ContentDirectoryService.
@@ -35,9 +35,14 @@
 #include <HUpnpAv/HSearchResult>
 #include <HUpnpCore/HClientAdapterOp>
 
+#include <QtCore/QHash>
 #include <QtCore/QQueue>
+#include <QtCore/QStringList>
+#include <QtCore/QFutureWatcher>
 #include <QtCore/QScopedPointer>
 
+class QThread;
+
 namespace Herqq
 {
 
@@ -48,41 +53,149 @@ namespace Av
 {
 
 //
+// Decodes the DIDL-Lite of a browse result into HObjects. The task can be run
+// in a worker thread, in which case the decoded objects are moved to the
+// specified target thread as they are decoded.
+//
+class HDidlLiteParseTask
+{
+H_DISABLE_COPY(HDidlLiteParseTask)
+
+private:
+
+    bool objectDecoded(HObject*);
+
+public:
+
+    QString m_didlLite;
+    QThread* m_targetThread;
+
+    HObjects m_objects;
+    bool m_succeeded;
+    QString m_errorDescription;
+
+    HDidlLiteParseTask(const QString& didlLite, QThread* targetThread);
+    ~HDidlLiteParseTask();
+
+    void run();
+
+    HObjects takeObjects();
+};
+
 //
+// A single Browse action invocation of a browse operation
+//
+class HBrowseRequest
+{
+H_DISABLE_COPY(HBrowseRequest)
+
+public:
+
+    QString m_objectId;
+    bool m_metadata;
+    quint32 m_startingIndex;
+    QScopedPointer<HClientAdapterOp<HSearchResult> > m_op;
+
+    QScopedPointer<HDidlLiteParseTask> m_parseTask;
+    QScopedPointer<QFutureWatcher<void> > m_parseWatcher;
+
+    HBrowseRequest(
+        const QString& objectId, bool metadata, quint32 startingIndex = 0) :
+            m_objectId(objectId),
+            m_metadata(metadata),
+            m_startingIndex(startingIndex),
+            m_op(0),
+            m_parseTask(0),
+            m_parseWatcher(0)
+    {
+    }
+
+    ~HBrowseRequest()
+    {
+        // The parse task cannot be interrupted, but its results are
+        // discarded along with the task.
+        if (m_parseWatcher)
+        {
+            m_parseWatcher->waitForFinished();
+        }
+    }
+};
+
+//
+// A browse operation started by the user or by an automatic update.
+//
+// The children of containers are browsed breadth-first: the containers whose
+// children are yet to be browsed are queued and at most
+// HBrowseParams::maxConcurrentRequests() requests are in flight at a time.
+// The pages of a single container are requested one after another.
+//
+// A synchronization operation refreshes objects that are already mirrored:
+// the pending containers are re-browsed and their children that are no longer
+// reported are pruned, while the pending objects have their metadata
+// re-browsed.
 //
 class HBrowseOp
 {
-HBrowseOp& operator=(const HBrowseOp&);
+H_DISABLE_COPY(HBrowseOp)
 
 public:
 
     HBrowseParams m_loadParams;
-    HObjects m_loadedObjects;
-    qint32 m_indexUnderProcessing;
-    QScopedPointer<HClientAdapterOp<HSearchResult> > m_currentOp;
-
-    HBrowseOp() :
-        m_loadParams(),
-        m_loadedObjects(),
-        m_indexUnderProcessing(-1),
-        m_currentOp(0)
+    QStringList m_pendingContainers;
+    QStringList m_pendingObjects;
+    QList<HBrowseRequest*> m_requests;
+    qint32 m_objectsBrowsed;
+    bool m_sync;
+    QHash<QString, QSet<QString> > m_seenChildren;
+
+    HBrowseOp(const HBrowseParams& arg, bool sync = false) :
+        m_loadParams(arg),
+        m_pendingContainers(),
+        m_pendingObjects(),
+        m_requests(),
+        m_objectsBrowsed(0),
+        m_sync(sync),
+        m_seenChildren()
     {
     }
 
-    HBrowseOp(const HBrowseParams& arg) :
-        m_loadParams(arg),
-        m_loadedObjects(),
-        m_indexUnderProcessing(arg.browseType() != HBrowseParams::DirectChildren ? -1 : 0),
-        m_currentOp(0)
+    ~HBrowseOp()
+    {
+        foreach(HBrowseRequest* request, m_requests)
+        {
+            request->m_op->abort();
+        }
+        qDeleteAll(m_requests);
+    }
+
+    HBrowseRequest* findRequest(const HClientAdapterOp<HSearchResult>& op) const
     {
+        foreach(HBrowseRequest* request, m_requests)
+        {
+            if (request->m_op->id() == op.id())
+            {
+                return request;
+            }
+        }
+        return 0;
     }
 
-    HBrowseOp(const HBrowseOp& other) :
-        m_loadParams(other.m_loadParams),
-        m_loadedObjects(other.m_loadedObjects),
-        m_indexUnderProcessing(other.m_indexUnderProcessing),
-        m_currentOp(new HClientAdapterOp<HSearchResult>(*m_currentOp))
+    HBrowseRequest* findRequest(const QObject* parseWatcher) const
     {
+        foreach(HBrowseRequest* request, m_requests)
+        {
+            if (request->m_parseWatcher.data() == parseWatcher)
+            {
+                return request;
+            }
+        }
+        return 0;
+    }
+
+    inline bool isDone() const
+    {
+        return m_requests.isEmpty() && m_pendingContainers.isEmpty() &&
+               m_pendingObjects.isEmpty();
     }
 };
 
@@ -104,6 +217,11 @@ private Q_SLOTS:
     void lastChangeReceived(
         Herqq::Upnp::Av::HContentDirectoryAdapter* source, const QString& data);
 
+    void containerUpdateIdsReceived(
+        Herqq::Upnp::Av::HContentDirectoryAdapter* source, const QString& data);
+
+    void parseCompleted();
+
 public:
 
     HContentDirectoryAdapter* m_contentDirectory;
@@ -116,6 +234,26 @@ public:
     QScopedPointer<HBrowseOp> m_currentAutoOp;
     QQueue<HBrowseOp*> m_autoOpQueue;
 
+    // The parameters used in synchronization operations. The filter, page size
+    // and concurrency follow the latest browse operation started by the user.
+    HBrowseParams m_syncParams;
+
+    // The SystemUpdateID reported by the latest processed LastChange event.
+    quint32 m_lastUpdateId;
+    bool m_hasUpdateId;
+
+    // The container update IDs of the mirrored containers, as reported by
+    // the latest complete browse of their children.
+    QHash<QString, quint32> m_containerUpdateIds;
+
+    // The containers reported changed in ContainerUpdateIDs events that are
+    // not known to be covered by the processed LastChange events, mapped to
+    // their reported container update IDs.
+    QHash<QString, quint32> m_staleContainers;
+
+    // The parent containers touched by the latest processed LastChange event.
+    QSet<QString> m_lastChangeParents;
+
     qint32 m_lastErrorCode;
     QString m_lastErrorDescription;
 
@@ -126,14 +264,21 @@ public:
 
     void checkNextAutoOp();
 
-    void autoBrowse(const HBrowseParams&);
+    void autoBrowse(HBrowseOp*);
 
     void update(const HCdsLastChangeInfos&);
+    void sync(const QStringList& containerIds, const QStringList& objectIds);
+    void refresh(HObject* object, const HObject& source);
+    void removeLocally(const QString& id);
+    void pruneChildren(HBrowseOp*, const QString& containerId);
 
-    bool browse(HBrowseOp*);
-    void reset();
+    void requestCompleted(HBrowseOp*, HBrowseRequest*);
+    bool syncCompleted(HBrowseOp*, HBrowseRequest*);
 
-    HObjects browseChildren(const QString& id);
+    bool start(HBrowseOp*);
+    bool dispatch(HBrowseOp*, HBrowseRequest*);
+    bool schedule(HBrowseOp*);
+    void reset();
 
     inline HMediaBrowser* owner() const
     {
@@ -20,20 +20,15 @@
  */
 
 #include "hconnection.h"
-#include "hrcs_lastchange_info.h"
-#include "havt_lastchange_info.h"
+#include "hlastchange_dispatcher_p.h"
 #include "../connectionmanager/hconnectioninfo.h"
 #include "../connectionmanager/hconnectionmanager_adapter.h"
 
 #include "../transport/havtransport_adapter.h"
 
-#include "../renderingcontrol/hchannel.h"
 #include "../renderingcontrol/hrenderingcontrol_adapter.h"
 
-#include <HUpnpCore/private/hlogger_p.h>
-
-#include <QtCore/QVariant>
-#include <QtCore/QXmlStreamReader>
+#include <QtCore/QPointer>
 
 namespace Herqq
 {
@@ -60,6 +55,11 @@ public:
     bool m_autoClose;
     bool m_valid;
 
+    QPointer<HLastChangeDispatcher> m_avtDispatcher;
+    QPointer<HLastChangeDispatcher> m_rcsDispatcher;
+    // the dispatchers are owned by the services and they may be deleted
+    // before this instance
+
     HConnectionPrivate(
         const HConnectionInfo& info,
         HConnectionManagerAdapter* cm,
@@ -70,7 +70,9 @@ public:
             m_transport(avt),
             m_renderingControl(rcs),
             m_autoClose(false),
-            m_valid(true)
+            m_valid(true),
+            m_avtDispatcher(),
+            m_rcsDispatcher()
     {
     }
 
@@ -100,155 +102,60 @@ HConnection::HConnection(
         SLOT(currentConnectionIdsChanged(Herqq::Upnp::Av::HConnectionManagerAdapter*, QList<quint32>)));
     Q_ASSERT(ok); Q_UNUSED(ok)
 
-    ok = connect(
-        rcs,
-        SIGNAL(lastChangeReceived(Herqq::Upnp::Av::HRenderingControlAdapter*, QString)),
-        this,
-        SLOT(lastChangeReceived(Herqq::Upnp::Av::HRenderingControlAdapter*, QString)));
-    Q_ASSERT(ok);
-
-    ok = connect(
-        avt,
-        SIGNAL(lastChangeReceived(Herqq::Upnp::Av::HAvTransportAdapter*, QString)),
-        this,
-        SLOT(lastChangeReceived(Herqq::Upnp::Av::HAvTransportAdapter*, QString)));
-    Q_ASSERT(ok);
-}
-
-HConnection::~HConnection()
-{
-    if (autoCloseConnection())
-    {
-        h_ptr->m_cm->connectionComplete(info().connectionId());
-    }
-    delete h_ptr;
-}
-
-void HConnection::currentConnectionIdsChanged(
-    HConnectionManagerAdapter*, const QList<quint32>& currentIds)
-{
-    if (!currentIds.contains(info().connectionId()))
+    // The LastChange events are parsed once per service and the changes of
+    // the instances of this connection are delivered to it directly.
+    if (avt && avt->service())
     {
-        h_ptr->m_valid = false;
-        emit invalidated(this);
-    }
-}
-
-void HConnection::lastChangeReceived(
-    HRenderingControlAdapter*, const QString& data)
-{
-    HLOG(H_AT, H_FUN);
+        h_ptr->m_avtDispatcher = HLastChangeDispatcher::instance(
+            avt->service(), HLastChangeDispatcher::AvTransport);
 
-    QXmlStreamReader reader(data.trimmed());
-    //addNamespaces(reader);
-
-    if (reader.readNextStartElement())
-    {
-        if (reader.name().compare("Event", Qt::CaseInsensitive) != 0)
+        if (h_ptr->m_avtDispatcher)
         {
-            return;
+            h_ptr->m_avtDispatcher->add(
+                static_cast<quint32>(connectionInfo.avTransportId()), this);
         }
     }
-    else
-    {
-        return;
-    }
 
-    HRcsLastChangeInfos infos;
-    while(!reader.atEnd() && reader.readNextStartElement())
+    if (rcs && rcs->service())
     {
-        QStringRef name = reader.name();
+        h_ptr->m_rcsDispatcher = HLastChangeDispatcher::instance(
+            rcs->service(), HLastChangeDispatcher::RenderingControl);
 
-        if (name.compare("InstanceID", Qt::CaseInsensitive))
+        if (h_ptr->m_rcsDispatcher)
         {
-            continue;
-        }
-
-        if (reader.attributes().value("val").toString().toInt() !=
-            h_ptr->m_connectionInfo.connectionId())
-        {
-            continue;
-        }
-
-        while(!reader.atEnd() && reader.readNextStartElement())
-        {
-            name = reader.name();
-
-            QXmlStreamAttributes attrs = reader.attributes();
-            QString value = attrs.value("val").toString();
-            QString channel = attrs.value("channel").toString();
-
-            HRcsLastChangeInfo info(name.toString(), value);
-            if (info.isValid())
-            {
-                if (!channel.isEmpty())
-                {
-                    info.setChannel(channel);
-                }
-                infos.append(info);
-            }
+            h_ptr->m_rcsDispatcher->add(
+                static_cast<quint32>(connectionInfo.rcsId()), this);
         }
     }
-
-    if (!infos.isEmpty())
-    {
-        emit renderingControlStateChanged(this, infos);
-    }
 }
 
-void HConnection::lastChangeReceived(HAvTransportAdapter*, const QString& data)
+HConnection::~HConnection()
 {
-    HLOG(H_AT, H_FUN);
-
-    QXmlStreamReader reader(data.trimmed());
-    //addNamespaces(reader);
-
-    if (reader.readNextStartElement())
+    if (h_ptr->m_avtDispatcher)
     {
-        if (reader.name().compare("Event", Qt::CaseInsensitive) != 0)
-        {
-            return;
-        }
+        h_ptr->m_avtDispatcher->remove(
+            static_cast<quint32>(info().avTransportId()), this);
     }
-    else
+    if (h_ptr->m_rcsDispatcher)
     {
-        return;
+        h_ptr->m_rcsDispatcher->remove(
+            static_cast<quint32>(info().rcsId()), this);
     }
 
-    HAvtLastChangeInfos infos;
-    while(!reader.atEnd() && reader.readNextStartElement())
+    if (autoCloseConnection())
     {
-        QStringRef name = reader.name();
-
-        if (name.compare("InstanceID", Qt::CaseInsensitive))
-        {
-            continue;
-        }
-
-        if (reader.attributes().value("val").toString().toInt() !=
-            h_ptr->m_connectionInfo.connectionId())
-        {
-            continue;
-        }
-
-        while(!reader.atEnd() && reader.readNextStartElement())
-        {
-            name = reader.name();
-
-            QXmlStreamAttributes attrs = reader.attributes();
-            QString value = attrs.value("val").toString();
-
-            HAvtLastChangeInfo info(name.toString(), value);
-            if (info.isValid())
-            {
-                infos.append(info);
-            }
-        }
+        h_ptr->m_cm->connectionComplete(info().connectionId());
     }
+    delete h_ptr;
+}
 
-    if (!infos.isEmpty())
+void HConnection::currentConnectionIdsChanged(
+    HConnectionManagerAdapter*, const QList<quint32>& currentIds)
+{
+    if (!currentIds.contains(info().connectionId()))
     {
-        emit avTransportStateChanged(this, infos);
+        h_ptr->m_valid = false;
+        emit invalidated(this);
     }
 }
 
@@ -36,6 +36,7 @@ namespace Av
 {
 
 class HConnectionPrivate;
+class HLastChangeDispatcher;
 
 /*!
  * \brief This class represents a \e connection to a MediaRenderer device.
@@ -51,6 +52,7 @@ class H_UPNP_AV_EXPORT HConnection :
 {
 Q_OBJECT
 H_DISABLE_COPY(HConnection)
+friend class HLastChangeDispatcher;
 
 private Q_SLOTS:
 
@@ -58,12 +60,6 @@ private Q_SLOTS:
         Herqq::Upnp::Av::HConnectionManagerAdapter*,
         const QList<quint32>& currentIds);
 
-    void lastChangeReceived(
-        Herqq::Upnp::Av::HRenderingControlAdapter*, const QString&);
-
-    void lastChangeReceived(
-        Herqq::Upnp::Av::HAvTransportAdapter*, const QString&);
-
 protected:
 
     HConnectionPrivate* h_ptr;
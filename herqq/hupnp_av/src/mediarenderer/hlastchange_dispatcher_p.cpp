@@ -0,0 +1,274 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hlastchange_dispatcher_p.h"
+
+#include "hconnection.h"
+#include "hrcs_lastchange_info.h"
+#include "havt_lastchange_info.h"
+
+#include <HUpnpCore/HClientService>
+#include <HUpnpCore/HStateVariableEvent>
+#include <HUpnpCore/HClientStateVariable>
+
+#include <HUpnpCore/private/hlogger_p.h>
+
+#include <QtCore/QVariant>
+#include <QtCore/QXmlStreamReader>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+namespace Av
+{
+
+/*******************************************************************************
+ * HLastChangeDispatcher
+ ******************************************************************************/
+HLastChangeDispatcher::HLastChangeDispatcher(
+    HClientService* service, Type type) :
+        QObject(service), m_type(type), m_connections()
+{
+}
+
+HLastChangeDispatcher::~HLastChangeDispatcher()
+{
+}
+
+HLastChangeDispatcher* HLastChangeDispatcher::instance(
+    HClientService* service, Type type)
+{
+    Q_ASSERT(service);
+
+    HLastChangeDispatcher* retVal = service->findChild<HLastChangeDispatcher*>();
+    if (retVal)
+    {
+        return retVal;
+    }
+
+    const HClientStateVariable* lastChange =
+        service->stateVariables().value("LastChange");
+
+    if (!lastChange)
+    {
+        return 0;
+    }
+
+    retVal = new HLastChangeDispatcher(service, type);
+
+    bool ok = connect(
+        lastChange,
+        SIGNAL(valueChanged(const Herqq::Upnp::HClientStateVariable*,Herqq::Upnp::HStateVariableEvent)),
+        retVal,
+        SLOT(lastChange(const Herqq::Upnp::HClientStateVariable*,Herqq::Upnp::HStateVariableEvent)));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    return retVal;
+}
+
+void HLastChangeDispatcher::add(quint32 instanceId, HConnection* connection)
+{
+    QList<HConnection*>& connections = m_connections[instanceId];
+    if (!connections.contains(connection))
+    {
+        connections.append(connection);
+    }
+}
+
+void HLastChangeDispatcher::remove(quint32 instanceId, HConnection* connection)
+{
+    QHash<quint32, QList<HConnection*> >::iterator it =
+        m_connections.find(instanceId);
+
+    if (it != m_connections.end())
+    {
+        it->removeAll(connection);
+        if (it->isEmpty())
+        {
+            m_connections.erase(it);
+        }
+    }
+}
+
+namespace
+{
+bool readEventElement(QXmlStreamReader* reader)
+{
+    return reader->readNextStartElement() &&
+           reader->name().compare("Event", Qt::CaseInsensitive) == 0;
+}
+
+// Reads the next InstanceID element, the ID of which is one of the
+// specified IDs. Other instances are skipped without reading their changes.
+template<typename T>
+bool readNextInstance(
+    QXmlStreamReader* reader, const QHash<quint32, T>& instanceIds,
+    quint32* instanceId)
+{
+    while(!reader->atEnd() && reader->readNextStartElement())
+    {
+        if (reader->name().compare("InstanceID", Qt::CaseInsensitive) == 0)
+        {
+            bool ok = false;
+            *instanceId = reader->attributes().value("val").toString().toUInt(&ok);
+            if (ok && instanceIds.contains(*instanceId))
+            {
+                return true;
+            }
+        }
+
+        reader->skipCurrentElement();
+    }
+
+    return false;
+}
+}
+
+void HLastChangeDispatcher::dispatchAvt(const QString& data)
+{
+    QXmlStreamReader reader(data.trimmed());
+    if (!readEventElement(&reader))
+    {
+        return;
+    }
+
+    QHash<quint32, HAvtLastChangeInfos> changes;
+
+    quint32 instanceId = 0;
+    while(readNextInstance(&reader, m_connections, &instanceId))
+    {
+        HAvtLastChangeInfos& infos = changes[instanceId];
+        while(!reader.atEnd() && reader.readNextStartElement())
+        {
+            QXmlStreamAttributes attrs = reader.attributes();
+            QString value = attrs.value("val").toString();
+
+            HAvtLastChangeInfo info(reader.name().toString(), value);
+            if (info.isValid())
+            {
+                infos.append(info);
+            }
+
+            reader.skipCurrentElement();
+        }
+    }
+
+    QHash<quint32, HAvtLastChangeInfos>::const_iterator ci = changes.constBegin();
+    for(; ci != changes.constEnd(); ++ci)
+    {
+        if (ci.value().isEmpty())
+        {
+            continue;
+        }
+
+        // A connection may be deleted as a result of a signal, in which case
+        // it is no longer registered.
+        QList<HConnection*> connections = m_connections.value(ci.key());
+        foreach(HConnection* connection, connections)
+        {
+            if (m_connections.value(ci.key()).contains(connection))
+            {
+                emit connection->avTransportStateChanged(connection, ci.value());
+            }
+        }
+    }
+}
+
+void HLastChangeDispatcher::dispatchRcs(const QString& data)
+{
+    QXmlStreamReader reader(data.trimmed());
+    if (!readEventElement(&reader))
+    {
+        return;
+    }
+
+    QHash<quint32, HRcsLastChangeInfos> changes;
+
+    quint32 instanceId = 0;
+    while(readNextInstance(&reader, m_connections, &instanceId))
+    {
+        HRcsLastChangeInfos& infos = changes[instanceId];
+        while(!reader.atEnd() && reader.readNextStartElement())
+        {
+            QXmlStreamAttributes attrs = reader.attributes();
+            QString value = attrs.value("val").toString();
+            QString channel = attrs.value("channel").toString();
+
+            HRcsLastChangeInfo info(reader.name().toString(), value);
+            if (info.isValid())
+            {
+                if (!channel.isEmpty())
+                {
+                    info.setChannel(channel);
+                }
+                infos.append(info);
+            }
+
+            reader.skipCurrentElement();
+        }
+    }
+
+    QHash<quint32, HRcsLastChangeInfos>::const_iterator ci = changes.constBegin();
+    for(; ci != changes.constEnd(); ++ci)
+    {
+        if (ci.value().isEmpty())
+        {
+            continue;
+        }
+
+        QList<HConnection*> connections = m_connections.value(ci.key());
+        foreach(HConnection* connection, connections)
+        {
+            if (m_connections.value(ci.key()).contains(connection))
+            {
+                emit connection->renderingControlStateChanged(connection, ci.value());
+            }
+        }
+    }
+}
+
+void HLastChangeDispatcher::lastChange(
+    const HClientStateVariable*, const HStateVariableEvent& event)
+{
+    HLOG(H_AT, H_FUN);
+
+    if (m_connections.isEmpty())
+    {
+        return;
+    }
+
+    QString data = event.newValue().toString();
+    if (m_type == AvTransport)
+    {
+        dispatchAvt(data);
+    }
+    else
+    {
+        dispatchRcs(data);
+    }
+}
+
+}
+}
+}
@@ -0,0 +1,109 @@
+/*
+ *  Copyright (C) 2011 Tuomo Penttinen, all rights reserved.
+ *
+ *  Author: Tuomo Penttinen <tp@herqq.org>
+ *
+ *  This file is part of Herqq UPnP Av (HUPnPAv) library.
+ *
+ *  Herqq UPnP Av is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Herqq UPnP Av is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Herqq UPnP Av. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HLASTCHANGE_DISPATCHER_P_H_
+#define HLASTCHANGE_DISPATCHER_P_H_
+
+//
+// !! Warning !!
+//
+// This file is not part of public API and it should
+// never be included in client code. The contents of this file may
+// change or the file may be removed without of notice.
+//
+
+#include <HUpnpAv/HUpnpAv>
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QObject>
+
+namespace Herqq
+{
+
+namespace Upnp
+{
+
+class HClientService;
+class HStateVariableEvent;
+class HClientStateVariable;
+
+namespace Av
+{
+
+//
+// Parses the LastChange events of a single AVTransport or RenderingControl
+// service once and dispatches the changes to the HConnection instances
+// by their instance IDs.
+//
+// A dispatcher is created on demand as a child of the service, which means
+// that all the connections to the same service share it.
+//
+class HLastChangeDispatcher :
+    public QObject
+{
+Q_OBJECT
+H_DISABLE_COPY(HLastChangeDispatcher)
+
+public:
+
+    enum Type
+    {
+        AvTransport,
+        RenderingControl
+    };
+
+private:
+
+    const Type m_type;
+
+    QHash<quint32, QList<HConnection*> > m_connections;
+    // the registered connections keyed by their instance IDs
+
+    HLastChangeDispatcher(HClientService* service, Type type);
+
+    void dispatchAvt(const QString& data);
+    void dispatchRcs(const QString& data);
+
+private Q_SLOTS:
+
+    void lastChange(
+        const Herqq::Upnp::HClientStateVariable*,
+        const Herqq::Upnp::HStateVariableEvent&);
+
+public:
+
+    virtual ~HLastChangeDispatcher();
+
+    // Returns the dispatcher of the specified service, creating one if the
+    // service does not have one yet. Returns a null pointer in case the
+    // service does not have the LastChange state variable.
+    static HLastChangeDispatcher* instance(HClientService*, Type);
+
+    void add(quint32 instanceId, HConnection*);
+    void remove(quint32 instanceId, HConnection*);
+};
+
+}
+}
+}
+
+#endif /* HLASTCHANGE_DISPATCHER_P_H_ */
@@ -46,10 +46,9 @@ namespace Av
  ******************************************************************************/
 HMediaRendererDevice::HMediaRendererDevice(
     const HMediaRendererDeviceConfiguration& conf) :
-        m_configuration(conf.clone()), m_timer(this), m_avtInstanceEvents(),
-        m_rcsInstanceEvents()
+        m_configuration(conf.clone()), m_avtLastChange(this),
+        m_rcsLastChange(this)
 {
-    m_timer.setInterval(200);
     bool ok = connect(
         m_configuration->rendererConnectionManager(),
         SIGNAL(connectionRemoved(Herqq::Upnp::Av::HAbstractConnectionManagerService*,qint32)),
@@ -57,26 +56,27 @@ HMediaRendererDevice::HMediaRendererDevice(
         SLOT(rendererConnectionRemoved(Herqq::Upnp::Av::HAbstractConnectionManagerService*,qint32)));
     Q_ASSERT(ok); Q_UNUSED(ok)
 
-    ok = connect(&m_timer, SIGNAL(timeout()), this, SLOT(timeout()));
+    ok = connect(
+        &m_avtLastChange.m_timer, SIGNAL(timeout()),
+        this, SLOT(avtLastChangeTimeout()));
+    Q_ASSERT(ok); Q_UNUSED(ok)
+
+    ok = connect(
+        &m_rcsLastChange.m_timer, SIGNAL(timeout()),
+        this, SLOT(rcsLastChangeTimeout()));
     Q_ASSERT(ok); Q_UNUSED(ok)
 }
 
 HMediaRendererDevice::~HMediaRendererDevice()
 {
     delete m_configuration;
-    qDeleteAll(m_avtInstanceEvents);
-    qDeleteAll(m_rcsInstanceEvents);
 }
 
 namespace
 {
-void clear(QList<HInstanceEvents*>* events)
-{
-    foreach(HInstanceEvents* ie, *events)
-    {
-        ie->m_changedProperties.clear();
-    }
-}
+// The minimum interval in milliseconds between two updates of
+// a LastChange state variable.
+const qint32 LastChangeModerationInterval = 200;
 
 bool generateLastChange(
     const QList<HInstanceEvents*>& events, bool rcs, QString* xml)
@@ -138,80 +138,91 @@ bool generateLastChange(
 }
 }
 
-void HMediaRendererDevice::timeout()
+void HMediaRendererDevice::schedule(HLastChangeEvents* lastChange)
 {
-    m_timer.stop();
-
-    QString lastChangeData;
-    if (!m_avtInstanceEvents.isEmpty())
+    if (lastChange->m_timer.isActive())
     {
-        if (generateLastChange(m_avtInstanceEvents, false, &lastChangeData))
-        {
-            bool ok = avTransport()->setValue("LastChange", lastChangeData);
-            Q_ASSERT(ok); Q_UNUSED(ok)
-            clear(&m_avtInstanceEvents);
-        }
+        // The pending update will include the latest changes as well.
+        return;
     }
-    if (!m_rcsInstanceEvents.isEmpty())
+
+    qint32 delay = 0;
+    if (lastChange->m_lastPublished.isValid())
     {
-        if (generateLastChange(m_rcsInstanceEvents, true, &lastChangeData))
-        {
-            bool ok = renderingControl()->setValue("LastChange", lastChangeData);
-            Q_ASSERT(ok); Q_UNUSED(ok)
-            clear(&m_rcsInstanceEvents);
-        }
+        // QTime follows the system clock, which may be adjusted.
+        delay = qBound(0,
+            LastChangeModerationInterval - lastChange->m_lastPublished.elapsed(),
+            LastChangeModerationInterval);
     }
-    m_timer.start();
+
+    // Even with no delay the update is deferred to the event loop, which
+    // enables the changes made in a single burst to be published together.
+    lastChange->m_timer.start(delay);
 }
 
-namespace
+void HMediaRendererDevice::publish(
+    HLastChangeEvents* lastChange, HServerService* service, bool rcs)
 {
-HInstanceEvents* getInstanceEvents(QList<HInstanceEvents*>* events, qint32 id)
-{
-    HInstanceEvents* retVal = 0;
-    foreach(HInstanceEvents* event, *events)
+    if (lastChange->m_dirtyInstances.isEmpty())
     {
-        if (event->m_instanceId == id)
-        {
-            retVal = event;
-            break;
-        }
+        return;
+    }
+
+    QString lastChangeData;
+    if (generateLastChange(lastChange->m_dirtyInstances, rcs, &lastChangeData))
+    {
+        bool ok = service->setValue("LastChange", lastChangeData);
+        Q_ASSERT(ok); Q_UNUSED(ok)
+    }
+
+    foreach(HInstanceEvents* events, lastChange->m_dirtyInstances)
+    {
+        events->m_changedProperties.clear();
     }
-    return retVal;
+    lastChange->m_dirtyInstances.clear();
+    lastChange->m_lastPublished.start();
+}
+
+void HMediaRendererDevice::avtLastChangeTimeout()
+{
+    publish(&m_avtLastChange, avTransport(), false);
 }
+
+void HMediaRendererDevice::rcsLastChangeTimeout()
+{
+    publish(&m_rcsLastChange, renderingControl(), true);
 }
 
 void HMediaRendererDevice::propertyChanged(
     HRendererConnectionInfo* source, const HRendererConnectionEventInfo& eventInfo)
 {
-    HConnectionInfo info;
-    qint32 retVal = connectionManager()->getCurrentConnectionInfo(
-        source->connection()->connectionInfo()->connectionId(), &info);
-
-    Q_ASSERT(retVal == UpnpSuccess); Q_UNUSED(retVal)
+    // The instance IDs of a connection do not change, so there is no need
+    // to query the Connection Manager for them.
+    const HConnectionInfo& info = *source->connection()->connectionInfo();
 
+    HLastChangeEvents* lastChange = 0;
     HInstanceEvents* events = 0;
     if (HAvTransportInfo::stateVariablesSetupData().contains(eventInfo.propertyName()))
     {
-        events = getInstanceEvents(&m_avtInstanceEvents, info.avTransportId());
-        if (!events)
-        {
-            events = new HInstanceEvents(info.avTransportId());
-            m_avtInstanceEvents.append(events);
-        }
+        lastChange = &m_avtLastChange;
+        events = lastChange->instanceEvents(info.avTransportId());
     }
     else
     {
-        events = getInstanceEvents(&m_rcsInstanceEvents, info.rcsId());
-        if (!events)
-        {
-            events = new HInstanceEvents(info.rcsId());
-            m_rcsInstanceEvents.append(events);
-        }
+        lastChange = &m_rcsLastChange;
+        events = lastChange->instanceEvents(info.rcsId());
     }
+
+    if (events->m_changedProperties.isEmpty())
+    {
+        lastChange->m_dirtyInstances.append(events);
+    }
+
     events->m_changedProperties.insert(
         eventInfo.propertyName(),
         qMakePair(eventInfo.newValue(), eventInfo.channel().toString()));
+
+    schedule(lastChange);
 }
 
 void HMediaRendererDevice::rendererConnectionRemoved(
@@ -317,8 +328,6 @@ bool HMediaRendererDevice::finalizeInit(QString* errDescription)
         }
     }
 
-    m_timer.start();
-
     return true;
 }
 
@@ -372,53 +381,14 @@ HRendererConnection* HMediaRendererDevice::createRendererConnection(
 
 HRendererConnection* HMediaRendererDevice::findConnectionByAvTransportId(qint32 id) const
 {
-    QList<quint32> connectionIds;
-    qint32 rc = connectionManager()->getCurrentConnectionIDs(&connectionIds);
-    Q_ASSERT(rc == UpnpSuccess); Q_UNUSED(rc)
-
-    foreach(quint32 cid, connectionIds)
-    {
-        HConnectionInfo info;
-        rc = connectionManager()->getCurrentConnectionInfo((qint32)cid, &info);
-        Q_ASSERT(rc == UpnpSuccess);
-
-        if (info.avTransportId() == id)
-        {
-            HRendererConnection* connection =
-                m_configuration->rendererConnectionManager()->connection(
-                    connectionManager(), cid);
-
-            return connection;
-        }
-    }
-
-    return 0;
+    return m_configuration->rendererConnectionManager()->connectionByAvTransportId(
+        connectionManager(), id);
 }
 
 HRendererConnection* HMediaRendererDevice::findConnectionByRcsId(qint32 id) const
 {
-    QList<quint32> connectionIds;
-    qint32 rc = connectionManager()->getCurrentConnectionIDs(&connectionIds);
-    Q_ASSERT(rc == UpnpSuccess); Q_UNUSED(rc)
-
-    foreach(quint32 cid, connectionIds)
-    {
-        HConnectionInfo info;
-        rc = connectionManager()->getCurrentConnectionInfo((qint32)cid, &info);
-        Q_ASSERT(rc == UpnpSuccess);
-
-        if (info.rcsId() == id)
-        {
-            HRendererConnection* connection =
-                m_configuration->rendererConnectionManager()->connection(
-                    connectionManager(), cid);
-            Q_ASSERT(connection);
-
-            return connection;
-        }
-    }
-
-    return 0;
+    return m_configuration->rendererConnectionManager()->connectionByRcsId(
+        connectionManager(), id);
 }
 
 HMediaRendererDeviceConfiguration* HMediaRendererDevice::configuration() const
@@ -41,6 +41,7 @@
 #include "hmediarenderer_deviceconfiguration.h"
 #include "../renderingcontrol/hrenderingcontrol_service_p.h"
 
+#include <QtCore/QTime>
 #include <QtCore/QTimer>
 #include <QtCore/QPointer>
 #include <QtNetwork/QNetworkReply>
@@ -74,6 +75,51 @@ public:
     }
 };
 
+//
+// The pending changes of a single LastChange state variable
+//
+class HLastChangeEvents
+{
+H_DISABLE_COPY(HLastChangeEvents)
+
+public:
+
+    QHash<qint32, HInstanceEvents*> m_instanceEvents;
+    // the event records of the instances keyed by the instance IDs
+
+    QList<HInstanceEvents*> m_dirtyInstances;
+    // the event records that have changes not yet published
+
+    QTimer m_timer;
+    // a single-shot timer that is armed only when there are pending changes
+
+    QTime m_lastPublished;
+    // the time the state variable was last updated; invalid if never
+
+    HLastChangeEvents(QObject* parent) :
+        m_instanceEvents(), m_dirtyInstances(), m_timer(parent),
+        m_lastPublished()
+    {
+        m_timer.setSingleShot(true);
+    }
+
+    ~HLastChangeEvents()
+    {
+        qDeleteAll(m_instanceEvents);
+    }
+
+    HInstanceEvents* instanceEvents(qint32 instanceId)
+    {
+        HInstanceEvents* retVal = m_instanceEvents.value(instanceId);
+        if (!retVal)
+        {
+            retVal = new HInstanceEvents(instanceId);
+            m_instanceEvents.insert(instanceId, retVal);
+        }
+        return retVal;
+    }
+};
+
 //
 //
 //
@@ -87,13 +133,16 @@ private:
 
     HMediaRendererDeviceConfiguration* m_configuration;
 
-    QTimer m_timer;
-    QList<HInstanceEvents*> m_avtInstanceEvents;
-    QList<HInstanceEvents*> m_rcsInstanceEvents;
+    HLastChangeEvents m_avtLastChange;
+    HLastChangeEvents m_rcsLastChange;
+
+    void schedule(HLastChangeEvents*);
+    void publish(HLastChangeEvents*, HServerService*, bool rcs);
 
 private Q_SLOTS:
 
-    void timeout();
+    void avtLastChangeTimeout();
+    void rcsLastChangeTimeout();
 
     void propertyChanged(
         Herqq::Upnp::Av::HRendererConnectionInfo* source,
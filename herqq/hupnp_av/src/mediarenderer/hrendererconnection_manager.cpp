@@ -42,10 +42,89 @@ namespace Av
  * HRendererConnectionManagerPrivate
  ******************************************************************************/
 HRendererConnectionManagerPrivate::HRendererConnectionManagerPrivate() :
-    m_connections()
+    m_connections(), m_connectionsById(), m_connectionsByAvTransportId(),
+    m_connectionsByRcsId()
 {
 }
 
+void HRendererConnectionManagerPrivate::add(const HManagedConnection& mc)
+{
+    m_connections.append(mc);
+
+    m_connectionsById.insert(
+        ConnectionKey(mc.m_cmService, mc.m_connectionId), mc.m_connection);
+
+    // An instance ID of -1 means that the connection has no instance of
+    // the service in question.
+    if (mc.m_avTransportId >= 0)
+    {
+        m_connectionsByAvTransportId.insert(
+            ConnectionKey(mc.m_cmService, mc.m_avTransportId), mc.m_connection);
+    }
+    if (mc.m_rcsId >= 0)
+    {
+        m_connectionsByRcsId.insert(
+            ConnectionKey(mc.m_cmService, mc.m_rcsId), mc.m_connection);
+    }
+}
+
+namespace
+{
+void removeFromIndex(
+    QHash<ConnectionKey, HRendererConnection*>* index,
+    const ConnectionKey& key, HRendererConnection* connection)
+{
+    // Another connection may have been indexed with the same key since.
+    if (index->value(key) == connection)
+    {
+        index->remove(key);
+    }
+}
+}
+
+void HRendererConnectionManagerPrivate::removeAt(qint32 index)
+{
+    HManagedConnection mc = m_connections.takeAt(index);
+
+    removeFromIndex(
+        &m_connectionsById,
+        ConnectionKey(mc.m_cmService, mc.m_connectionId), mc.m_connection);
+
+    removeFromIndex(
+        &m_connectionsByAvTransportId,
+        ConnectionKey(mc.m_cmService, mc.m_avTransportId), mc.m_connection);
+
+    removeFromIndex(
+        &m_connectionsByRcsId,
+        ConnectionKey(mc.m_cmService, mc.m_rcsId), mc.m_connection);
+}
+
+qint32 HRendererConnectionManagerPrivate::indexOf(
+    const HAbstractConnectionManagerService* cmService, qint32 cid) const
+{
+    for(qint32 i = 0; i < m_connections.size(); ++i)
+    {
+        const HManagedConnection& mc = m_connections.at(i);
+        if (mc.m_cmService == cmService && mc.m_connectionId == cid)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+qint32 HRendererConnectionManagerPrivate::indexOf(const QObject* connection) const
+{
+    for(qint32 i = 0; i < m_connections.size(); ++i)
+    {
+        if (m_connections.at(i).m_connection == connection)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
 /*******************************************************************************
  * HRendererConnectionManager
  ******************************************************************************/
@@ -62,16 +141,12 @@ HRendererConnectionManager::~HRendererConnectionManager()
 
 void HRendererConnectionManager::destroyed_(QObject* obj)
 {
-    Connections::iterator it = h_ptr->m_connections.begin();
-    for(; it != h_ptr->m_connections.end(); ++it)
+    qint32 index = h_ptr->indexOf(obj);
+    if (index >= 0)
     {
-        if (it->second == obj)
-        {
-            qint32 cid = it->first.second;
-            h_ptr->m_connections.erase(it);
-            emit connectionRemoved(it->first.first, cid);
-            break;
-        }
+        HManagedConnection mc = h_ptr->m_connections.at(index);
+        h_ptr->removeAt(index);
+        emit connectionRemoved(mc.m_cmService, mc.m_connectionId);
     }
 }
 
@@ -104,8 +179,13 @@ HRendererConnection* HRendererConnectionManager::createAndAdd(
 
     connection->finalizeInit();
 
-    h_ptr->m_connections.append(
-        qMakePair(qMakePair(cmService, connectionInfo.connectionId()), connection));
+    HManagedConnection mc;
+    mc.m_cmService = cmService;
+    mc.m_connectionId = connectionInfo.connectionId();
+    mc.m_avTransportId = connectionInfo.avTransportId();
+    mc.m_rcsId = connectionInfo.rcsId();
+    mc.m_connection = connection;
+    h_ptr->add(mc);
 
     emit connectionAdded(cmService, connectionInfo);
 
@@ -115,15 +195,11 @@ HRendererConnection* HRendererConnectionManager::createAndAdd(
 bool HRendererConnectionManager::removeConnection(
     const HAbstractConnectionManagerService* cmService, qint32 cid)
 {
-    Connections::iterator it;
-    for(it = h_ptr->m_connections.begin(); it != h_ptr->m_connections.end(); ++it)
+    qint32 index = h_ptr->indexOf(cmService, cid);
+    if (index >= 0)
     {
-        Connection connection = *it;
-        if (connection.first.first == cmService && connection.first.second == cid)
-        {
-            h_ptr->m_connections.erase(it);
-            return true;
-        }
+        h_ptr->removeAt(index);
+        return true;
     }
 
     return false;
@@ -132,14 +208,20 @@ bool HRendererConnectionManager::removeConnection(
 HRendererConnection* HRendererConnectionManager::connection(
     HAbstractConnectionManagerService* cmService, qint32 cid) const
 {
-    foreach(Connection connection, h_ptr->m_connections)
-    {
-        if (connection.first.first == cmService && connection.first.second == cid)
-        {
-            return connection.second;
-        }
-    }
-    return 0;
+    return h_ptr->m_connectionsById.value(ConnectionKey(cmService, cid));
+}
+
+HRendererConnection* HRendererConnectionManager::connectionByAvTransportId(
+    const HAbstractConnectionManagerService* cmService, qint32 avTransportId) const
+{
+    return h_ptr->m_connectionsByAvTransportId.value(
+        ConnectionKey(cmService, avTransportId));
+}
+
+HRendererConnection* HRendererConnectionManager::connectionByRcsId(
+    const HAbstractConnectionManagerService* cmService, qint32 rcsId) const
+{
+    return h_ptr->m_connectionsByRcsId.value(ConnectionKey(cmService, rcsId));
 }
 
 QList<HRendererConnection*> HRendererConnectionManager::connections(
@@ -147,11 +229,11 @@ QList<HRendererConnection*> HRendererConnectionManager::connections(
 {
     QList<HRendererConnection*> retVal;
 
-    foreach(Connection connection, h_ptr->m_connections)
+    foreach(const HManagedConnection& mc, h_ptr->m_connections)
     {
-        if (connection.first.first == cmService)
+        if (mc.m_cmService == cmService)
         {
-            retVal.append(connection.second);
+            retVal.append(mc.m_connection);
         }
     }
 
@@ -161,17 +243,14 @@ QList<HRendererConnection*> HRendererConnectionManager::connections(
 bool HRendererConnectionManager::connectionComplete(
     HAbstractConnectionManagerService* cmService, qint32 connectionId)
 {
-    Connections::iterator it = h_ptr->m_connections.begin();
-    for(; it != h_ptr->m_connections.end(); ++it)
+    qint32 index = h_ptr->indexOf(cmService, connectionId);
+    if (index >= 0)
     {
-        if (it->first.first == cmService && it->first.second == connectionId)
-        {
-            HRendererConnection* conn =  it->second;
-            h_ptr->m_connections.erase(it);
-            conn->dispose();
-            emit connectionRemoved(it->first.first, connectionId);
-            return true;
-        }
+        HRendererConnection* conn = h_ptr->m_connections.at(index).m_connection;
+        h_ptr->removeAt(index);
+        conn->dispose();
+        emit connectionRemoved(cmService, connectionId);
+        return true;
     }
     return false;
 }
@@ -140,6 +140,39 @@ public:
     HRendererConnection* connection(
         HAbstractConnectionManagerService* cmService, qint32 cid) const;
 
+    /*!
+     * Returns an HRendererConnection instance managed by this manager that
+     * has the specified AVTransport instance ID.
+     *
+     * \param cmService specifies the Connection Manager which owns the connection.
+     *
+     * \param avTransportId specifies the AVTransport instance ID.
+     *
+     * \return an HRendererConnection instance managed by this manager that
+     * has the specified AVTransport instance ID.
+     *
+     * \remarks This is a constant-time lookup.
+     */
+    HRendererConnection* connectionByAvTransportId(
+        const HAbstractConnectionManagerService* cmService,
+        qint32 avTransportId) const;
+
+    /*!
+     * Returns an HRendererConnection instance managed by this manager that
+     * has the specified RenderingControl instance ID.
+     *
+     * \param cmService specifies the Connection Manager which owns the connection.
+     *
+     * \param rcsId specifies the RenderingControl instance ID.
+     *
+     * \return an HRendererConnection instance managed by this manager that
+     * has the specified RenderingControl instance ID.
+     *
+     * \remarks This is a constant-time lookup.
+     */
+    HRendererConnection* connectionByRcsId(
+        const HAbstractConnectionManagerService* cmService, qint32 rcsId) const;
+
     /*!
      * Returns the connections owned by the specified Connection Manager.
      *
@@ -32,6 +32,7 @@
 
 #include <HUpnpAv/HUpnpAv>
 
+#include <QtCore/QHash>
 #include <QtCore/QPair>
 #include <QtCore/QPointer>
 
@@ -44,8 +45,32 @@ namespace Upnp
 namespace Av
 {
 
-typedef QPair<QPair<HAbstractConnectionManagerService*, qint32>, HRendererConnection*> Connection;
-typedef QList<Connection> Connections;
+//
+// A renderer connection under the control of a renderer connection manager
+//
+class HManagedConnection
+{
+public:
+
+    HAbstractConnectionManagerService* m_cmService;
+    qint32 m_connectionId;
+    qint32 m_avTransportId;
+    qint32 m_rcsId;
+    HRendererConnection* m_connection;
+
+    HManagedConnection() :
+        m_cmService(0), m_connectionId(-1), m_avTransportId(-1), m_rcsId(-1),
+        m_connection(0)
+    {
+    }
+};
+
+typedef QList<HManagedConnection> Connections;
+
+// The first component is the Connection Manager that owns the connection and
+// the second component is an ID of the connection or of its AVTransport or
+// RenderingControl instance.
+typedef QPair<const HAbstractConnectionManagerService*, qint32> ConnectionKey;
 
 //
 // Implementation details of HRendererConnectionManager
@@ -55,10 +80,23 @@ class HRendererConnectionManagerPrivate
 public:
 
     Connections m_connections;
+    // the managed connections in the order they were added
+
+    QHash<ConnectionKey, HRendererConnection*> m_connectionsById;
+    QHash<ConnectionKey, HRendererConnection*> m_connectionsByAvTransportId;
+    QHash<ConnectionKey, HRendererConnection*> m_connectionsByRcsId;
+    // the managed connections indexed by the IDs found in the
+    // connection information
 
 public:
 
     HRendererConnectionManagerPrivate();
+
+    void add(const HManagedConnection&);
+    void removeAt(qint32 index);
+
+    qint32 indexOf(const HAbstractConnectionManagerService*, qint32 cid) const;
+    qint32 indexOf(const QObject* connection) const;
 };
 
 }
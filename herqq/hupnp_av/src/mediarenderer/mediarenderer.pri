@@ -9,6 +9,7 @@ HEADERS += \
     $$SRC_LOC/mediarenderer/hrendererconnection_info.h \
     $$SRC_LOC/mediarenderer/hrendererconnection_info_p.h \
     $$SRC_LOC/mediarenderer/hconnection.h \
+    $$SRC_LOC/mediarenderer/hlastchange_dispatcher_p.h \
     $$SRC_LOC/mediarenderer/havt_lastchange_info.h \
     $$SRC_LOC/mediarenderer/hrcs_lastchange_info.h \
     $$SRC_LOC/mediarenderer/habstractmediarenderer_device.h \
@@ -24,6 +25,7 @@ SOURCES += \
     $$SRC_LOC/mediarenderer/hrendererconnection.cpp \
     $$SRC_LOC/mediarenderer/hrendererconnection_info.cpp \
     $$SRC_LOC/mediarenderer/hconnection.cpp \
+    $$SRC_LOC/mediarenderer/hlastchange_dispatcher_p.cpp \
     $$SRC_LOC/mediarenderer/havt_lastchange_info.cpp \
     $$SRC_LOC/mediarenderer/hrcs_lastchange_info.cpp \
     $$SRC_LOC/mediarenderer/hrendererconnection_manager.cpp \